@@ -39,19 +39,73 @@ HEADERS  += \
     spline_library/splines/uniform_cr_spline.h \
     spline_library/splines/quintic_hermite_spline.h \
     spline_library/splines/natural_spline.h \
+    spline_library/splines/baked_cubic_spline.h \
     spline_library/utils/arclength.h \
-    spline_library/utils/splineinverter.h
+    spline_library/utils/splineinverter.h \
+    spline_library/utils/splinecursor.h \
+    spline_library/utils/arclengthindex.h \
+    spline_library/utils/arclengthparameterization.h \
+    spline_library/utils/splinefile.h \
+    spline_library/utils/splinescratch.h \
+    spline_library/utils/speedpolynomial.h \
+    spline_library/utils/splinegpubuffer.h \
+    spline_library/utils/instrumentation.h \
+    spline_library/utils/workstealing.h \
+    spline_library/utils/tessellation.h \
+    spline_library/utils/distancefield.h \
+    spline_library/utils/dynamicsplineinverter.h \
+    spline_library/utils/segmentbvh.h \
+    spline_library/utils/lazysplinecore.h \
+    spline_library/utils/splinepool.h \
+    spline_library/utils/uniformsegmentquadrature.h \
+    spline_library/utils/splinejobs.h
+
+DISTFILES += \
+    spline_library/shaders/spline_eval.glsl \
+    spline_library/shaders/spline_eval.hlsl
 
 
 FORMS    += \
     demo/settingswidget.ui \
     demo/mainwindow.ui
 
-test {
+perftest {
+    #throughput regression tests. they compare wall-clock timings against test/performance_baseline.txt, which depends on the machine and how busy it is,
+    #so they're a separate target instead of part of the unit tests. build them in release mode, and without instrumentation, since that would be timed too
+    message(Performance test build)
+    QT = core testlib
+    CONFIG += console
+    CONFIG -= app_bundle
+    TARGET = PerformanceTests
+    DEFINES += SPLINE_LIBRARY_SIMD_VECTORS
+
+    FORMS =
+    HEADERS = \
+        test/testperformance.h \
+        test/common.h \
+        benchmark/benchmarkharness.h
+    SOURCES = \
+        test/performance_main.cpp \
+        test/testperformance.cpp
+
+    DISTFILES += test/performance_baseline.txt
+
+} else:test {
     message(Test build)
     QT += testlib
     TARGET = UnitTests
 
+    #the instrumentation tests are skipped unless the counters are compiled in, so they need a second build with CONFIG+=instrumentation
+    #the default test build leaves the counters out, to test the library the way it's normally compiled
+    instrumentation {
+        message(Instrumentation enabled)
+        TARGET = UnitTestsInstrumented
+        DEFINES += SPLINE_LIBRARY_INSTRUMENTATION_TIMERS
+    }
+
+    #test the SIMD backed vectors, since the array fallback is the same on every compiler
+    DEFINES += SPLINE_LIBRARY_SIMD_VECTORS
+
     HEADERS += \
         test/testcalculus.h \
         test/testvector.h \
@@ -59,6 +113,8 @@ test {
         test/testlinalg.h \
         test/testarclength.h \
         test/testsplinecommon.h \
+        test/testsplineinverter.h \
+        test/testtessellation.h \
         test/common.h
 
     SOURCES += \
@@ -68,7 +124,22 @@ test {
         test/testspline.cpp \
         test/testlinalg.cpp \
         test/testarclength.cpp \
-        test/testsplinecommon.cpp
+        test/testsplinecommon.cpp \
+        test/testsplineinverter.cpp \
+        test/testtessellation.cpp
+
+} else:benchmark {
+    #headless benchmark of every spline type: doesn't use Qt at all, so replace the demo's sources and modules entirely
+    message(Benchmark build)
+    QT =
+    CONFIG += console
+    CONFIG -= app_bundle
+    TARGET = SplineBenchmark
+    DEFINES += SPLINE_LIBRARY_SIMD_VECTORS
+
+    FORMS =
+    HEADERS = benchmark/benchmarkharness.h
+    SOURCES = benchmark/benchmark_main.cpp
 
 } else {
     SOURCES += demo/main.cpp
@@ -0,0 +1,401 @@
+#include "benchmarkharness.h"
+
+#include "spline_library/vector.h"
+#include "spline_library/spline.h"
+#include "spline_library/splines/uniform_cr_spline.h"
+#include "spline_library/splines/cubic_hermite_spline.h"
+#include "spline_library/splines/quintic_hermite_spline.h"
+#include "spline_library/splines/natural_spline.h"
+#include "spline_library/splines/uniform_cubic_bspline.h"
+#include "spline_library/splines/generic_b_spline.h"
+#include "spline_library/splines/baked_cubic_spline.h"
+#include "spline_library/utils/arclength.h"
+#include "spline_library/utils/splineinverter.h"
+
+#include <fstream>
+#include <memory>
+#include <random>
+#include <cstring>
+#include <cstdlib>
+
+//headless benchmark of every spline type. build with "qmake CONFIG+=benchmark", or compile this file directly with the repository root on the include path
+//run with --help for the list of options
+
+using namespace SplineBenchmark;
+
+namespace
+{
+    template<typename floating_t> const char *floatingName(void);
+    template<> const char *floatingName<float>(void) { return "float"; }
+    template<> const char *floatingName<double>(void) { return "double"; }
+
+    template<size_t dimension, typename floating_t>
+    struct SplineFactory
+    {
+        typedef Vector<dimension, floating_t> VectorT;
+
+        std::string name;
+        std::function<std::unique_ptr<Spline<VectorT, floating_t>>(const std::vector<VectorT>&)> create;
+    };
+
+    //the tangents and curvatures for hermite splines. any smooth-ish data will do, since we're only timing them
+    template<class VectorT>
+    std::vector<VectorT> makeDifferences(const std::vector<VectorT> &points)
+    {
+        std::vector<VectorT> result(points.size());
+        for(size_t i = 0; i < points.size(); i++)
+        {
+            size_t before = i == 0 ? 0 : i - 1;
+            size_t after = i + 1 == points.size() ? i : i + 1;
+            result[i] = points[after] - points[before];
+        }
+        return result;
+    }
+
+    template<size_t dimension, typename floating_t>
+    std::vector<SplineFactory<dimension, floating_t>> makeFactories(void)
+    {
+        typedef Vector<dimension, floating_t> VectorT;
+        typedef std::unique_ptr<Spline<VectorT, floating_t>> SplinePtr;
+        typedef std::vector<VectorT> Points;
+
+        floating_t alpha = floating_t(0.5);
+
+        return {
+            { "UniformCRSpline", [](const Points &p) { return SplinePtr(new UniformCRSpline<VectorT, floating_t>(p)); } },
+            { "CatmullRomSpline", [=](const Points &p) { return SplinePtr(new CubicHermiteSpline<VectorT, floating_t>(p, alpha)); } },
+            { "CubicHermiteSpline", [=](const Points &p) { return SplinePtr(new CubicHermiteSpline<VectorT, floating_t>(p, makeDifferences(p), alpha)); } },
+            { "QuinticCatmullRomSpline", [=](const Points &p) { return SplinePtr(new QuinticHermiteSpline<VectorT, floating_t>(p, alpha)); } },
+            { "QuinticHermiteSpline", [=](const Points &p) {
+                auto tangents = makeDifferences(p);
+                return SplinePtr(new QuinticHermiteSpline<VectorT, floating_t>(p, tangents, makeDifferences(tangents), alpha)); } },
+            { "NaturalSpline", [=](const Points &p) { return SplinePtr(new NaturalSpline<VectorT, floating_t>(p, true, alpha)); } },
+            { "NotAKnotSpline", [=](const Points &p) {
+                return SplinePtr(new NaturalSpline<VectorT, floating_t>(p, true, alpha, NaturalSpline<VectorT, floating_t>::NotAKnot)); } },
+            { "UniformCubicBSpline", [](const Points &p) { return SplinePtr(new UniformCubicBSpline<VectorT, floating_t>(p)); } },
+            { "GenericBSpline5", [](const Points &p) { return SplinePtr(new GenericBSpline<VectorT, floating_t>(p, 5)); } },
+            { "BakedCubicSpline", [=](const Points &p) {
+                NaturalSpline<VectorT, floating_t> natural(p, true, alpha);
+                return SplinePtr(new BakedCubicSpline<VectorT, floating_t>(natural)); } },
+
+            { "LoopingUniformCRSpline", [](const Points &p) { return SplinePtr(new LoopingUniformCRSpline<VectorT, floating_t>(p)); } },
+            { "LoopingCatmullRomSpline", [=](const Points &p) { return SplinePtr(new LoopingCubicHermiteSpline<VectorT, floating_t>(p, alpha)); } },
+            { "LoopingQuinticCatmullRomSpline", [=](const Points &p) { return SplinePtr(new LoopingQuinticHermiteSpline<VectorT, floating_t>(p, alpha)); } },
+            { "LoopingNaturalSpline", [=](const Points &p) { return SplinePtr(new LoopingNaturalSpline<VectorT, floating_t>(p, alpha)); } },
+            { "LoopingUniformCubicBSpline", [](const Points &p) { return SplinePtr(new LoopingUniformCubicBSpline<VectorT, floating_t>(p)); } },
+            { "LoopingGenericBSpline5", [](const Points &p) { return SplinePtr(new LoopingGenericBSpline<VectorT, floating_t>(p, 5)); } },
+        };
+    }
+
+    //a random walk, so that neighboring points are close together, like the points of a real path
+    template<size_t dimension, typename floating_t>
+    std::vector<Vector<dimension, floating_t>> makePoints(size_t size, std::minstd_rand &gen)
+    {
+        std::uniform_real_distribution<floating_t> distribution(-1, 1);
+
+        std::vector<Vector<dimension, floating_t>> result(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            std::array<floating_t, dimension> step;
+            for(size_t d = 0; d < dimension; d++)
+            {
+                step[d] = distribution(gen);
+            }
+            result[i] = i == 0 ? Vector<dimension, floating_t>(step) : result[i - 1] + Vector<dimension, floating_t>(step);
+        }
+        return result;
+    }
+
+    template<size_t dimension, typename floating_t>
+    void runSplineBenchmarks(Runner &runner, const SplineFactory<dimension, floating_t> &factory, size_t size)
+    {
+        typedef Vector<dimension, floating_t> VectorT;
+
+        Result description;
+        description.spline = factory.name;
+        description.floatingType = floatingName<floating_t>();
+        description.dimension = dimension;
+        description.points = size;
+
+        auto nameFor = [&](const char *operation) {
+            std::ostringstream stream;
+            stream << factory.name << "<" << dimension << "," << description.floatingType << ">/" << operation << "/" << size;
+            return stream.str();
+        };
+
+        //skip all the work of building the spline if nothing for this spline is going to run
+        const char *operations[] = { "construction", "getPosition", "getTangent", "getCurvature", "getWiggle", "arcLength", "totalLength", "solveLength", "partitionN", "findClosestT" };
+        bool anyMatch = false;
+        for(const char *operation : operations)
+        {
+            anyMatch |= runner.matches(nameFor(operation));
+        }
+        if(!anyMatch)
+            return;
+
+        std::minstd_rand gen(size * 31 + dimension);
+        std::vector<VectorT> points = makePoints<dimension, floating_t>(size, gen);
+        std::unique_ptr<Spline<VectorT, floating_t>> spline = factory.create(points);
+
+        size_t queries = runner.getOptions().queries;
+        std::uniform_real_distribution<floating_t> tDistribution(0, spline->getMaxT());
+        std::vector<floating_t> tValues(queries);
+        for(auto &t : tValues)
+        {
+            t = tDistribution(gen);
+        }
+
+        auto runOperation = [&](const char *operation, size_t items, const std::function<void(void)> &body) {
+            description.name = nameFor(operation);
+            description.operation = operation;
+            runner.run(description, items, body);
+        };
+
+        runOperation("construction", size, [&]() {
+            auto built = factory.create(points);
+            sink = sink + double(built->getMaxT());
+        });
+
+        runOperation("getPosition", queries, [&]() {
+            floating_t sum = 0;
+            for(floating_t t : tValues)
+                sum += spline->getPosition(t)[0];
+            sink = sink + double(sum);
+        });
+        runOperation("getTangent", queries, [&]() {
+            floating_t sum = 0;
+            for(floating_t t : tValues)
+                sum += spline->getTangent(t).tangent[0];
+            sink = sink + double(sum);
+        });
+        runOperation("getCurvature", queries, [&]() {
+            floating_t sum = 0;
+            for(floating_t t : tValues)
+                sum += spline->getCurvature(t).curvature[0];
+            sink = sink + double(sum);
+        });
+        runOperation("getWiggle", queries, [&]() {
+            floating_t sum = 0;
+            for(floating_t t : tValues)
+                sum += spline->getWiggle(t).wiggle[0];
+            sink = sink + double(sum);
+        });
+
+        //arc lengths between consecutive random T values, so each query crosses about a third of the spline
+        runOperation("arcLength", queries, [&]() {
+            floating_t sum = 0;
+            for(size_t i = 0; i + 1 < tValues.size(); i++)
+                sum += spline->arcLength(tValues[i], tValues[i + 1]);
+            sink = sink + double(sum);
+        });
+        runOperation("totalLength", 1, [&]() {
+            sink = sink + double(spline->totalLength());
+        });
+
+        //solve from each random T for a short distance, so that every query is a single segment's halley iteration
+        floating_t averageSegmentLength = spline->totalLength() / spline->segmentCount();
+        runOperation("solveLength", queries, [&]() {
+            floating_t sum = 0;
+            for(floating_t t : tValues)
+                sum += ArcLength::solveLength(*spline, t, averageSegmentLength * floating_t(0.5));
+            sink = sink + double(sum);
+        });
+        runOperation("partitionN", 1, [&]() {
+            sink = sink + double(ArcLength::partitionN(*spline, spline->segmentCount()).back());
+        });
+
+        //the inverter itself is expensive to build, so only build it if its benchmark is going to run
+        description.name = nameFor("findClosestT");
+        if(runner.matches(description.name) && !runner.getOptions().listOnly)
+        {
+            SplineInverter<VectorT, floating_t, dimension> inverter(*spline);
+
+            std::normal_distribution<floating_t> offsetDistribution(0, floating_t(0.5));
+            std::vector<VectorT> queryPoints(queries);
+            for(size_t i = 0; i < queries; i++)
+            {
+                std::array<floating_t, dimension> offset;
+                for(size_t d = 0; d < dimension; d++)
+                {
+                    offset[d] = offsetDistribution(gen);
+                }
+                queryPoints[i] = spline->getPosition(tValues[i]) + VectorT(offset);
+            }
+
+            runOperation("findClosestT", queries, [&]() {
+                floating_t sum = 0;
+                for(const VectorT &queryPoint : queryPoints)
+                    sum += inverter.findClosestT(queryPoint);
+                sink = sink + double(sum);
+            });
+        }
+        else
+        {
+            runOperation("findClosestT", queries, [](){});
+        }
+    }
+
+    //segment lookups alone, with and without a SplineCommon::KnotIndex. "jittered" knots are about evenly spaced, like the knots of a spline with a small alpha,
+    //while "gapped" knots have a gap thousands of times the usual spacing every 200 knots or so, like a GPS trace with signal dropouts
+    template<typename floating_t>
+    void runKnotLookupBenchmarks(Runner &runner, size_t size)
+    {
+        for(bool gapped : { false, true })
+        {
+            Result description;
+            description.spline = gapped ? "GappedKnots" : "JitteredKnots";
+            description.floatingType = floatingName<floating_t>();
+            description.dimension = 1;
+            description.points = size;
+
+            auto nameFor = [&](const char *operation) {
+                std::ostringstream stream;
+                stream << description.spline << "<" << description.floatingType << ">/" << operation << "/" << size;
+                return stream.str();
+            };
+            if(!runner.matches(nameFor("getIndexForT")) && !runner.matches(nameFor("knotIndex")))
+                continue;
+
+            //build the knots the same way the spline constructors do: accumulate the T distances, then scale them so that the last knot is size - 1
+            std::minstd_rand gen(size * 17 + gapped);
+            std::uniform_real_distribution<floating_t> spacing(floating_t(0.5), floating_t(1.5));
+            std::vector<floating_t> knots(size);
+            floating_t total = 0;
+            for(size_t i = 0; i < size; i++)
+            {
+                knots[i] = total;
+                total += gapped && gen() % 200 == 0 ? spacing(gen) * 5000 : spacing(gen);
+            }
+            floating_t scale = floating_t(size - 1) / knots.back();
+            for(floating_t &knot : knots)
+            {
+                knot *= scale;
+            }
+
+            std::uniform_real_distribution<floating_t> tDistribution(0, knots.back());
+            std::vector<floating_t> tValues(runner.getOptions().queries);
+            for(auto &t : tValues)
+            {
+                t = tDistribution(gen);
+            }
+
+            description.name = nameFor("getIndexForT");
+            description.operation = "getIndexForT";
+            runner.run(description, tValues.size(), [&]() {
+                size_t sum = 0;
+                for(floating_t t : tValues)
+                    sum += SplineCommon::getIndexForT(knots, t);
+                sink = sink + double(sum);
+            });
+
+            SplineCommon::KnotIndex<floating_t> index(knots);
+            description.name = nameFor("knotIndex");
+            description.operation = "knotIndex";
+            runner.run(description, tValues.size(), [&]() {
+                size_t sum = 0;
+                for(floating_t t : tValues)
+                    sum += index.find(knots, t);
+                sink = sink + double(sum);
+            });
+        }
+    }
+
+    template<size_t dimension, typename floating_t>
+    void runAll(Runner &runner)
+    {
+        auto factories = makeFactories<dimension, floating_t>();
+        for(size_t size : runner.getOptions().sizes)
+        {
+            for(const auto &factory : factories)
+            {
+                runSplineBenchmarks(runner, factory, size);
+            }
+        }
+    }
+
+    std::vector<size_t> parseSizes(const char *text)
+    {
+        std::vector<size_t> result;
+        std::istringstream stream(text);
+        std::string item;
+        while(std::getline(stream, item, ','))
+        {
+            if(!item.empty())
+                result.push_back(size_t(std::strtoull(item.c_str(), nullptr, 10)));
+        }
+        return result;
+    }
+
+    void printUsage(void)
+    {
+        std::cout <<
+            "usage: SplineBenchmark [options]\n"
+            "  --sizes=10,1000,100000   point counts to benchmark. every spline type needs at least 8 points\n"
+            "  --filter=text            only run benchmarks whose name contains text, IE --filter=NaturalSpline<3,double>/getPosition\n"
+            "  --min-time=0.1           minimum seconds to spend on each benchmark\n"
+            "  --queries=10000          T values or query points per iteration, for the benchmarks that make many queries\n"
+            "  --json=path              also write the results to path as JSON\n"
+            "  --list                   print the names of the benchmarks that would run, without running them\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    for(int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if(std::strncmp(arg, "--sizes=", 8) == 0)
+            options.sizes = parseSizes(arg + 8);
+        else if(std::strncmp(arg, "--filter=", 9) == 0)
+            options.filter = arg + 9;
+        else if(std::strncmp(arg, "--min-time=", 11) == 0)
+            options.minTime = std::atof(arg + 11);
+        else if(std::strncmp(arg, "--queries=", 10) == 0)
+            options.queries = std::max(size_t(2), size_t(std::strtoull(arg + 10, nullptr, 10)));
+        else if(std::strncmp(arg, "--json=", 7) == 0)
+            options.jsonPath = arg + 7;
+        else if(std::strcmp(arg, "--list") == 0)
+            options.listOnly = true;
+        else
+        {
+            printUsage();
+            return std::strcmp(arg, "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    for(size_t size : options.sizes)
+    {
+        if(size < 8)
+        {
+            std::cerr << "every spline type needs at least 8 points" << std::endl;
+            return 1;
+        }
+    }
+
+    Runner runner(options);
+    for(size_t size : options.sizes)
+    {
+        runKnotLookupBenchmarks<float>(runner, size);
+        runKnotLookupBenchmarks<double>(runner, size);
+    }
+    runAll<2, float>(runner);
+    runAll<3, float>(runner);
+    runAll<4, float>(runner);
+    runAll<2, double>(runner);
+    runAll<3, double>(runner);
+    runAll<4, double>(runner);
+
+    if(!options.jsonPath.empty() && !options.listOnly)
+    {
+        std::ofstream file(options.jsonPath);
+        if(!file)
+        {
+            std::cerr << "couldn't write " << options.jsonPath << std::endl;
+            return 1;
+        }
+        runner.writeJson(file);
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+#include <thread>
+#include <algorithm>
+
+//a minimal timing harness for the headless benchmark, so that it doesn't need Qt or any other dependency
+//each benchmark body is run with a growing iteration count until it takes at least minTime seconds, and the result is reported per item
+//the JSON output follows the layout of google benchmark's --benchmark_format=json, so tools written for that can read it
+namespace SplineBenchmark
+{
+    //benchmark bodies add something computed from their results to this, so that the compiler can't remove the work
+    static volatile double sink = 0;
+
+    struct Result
+    {
+        std::string name;
+        std::string spline;
+        std::string operation;
+        std::string floatingType;
+        size_t dimension;
+        size_t points;
+
+        size_t iterations;
+        size_t itemsPerIteration;
+
+        //wall clock time per item, IE per evaluation for the getPosition benchmarks, or per point for construction
+        double nanosecondsPerItem;
+    };
+
+    struct Options
+    {
+        std::vector<size_t> sizes = { 10, 1000, 100000 };
+
+        //only run benchmarks whose name contains this string
+        std::string filter;
+
+        double minTime = 0.1;
+
+        //number of T values, lengths, or query points used by the benchmarks that make many queries
+        size_t queries = 10000;
+
+        //empty to skip writing JSON
+        std::string jsonPath;
+
+        bool listOnly = false;
+    };
+
+    class Runner
+    {
+    public:
+        Runner(Options options)
+            :options(std::move(options))
+        {}
+
+        const Options &getOptions(void) const { return options; }
+        const std::vector<Result> &getResults(void) const { return results; }
+
+        bool matches(const std::string &name) const
+        {
+            return options.filter.empty() || name.find(options.filter) != std::string::npos;
+        }
+
+        //time the given body, which processes itemsPerIteration items every time it's called
+        void run(Result description, size_t itemsPerIteration, const std::function<void(void)> &body)
+        {
+            if(!matches(description.name))
+                return;
+
+            if(options.listOnly)
+            {
+                std::cout << description.name << std::endl;
+                return;
+            }
+
+            //run once untimed, so that caches and lazily allocated memory are warmed up
+            body();
+
+            size_t iterations = 1;
+            double elapsed = 0;
+            while(true)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                for(size_t i = 0; i < iterations; i++)
+                {
+                    body();
+                }
+                auto end = std::chrono::steady_clock::now();
+                elapsed = std::chrono::duration<double>(end - begin).count();
+
+                if(elapsed >= options.minTime)
+                    break;
+
+                //aim a little past the minimum time, but never grow by more than 10x at once in case the first runs were noisy
+                double scale = elapsed > 0 ? options.minTime * 1.2 / elapsed : 10;
+                iterations = std::max(iterations + 1, size_t(iterations * std::min(scale, 10.0)));
+            }
+
+            description.iterations = iterations;
+            description.itemsPerIteration = itemsPerIteration;
+            description.nanosecondsPerItem = elapsed * 1e9 / (double(iterations) * itemsPerIteration);
+            results.push_back(description);
+
+            std::cout << std::left << std::setw(72) << description.name
+                      << std::right << std::setw(14) << std::fixed << std::setprecision(2) << description.nanosecondsPerItem << " ns"
+                      << std::setw(12) << iterations << std::endl;
+        }
+
+        void writeJson(std::ostream &stream) const
+        {
+            std::time_t now = std::time(nullptr);
+            char date[64];
+            std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+            stream << "{\n";
+            stream << "  \"context\": {\n";
+            stream << "    \"date\": \"" << date << "\",\n";
+            stream << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#if defined(NDEBUG) || defined(QT_NO_DEBUG)
+            stream << "    \"library_build_type\": \"release\",\n";
+#else
+            stream << "    \"library_build_type\": \"debug\",\n";
+#endif
+            stream << "    \"min_time\": " << options.minTime << ",\n";
+            stream << "    \"queries\": " << options.queries << "\n";
+            stream << "  },\n";
+            stream << "  \"benchmarks\": [";
+            for(size_t i = 0; i < results.size(); i++)
+            {
+                const Result &result = results[i];
+                stream << (i == 0 ? "\n" : ",\n");
+                stream << "    {\n";
+                stream << "      \"name\": \"" << result.name << "\",\n";
+                stream << "      \"spline\": \"" << result.spline << "\",\n";
+                stream << "      \"operation\": \"" << result.operation << "\",\n";
+                stream << "      \"floating_type\": \"" << result.floatingType << "\",\n";
+                stream << "      \"dimension\": " << result.dimension << ",\n";
+                stream << "      \"points\": " << result.points << ",\n";
+                stream << "      \"iterations\": " << result.iterations << ",\n";
+                stream << "      \"items_per_iteration\": " << result.itemsPerIteration << ",\n";
+                stream << "      \"real_time\": " << std::setprecision(4) << std::fixed << result.nanosecondsPerItem << ",\n";
+                stream << "      \"time_unit\": \"ns\"\n";
+                stream << "    }";
+            }
+            stream << "\n  ]\n";
+            stream << "}\n";
+        }
+
+    private:
+        Options options;
+        std::vector<Result> results;
+    };
+}
@@ -43,11 +43,20 @@ QMap<QString, float> Benchmarker::runBenchmark(void)
         return result;
     };
 
+    //same as above, but with the degree fixed at compile time
+    auto fixedDegreeBSpline = [this, randomSource](size_t size) {
+        auto points = randomPoints_Uniform<VectorT, D, FloatingT>(randomSource, size);
+        std::unique_ptr<SplineType> result = std::make_unique<LoopingGenericBSpline<VectorT,FloatingT,7>>(points);
+        return result;
+    };
+
     QMap<QString, float> results;
     timeSplineMemberFunction(results, &Benchmarker::testArcLength, crSpline, "uniform_cr[10]",    10000, 12);
     timeSplineMemberFunction(results, &Benchmarker::testArcLength, crSpline, "uniform_cr[1000]",  1000, 1002);
     timeSplineMemberFunction(results, &Benchmarker::testArcLength, genericBSpline, "bspline[10]",    1000, 16);
     timeSplineMemberFunction(results, &Benchmarker::testArcLength, genericBSpline, "bspline[1000]",  100, 1006);
+    timeSplineMemberFunction(results, &Benchmarker::testArcLength, fixedDegreeBSpline, "bspline_fixed[10]",    1000, 16);
+    timeSplineMemberFunction(results, &Benchmarker::testArcLength, fixedDegreeBSpline, "bspline_fixed[1000]",  100, 1006);
 
     return results;
 }
@@ -12,6 +12,7 @@
 #include <algorithm>
 
 #include "spline_library/utils/splineinverter.h"
+#include "spline_library/utils/distancefield.h"
 #include "spline_library/splines/natural_spline.h"
 #include "spline_library/splines/cubic_hermite_spline.h"
 
@@ -194,12 +195,6 @@ void GraphicsController::clearBackground(void)
 
 void GraphicsController::createDistanceField(const QString &filename)
 {
-	QImage output(700,700, QImage::Format_ARGB32_Premultiplied);
-	QPainter painter(&output);
-	painter.setRenderHint(QPainter::Antialiasing);
-	painter.setRenderHint(QPainter::HighQualityAntialiasing);
-	painter.setRenderHint(QPainter::SmoothPixmapTransform);
-
 	qsrand(time(0));
 
     std::vector<QVector3D> colorList;
@@ -215,42 +210,21 @@ void GraphicsController::createDistanceField(const QString &filename)
     else
         colorSpline = std::make_shared<NaturalSpline<QVector3D>>(colorList);
 
-	painter.fillRect(0,0,output.width(),output.height(),Qt::white);
-
-    SplineInverter<QVector2D> calc(*mainSpline.get(), 10);
+    DistanceField<QVector2D>::Settings settings;
+    settings.width = 700;
+    settings.height = 700;
 
 	//supersampling amount - 1 is no supersampling
-    int supersampling = 2;
-	int totalSamples = supersampling * supersampling;
-    float base = 1 / (float(supersampling) * 2);
-    float step = 1 / float(supersampling);
+    settings.supersampling = 2;
 
-	//for every pixel in the image, determine the closest T value
-	for(int y = 0; y < output.height(); y++)
-	{
-		for(int x = 0; x < output.width(); x++)
-		{
-			//use 2x supersampling, with a simple grid
-            QVector3D colorVector;
-			for(int dy = 0; dy < supersampling; dy++) {
-				for(int dx = 0; dx < supersampling; dx++) {
-                    QVector2D realPoint(
-						x + base + dx * step,
-                        y + base + dy * step);
-                    float tfast = calc.findClosestT(realPoint);
-                    colorVector += getColor(tfast);
-				}
-			}
-
-			output.setPixel(x,y,
-				qRgb(
-					colorVector.x() / totalSamples,
-					colorVector.y() / totalSamples,
-					colorVector.z() / totalSamples
-				)
-			);
-		}
-    }
+    //color every pixel by the T value of its closest point, averaged over its samples, using every available thread
+    //each row of a 700 pixel RGBA image is already 4-byte aligned, so the image's bits are exactly the tightly packed layout the field writes
+    QImage output(int(settings.width), int(settings.height), QImage::Format_RGBA8888);
+    DistanceField<QVector2D> field(*mainSpline.get(), settings);
+    field.computeColors([this](float t) {
+        QVector3D color = getColor(t) / 255.0f;
+        return std::array<float, 4>{{ color.x(), color.y(), color.z(), 1.0f }};
+    }, output.bits());
 
 	output.save(filename);
 }
@@ -365,22 +339,25 @@ void GraphicsController::drawSpline(QPainter &painter, const Spline<QVector2D> &
 
     painter.setPen(color);
 
+    //we're going to walk the spline from beginning to end, so use a cursor to avoid searching for the segment of every T value
+    SplineCursor<QVector2D> cursor(s);
+
     while(currentStep <= limit)
     {
-        drawSplineSegment(painter, s, currentStep - stepSize, currentStep);
+        drawSplineSegment(painter, cursor, currentStep - stepSize, currentStep);
         currentStep += stepSize;
     }
 }
 
-void GraphicsController::drawSplineSegment(QPainter &painter, const Spline<QVector2D> &s, float beginT, float endT)
+void GraphicsController::drawSplineSegment(QPainter &painter, SplineCursor<QVector2D> &cursor, float beginT, float endT)
 {
-    auto beginData = s.getPosition(beginT);
-    auto endData = s.getPosition(endT);
+    auto beginData = cursor.getPosition(beginT);
+    auto endData = cursor.getPosition(endT);
 
     float middleT = (beginT + endT) * .5f;
 
     QVector2D midExpected = (beginData + endData) * .5f;
-    auto midActual = s.getPosition((beginT + endT) * .5f);
+    auto midActual = cursor.getPosition((beginT + endT) * .5f);
 
 
 
@@ -393,8 +370,8 @@ void GraphicsController::drawSplineSegment(QPainter &painter, const Spline<QVect
         //if the actual midpoint is too far away from the expected midpoint, subdivide and try again
         if((midExpected - midActual).lengthSquared() > maxDistance)
         {
-            drawSplineSegment(painter, s, beginT, middleT);
-            drawSplineSegment(painter, s, middleT, endT);
+            drawSplineSegment(painter, cursor, beginT, middleT);
+            drawSplineSegment(painter, cursor, middleT, endT);
         }
         else
         {
@@ -418,22 +395,24 @@ void GraphicsController::drawSplineDerivative(QPainter &painter, const Spline<QV
 
     painter.setPen(color);
 
+    SplineCursor<QVector2D> cursor(s);
+
     while(currentStep <= limit)
     {
-        drawSplineSegmentDerivative(painter, s,currentStep - stepSize, currentStep);
+        drawSplineSegmentDerivative(painter, cursor, currentStep - stepSize, currentStep);
         currentStep += stepSize;
     }
 }
 
-void GraphicsController::drawSplineSegmentDerivative(QPainter &painter, const Spline<QVector2D> &s, float beginT, float endT)
+void GraphicsController::drawSplineSegmentDerivative(QPainter &painter, SplineCursor<QVector2D> &cursor, float beginT, float endT)
 {
-    auto beginData = s.getTangent(beginT);
-    auto endData = s.getTangent(endT);
+    auto beginData = cursor.getTangent(beginT);
+    auto endData = cursor.getTangent(endT);
 
     float middleT = (beginT + endT) * .5;
 
     QVector2D midExpected = (beginData.tangent + endData.tangent) * .5;
-    auto midActual = s.getTangent((beginT + endT) * .5);
+    auto midActual = cursor.getTangent((beginT + endT) * .5);
 
 
 
@@ -443,8 +422,8 @@ void GraphicsController::drawSplineSegmentDerivative(QPainter &painter, const Sp
     {
         if((midExpected - midActual.tangent).lengthSquared() > maxDistance)
         {
-            drawSplineSegmentDerivative(painter, s, beginT, middleT);
-            drawSplineSegmentDerivative(painter, s, middleT, endT);
+            drawSplineSegmentDerivative(painter, cursor, beginT, middleT);
+            drawSplineSegmentDerivative(painter, cursor, middleT, endT);
         }
         else
         {
@@ -5,6 +5,7 @@
 #include <QGLWidget>
 
 #include "spline_library/spline.h"
+#include "spline_library/utils/splinecursor.h"
 
 class QVector2D;
 
@@ -56,14 +57,14 @@ private:
      void drawSpline(QPainter &painter, const Spline<QVector2D> &s, const QColor &color);
      void drawSplineSegment(
              QPainter &painter,
-             const Spline<QVector2D> &s,
+             SplineCursor<QVector2D> &cursor,
              float beginT,
              float endT);
 
      void drawSplineDerivative(QPainter &painter, const Spline<QVector2D> &s, const QColor &color);
      void drawSplineSegmentDerivative(
              QPainter &painter,
-             const Spline<QVector2D> &s,
+             SplineCursor<QVector2D> &cursor,
              float beginT,
              float endT);
 
@@ -0,0 +1,103 @@
+// reference evaluator for splines packed by SplineGpuBuffer (spline_library/utils/splinegpubuffer.h)
+// include this in any GLSL 4.30+ shader stage. before including it, either define SPLINE_BUFFER_BINDING to have this file declare
+// the storage buffer, or declare your own std430 buffer containing "uint splineWords[];" and define SPLINE_WORDS_DECLARED
+//
+// every function takes the word offset that SplineGpuBuffer::addSpline returned, so one buffer can hold any number of splines
+// results are vec4s: splines with fewer than 4 dimensions leave the unused components 0
+
+#ifndef SPLINE_WORDS_DECLARED
+#ifndef SPLINE_BUFFER_BINDING
+#define SPLINE_BUFFER_BINDING 0
+#endif
+layout(std430, binding = SPLINE_BUFFER_BINDING) readonly buffer SplineBuffer
+{
+    uint splineWords[];
+};
+#endif
+
+const uint SPLINE_FLAG_LOOPING = 1u;
+
+float splineReadFloat(uint offset)
+{
+    return uintBitsToFloat(splineWords[offset]);
+}
+
+vec4 splineReadCoefficient(uint offset)
+{
+    return vec4(
+        splineReadFloat(offset),
+        splineReadFloat(offset + 1u),
+        splineReadFloat(offset + 2u),
+        splineReadFloat(offset + 3u)
+        );
+}
+
+float splineMaxT(uint splineOffset)
+{
+    return splineReadFloat(splineOffset + 4u);
+}
+
+// return the segment containing t, and write t's offset from the beginning of that segment to s
+// looping splines wrap t into [0, maxT) first
+uint splineFindSegment(uint splineOffset, float t, out float s)
+{
+    uint segmentCount = splineWords[splineOffset + 2u];
+    uint flags = splineWords[splineOffset + 3u];
+    float maxT = splineReadFloat(splineOffset + 4u);
+    uint knotOffset = splineWords[splineOffset + 5u];
+
+    if((flags & SPLINE_FLAG_LOOPING) != 0u)
+    {
+        t = t - maxT * floor(t / maxT);
+    }
+
+    // binary search for the last knot at or before t, clamped to a valid segment
+    uint low = 0u;
+    uint high = segmentCount - 1u;
+    while(low < high)
+    {
+        uint middle = (low + high + 1u) / 2u;
+        if(splineReadFloat(knotOffset + middle) <= t)
+            low = middle;
+        else
+            high = middle - 1u;
+    }
+
+    s = t - splineReadFloat(knotOffset + low);
+    return low;
+}
+
+vec4 splinePosition(uint splineOffset, float t)
+{
+    uint degree = splineWords[splineOffset + 1u];
+    uint coefficientOffset = splineWords[splineOffset + 6u];
+
+    float s;
+    uint segmentIndex = splineFindSegment(splineOffset, t, s);
+    uint base = coefficientOffset + 4u * segmentIndex * (degree + 1u);
+
+    // horner's method, from the highest coefficient down
+    vec4 result = vec4(0.0);
+    for(uint k = degree + 1u; k > 0u; k--)
+    {
+        result = result * s + splineReadCoefficient(base + 4u * (k - 1u));
+    }
+    return result;
+}
+
+vec4 splineTangent(uint splineOffset, float t)
+{
+    uint degree = splineWords[splineOffset + 1u];
+    uint coefficientOffset = splineWords[splineOffset + 6u];
+
+    float s;
+    uint segmentIndex = splineFindSegment(splineOffset, t, s);
+    uint base = coefficientOffset + 4u * segmentIndex * (degree + 1u);
+
+    vec4 result = vec4(0.0);
+    for(uint k = degree; k > 0u; k--)
+    {
+        result = result * s + float(k) * splineReadCoefficient(base + 4u * k);
+    }
+    return result;
+}
@@ -0,0 +1,101 @@
+// reference evaluator for splines packed by SplineGpuBuffer (spline_library/utils/splinegpubuffer.h)
+// include this in any shader model 5.0+ stage. before including it, either define SPLINE_BUFFER_REGISTER (IE t0) to have this file
+// declare the buffer, or declare your own ByteAddressBuffer named splineBuffer and define SPLINE_BUFFER_DECLARED
+//
+// every function takes the word offset that SplineGpuBuffer::addSpline returned, so one buffer can hold any number of splines
+// results are float4s: splines with fewer than 4 dimensions leave the unused components 0
+
+#ifndef SPLINE_BUFFER_DECLARED
+#ifndef SPLINE_BUFFER_REGISTER
+#define SPLINE_BUFFER_REGISTER t0
+#endif
+ByteAddressBuffer splineBuffer : register(SPLINE_BUFFER_REGISTER);
+#endif
+
+static const uint SPLINE_FLAG_LOOPING = 1u;
+
+// offsets are in 32-bit words, to match the C++ and GLSL versions. ByteAddressBuffer addresses are in bytes
+uint splineReadWord(uint offset)
+{
+    return splineBuffer.Load(offset * 4u);
+}
+
+float splineReadFloat(uint offset)
+{
+    return asfloat(splineBuffer.Load(offset * 4u));
+}
+
+float4 splineReadCoefficient(uint offset)
+{
+    return asfloat(splineBuffer.Load4(offset * 4u));
+}
+
+float splineMaxT(uint splineOffset)
+{
+    return splineReadFloat(splineOffset + 4u);
+}
+
+// return the segment containing t, and write t's offset from the beginning of that segment to s
+// looping splines wrap t into [0, maxT) first
+uint splineFindSegment(uint splineOffset, float t, out float s)
+{
+    uint segmentCount = splineReadWord(splineOffset + 2u);
+    uint flags = splineReadWord(splineOffset + 3u);
+    float maxT = splineReadFloat(splineOffset + 4u);
+    uint knotOffset = splineReadWord(splineOffset + 5u);
+
+    if((flags & SPLINE_FLAG_LOOPING) != 0u)
+    {
+        t = t - maxT * floor(t / maxT);
+    }
+
+    // binary search for the last knot at or before t, clamped to a valid segment
+    uint low = 0u;
+    uint high = segmentCount - 1u;
+    while(low < high)
+    {
+        uint middle = (low + high + 1u) / 2u;
+        if(splineReadFloat(knotOffset + middle) <= t)
+            low = middle;
+        else
+            high = middle - 1u;
+    }
+
+    s = t - splineReadFloat(knotOffset + low);
+    return low;
+}
+
+float4 splinePosition(uint splineOffset, float t)
+{
+    uint degree = splineReadWord(splineOffset + 1u);
+    uint coefficientOffset = splineReadWord(splineOffset + 6u);
+
+    float s;
+    uint segmentIndex = splineFindSegment(splineOffset, t, s);
+    uint base = coefficientOffset + 4u * segmentIndex * (degree + 1u);
+
+    // horner's method, from the highest coefficient down
+    float4 result = float4(0.0, 0.0, 0.0, 0.0);
+    for(uint k = degree + 1u; k > 0u; k--)
+    {
+        result = result * s + splineReadCoefficient(base + 4u * (k - 1u));
+    }
+    return result;
+}
+
+float4 splineTangent(uint splineOffset, float t)
+{
+    uint degree = splineReadWord(splineOffset + 1u);
+    uint coefficientOffset = splineReadWord(splineOffset + 6u);
+
+    float s;
+    uint segmentIndex = splineFindSegment(splineOffset, t, s);
+    uint base = coefficientOffset + 4u * segmentIndex * (degree + 1u);
+
+    float4 result = float4(0.0, 0.0, 0.0, 0.0);
+    for(uint k = degree; k > 0u; k--)
+    {
+        result = result * s + float(k) * splineReadCoefficient(base + 4u * k);
+    }
+    return result;
+}
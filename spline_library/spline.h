@@ -1,10 +1,66 @@
 #pragma once
 
 #include <vector>
+#include <cassert>
+#include <type_traits>
 
 #include "utils/spline_common.h"
 #include "utils/calculus.h"
 
+//a non-owning reference to a contiguous array of points, IE a std::vector, or a memory-mapped file
+//view splines store one of these instead of copying their points, so the points must outlive the spline
+template<class InterpolationType>
+class SplinePointView
+{
+public:
+    SplinePointView(void) = default;
+    SplinePointView(const InterpolationType *data, size_t size)
+        :pointData(data), pointCount(size)
+    {}
+    SplinePointView(const std::vector<InterpolationType> &points)
+        :pointData(points.data()), pointCount(points.size())
+    {}
+
+    inline const InterpolationType &operator[](size_t i) const { return pointData[i]; }
+    inline const InterpolationType *data(void) const { return pointData; }
+    inline size_t size(void) const { return pointCount; }
+    inline bool empty(void) const { return pointCount == 0; }
+
+    inline const InterpolationType *begin(void) const { return pointData; }
+    inline const InterpolationType *end(void) const { return pointData + pointCount; }
+    inline const InterpolationType &front(void) const { return pointData[0]; }
+    inline const InterpolationType &back(void) const { return pointData[pointCount - 1]; }
+
+private:
+    const InterpolationType *pointData = nullptr;
+    size_t pointCount = 0;
+};
+
+//flags for evaluate() and segmentEvaluate(), to choose which of the position and its derivatives to compute
+//combine them with |, IE spline.evaluate<SplineDerivatives::Tangent | SplineDerivatives::Curvature>(t) for a caller that never looks at the position
+namespace SplineDerivatives
+{
+    enum : unsigned
+    {
+        Position = 1,
+        Tangent = 2,
+        Curvature = 4,
+        Wiggle = 8,
+
+        All = Position | Tangent | Curvature | Wiggle
+    };
+
+    //the order of the highest and lowest derivatives requested, where the position is order 0. IE for Tangent | Curvature, highestOrder is 2 and lowestOrder is 1
+    constexpr size_t highestOrder(unsigned derivatives)
+    {
+        return (derivatives & Wiggle) ? 3 : (derivatives & Curvature) ? 2 : (derivatives & Tangent) ? 1 : 0;
+    }
+    constexpr size_t lowestOrder(unsigned derivatives)
+    {
+        return (derivatives & Position) ? 0 : (derivatives & Tangent) ? 1 : (derivatives & Curvature) ? 2 : (derivatives & Wiggle) ? 3 : 0;
+    }
+}
+
 template<class InterpolationType, typename floating_t=float>
 class Spline
 {
@@ -13,6 +69,13 @@ public:
         :maxT(maxT), originalPoints(std::move(originalPoints))
     {}
 
+    //for view splines: borrow the caller's points instead of copying them
+    Spline(SplinePointView<InterpolationType> borrowedPoints, floating_t maxT)
+        :maxT(maxT), borrowedPoints(borrowedPoints)
+    {
+        assert(borrowedPoints.data() != nullptr);
+    }
+
 public:
     struct InterpolatedPT;
 
@@ -20,29 +83,77 @@ public:
 
     struct InterpolatedPTCW;
 
+    //result of evaluate() and segmentEvaluate(). only the members that were requested are computed, the rest are left default-constructed
+    struct InterpolatedDerivatives;
+
     virtual InterpolationType getPosition(floating_t x) const = 0;
     virtual InterpolatedPT getTangent(floating_t x) const = 0;
     virtual InterpolatedPTC getCurvature(floating_t x) const = 0;
     virtual InterpolatedPTCW getWiggle(floating_t x) const = 0;
 
+    //batch versions of the above: evaluate count T values from tValues, and write the results to output
+    //output must have room for count results. T values don't need to be sorted, but consecutive T values in the same segment are faster
+    virtual void getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const = 0;
+    virtual void getTangents(const floating_t *tValues, size_t count, InterpolatedPT *output) const = 0;
+    virtual void getCurvatures(const floating_t *tValues, size_t count, InterpolatedPTC *output) const = 0;
+    virtual void getWiggles(const floating_t *tValues, size_t count, InterpolatedPTCW *output) const = 0;
+
     virtual floating_t arcLength(floating_t a, floating_t b) const = 0;
     virtual floating_t totalLength(void) const = 0;
+
+    //version of arcLength that integrates each segment with the given quadrature, IE Quadrature::fast() or Quadrature::adaptive(tolerance)
+    //instead of the default 13 point gauss-legendre quadrature, so that bulk length queries can trade precision for throughput
+    typedef SplineLibraryCalculus::Quadrature<floating_t> Quadrature;
+    virtual floating_t arcLength(floating_t a, floating_t b, const Quadrature &quadrature) const = 0;
     inline floating_t getMaxT(void) const { return maxT; }
 
-    const std::vector<InterpolationType> &getOriginalPoints(void) const { return originalPoints; }
+    //view splines don't store a vector of their points, so this is only available if ownsPoints() is true. getOriginalPointsView works for every spline
+    const std::vector<InterpolationType> &getOriginalPoints(void) const { assert(ownsPoints()); return originalPoints; }
+    SplinePointView<InterpolationType> getOriginalPointsView(void) const { return ownsPoints() ? SplinePointView<InterpolationType>(originalPoints) : borrowedPoints; }
+    bool ownsPoints(void) const { return borrowedPoints.data() == nullptr; }
+
     virtual bool isLooping(void) const = 0;
 
+    //the degree of each segment's polynomial, IE 3 for cubic splines and 5 for quintic splines
+    virtual size_t degree(void) const = 0;
+
     //lower level functions
     virtual size_t segmentCount(void) const = 0;
     virtual size_t segmentForT(floating_t t) const = 0;
     virtual floating_t segmentT(size_t segmentIndex) const = 0;
     virtual floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b) const = 0;
+    virtual floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b, const Quadrature &quadrature) const = 0;
+
+    //versions of getPosition etc that skip the segment lookup, for callers that already know which segment t is in
+    //t must be inside the given segment: for looping splines, t is not wrapped
+    virtual InterpolationType segmentPosition(size_t segmentIndex, floating_t t) const = 0;
+    virtual InterpolatedPT segmentTangent(size_t segmentIndex, floating_t t) const = 0;
+    virtual InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t t) const = 0;
+    virtual InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t t) const = 0;
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE the tangent and curvature without the position
+    //through this base class, each call is one virtual call. SplineImpl and SplineLoopingImpl hide these with versions that call the core directly,
+    //so a caller that knows the concrete spline type gets the core's evaluate() inlined
+    template<unsigned derivatives>
+    inline InterpolatedDerivatives evaluate(floating_t t) const { return evaluateDerivatives(t, derivatives); }
+    template<unsigned derivatives>
+    inline InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t t) const { return segmentEvaluateDerivatives(segmentIndex, t, derivatives); }
 
 protected:
-    const floating_t maxT;
+    //templates can't be virtual, so evaluate() passes its flags at runtime, and the implementation switches back to a compile-time value
+    virtual InterpolatedDerivatives evaluateDerivatives(floating_t t, unsigned derivatives) const = 0;
+    virtual InterpolatedDerivatives segmentEvaluateDerivatives(size_t segmentIndex, floating_t t, unsigned derivatives) const = 0;
+
+    //for splines that can be edited after they're built, so that they can keep their original points in sync with their edits
+    std::vector<InterpolationType> &getEditableOriginalPoints(void) { assert(ownsPoints()); return originalPoints; }
+
+    floating_t maxT;
 
 private:
-    const std::vector<InterpolationType> originalPoints;
+    std::vector<InterpolationType> originalPoints;
+
+    //empty unless this is a view spline
+    const SplinePointView<InterpolationType> borrowedPoints;
 };
 
 template<class InterpolationType, typename floating_t=float>
@@ -52,9 +163,12 @@ public:
     LoopingSpline(std::vector<InterpolationType> originalPoints, floating_t maxT)
         :Spline<InterpolationType, floating_t>(std::move(originalPoints), maxT)
     {}
+    LoopingSpline(SplinePointView<InterpolationType> borrowedPoints, floating_t maxT)
+        :Spline<InterpolationType, floating_t>(borrowedPoints, maxT)
+    {}
 
     inline floating_t wrapT(floating_t t) const {
-        float wrappedT = std::fmod(t, this->maxT);
+        floating_t wrappedT = std::fmod(t, this->maxT);
         if(wrappedT < 0)
             return wrappedT + this->maxT;
         else
@@ -65,34 +179,198 @@ public:
 
 
 
+namespace __SplinePrivate
+{
+    //helpers that are templated on the spline type need to know whether they have a looping spline, so that they can wrap T values
+    //when the static type is already known to be looping, this doesn't need a dynamic_cast
+    template<class InterpolationType, typename floating_t>
+    const LoopingSpline<InterpolationType, floating_t> *asLoopingSpline(const LoopingSpline<InterpolationType, floating_t> *spline)
+    {
+        return spline;
+    }
+
+    template<class InterpolationType, typename floating_t>
+    const LoopingSpline<InterpolationType, floating_t> *asLoopingSpline(const Spline<InterpolationType, floating_t> *spline)
+    {
+        return dynamic_cast<const LoopingSpline<InterpolationType, floating_t>*>(spline);
+    }
+
+    //remembers which segment the most recent T value fell in, so that nearby T values don't need to search for their segment
+    //works with anything that has segmentCount(), segmentForT(), and segmentT() -- IE spline cores, or splines themselves
+    template<typename floating_t>
+    struct SegmentTracker
+    {
+        size_t index = 0;
+        floating_t begin = 0;
+        floating_t end = 0;
+
+        //false until the first search, so that the first T value always searches
+        bool valid = false;
+
+        template<class SegmentedT>
+        void seek(const SegmentedT &segmented, floating_t t)
+        {
+            //the segment's end T belongs to the next segment, so only reuse the segment index when t is in the half-open range [begin, end)
+            if(valid && t >= begin && t < end)
+                return;
+
+            //sorted sweeps almost always move into the next segment, so check that before doing a full search
+            if(valid && t >= end && index + 1 < segmented.segmentCount())
+            {
+                floating_t nextEnd = segmented.segmentT(index + 2);
+                if(t < nextEnd)
+                {
+                    index++;
+                    begin = end;
+                    end = nextEnd;
+                    return;
+                }
+            }
+
+            index = segmented.segmentForT(t);
+            begin = segmented.segmentT(index);
+            end = segmented.segmentT(index + 1);
+            valid = true;
+        }
+    };
+
+    //call function with std::integral_constant<unsigned, derivatives>, to turn flags chosen at runtime back into a template argument
+    //every combination of SplineDerivatives flags is instantiated, counting down from All
+    template<unsigned derivatives = SplineDerivatives::All>
+    struct DerivativeDispatch
+    {
+        template<class Function>
+        static inline auto call(unsigned runtimeDerivatives, Function function)
+        {
+            if(runtimeDerivatives == derivatives)
+                return function(std::integral_constant<unsigned, derivatives>());
+            else
+                return DerivativeDispatch<derivatives - 1>::call(runtimeDerivatives, function);
+        }
+    };
+
+    template<>
+    struct DerivativeDispatch<0>
+    {
+        template<class Function>
+        static inline auto call(unsigned /*runtimeDerivatives*/, Function function)
+        {
+            return function(std::integral_constant<unsigned, 0>());
+        }
+    };
+
+    //an evaluate() call is counted as an evaluation of the highest derivative it computes, IE evaluate<Tangent | Curvature> counts as a curvature evaluation
+    template<unsigned derivatives>
+    inline void countEvaluations(size_t count)
+    {
+        const size_t order = SplineDerivatives::highestOrder(derivatives);
+        if(order == 3) { SPLINE_INSTRUMENT_COUNT_N(WiggleEvaluations, count); }
+        else if(order == 2) { SPLINE_INSTRUMENT_COUNT_N(CurvatureEvaluations, count); }
+        else if(order == 1) { SPLINE_INSTRUMENT_COUNT_N(TangentEvaluations, count); }
+        else if(derivatives != 0) { SPLINE_INSTRUMENT_COUNT_N(PositionEvaluations, count); }
+        (void)count;
+    }
+
+    //evaluate every T value in tValues, writing the results to output
+    //consecutive T values usually fall in the same segment, so we only search for a new segment when we leave the current one
+    template<class SplineCore, typename floating_t, class OutputType, class WrapFunction, class EvaluateFunction>
+    void evaluateBatch(const SplineCore &core, const floating_t *tValues, size_t count, OutputType *output, WrapFunction wrap, EvaluateFunction evaluate)
+    {
+        SegmentTracker<floating_t> tracker;
+
+        for(size_t i = 0; i < count; i++)
+        {
+            floating_t t = wrap(tValues[i]);
+            tracker.seek(core, t);
+            output[i] = evaluate(tracker.index, t);
+        }
+    }
+}
+
+
+
 
 template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
 class SplineImpl: public Spline<InterpolationType, floating_t>
 {
 public:
-    InterpolationType getPosition(floating_t t) const override { return common.getPosition(t); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t t) const override { return common.getTangent(t); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t t) const override { return common.getCurvature(t); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t t) const override { return common.getWiggle(t); }
-
-    floating_t arcLength(floating_t a, floating_t b) const override;
+    InterpolationType getPosition(floating_t t) const override { SPLINE_INSTRUMENT_COUNT(PositionEvaluations); return common.getPosition(t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t t) const override { SPLINE_INSTRUMENT_COUNT(TangentEvaluations); return common.getTangent(t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t t) const override { SPLINE_INSTRUMENT_COUNT(CurvatureEvaluations); return common.getCurvature(t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t t) const override { SPLINE_INSTRUMENT_COUNT(WiggleEvaluations); return common.getWiggle(t); }
+
+    void getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const override;
+    void getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const override;
+    void getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const override;
+    void getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const override;
+
+    floating_t arcLength(floating_t a, floating_t b) const override { return computeArcLength(a, b, SplineLibraryCalculus::DefaultQuadrature()); }
+    floating_t arcLength(floating_t a, floating_t b, const typename Spline<InterpolationType,floating_t>::Quadrature &quadrature) const override { return computeArcLength(a, b, quadrature); }
     floating_t totalLength(void) const override;
 
     bool isLooping(void) const override { return false; }
+    size_t degree(void) const override { return common.degree(); }
 
     size_t segmentCount(void) const override { return common.segmentCount(); }
     size_t segmentForT(floating_t t) const override { return common.segmentForT(t); }
     floating_t segmentT(size_t segmentIndex) const override { return common.segmentT(segmentIndex); }
     floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b) const override { return common.segmentLength(segmentIndex, a, b); }
+    floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b, const typename Spline<InterpolationType,floating_t>::Quadrature &quadrature) const override { return common.segmentLength(segmentIndex, a, b, quadrature); }
+
+    InterpolationType segmentPosition(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(PositionEvaluations); return common.segmentPosition(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(TangentEvaluations); return common.segmentTangent(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(CurvatureEvaluations); return common.segmentCurvature(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(WiggleEvaluations); return common.segmentWiggle(segmentIndex, t); }
+
+    //hide Spline's evaluate() and segmentEvaluate(), so that callers who know the concrete type skip the virtual call
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t t) const { __SplinePrivate::countEvaluations<derivatives>(1); return common.template evaluate<derivatives>(t); }
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t t) const { __SplinePrivate::countEvaluations<derivatives>(1); return common.template segmentEvaluate<derivatives>(segmentIndex, t); }
+
+    //direct access to the non-virtual implementation, for hot loops that know the concrete spline type
+    //the core's methods aren't virtual, so they can be inlined. the core's segment methods are named the same as the spline's, but segmentArcLength is segmentLength
+    typedef SplineCore<InterpolationType, floating_t> CoreType;
+    inline const CoreType &core(void) const { return common; }
+
+    //only for splines whose segments are cubic polynomials: natural, cubic hermite, uniform catmull-rom, and uniform cubic b-splines
+    //precompute each segment's squared speed as a quartic, so that arc length computations integrate the quartic instead of evaluating the tangent
+    //the cache is discarded when the spline is edited. these aren't virtual, so they're only instantiated if they're called
+    void cacheSpeedPolynomials(void) { common.cacheSpeedPolynomials(); }
+    void clearSpeedPolynomials(void) { common.clearSpeedPolynomials(); }
+    bool hasSpeedPolynomials(void) const { return common.hasSpeedPolynomials(); }
+
+    //only for splines with a knot list: cubic and quintic hermite, catmull-rom, natural, generic b-splines, and baked splines
+    //build an index of the knots, so that finding the segment for a T value is a bucket lookup and a short binary search, instead of a galloping search from a uniform guess
+    //worth it when the knot spacing varies a lot, IE with a large alpha on very unevenly spaced points
+    void buildKnotIndex(void) { common.buildKnotIndex(); }
+    void clearKnotIndex(void) { common.clearKnotIndex(); }
+    bool hasKnotIndex(void) const { return common.hasKnotIndex(); }
 
 protected:
     //protected constructor and destructor, so that this class can only be used as a parent class, even though it won't have any pure virtual methods
     SplineImpl(std::vector<InterpolationType> originalPoints, floating_t maxT)
         :Spline<InterpolationType, floating_t>(std::move(originalPoints), maxT)
     {}
+    SplineImpl(SplinePointView<InterpolationType> borrowedPoints, floating_t maxT)
+        :Spline<InterpolationType, floating_t>(borrowedPoints, maxT)
+    {}
     ~SplineImpl(void) = default;
 
     SplineCore<InterpolationType, floating_t> common;
+
+    typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluateDerivatives(floating_t t, unsigned derivatives) const override
+    {
+        return __SplinePrivate::DerivativeDispatch<>::call(derivatives, [this, t](auto flags) { return this->template evaluate<decltype(flags)::value>(t); });
+    }
+    typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluateDerivatives(size_t segmentIndex, floating_t t, unsigned derivatives) const override
+    {
+        return __SplinePrivate::DerivativeDispatch<>::call(derivatives, [this, segmentIndex, t](auto flags) { return this->template segmentEvaluate<decltype(flags)::value>(segmentIndex, t); });
+    }
+
+private:
+    template<class QuadratureType>
+    floating_t computeArcLength(floating_t a, floating_t b, const QuadratureType &quadrature) const;
 };
 
 
@@ -101,30 +379,84 @@ template<template<class, typename> class SplineCore, class InterpolationType, ty
 class SplineLoopingImpl: public LoopingSpline<InterpolationType, floating_t>
 {
 public:
-    InterpolationType getPosition(floating_t globalT) const override { return common.getPosition(this->wrapT(globalT)); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const override { return common.getTangent(this->wrapT(globalT)); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const override { return common.getCurvature(this->wrapT(globalT)); }
-    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const override { return common.getWiggle(this->wrapT(globalT)); }
-
-    floating_t arcLength(floating_t a, floating_t b) const override;
+    InterpolationType getPosition(floating_t globalT) const override { SPLINE_INSTRUMENT_COUNT(PositionEvaluations); return common.getPosition(this->wrapT(globalT)); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const override { SPLINE_INSTRUMENT_COUNT(TangentEvaluations); return common.getTangent(this->wrapT(globalT)); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const override { SPLINE_INSTRUMENT_COUNT(CurvatureEvaluations); return common.getCurvature(this->wrapT(globalT)); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const override { SPLINE_INSTRUMENT_COUNT(WiggleEvaluations); return common.getWiggle(this->wrapT(globalT)); }
+
+    void getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const override;
+    void getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const override;
+    void getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const override;
+    void getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const override;
+
+    floating_t arcLength(floating_t a, floating_t b) const override { return computeArcLength(a, b, SplineLibraryCalculus::DefaultQuadrature()); }
+    floating_t arcLength(floating_t a, floating_t b, const typename Spline<InterpolationType,floating_t>::Quadrature &quadrature) const override { return computeArcLength(a, b, quadrature); }
     floating_t cyclicArcLength(floating_t a, floating_t b) const override;
     floating_t totalLength(void) const override;
 
     bool isLooping(void) const override { return true; }
+    size_t degree(void) const override { return common.degree(); }
 
     size_t segmentCount(void) const override { return common.segmentCount(); }
     size_t segmentForT(floating_t t) const override { return common.segmentForT(this->wrapT(t)); }
     floating_t segmentT(size_t segmentIndex) const override { return common.segmentT(segmentIndex); }
     floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b) const override { return common.segmentLength(segmentIndex, a, b); }
+    floating_t segmentArcLength(size_t segmentIndex, floating_t a, floating_t b, const typename Spline<InterpolationType,floating_t>::Quadrature &quadrature) const override { return common.segmentLength(segmentIndex, a, b, quadrature); }
+
+    InterpolationType segmentPosition(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(PositionEvaluations); return common.segmentPosition(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(TangentEvaluations); return common.segmentTangent(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(CurvatureEvaluations); return common.segmentCurvature(segmentIndex, t); }
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t t) const override { SPLINE_INSTRUMENT_COUNT(WiggleEvaluations); return common.segmentWiggle(segmentIndex, t); }
+
+    //hide Spline's evaluate() and segmentEvaluate(), so that callers who know the concrete type skip the virtual call
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const { __SplinePrivate::countEvaluations<derivatives>(1); return common.template evaluate<derivatives>(this->wrapT(globalT)); }
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t t) const { __SplinePrivate::countEvaluations<derivatives>(1); return common.template segmentEvaluate<derivatives>(segmentIndex, t); }
+
+    //direct access to the non-virtual implementation, for hot loops that know the concrete spline type
+    //the core's methods aren't virtual, so they can be inlined. unlike the spline, the core doesn't wrap t values, so use wrapT() first
+    typedef SplineCore<InterpolationType, floating_t> CoreType;
+    inline const CoreType &core(void) const { return common; }
+
+    //only for splines whose segments are cubic polynomials: natural, cubic hermite, uniform catmull-rom, and uniform cubic b-splines
+    //precompute each segment's squared speed as a quartic, so that arc length computations integrate the quartic instead of evaluating the tangent
+    //the cache is discarded when the spline is edited. these aren't virtual, so they're only instantiated if they're called
+    void cacheSpeedPolynomials(void) { common.cacheSpeedPolynomials(); }
+    void clearSpeedPolynomials(void) { common.clearSpeedPolynomials(); }
+    bool hasSpeedPolynomials(void) const { return common.hasSpeedPolynomials(); }
+
+    //only for splines with a knot list: cubic and quintic hermite, catmull-rom, natural, generic b-splines, and baked splines
+    //build an index of the knots, so that finding the segment for a T value is a bucket lookup and a short binary search, instead of a galloping search from a uniform guess
+    //worth it when the knot spacing varies a lot, IE with a large alpha on very unevenly spaced points
+    void buildKnotIndex(void) { common.buildKnotIndex(); }
+    void clearKnotIndex(void) { common.clearKnotIndex(); }
+    bool hasKnotIndex(void) const { return common.hasKnotIndex(); }
 
 protected:
     //protected constructor and destructor, so that this class can only be used as a parent class, even though it won't have any pure virtual methods
     SplineLoopingImpl(std::vector<InterpolationType> originalPoints, floating_t maxT)
         :LoopingSpline<InterpolationType, floating_t>(std::move(originalPoints), maxT)
     {}
+    SplineLoopingImpl(SplinePointView<InterpolationType> borrowedPoints, floating_t maxT)
+        :LoopingSpline<InterpolationType, floating_t>(borrowedPoints, maxT)
+    {}
     ~SplineLoopingImpl(void) = default;
 
     SplineCore<InterpolationType, floating_t> common;
+
+    typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluateDerivatives(floating_t t, unsigned derivatives) const override
+    {
+        return __SplinePrivate::DerivativeDispatch<>::call(derivatives, [this, t](auto flags) { return this->template evaluate<decltype(flags)::value>(t); });
+    }
+    typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluateDerivatives(size_t segmentIndex, floating_t t, unsigned derivatives) const override
+    {
+        return __SplinePrivate::DerivativeDispatch<>::call(derivatives, [this, segmentIndex, t](auto flags) { return this->template segmentEvaluate<decltype(flags)::value>(segmentIndex, t); });
+    }
+
+private:
+    template<class QuadratureType>
+    floating_t computeArcLength(floating_t a, floating_t b, const QuadratureType &quadrature) const;
 };
 
 
@@ -137,6 +469,7 @@ struct Spline<InterpolationType,floating_t>::InterpolatedPT
     InterpolationType position;
     InterpolationType tangent;
 
+    InterpolatedPT(void) = default;
     InterpolatedPT(const InterpolationType &p, const InterpolationType &t)
         :position(p),tangent(t)
     {}
@@ -149,6 +482,7 @@ struct Spline<InterpolationType,floating_t>::InterpolatedPTC
     InterpolationType tangent;
     InterpolationType curvature;
 
+    InterpolatedPTC(void) = default;
     InterpolatedPTC(const InterpolationType &p, const InterpolationType &t, const InterpolationType &c)
         :position(p),tangent(t),curvature(c)
     {}
@@ -162,14 +496,99 @@ struct Spline<InterpolationType,floating_t>::InterpolatedPTCW
     InterpolationType curvature;
     InterpolationType wiggle;
 
+    InterpolatedPTCW(void) = default;
     InterpolatedPTCW(const InterpolationType &p, const InterpolationType &t, const InterpolationType &c, const InterpolationType &w)
         :position(p),tangent(t),curvature(c), wiggle(w)
     {}
 };
 
+template<class InterpolationType, typename floating_t>
+struct Spline<InterpolationType,floating_t>::InterpolatedDerivatives
+{
+    InterpolationType position;
+    InterpolationType tangent;
+    InterpolationType curvature;
+    InterpolationType wiggle;
+};
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineImpl<SplineCore, InterpolationType, floating_t>::getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(PositionEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [](floating_t t) { return t; },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentPosition(segmentIndex, t); });
+}
+
 template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
-floating_t SplineImpl<SplineCore, InterpolationType, floating_t>::arcLength(floating_t a, floating_t b) const
+void SplineImpl<SplineCore, InterpolationType, floating_t>::getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const
 {
+    SPLINE_INSTRUMENT_COUNT_N(TangentEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [](floating_t t) { return t; },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentTangent(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineImpl<SplineCore, InterpolationType, floating_t>::getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(CurvatureEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [](floating_t t) { return t; },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentCurvature(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineImpl<SplineCore, InterpolationType, floating_t>::getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(WiggleEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [](floating_t t) { return t; },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentWiggle(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(PositionEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [this](floating_t t) { return this->wrapT(t); },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentPosition(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(TangentEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [this](floating_t t) { return this->wrapT(t); },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentTangent(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(CurvatureEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [this](floating_t t) { return this->wrapT(t); },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentCurvature(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+void SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(WiggleEvaluations, count);
+    __SplinePrivate::evaluateBatch(common, tValues, count, output,
+        [this](floating_t t) { return this->wrapT(t); },
+        [this](size_t segmentIndex, floating_t t) { return common.segmentWiggle(segmentIndex, t); });
+}
+
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+template<class QuadratureType>
+floating_t SplineImpl<SplineCore, InterpolationType, floating_t>::computeArcLength(floating_t a, floating_t b, const QuadratureType &quadrature) const
+{
+    SPLINE_INSTRUMENT_TIMER(ArcLength);
+
     if(a > b) {
         std::swap(a,b);
     }
@@ -181,7 +600,7 @@ floating_t SplineImpl<SplineCore, InterpolationType, floating_t>::arcLength(floa
     //if a and b occur inside the same segment, compute the length within that segment
     //but excude cases where a > b, because that means we need to wrap around
     if(aIndex == bIndex) {
-        return common.segmentLength(aIndex, a, b);
+        return common.segmentLength(aIndex, a, b, quadrature);
     }
     else {
         //a and b occur in different segments, so compute one length for every segment
@@ -189,16 +608,16 @@ floating_t SplineImpl<SplineCore, InterpolationType, floating_t>::arcLength(floa
 
         //first segment
         floating_t aEnd = common.segmentT(aIndex + 1);
-        result += common.segmentLength(aIndex, a, aEnd);
+        result += common.segmentLength(aIndex, a, aEnd, quadrature);
 
         //middle segments
         for(size_t i = aIndex + 1; i < bIndex; i++) {
-            result += common.segmentLength(i, common.segmentT(i), common.segmentT(i + 1));
+            result += common.segmentLength(i, common.segmentT(i), common.segmentT(i + 1), quadrature);
         }
 
         //last segment
         floating_t bBegin = common.segmentT(bIndex);
-        result += common.segmentLength(bIndex, bBegin, b);
+        result += common.segmentLength(bIndex, bBegin, b, quadrature);
 
         return result;
     }
@@ -216,8 +635,11 @@ floating_t SplineImpl<SplineCore, InterpolationType, floating_t>::totalLength(vo
 
 
 template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
-floating_t SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::arcLength(floating_t a, floating_t b) const
+template<class QuadratureType>
+floating_t SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::computeArcLength(floating_t a, floating_t b, const QuadratureType &quadrature) const
 {
+    SPLINE_INSTRUMENT_TIMER(ArcLength);
+
     a = this->wrapT(a);
     b = this->wrapT(b);
 
@@ -232,7 +654,7 @@ floating_t SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::arcLeng
     //if a and b occur inside the same segment, compute the length within that segment
     //but excude cases where a > b, because that means we need to wrap around
     if(aIndex == bIndex) {
-        return common.segmentLength(aIndex, a, b);
+        return common.segmentLength(aIndex, a, b, quadrature);
     }
     else {
         //a and b occur in different segments, so compute one length for every segment
@@ -240,16 +662,16 @@ floating_t SplineLoopingImpl<SplineCore, InterpolationType, floating_t>::arcLeng
 
         //first segment
         floating_t aEnd = common.segmentT(aIndex + 1);
-        result += common.segmentLength(aIndex, a, aEnd);
+        result += common.segmentLength(aIndex, a, aEnd, quadrature);
 
         //middle segments
         for(size_t i = aIndex + 1; i < bIndex; i++) {
-            result += common.segmentLength(i, common.segmentT(i), common.segmentT(i + 1));
+            result += common.segmentLength(i, common.segmentT(i), common.segmentT(i + 1), quadrature);
         }
 
         //last segment
         floating_t bBegin = common.segmentT(bIndex);
-        result += common.segmentLength(bIndex, bBegin, b);
+        result += common.segmentLength(bIndex, bBegin, b, quadrature);
 
         return result;
     }
@@ -0,0 +1,620 @@
+#pragma once
+
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "../spline.h"
+
+//power-basis coefficients for one segment: position = a + s * (b + s * (c + s * d)), where s = t - the segment's begin T
+template<class InterpolationType>
+struct alignas(16) BakedCubicSegment
+{
+    InterpolationType a, b, c, d;
+};
+
+//SegmentList and KnotList are std::vectors for baked splines that own their data,
+//or SplinePointViews for view splines that evaluate straight from someone else's memory, IE a memory-mapped spline file
+template<class InterpolationType, typename floating_t, class SegmentList, class KnotList>
+class BakedCubicSplineCommon
+{
+public:
+    typedef BakedCubicSegment<InterpolationType> Segment;
+
+    inline BakedCubicSplineCommon(void) = default;
+    inline BakedCubicSplineCommon(SegmentList segments, KnotList knots)
+        :segments(std::move(segments)), knots(std::move(knots))
+    {}
+
+    //bake the given spline. every segment of the given spline must be a polynomial of degree 3 or less, or this throws std::invalid_argument
+    inline BakedCubicSplineCommon(const Spline<InterpolationType, floating_t> &cubicSpline)
+        :segments(cubicSpline.segmentCount()), knots(cubicSpline.segmentCount() + 1)
+    {
+        requireCubic(cubicSpline);
+
+        for(size_t i = 0; i < segments.size(); i++)
+        {
+            knots[i] = cubicSpline.segmentT(i);
+            segments[i] = bakeSegment(cubicSpline, i);
+        }
+        knots[segments.size()] = cubicSpline.segmentT(segments.size());
+    }
+
+    inline size_t segmentCount(void) const
+    {
+        return segments.size();
+    }
+
+    inline size_t degree(void) const
+    {
+        return 3;
+    }
+
+    //higher degree segments can't be represented by the power-basis cubic coefficients, so baking one would silently produce a different curve
+    //lower degree segments are fine: their higher coefficients are just 0
+    static inline void requireCubic(const Spline<InterpolationType, floating_t> &spline)
+    {
+        if(spline.degree() > 3)
+            throw std::invalid_argument("Only splines of degree 3 or less can be baked into cubic segments");
+    }
+
+    //the Taylor expansion of a cubic at the beginning of its segment is exact, so the coefficients come straight from the position and derivatives there
+    //everything that bakes cubic segments (IE SplinePool and SplineGpuBuffer) goes through this, so they all get exactly the same coefficients
+    static inline Segment bakeSegment(const Spline<InterpolationType, floating_t> &cubicSpline, size_t segmentIndex)
+    {
+        auto result = cubicSpline.segmentWiggle(segmentIndex, cubicSpline.segmentT(segmentIndex));
+        return Segment{result.position, result.tangent, result.curvature / floating_t(2), result.wiggle / floating_t(6)};
+    }
+
+    inline size_t segmentForT(floating_t t) const
+    {
+        size_t segmentIndex = SplineCommon::getIndexForT(knots, knotIndex, t);
+        if(segmentIndex >= segmentCount())
+            return segmentCount() - 1;
+        else
+            return segmentIndex;
+    }
+
+    inline floating_t segmentT(size_t segmentIndex) const
+    {
+        return knots[segmentIndex];
+    }
+
+    //the baked data itself, IE for writing it to a file
+    inline const SegmentList &getSegments(void) const { return segments; }
+    inline const KnotList &getKnots(void) const { return knots; }
+
+    //optional index of the knots, for faster segment lookups on splines whose knot spacing is very uneven
+    inline void buildKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(knots); }
+    inline void clearKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(); }
+    inline bool hasKnotIndex(void) const { return !knotIndex.empty(); }
+
+    inline InterpolationType getPosition(floating_t globalT) const
+    {
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        return computePosition(segments[segmentIndex], localT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        const Segment &segment = segments[segmentIndex];
+
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPT(
+                    computePosition(segment, localT),
+                    computeTangent(segment, localT)
+                    );
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        const Segment &segment = segments[segmentIndex];
+
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPTC(
+                    computePosition(segment, localT),
+                    computeTangent(segment, localT),
+                    computeCurvature(segment, localT)
+                    );
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        const Segment &segment = segments[segmentIndex];
+
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPTCW(
+                    computePosition(segment, localT),
+                    computeTangent(segment, localT),
+                    computeCurvature(segment, localT),
+                    computeWiggle(segment)
+                    );
+    }
+
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        const Segment &segment = segments[segmentIndex];
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(segment, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(segment, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(segment, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(segment);
+        return result;
+    }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
+    {
+        const Segment &segment = segments[segmentIndex];
+        auto segmentFunction = [&segment](floating_t t) -> floating_t {
+            return computeTangent(segment, t).length();
+        };
+
+        floating_t localA = a - knots[segmentIndex];
+        floating_t localB = b - knots[segmentIndex];
+
+        return quadrature(segmentFunction, localA, localB);
+    }
+
+private: //methods
+    //evaluate each polynomial with horner's method
+    static inline InterpolationType computePosition(const Segment &segment, floating_t t)
+    {
+        return segment.a + t * (segment.b + t * (segment.c + t * segment.d));
+    }
+
+    static inline InterpolationType computeTangent(const Segment &segment, floating_t t)
+    {
+        return segment.b + t * (floating_t(2) * segment.c + (3 * t) * segment.d);
+    }
+
+    static inline InterpolationType computeCurvature(const Segment &segment, floating_t t)
+    {
+        return floating_t(2) * segment.c + (6 * t) * segment.d;
+    }
+
+    static inline InterpolationType computeWiggle(const Segment &segment)
+    {
+        return floating_t(6) * segment.d;
+    }
+
+private: //data
+    SegmentList segments;
+    KnotList knots;
+
+    //empty unless buildKnotIndex() has been called
+    SplineCommon::KnotIndex<floating_t> knotIndex;
+};
+
+//SplineImpl expects a core with two template parameters, so bind the storage with an alias
+struct BakedCubicSplineOwningCommon
+{
+    template<class InterpolationType, typename floating_t>
+    using type = BakedCubicSplineCommon<InterpolationType, floating_t, std::vector<BakedCubicSegment<InterpolationType>>, std::vector<floating_t>>;
+};
+
+struct BakedCubicSplineViewCommon
+{
+    template<class InterpolationType, typename floating_t>
+    using type = BakedCubicSplineCommon<InterpolationType, floating_t, SplinePointView<BakedCubicSegment<InterpolationType>>, SplinePointView<floating_t>>;
+};
+
+template<class InterpolationType, typename floating_t=float>
+class BakedCubicSpline final : public SplineImpl<BakedCubicSplineOwningCommon::type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    //convert an existing cubic spline into power-basis form. the result has the same T values and segments as the original
+    //the original spline must be cubic: UniformCRSpline, CubicHermiteSpline, NaturalSpline, UniformCubicBSpline, or GenericBSpline with degree 3 or less
+    //any other spline throws std::invalid_argument
+    BakedCubicSpline(const Spline<InterpolationType, floating_t> &cubicSpline)
+        :SplineImpl<BakedCubicSplineOwningCommon::type, InterpolationType,floating_t>(
+             std::vector<InterpolationType>(cubicSpline.getOriginalPointsView().begin(), cubicSpline.getOriginalPointsView().end()), cubicSpline.getMaxT())
+    {
+        this->common = BakedCubicSplineOwningCommon::type<InterpolationType, floating_t>(cubicSpline);
+    }
+};
+
+template<class InterpolationType, typename floating_t=float>
+class LoopingBakedCubicSpline final : public SplineLoopingImpl<BakedCubicSplineOwningCommon::type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    //convert an existing looping cubic spline into power-basis form. the result has the same T values and segments as the original
+    //the original spline must be cubic: see BakedCubicSpline for the list of cubic spline types
+    LoopingBakedCubicSpline(const LoopingSpline<InterpolationType, floating_t> &cubicSpline)
+        :SplineLoopingImpl<BakedCubicSplineOwningCommon::type, InterpolationType,floating_t>(
+             std::vector<InterpolationType>(cubicSpline.getOriginalPointsView().begin(), cubicSpline.getOriginalPointsView().end()), cubicSpline.getMaxT())
+    {
+        this->common = BakedCubicSplineOwningCommon::type<InterpolationType, floating_t>(cubicSpline);
+    }
+};
+
+//baked splines that borrow their points, knots, and segments instead of copying them, IE from a memory-mapped spline file (see utils/splinefile.h)
+//knots must have one more entry than segments. the data must not be modified or freed while the spline exists
+template<class InterpolationType, typename floating_t=float>
+class BakedCubicSplineView final : public SplineImpl<BakedCubicSplineViewCommon::type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    BakedCubicSplineView(SplinePointView<InterpolationType> points, SplinePointView<floating_t> knots, SplinePointView<BakedCubicSegment<InterpolationType>> segments, floating_t maxT)
+        :SplineImpl<BakedCubicSplineViewCommon::type, InterpolationType,floating_t>(points, maxT)
+    {
+        assert(segments.size() > 0);
+        assert(knots.size() == segments.size() + 1);
+
+        this->common = BakedCubicSplineViewCommon::type<InterpolationType, floating_t>(segments, knots);
+    }
+};
+
+template<class InterpolationType, typename floating_t=float>
+class LoopingBakedCubicSplineView final : public SplineLoopingImpl<BakedCubicSplineViewCommon::type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    LoopingBakedCubicSplineView(SplinePointView<InterpolationType> points, SplinePointView<floating_t> knots, SplinePointView<BakedCubicSegment<InterpolationType>> segments, floating_t maxT)
+        :SplineLoopingImpl<BakedCubicSplineViewCommon::type, InterpolationType,floating_t>(points, maxT)
+    {
+        assert(segments.size() > 0);
+        assert(knots.size() == segments.size() + 1);
+
+        this->common = BakedCubicSplineViewCommon::type<InterpolationType, floating_t>(segments, knots);
+    }
+};
+
+
+
+namespace __BakedCubicSplinePrivate
+{
+    //fallback storage for a pack of lanes, with just enough arithmetic for the polynomials: each operation is a fixed-length loop over the lanes
+    template<typename floating_t, size_t packSize>
+    struct LaneArray
+    {
+        floating_t data[packSize];
+
+        inline floating_t& operator[](size_t lane) { return data[lane]; }
+        inline const floating_t& operator[](size_t lane) const { return data[lane]; }
+
+        inline LaneArray operator+(const LaneArray &other) const
+        {
+            LaneArray result;
+            for(size_t lane = 0; lane < packSize; lane++)
+                result.data[lane] = data[lane] + other.data[lane];
+            return result;
+        }
+
+        inline LaneArray operator*(const LaneArray &other) const
+        {
+            LaneArray result;
+            for(size_t lane = 0; lane < packSize; lane++)
+                result.data[lane] = data[lane] * other.data[lane];
+            return result;
+        }
+
+        inline friend LaneArray operator*(floating_t s, const LaneArray &v)
+        {
+            LaneArray result;
+            for(size_t lane = 0; lane < packSize; lane++)
+                result.data[lane] = s * v.data[lane];
+            return result;
+        }
+    };
+
+    //the type BakedCubicSplineSoA stores a pack of lanes in. like a Vector's storage (see vector.h), it's a vector extension type with SPLINE_LIBRARY_SIMD_VECTORS,
+    //so each operation applies to every lane at once, and packs wider than a register are split into several registers by the compiler
+    template<typename floating_t, size_t packSize>
+    struct Lanes
+    {
+        typedef LaneArray<floating_t, packSize> type;
+    };
+
+#if defined(SPLINE_LIBRARY_SIMD_VECTORS_ENABLED) && (defined(__SSE2__) || defined(__ARM_NEON))
+    template<size_t packSize> struct Lanes<float, packSize> { typedef float type __attribute__((vector_size(packSize * sizeof(float)))); };
+    template<size_t packSize> struct Lanes<double, packSize> { typedef double type __attribute__((vector_size(packSize * sizeof(double)))); };
+#endif
+}
+
+//structure-of-arrays version of the baked cubic spline, for evaluating large batches of T values
+//instead of storing each segment's coefficients together, every coefficient of every component is stored in its own contiguous array
+//T values are evaluated in packs: each pack looks up its segments and gathers their coefficients first, which is scalar,
+//then runs the same polynomial over every lane of the pack at once. with SPLINE_LIBRARY_SIMD_VECTORS, a pack is stored in SIMD registers,
+//so each step of the polynomial is one instruction per register. otherwise it's an array, and each step is a loop over the lanes
+//this isn't a subclass of Spline: it's meant to be built once from an existing cubic spline, then used for bulk evaluation
+template<class InterpolationType, typename floating_t=float, size_t dimension=2>
+class BakedCubicSplineSoA
+{
+public:
+    //number of T values evaluated together by the batch methods
+    static constexpr size_t packSize = 8;
+
+    //the given spline must be cubic, or this throws std::invalid_argument: see BakedCubicSpline for the list of cubic spline types
+    BakedCubicSplineSoA(const Spline<InterpolationType, floating_t> &cubicSpline);
+
+    size_t segmentCount(void) const { return knots.size() - 1; }
+    size_t segmentForT(floating_t t) const;
+    floating_t segmentT(size_t segmentIndex) const { return knots[segmentIndex]; }
+    floating_t getMaxT(void) const { return maxT; }
+    bool isLooping(void) const { return looping; }
+
+    //scalar evaluation. also used as the reference for the batch methods
+    InterpolationType getPosition(floating_t t) const;
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t t) const;
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t t) const;
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t t) const;
+
+    //batch evaluation: evaluate count T values from tValues, and write the results to output
+    void getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const;
+    void getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const;
+    void getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const;
+    void getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const;
+
+private: //types
+    typedef typename __BakedCubicSplinePrivate::Lanes<floating_t, packSize>::type Lanes;
+
+private: //methods
+    enum Coefficient { A, B, C, D };
+
+    //the array of a single coefficient of a single component, indexed by segment
+    inline const floating_t *coefficientArray(size_t component, Coefficient coefficient) const
+    {
+        return coefficients.data() + (component * 4 + coefficient) * segmentCount();
+    }
+
+    floating_t wrapT(floating_t t) const;
+
+    //compute the position and the first `derivatives` derivatives of one component, for every lane in a pack
+    template<size_t derivatives>
+    void evaluatePack(size_t component, const size_t *segmentIndexes, const Lanes &localT, Lanes result[]) const;
+
+    //evaluate the given t values in packs, passing the results of each pack to storeFunction
+    template<size_t derivatives, class StoreFunction>
+    void evaluateBatch(const floating_t *tValues, size_t count, StoreFunction storeFunction) const;
+
+private: //data
+    std::vector<floating_t> knots;
+
+    //indexed by (component * 4 + coefficient) * segmentCount + segment
+    std::vector<floating_t> coefficients;
+
+    floating_t maxT;
+    bool looping;
+};
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+constexpr size_t BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::packSize;
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::BakedCubicSplineSoA(const Spline<InterpolationType, floating_t> &cubicSpline)
+    :knots(cubicSpline.segmentCount() + 1),
+      coefficients(cubicSpline.segmentCount() * dimension * 4),
+      maxT(cubicSpline.getMaxT()),
+      looping(cubicSpline.isLooping())
+{
+    typedef typename BakedCubicSplineOwningCommon::type<InterpolationType, floating_t> CommonType;
+    CommonType::requireCubic(cubicSpline);
+
+    size_t numSegments = cubicSpline.segmentCount();
+    for(size_t i = 0; i < numSegments; i++)
+    {
+        knots[i] = cubicSpline.segmentT(i);
+
+        //bake the segment the same way BakedCubicSplineCommon does, then scatter it into the coefficient arrays
+        auto segment = CommonType::bakeSegment(cubicSpline, i);
+        for(size_t component = 0; component < dimension; component++)
+        {
+            coefficients[(component * 4 + A) * numSegments + i] = segment.a[component];
+            coefficients[(component * 4 + B) * numSegments + i] = segment.b[component];
+            coefficients[(component * 4 + C) * numSegments + i] = segment.c[component];
+            coefficients[(component * 4 + D) * numSegments + i] = segment.d[component];
+        }
+    }
+    knots[numSegments] = cubicSpline.segmentT(numSegments);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+size_t BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::segmentForT(floating_t t) const
+{
+    size_t segmentIndex = SplineCommon::getIndexForT(knots, wrapT(t));
+    if(segmentIndex >= segmentCount())
+        return segmentCount() - 1;
+    else
+        return segmentIndex;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+floating_t BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::wrapT(floating_t t) const
+{
+    if(!looping)
+        return t;
+
+    //same as LoopingSpline::wrapT
+    floating_t wrappedT = std::fmod(t, maxT);
+    if(wrappedT < 0)
+        return wrappedT + maxT;
+    else
+        return wrappedT;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+InterpolationType BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getPosition(floating_t t) const
+{
+    InterpolationType result;
+    getPositions(&t, 1, &result);
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+typename Spline<InterpolationType,floating_t>::InterpolatedPT BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getTangent(floating_t t) const
+{
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT result;
+    getTangents(&t, 1, &result);
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+typename Spline<InterpolationType,floating_t>::InterpolatedPTC BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getCurvature(floating_t t) const
+{
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC result;
+    getCurvatures(&t, 1, &result);
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+typename Spline<InterpolationType,floating_t>::InterpolatedPTCW BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getWiggle(floating_t t) const
+{
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW result;
+    getWiggles(&t, 1, &result);
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getPositions(const floating_t *tValues, size_t count, InterpolationType *output) const
+{
+    evaluateBatch<0>(tValues, count, [output](size_t outputIndex, size_t component, floating_t values[]) {
+        output[outputIndex][component] = values[0];
+    });
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getTangents(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const
+{
+    evaluateBatch<1>(tValues, count, [output](size_t outputIndex, size_t component, floating_t values[]) {
+        output[outputIndex].position[component] = values[0];
+        output[outputIndex].tangent[component] = values[1];
+    });
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getCurvatures(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTC *output) const
+{
+    evaluateBatch<2>(tValues, count, [output](size_t outputIndex, size_t component, floating_t values[]) {
+        output[outputIndex].position[component] = values[0];
+        output[outputIndex].tangent[component] = values[1];
+        output[outputIndex].curvature[component] = values[2];
+    });
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::getWiggles(const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPTCW *output) const
+{
+    evaluateBatch<3>(tValues, count, [output](size_t outputIndex, size_t component, floating_t values[]) {
+        output[outputIndex].position[component] = values[0];
+        output[outputIndex].tangent[component] = values[1];
+        output[outputIndex].curvature[component] = values[2];
+        output[outputIndex].wiggle[component] = values[3];
+    });
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+template<size_t derivatives>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::evaluatePack(
+        size_t component, const size_t *segmentIndexes, const Lanes &localT, Lanes result[]) const
+{
+    const floating_t *aArray = coefficientArray(component, A);
+    const floating_t *bArray = coefficientArray(component, B);
+    const floating_t *cArray = coefficientArray(component, C);
+    const floating_t *dArray = coefficientArray(component, D);
+
+    //gather each lane's coefficients. this is the only part of the pack that depends on the segment indexes
+    Lanes a, b, c, d;
+    for(size_t lane = 0; lane < packSize; lane++)
+    {
+        size_t i = segmentIndexes[lane];
+        a[lane] = aArray[i];
+        b[lane] = bArray[i];
+        c[lane] = cArray[i];
+        d[lane] = dArray[i];
+    }
+
+    //the same horner's method polynomials as BakedCubicSplineCommon, with every operation applied to the whole pack at once
+    const Lanes &t = localT;
+    result[0] = a + t * (b + t * (c + t * d));
+    if(derivatives >= 1)
+        result[1] = b + t * (floating_t(2) * c + (floating_t(3) * t) * d);
+    if(derivatives >= 2)
+        result[2] = floating_t(2) * c + (floating_t(6) * t) * d;
+    if(derivatives >= 3)
+        result[3] = floating_t(6) * d;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+template<size_t derivatives, class StoreFunction>
+void BakedCubicSplineSoA<InterpolationType, floating_t, dimension>::evaluateBatch(const floating_t *tValues, size_t count, StoreFunction storeFunction) const
+{
+    size_t segmentIndexes[packSize];
+    Lanes localT;
+    Lanes result[derivatives + 1];
+    floating_t laneValues[derivatives + 1];
+
+    __SplinePrivate::SegmentTracker<floating_t> tracker;
+
+    for(size_t packBegin = 0; packBegin < count; packBegin += packSize)
+    {
+        size_t packCount = std::min(packSize, count - packBegin);
+
+        //find the segment for each lane. this part is scalar, but for sorted T values it's almost always a comparison or two per lane
+        for(size_t lane = 0; lane < packCount; lane++)
+        {
+            floating_t t = wrapT(tValues[packBegin + lane]);
+            tracker.seek(*this, t);
+            segmentIndexes[lane] = tracker.index;
+            localT[lane] = t - tracker.begin;
+        }
+
+        //if this is the last pack and it isn't full, fill the rest of the lanes with harmless values, so that the pack loop can always run at full length
+        for(size_t lane = packCount; lane < packSize; lane++)
+        {
+            segmentIndexes[lane] = 0;
+            localT[lane] = 0;
+        }
+
+        for(size_t component = 0; component < dimension; component++)
+        {
+            evaluatePack<derivatives>(component, segmentIndexes, localT, result);
+
+            for(size_t lane = 0; lane < packCount; lane++)
+            {
+                for(size_t n = 0; n <= derivatives; n++) {
+                    laneValues[n] = result[n][lane];
+                }
+                storeFunction(packBegin + lane, component, laneValues);
+            }
+        }
+    }
+}
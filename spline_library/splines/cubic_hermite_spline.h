@@ -1,8 +1,11 @@
 #pragma once
 
 #include <cassert>
+#include <algorithm>
 
 #include "../spline.h"
+#include "../utils/speedpolynomial.h"
+#include "../utils/lazysplinecore.h"
 
 template<class InterpolationType, typename floating_t>
 class CubicHermiteSplineCommon
@@ -23,9 +26,14 @@ public:
         return points.size() - 1;
     }
 
+    inline size_t degree(void) const
+    {
+        return 3;
+    }
+
     inline size_t segmentForT(floating_t t) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, t);
+        size_t segmentIndex = SplineCommon::getIndexForT(knots, knotIndex, t);
         if(segmentIndex > segmentCount() - 1)
             return segmentCount() - 1;
         else
@@ -37,20 +45,80 @@ public:
         return knots[segmentIndex];
     }
 
+    //for editable splines: read or change a single point and its knot, or add one to the end
+    inline const CubicHermiteSplinePoint &getPoint(size_t index) const { return points[index]; }
+    inline void setPoint(size_t index, const CubicHermiteSplinePoint &point) { points[index] = point; speedPolynomials.clear(); }
+    inline void setKnot(size_t index, floating_t knot) { knots[index] = knot; speedPolynomials.clear(); clearKnotIndex(); }
+    inline void appendPoint(const CubicHermiteSplinePoint &point, floating_t knot)
+    {
+        points.push_back(point);
+        knots.push_back(knot);
+        speedPolynomials.clear();
+        clearKnotIndex();
+    }
+
+    //for cores whose tangents are filled in after construction, IE by LazySplineCore
+    inline CubicHermiteSplinePoint *pointData(void) { return points.data(); }
+
+    //optional index of the knots, for faster segment lookups on splines whose knot spacing is very uneven. changing or adding a knot discards it
+    inline void buildKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(knots); }
+    inline void clearKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(); }
+    inline bool hasKnotIndex(void) const { return !knotIndex.empty(); }
+
+    //the tangent used by catmull-rom splines, computed from a point, its neighbors, and their T values
+    static inline InterpolationType computeCatmullRomTangent(
+            const InterpolationType &pPrev, const InterpolationType &pCurrent, const InterpolationType &pNext,
+            floating_t tPrev, floating_t tCurrent, floating_t tNext)
+    {
+        //the tangent is the standard catmull-rom spline tangent calculation
+        return
+                pPrev * (tCurrent - tNext) / ((tNext - tPrev) * (tCurrent - tPrev))
+                + pNext * (tCurrent - tPrev) / ((tNext - tPrev) * (tNext - tCurrent))
+
+             //plus a little something extra - this is derived from the pyramid contruction
+             //when the t values are evenly spaced (ie when alpha is 0), this whole line collapses to 0,
+             //yielding the standard catmull-rom formula
+                - pCurrent * ((tCurrent - tPrev) - (tNext - tCurrent)) / ((tNext - tCurrent) * (tCurrent - tPrev));
+    }
+
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        size_t knotIndex = segmentForT(globalT);
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
 
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t knotIndex, floating_t globalT) const
+    {
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
         return computePosition(knotIndex, tDiff, localT);
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t knotIndex, floating_t globalT) const
     {
-        size_t knotIndex = segmentForT(globalT);
-
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -60,10 +128,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t knotIndex, floating_t globalT) const
     {
-        size_t knotIndex = segmentForT(globalT);
-
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -74,10 +140,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t knotIndex, floating_t globalT) const
     {
-        size_t knotIndex = segmentForT(globalT);
-
         floating_t tDiff = knots[knotIndex + 1] - knots[knotIndex];
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -89,8 +153,35 @@ public:
                     );
     }
 
-    inline floating_t segmentLength(size_t index, floating_t a, floating_t b) const
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t knotIndex, floating_t globalT) const
     {
+        floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
+        floating_t localT = (globalT - knots[knotIndex]) / tDiff;
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(knotIndex, tDiff);
+        return result;
+    }
+
+    //optional cache of each segment's speed polynomial, which segmentLength integrates instead of the tangent. setPoint, setKnot, and appendPoint discard it
+    inline void cacheSpeedPolynomials(void) { speedPolynomials = SpeedPolynomial<floating_t>::computeForCore(*this); }
+    inline void clearSpeedPolynomials(void) { speedPolynomials.clear(); }
+    inline bool hasSpeedPolynomials(void) const { return !speedPolynomials.empty(); }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t index, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
+    {
+        if(!speedPolynomials.empty())
+            return speedPolynomials[index].integrate(a - segmentT(index), b - segmentT(index), quadrature);
+
         floating_t tDiff = knots[index + 1] - knots[index];
         auto segmentFunction = [this, index, tDiff](floating_t t) -> floating_t {
             auto tangent = computeTangent(index, tDiff, t);
@@ -100,7 +191,7 @@ public:
         floating_t localA = (a - knots[index]) / tDiff;
         floating_t localB = (b - knots[index]) / tDiff;
 
-        return tDiff * SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, localA, localB);
+        return quadrature(segmentFunction, localA, localB, tDiff);
     }
 
 
@@ -178,6 +269,12 @@ private: //methods
 private: //data
     std::vector<CubicHermiteSplinePoint> points;
     std::vector<floating_t> knots;
+
+    //empty unless cacheSpeedPolynomials() has been called
+    std::vector<SpeedPolynomial<floating_t>> speedPolynomials;
+
+    //empty unless buildKnotIndex() has been called
+    SplineCommon::KnotIndex<floating_t> knotIndex;
 };
 
 
@@ -185,82 +282,318 @@ private: //data
 template<class InterpolationType, typename floating_t=float>
 class CubicHermiteSpline final : public SplineImpl<CubicHermiteSplineCommon, InterpolationType, floating_t>
 {
+    typedef typename CubicHermiteSplineCommon<InterpolationType, floating_t>::CubicHermiteSplinePoint PointData;
+
 //constructors
 public:
     CubicHermiteSpline(const std::vector<InterpolationType> &points, const std::vector<InterpolationType> &tangents, floating_t alpha = 0.0)
-        :SplineImpl<CubicHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 1)
+        :SplineImpl<CubicHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 1),
+          alpha(alpha), padding(0)
     {
         assert(points.size() >= 2);
         assert(points.size() == tangents.size());
 
-        size_t firstTangent = 0;
         size_t numSegments = points.size() - 1;
 
         //compute the T values for each point
-        std::vector<floating_t> knots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, firstTangent);
+        initKnots(points);
 
         //pre-arrange the data needed for interpolation
-        std::vector<typename CubicHermiteSplineCommon<InterpolationType, floating_t>::CubicHermiteSplinePoint> positionData(numSegments + 1);
+        std::vector<floating_t> knots(numSegments + 1);
+        std::vector<PointData> positionData(numSegments + 1);
         for(size_t i = 0; i < positionData.size(); i++)
         {
+            knots[i] = paddedKnot(i);
             positionData[i].position = points[i];
             positionData[i].tangent = tangents[i];
         }
 
         this->common = CubicHermiteSplineCommon<InterpolationType, floating_t>(std::move(positionData), std::move(knots));
+        releaseRawKnots();
     }
 
     CubicHermiteSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0)
-        :SplineImpl<CubicHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 3)
+        :SplineImpl<CubicHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 3),
+          alpha(alpha), padding(1)
     {
         assert(points.size() >= 4);
 
-        size_t firstTangent = 1;
         size_t numSegments = points.size() - 3;
 
         //compute the T values for each point
-        std::vector<floating_t> paddedKnots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, firstTangent);
+        initKnots(points);
 
-        //compute the tangents
-        std::vector<InterpolationType> tangents(points.size());
-        for(size_t i = firstTangent; i < firstTangent + numSegments + 1; i++)
-        {
-            floating_t tPrev = paddedKnots[i - 1];
-            floating_t tCurrent = paddedKnots[i];
-            floating_t tNext = paddedKnots[i + 1];
-
-            InterpolationType pPrev = points.at(i - 1);
-            InterpolationType pCurrent = points.at(i);
-            InterpolationType pNext = points.at(i + 1);
-
-            //the tangent is the standard catmull-rom spline tangent calculation
-            tangents[i] =
-                                pPrev * (tCurrent - tNext) / ((tNext - tPrev) * (tCurrent - tPrev))
-                                + pNext * (tCurrent - tPrev) / ((tNext - tPrev) * (tNext - tCurrent))
-
-                             //plus a little something extra - this is derived from the pyramid contruction
-                             //when the t values are evenly spaced (ie when alpha is 0), this whole line collapses to 0,
-                             //yielding the standard catmull-rom formula
-                                - pCurrent * ((tCurrent - tPrev) - (tNext - tCurrent)) / ((tNext - tCurrent) * (tCurrent - tPrev));
-        }
-
-        //pre-arrange the data needed for interpolation
+        //compute the tangents, and pre-arrange the data needed for interpolation
         std::vector<floating_t> knots(numSegments + 1);
-        std::vector<typename CubicHermiteSplineCommon<InterpolationType, floating_t>::CubicHermiteSplinePoint> positionData(numSegments + 1);
+        std::vector<PointData> positionData(numSegments + 1);
         for(size_t i = 0; i < positionData.size(); i++)
         {
-            knots[i] = paddedKnots[i + firstTangent];
-            positionData[i].position = points[i + firstTangent];
-            positionData[i].tangent = tangents[i + firstTangent];
+            knots[i] = paddedKnot(i + padding);
+            positionData[i].position = points[i + padding];
+            positionData[i].tangent = computeTangent(i + padding);
         }
 
         this->common = CubicHermiteSplineCommon<InterpolationType, floating_t>(std::move(positionData), std::move(knots));
+        releaseRawKnots();
+    }
+
+//editing
+public:
+    //add a point to the end of the spline, IE for a live stream of points. this adds one segment to the end of the spline
+    //only the last segment's tangents and knots are computed. if alpha is nonzero, every knot is rescaled so that maxT is still the number of segments
+    //for splines created with tangents only
+    void appendPoint(const InterpolationType &point, const InterpolationType &tangent)
+    {
+        assert(padding == 0);
+
+        size_t index = appendOriginalPoint(point);
+        this->common.appendPoint(PointData{point, tangent}, 0);
+        updateKnots(index, index + 1);
+    }
+
+    //for splines created without tangents. the previous final point was only used to compute a tangent, so now it becomes the end of the spline,
+    //and the given point is used to compute its tangent
+    void appendPoint(const InterpolationType &point)
+    {
+        assert(padding == 1);
+
+        size_t index = appendOriginalPoint(point);
+        this->common.appendPoint(PointData{this->getOriginalPoints()[index - 1], InterpolationType()}, 0);
+        updateKnots(index - 1, index);
+        updateTangents(index - 1);
+    }
+
+    //replace the point at the given index (an index into getOriginalPoints()). only the segments that use the point are recomputed,
+    //unless alpha is nonzero, in which case every knot is rescaled so that maxT is still the number of segments
+    //for splines created with tangents only
+    void replacePoint(size_t index, const InterpolationType &point, const InterpolationType &tangent)
+    {
+        assert(padding == 0);
+        assert(index < this->getOriginalPoints().size());
+
+        prepareRawKnots();
+        this->getEditableOriginalPoints()[index] = point;
+        this->common.setPoint(index, PointData{point, tangent});
+        replaceRawKnot(index);
+    }
+
+    //for splines created without tangents
+    void replacePoint(size_t index, const InterpolationType &point)
+    {
+        assert(padding == 1);
+        assert(index < this->getOriginalPoints().size());
+
+        prepareRawKnots();
+        this->getEditableOriginalPoints()[index] = point;
+        if(index >= padding && index - padding <= this->common.segmentCount())
+        {
+            PointData data = this->common.getPoint(index - padding);
+            data.position = point;
+            this->common.setPoint(index - padding, data);
+        }
+        replaceRawKnot(index);
+
+        //every tangent that uses this point, or the T value of this point, needs to be recomputed
+        for(size_t i = std::max(index, size_t(1)) - 1; i <= index + 1; i++)
+            updateTangents(i);
+    }
+
+private: //methods
+    //the T value of the original point at the given index, normalized the same way the spline's knots were
+    floating_t paddedKnot(size_t index) const { return rawKnots[index] * knotScale; }
+
+    void initKnots(const std::vector<InterpolationType> &points)
+    {
+        rawKnots = SplineCommon::computeUnnormalizedTValuesWithInnerPadding(points, alpha, padding);
+        knotScale = computeKnotScale();
+    }
+
+    //the raw T values are only needed to edit the spline, so the constructors free them, and the first edit computes them again from the unchanged points
+    //this has to happen before the edit changes any points
+    void releaseRawKnots(void) { rawKnots = std::vector<floating_t>(); }
+    void prepareRawKnots(void)
+    {
+        if(rawKnots.empty())
+            initKnots(this->getOriginalPoints());
+    }
+
+    //same normalization as SplineCommon::computeTValuesWithInnerPadding
+    floating_t computeKnotScale(void) const
+    {
+        size_t desiredMaxT = rawKnots.size() - 2 * padding - 1;
+        return desiredMaxT / rawKnots[rawKnots.size() - 1 - padding];
+    }
+
+    //the catmull-rom tangent of the original point at the given index
+    InterpolationType computeTangent(size_t index) const
+    {
+        const auto &points = this->getOriginalPoints();
+        return CubicHermiteSplineCommon<InterpolationType, floating_t>::computeCatmullRomTangent(
+                    points[index - 1], points[index], points[index + 1],
+                    paddedKnot(index - 1), paddedKnot(index), paddedKnot(index + 1));
+    }
+
+    size_t appendOriginalPoint(const InterpolationType &point)
+    {
+        prepareRawKnots();
+
+        auto &points = this->getEditableOriginalPoints();
+        points.push_back(point);
+
+        size_t index = points.size() - 1;
+        rawKnots.push_back(rawKnots[index - 1] + SplineCommon::computeTDiff(points[index], points[index - 1], alpha));
+        return index;
+    }
+
+    //recompute the raw T values that depend on the point at the given index, then update the spline's knots
+    void replaceRawKnot(size_t index)
+    {
+        const auto &points = this->getOriginalPoints();
+
+        //the point at index 'padding' always has a T value of 0. points before it have T values relative to the point after them,
+        //and points after it have T values relative to the point before them
+        if(index > padding)
+            rawKnots[index] = rawKnots[index - 1] + SplineCommon::computeTDiff(points[index], points[index - 1], alpha);
+        else if(index < padding)
+            rawKnots[index] = rawKnots[index + 1] - SplineCommon::computeTDiff(points[index], points[index + 1], alpha);
+
+        if(index > 0 && index <= padding)
+            rawKnots[index - 1] = rawKnots[index] - SplineCommon::computeTDiff(points[index - 1], points[index], alpha);
+
+        //the T distance to the next point changed, so every later T value moves by the same amount
+        size_t changedEnd = std::min(index + 2, points.size());
+        if(index >= padding && index + 1 < points.size())
+        {
+            floating_t nextKnot = rawKnots[index] + SplineCommon::computeTDiff(points[index + 1], points[index], alpha);
+            floating_t delta = nextKnot - rawKnots[index + 1];
+            if(delta != 0)
+            {
+                for(size_t i = index + 1; i < points.size(); i++)
+                    rawKnots[i] += delta;
+                changedEnd = points.size();
+            }
+        }
+
+        updateKnots(std::max(index, size_t(1)) - 1, changedEnd);
+    }
+
+    //update the spline's knots after the raw T values in [changedBegin, changedEnd) changed
+    //if the normalization changed, every knot changes with it. the catmull-rom tangents are proportional to 1 / the T distance between points,
+    //so they're rescaled too, rather than recomputed
+    void updateKnots(size_t changedBegin, size_t changedEnd)
+    {
+        size_t numSegments = rawKnots.size() - 2 * padding - 1;
+        this->maxT = numSegments;
+
+        floating_t newScale = computeKnotScale();
+        if(newScale != knotScale)
+        {
+            floating_t tangentScale = knotScale / newScale;
+            knotScale = newScale;
+
+            changedBegin = 0;
+            changedEnd = rawKnots.size();
+
+            if(padding > 0)
+            {
+                for(size_t i = 0; i <= numSegments; i++)
+                {
+                    PointData data = this->common.getPoint(i);
+                    data.tangent = data.tangent * tangentScale;
+                    this->common.setPoint(i, data);
+                }
+            }
+        }
+
+        //only the knots of interpolated points are stored in the spline
+        changedBegin = std::max(changedBegin, padding);
+        changedEnd = std::min(changedEnd, numSegments + 1 + padding);
+        for(size_t i = changedBegin; i < changedEnd; i++)
+            this->common.setKnot(i - padding, paddedKnot(i));
     }
+
+    //recompute the tangent of the original point at the given index, if it's one of the interpolated points
+    void updateTangents(size_t index)
+    {
+        if(index < padding || index - padding > this->common.segmentCount())
+            return;
+
+        PointData data = this->common.getPoint(index - padding);
+        data.tangent = computeTangent(index);
+        this->common.setPoint(index - padding, data);
+    }
+
+private: //data
+    floating_t alpha;
+
+    //1 if the tangents are computed from the neighboring points, 0 if they were supplied
+    size_t padding;
+
+    //T values of every original point before they're normalized, so that moving a point only changes the T values next to it
+    //empty until the spline is first edited, so that splines that are never edited don't store a second copy of their knots
+    std::vector<floating_t> rawKnots;
+    floating_t knotScale;
 };
 
 
 
 
+template<class InterpolationType, typename floating_t>
+using LazyCubicHermiteSplineCore = LazySplineCore<CubicHermiteSplineCommon, InterpolationType, floating_t>;
+
+//a CubicHermiteSpline whose catmull-rom tangents are computed one block of points at a time, the first time a segment in the block is evaluated,
+//instead of all at once in the constructor. for very large splines where only a small part is ever evaluated. the results are identical to CubicHermiteSpline's
+template<class InterpolationType, typename floating_t=float>
+class LazyCubicHermiteSpline final : public SplineImpl<LazyCubicHermiteSplineCore, InterpolationType, floating_t>
+{
+    typedef CubicHermiteSplineCommon<InterpolationType, floating_t> CommonType;
+    typedef typename CommonType::CubicHermiteSplinePoint PointData;
+
+//constructors
+public:
+    LazyCubicHermiteSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0, size_t blockSize = 1024)
+        :SplineImpl<LazyCubicHermiteSplineCore, InterpolationType,floating_t>(points, points.size() - 3)
+    {
+        assert(points.size() >= 4);
+
+        size_t padding = 1;
+        size_t numSegments = points.size() - 3;
+
+        //compute the T values for each point
+        std::vector<floating_t> paddedKnots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, padding);
+
+        //the positions and knots are arranged now, and the tangents are left empty until their block is needed
+        std::vector<floating_t> knots(paddedKnots.begin() + padding, paddedKnots.begin() + padding + numSegments + 1);
+        std::vector<PointData> positionData(numSegments + 1);
+        for(size_t i = 0; i < positionData.size(); i++)
+        {
+            positionData[i].position = points[i + padding];
+        }
+
+        //this spline can't be copied or moved, so the block function can keep a view of its original points
+        SplinePointView<InterpolationType> originalPoints = this->getOriginalPointsView();
+        auto computeBlock = [originalPoints, paddedKnots = std::move(paddedKnots), padding](CommonType &core, size_t beginPoint, size_t endPoint) {
+            PointData *pointData = core.pointData();
+            for(size_t i = beginPoint; i < endPoint; i++)
+            {
+                size_t index = i + padding;
+                pointData[i].tangent = CommonType::computeCatmullRomTangent(
+                            originalPoints[index - 1], originalPoints[index], originalPoints[index + 1],
+                            paddedKnots[index - 1], paddedKnots[index], paddedKnots[index + 1]);
+            }
+        };
+
+        this->common = LazyCubicHermiteSplineCore<InterpolationType, floating_t>(
+                    CommonType(std::move(positionData), std::move(knots)), numSegments + 1, blockSize, std::move(computeBlock));
+    }
+
+    //compute every tangent that hasn't been computed yet
+    void prepareAll(void) const { this->common.prepareAll(); }
+    size_t preparedBlockCount(void) const { return this->common.preparedBlockCount(); }
+};
+
+
+
 template<class InterpolationType, typename floating_t=float>
 class LoopingCubicHermiteSpline final : public SplineLoopingImpl<CubicHermiteSplineCommon, InterpolationType, floating_t>
 {
@@ -310,15 +643,7 @@ public:
             InterpolationType pCurrent = points[i];
             InterpolationType pNext = points[(i + 1)%size];
 
-            //the tangent is the standard catmull-rom spline tangent calculation
-            tangents[i] =
-                                pPrev * (tCurrent - tNext) / ((tNext - tPrev) * (tCurrent - tPrev))
-                                + pNext * (tCurrent - tPrev) / ((tNext - tPrev) * (tNext - tCurrent))
-
-                             //plus a little something extra - this is derived from the pyramid contruction
-                             //when the t values are evenly spaced (ie when alpha is 0), this whole line collapses to 0,
-                             //yielding the standard catmull-rom formula
-                                - pCurrent * ((tCurrent - tPrev) - (tNext - tCurrent)) / ((tNext - tCurrent) * (tCurrent - tPrev));
+            tangents[i] = CubicHermiteSplineCommon<InterpolationType, floating_t>::computeCatmullRomTangent(pPrev, pCurrent, pNext, tPrev, tCurrent, tNext);
         }
 
         //pre-arrange the data needed for interpolation
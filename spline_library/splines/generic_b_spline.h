@@ -1,21 +1,35 @@
 #pragma once
 
 #include <cassert>
+#include <array>
+#include <algorithm>
 
 #include "../spline.h"
 
-template<class InterpolationType, typename floating_t>
+//if fixedDegree is 0, the degree is chosen at runtime. otherwise, the degree is always fixedDegree, so that the de boor loops have a compile-time length
+//PositionStorage is std::vector for splines that own their control points, or SplinePointView for view splines that evaluate straight from the caller's points
+template<class InterpolationType, typename floating_t, size_t fixedDegree, class PositionStorage = std::vector<InterpolationType>>
 class GenericBSplineCommon
 {
 public:
+    //largest runtime degree whose de boor working space fits in a fixed-size array on the stack. higher runtime degrees allocate it on the heap for every evaluation
+    static constexpr size_t maxRuntimeDegree = 15;
+
     inline GenericBSplineCommon(void) = default;
-    inline GenericBSplineCommon(std::vector<InterpolationType> positions, std::vector<floating_t> knots, size_t splineDegree)
+    inline GenericBSplineCommon(PositionStorage positions, std::vector<floating_t> knots, size_t splineDegree)
         :positions(std::move(positions)), knots(std::move(knots)), splineDegree(splineDegree)
-    {}
+    {
+        assert(fixedDegree == 0 || splineDegree == fixedDegree);
+    }
 
     inline size_t segmentCount(void) const
     {
-        return positions.size() - splineDegree;
+        return positions.size() - degree();
+    }
+
+    inline size_t degree(void) const
+    {
+        return fixedDegree > 0 ? fixedDegree : splineDegree;
     }
 
     inline size_t segmentForT(floating_t t) const
@@ -24,7 +38,7 @@ public:
             return 0;
         }
 
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, t) - (splineDegree - 1);
+        size_t segmentIndex = SplineCommon::getIndexForT(knots, knotIndex, t) - (degree() - 1);
         if(segmentIndex > segmentCount() - 1)
         {
             return segmentCount() - 1;
@@ -37,56 +51,99 @@ public:
 
     inline floating_t segmentT(size_t segmentIndex) const
     {
-        return knots[segmentIndex + splineDegree - 1];
+        return knots[segmentIndex + degree() - 1];
     }
 
+    //optional index of the knots, for faster segment lookups on splines whose knot spacing is very uneven
+    inline void buildKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(knots); }
+    inline void clearKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(); }
+    inline bool hasKnotIndex(void) const { return !knotIndex.empty(); }
+
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
-        size_t innerIndex = segmentIndex + (splineDegree - 1);
-
-        return computeDeboor(innerIndex + 1, splineDegree, globalT);
+        return segmentPosition(segmentForT(globalT), globalT);
     }
 
     inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
-        size_t innerIndex = segmentIndex + (splineDegree - 1);
-
-        return typename Spline<InterpolationType,floating_t>::InterpolatedPT(
-                    computeDeboor(innerIndex + 1, splineDegree, globalT),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 1)
-                    );
+        return segmentTangent(segmentForT(globalT), globalT);
     }
 
     inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
-        size_t innerIndex = segmentIndex + (splineDegree - 1);
-
-        return typename Spline<InterpolationType,floating_t>::InterpolatedPTC(
-                    computeDeboor(innerIndex + 1, splineDegree, globalT),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 1),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 2)
-                    );
+        return segmentCurvature(segmentForT(globalT), globalT);
     }
 
     inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
-        size_t innerIndex = segmentIndex + (splineDegree - 1);
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
+        size_t innerIndex = segmentIndex + (degree() - 1);
+
+        return computeDeboor<0>(innerIndex + 1, globalT)[0];
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
+    {
+        size_t innerIndex = segmentIndex + (degree() - 1);
+        auto result = computeDeboor<1>(innerIndex + 1, globalT);
+
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPT(result[0], result[1]);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
+    {
+        size_t innerIndex = segmentIndex + (degree() - 1);
+        auto result = computeDeboor<2>(innerIndex + 1, globalT);
 
-        return typename Spline<InterpolationType,floating_t>::InterpolatedPTCW(
-                    computeDeboor(innerIndex + 1, splineDegree, globalT),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 1),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 2),
-                    computeDeboorDerivative(innerIndex + 1, splineDegree, globalT, 3)
-                    );
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPTC(result[0], result[1], result[2]);
     }
 
-    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b) const {
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
+    {
+        size_t innerIndex = segmentIndex + (degree() - 1);
+        auto result = computeDeboor<3>(innerIndex + 1, globalT);
+
+        return typename Spline<InterpolationType,floating_t>::InterpolatedPTCW(result[0], result[1], result[2], result[3]);
+    }
 
-        auto innerIndex = segmentIndex + splineDegree - 1;
+    //without the position, the de boor algorithm can stop before its last levels, and skip the derivatives below the lowest one requested
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
+    {
+        const size_t highest = SplineDerivatives::highestOrder(derivatives);
+        const size_t lowest = SplineDerivatives::lowestOrder(derivatives);
+
+        size_t innerIndex = segmentIndex + (degree() - 1);
+        auto deboor = computeDeboor<highest, lowest>(innerIndex + 1, globalT);
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = deboor[0];
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = deboor[std::min<size_t>(1, highest)];
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = deboor[std::min<size_t>(2, highest)];
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = deboor[std::min<size_t>(3, highest)];
+        return result;
+    }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const {
+
+        auto innerIndex = segmentIndex + degree() - 1;
 
         floating_t tDistance = knots[innerIndex + 1] - knots[innerIndex];
 
@@ -94,11 +151,11 @@ public:
         if(tDistance > 0)
         {
             auto segmentFunction = [this, innerIndex](floating_t t) -> floating_t {
-                auto tangent = computeDeboorDerivative(innerIndex + 1, splineDegree, t, 1);
+                auto tangent = computeDeboor<1, 1>(innerIndex + 1, t)[1];
                 return tangent.length();
             };
 
-            return SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, a, b);
+            return quadrature(segmentFunction, a, b);
         }
         else
         {
@@ -107,76 +164,150 @@ public:
     }
 
 private: //methods
-    InterpolationType computeDeboor(size_t knotIndex, size_t degree, float globalT) const;
-    InterpolationType computeDeboorDerivative(size_t knotIndex, size_t degree, float globalT, int derivativeLevel) const;
+    //working space for the de boor algorithm: one entry per control point that affects a segment
+    typedef std::array<InterpolationType, (fixedDegree > 0 ? fixedDegree : maxRuntimeDegree) + 1> DeboorBuffer;
+
+    //compute the position and the first `derivatives` derivatives at globalT, for the segment whose last control point is knotIndex
+    //result[0] is the position, result[n] is the nth derivative. if lowestDerivative is above 0, results below it are left default-constructed,
+    //and the blending levels that only they need are skipped
+    template<size_t derivatives, size_t lowestDerivative = 0>
+    std::array<InterpolationType, derivatives + 1> computeDeboor(size_t knotIndex, floating_t globalT) const;
+
+    //the de boor algorithm itself, using the given working space. Buffer is either DeboorBuffer or a std::vector with at least degree() + 1 entries
+    template<size_t derivatives, size_t lowestDerivative, class Buffer>
+    std::array<InterpolationType, derivatives + 1> computeDeboor(size_t knotIndex, floating_t globalT, Buffer &points, std::array<Buffer, derivatives> &stagePoints) const;
 
 private: //data
-    std::vector<InterpolationType> positions;
+    PositionStorage positions;
     std::vector<floating_t> knots;
     size_t splineDegree;
+
+    //empty unless buildKnotIndex() has been called
+    SplineCommon::KnotIndex<floating_t> knotIndex;
 };
 
-template<class InterpolationType, typename floating_t>
-InterpolationType GenericBSplineCommon<InterpolationType,floating_t>::computeDeboor(size_t knotIndex, size_t degree, float globalT) const
+template<class InterpolationType, typename floating_t, size_t fixedDegree, class PositionStorage>
+constexpr size_t GenericBSplineCommon<InterpolationType,floating_t,fixedDegree,PositionStorage>::maxRuntimeDegree;
+
+template<class InterpolationType, typename floating_t, size_t fixedDegree, class PositionStorage>
+template<size_t derivatives, size_t lowestDerivative>
+std::array<InterpolationType, derivatives + 1> GenericBSplineCommon<InterpolationType,floating_t,fixedDegree,PositionStorage>::computeDeboor(size_t knotIndex, floating_t globalT) const
 {
-    if(degree == 0)
+    if(fixedDegree > 0 || degree() <= maxRuntimeDegree)
     {
-        return positions[knotIndex];
+        DeboorBuffer points;
+        std::array<DeboorBuffer, derivatives> stagePoints;
+        return computeDeboor<derivatives, lowestDerivative>(knotIndex, globalT, points, stagePoints);
     }
     else
     {
-        floating_t alpha = (globalT - knots[knotIndex - 1]) / (knots[knotIndex + splineDegree - degree] - knots[knotIndex - 1]);
-
-        InterpolationType leftRecursive = computeDeboor(knotIndex - 1, degree - 1, globalT);
-        InterpolationType rightRecursive = computeDeboor(knotIndex, degree - 1, globalT);
-
-        InterpolationType blended = leftRecursive * (1 - alpha) + rightRecursive * alpha;
-
-        return blended;
+        std::vector<InterpolationType> points(degree() + 1);
+        std::array<std::vector<InterpolationType>, derivatives> stagePoints;
+        for(auto &stage : stagePoints)
+        {
+            stage.resize(degree() + 1);
+        }
+        return computeDeboor<derivatives, lowestDerivative>(knotIndex, globalT, points, stagePoints);
     }
 }
 
-template<class InterpolationType, typename floating_t>
-InterpolationType GenericBSplineCommon<InterpolationType,floating_t>::computeDeboorDerivative(size_t knotIndex, size_t degree, float globalT, int derivativeLevel) const
+template<class InterpolationType, typename floating_t, size_t fixedDegree, class PositionStorage>
+template<size_t derivatives, size_t lowestDerivative, class Buffer>
+std::array<InterpolationType, derivatives + 1> GenericBSplineCommon<InterpolationType,floating_t,fixedDegree,PositionStorage>::computeDeboor(
+        size_t knotIndex, floating_t globalT, Buffer &points, std::array<Buffer, derivatives> &stagePoints) const
 {
-    if(degree == 0)
+    const size_t splineDegree = degree();
+    std::array<InterpolationType, derivatives + 1> result;
+
+    //the nth derivative is computed from level splineDegree - n, so nothing past the level of the lowest requested result is needed
+    const size_t lastLevel = splineDegree - std::min(lowestDerivative, splineDegree);
+    const size_t firstDerivative = lowestDerivative > 1 ? lowestDerivative : 1;
+
+    //this is the triangular form of the de boor algorithm: start with the splineDegree + 1 control points that affect this segment,
+    //then repeatedly blend adjacent points. each level has one fewer point than the previous, and the final level is the position
+    //points[i] holds the point whose knot index is knotIndex - splineDegree + i
+    for(size_t i = 0; i <= splineDegree; i++)
     {
-        //if we hit degree 0 before derivative level 0, then this spline's
-        //degree isn't high enough to support whatever derivative level was requested
-        return InterpolationType();
+        points[i] = positions[knotIndex - splineDegree + i];
     }
-    else
+
+    //the nth derivative uses the n+1 points at level splineDegree - n, so save a copy of those in stagePoints when we pass that level
+    for(size_t level = 0; level <= lastLevel; level++)
     {
-        floating_t multiplier = degree / (knots[knotIndex + splineDegree - degree] - knots[knotIndex - 1]);
+        //level 0 is the control points themselves. for the other levels, go backwards so that points[i - 1] still holds the previous level's value when we read it
+        if(level > 0)
+        {
+            for(size_t i = splineDegree; i >= level; i--)
+            {
+                size_t currentIndex = knotIndex - splineDegree + i;
+                floating_t alpha = (globalT - knots[currentIndex - 1]) / (knots[currentIndex + splineDegree - level] - knots[currentIndex - 1]);
 
-        if(derivativeLevel <= 1)
+                points[i] = points[i - 1] * (1 - alpha) + points[i] * alpha;
+            }
+        }
+
+        size_t derivativeLevel = splineDegree - level;
+        if(derivativeLevel >= firstDerivative && derivativeLevel <= derivatives)
         {
-            //once we reach this point, the derivative calculation is "complete"
-            //in that from here, we go back to the normal deboor calculation deeper in the recursive tree
-            return multiplier *
-                    (computeDeboor(knotIndex, degree - 1, globalT)
-                   - computeDeboor(knotIndex - 1, degree - 1, globalT)
-                     );
+            std::copy_n(points.begin() + level, derivativeLevel + 1, stagePoints[derivativeLevel - 1].begin());
         }
-        else
+    }
+    if(lowestDerivative == 0)
+        result[0] = points[splineDegree];
+
+    //each derivative replaces the remaining levels' blends with scaled differences
+    for(size_t n = firstDerivative; n <= derivatives; n++)
+    {
+        //if the degree is lower than the derivative level, the derivative is 0
+        if(n > splineDegree)
         {
-            //recursively call the derivative function to compute a higher derivative
-            return multiplier *
-                    (computeDeboorDerivative(knotIndex, degree - 1, globalT, derivativeLevel - 1)
-                   - computeDeboorDerivative(knotIndex - 1, degree - 1, globalT, derivativeLevel - 1)
-                     );
+            result[n] = InterpolationType();
+            continue;
         }
+
+        //stage[i] holds the point whose knot index is knotIndex - n + i
+        Buffer &stage = stagePoints[n - 1];
+        for(size_t level = splineDegree - n + 1; level <= splineDegree; level++)
+        {
+            for(size_t i = n; i >= level - (splineDegree - n); i--)
+            {
+                size_t currentIndex = knotIndex - n + i;
+                floating_t multiplier = level / (knots[currentIndex + splineDegree - level] - knots[currentIndex - 1]);
+
+                stage[i] = multiplier * (stage[i] - stage[i - 1]);
+            }
+        }
+        result[n] = stage[n];
     }
+
+    return result;
 }
 
-template<class InterpolationType, typename floating_t=float>
-class GenericBSpline final : public SplineImpl<GenericBSplineCommon, InterpolationType, floating_t>
+//SplineImpl expects a core with two template parameters, so bind the degree with an alias
+template<size_t fixedDegree>
+struct GenericBSplineCommonForDegree
+{
+    template<class InterpolationType, typename floating_t>
+    using type = GenericBSplineCommon<InterpolationType, floating_t, fixedDegree>;
+};
+
+template<size_t fixedDegree>
+struct GenericBSplineViewCommonForDegree
+{
+    template<class InterpolationType, typename floating_t>
+    using type = GenericBSplineCommon<InterpolationType, floating_t, fixedDegree, SplinePointView<InterpolationType>>;
+};
+
+//if fixedDegree is nonzero, the degree is known at compile time and the degree passed to the constructor must match it
+template<class InterpolationType, typename floating_t=float, size_t fixedDegree=0>
+class GenericBSpline final : public SplineImpl<GenericBSplineCommonForDegree<fixedDegree>::template type, InterpolationType, floating_t>
 {
 //constructors
 public:
-    GenericBSpline(const std::vector<InterpolationType> &points, size_t degree)
-        :SplineImpl<GenericBSplineCommon, InterpolationType,floating_t>(points, points.size() - degree)
+    GenericBSpline(const std::vector<InterpolationType> &points, size_t degree = fixedDegree)
+        :SplineImpl<GenericBSplineCommonForDegree<fixedDegree>::template type, InterpolationType,floating_t>(points, points.size() - degree)
     {
+        assert(degree > 0);
         assert(points.size() > degree);
 
         std::vector<floating_t> knots(points.size() + degree - 1);
@@ -185,18 +316,19 @@ public:
             knots[i] = floating_t(i) - floating_t(degree - 1);
         }
 
-        this->common = GenericBSplineCommon<InterpolationType, floating_t>(points, std::move(knots), degree);
+        this->common = GenericBSplineCommon<InterpolationType, floating_t, fixedDegree>(points, std::move(knots), degree);
     }
 };
 
-template<class InterpolationType, typename floating_t=float>
-class LoopingGenericBSpline final : public SplineLoopingImpl<GenericBSplineCommon, InterpolationType, floating_t>
+template<class InterpolationType, typename floating_t=float, size_t fixedDegree=0>
+class LoopingGenericBSpline final : public SplineLoopingImpl<GenericBSplineCommonForDegree<fixedDegree>::template type, InterpolationType, floating_t>
 {
 //constructors
 public:
-    LoopingGenericBSpline(const std::vector<InterpolationType> &points, size_t degree)
-        :SplineLoopingImpl<GenericBSplineCommon, InterpolationType,floating_t>(points, points.size())
+    LoopingGenericBSpline(const std::vector<InterpolationType> &points, size_t degree = fixedDegree)
+        :SplineLoopingImpl<GenericBSplineCommonForDegree<fixedDegree>::template type, InterpolationType,floating_t>(points, points.size())
     {
+        assert(degree > 0);
         assert(points.size() > degree);
 
         std::vector<floating_t> knots(points.size() + degree * 2 - 1);
@@ -216,7 +348,29 @@ public:
         std::copy(points.begin(), points.end(), positions.begin() + 1);
         std::copy_n(points.begin(), padding, positions.end() - padding);
 
-        this->common = GenericBSplineCommon<InterpolationType, floating_t>(std::move(positions), std::move(knots), degree);
+        this->common = GenericBSplineCommon<InterpolationType, floating_t, fixedDegree>(std::move(positions), std::move(knots), degree);
     }
 };
 
+//same as GenericBSpline, but borrows the given control points instead of copying them, IE to evaluate a memory-mapped file of points in place
+//the points must not be modified or freed while the spline exists. the spline still stores its own knot vector
+template<class InterpolationType, typename floating_t=float, size_t fixedDegree=0>
+class GenericBSplineView final : public SplineImpl<GenericBSplineViewCommonForDegree<fixedDegree>::template type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    GenericBSplineView(SplinePointView<InterpolationType> points, size_t degree = fixedDegree)
+        :SplineImpl<GenericBSplineViewCommonForDegree<fixedDegree>::template type, InterpolationType,floating_t>(points, points.size() - degree)
+    {
+        assert(degree > 0);
+        assert(points.size() > degree);
+
+        std::vector<floating_t> knots(points.size() + degree - 1);
+        for(size_t i = 0; i < knots.size(); i++)
+        {
+            knots[i] = floating_t(i) - floating_t(degree - 1);
+        }
+
+        this->common = GenericBSplineCommon<InterpolationType, floating_t, fixedDegree, SplinePointView<InterpolationType>>(points, std::move(knots), degree);
+    }
+};
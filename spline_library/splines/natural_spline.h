@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cassert>
+#include <algorithm>
 
 #include "../spline.h"
+#include "../utils/speedpolynomial.h"
 #include "../utils/linearalgebra.h"
+#include "../utils/splinescratch.h"
 
 template<class InterpolationType, typename floating_t>
 class NaturalSplineCommon
@@ -24,9 +27,14 @@ public:
         return segments.size() - 1;
     }
 
+    inline size_t degree(void) const
+    {
+        return 3;
+    }
+
     inline size_t segmentForT(floating_t t) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, t);
+        size_t segmentIndex = SplineCommon::getIndexForT(knots, knotIndex, t);
         if(segmentIndex >= segmentCount())
             return segmentCount() - 1;
         else
@@ -38,24 +46,61 @@ public:
         return knots[segmentIndex];
     }
 
+    //for editable splines: read or change a single point's data and knot, or add one to the end
+    inline const NaturalSplineSegment &getSegment(size_t index) const { return segments[index]; }
+    inline void setSegment(size_t index, const NaturalSplineSegment &segment) { segments[index] = segment; speedPolynomials.clear(); }
+    inline void setKnot(size_t index, floating_t knot) { knots[index] = knot; speedPolynomials.clear(); clearKnotIndex(); }
+    inline void appendSegment(const NaturalSplineSegment &segment, floating_t knot)
+    {
+        segments.push_back(segment);
+        knots.push_back(knot);
+        speedPolynomials.clear();
+        clearKnotIndex();
+    }
+
+    //optional index of the knots, for faster segment lookups on splines whose knot spacing is very uneven. changing or adding a knot discards it
+    inline void buildKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(knots); }
+    inline void clearKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(); }
+    inline bool hasKnotIndex(void) const { return !knotIndex.empty(); }
+
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(segmentIndex >= knots.size() - 1)
-            segmentIndex--;
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
 
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
         floating_t localT = globalT - knots[segmentIndex];
         floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
 
         return computePosition(segmentIndex, tDiff, localT);
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(segmentIndex >= knots.size() - 1)
-            segmentIndex--;
-
         floating_t localT = globalT - knots[segmentIndex];
         floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
 
@@ -65,12 +110,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(segmentIndex >= knots.size() - 1)
-            segmentIndex--;
-
         floating_t localT = globalT - knots[segmentIndex];
         floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
 
@@ -81,12 +122,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(segmentIndex >= knots.size() - 1)
-            segmentIndex--;
-
         floating_t localT = globalT - knots[segmentIndex];
         floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
 
@@ -98,7 +135,34 @@ public:
                     );
     }
 
-    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b) const {
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - knots[segmentIndex];
+        floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(segmentIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(segmentIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(segmentIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(segmentIndex, tDiff);
+        return result;
+    }
+
+    //optional cache of each segment's speed polynomial, which segmentLength integrates instead of the tangent. setSegment, setKnot, and appendSegment discard it
+    inline void cacheSpeedPolynomials(void) { speedPolynomials = SpeedPolynomial<floating_t>::computeForCore(*this); }
+    inline void clearSpeedPolynomials(void) { speedPolynomials.clear(); }
+    inline bool hasSpeedPolynomials(void) const { return !speedPolynomials.empty(); }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const {
+
+        if(!speedPolynomials.empty())
+            return speedPolynomials[segmentIndex].integrate(a - segmentT(segmentIndex), b - segmentT(segmentIndex), quadrature);
 
         floating_t tDiff = knots[segmentIndex + 1] - knots[segmentIndex];
         auto segmentFunction = [=](floating_t t) -> floating_t {
@@ -109,7 +173,7 @@ public:
         floating_t localA = a - knots[segmentIndex];
         floating_t localB = b - knots[segmentIndex];
 
-        return SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, localA, localB);
+        return quadrature(segmentFunction, localA, localB);
     }
 
 private: //methods
@@ -169,67 +233,411 @@ private: //methods
 private: //data
     std::vector<NaturalSplineSegment> segments;
     std::vector<floating_t> knots;
+
+    //empty unless cacheSpeedPolynomials() has been called
+    std::vector<SpeedPolynomial<floating_t>> speedPolynomials;
+
+    //empty unless buildKnotIndex() has been called
+    SplineCommon::KnotIndex<floating_t> knotIndex;
 };
 
 
 template<class InterpolationType, typename floating_t=float>
 class NaturalSpline final : public SplineImpl<NaturalSplineCommon, InterpolationType, floating_t>
 {
+    typedef typename NaturalSplineCommon<InterpolationType, floating_t>::NaturalSplineSegment SegmentData;
+
 public:
     enum EndConditions { Natural, NotAKnot };
 
+    //number of curvatures on either side of an edit that are recomputed by appendPoint and replacePoint, unless a different window is given
+    static constexpr size_t defaultUpdateWindow = 32;
+
 //constructors
 public:
     NaturalSpline(const std::vector<InterpolationType> &points,
                   bool includeEndpoints = true,
                   floating_t alpha = 0.0,
                   EndConditions endConditions = Natural)
-        :SplineImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, includeEndpoints ? points.size()- 1 : points.size() - 3)
+        :SplineImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, includeEndpoints ? points.size()- 1 : points.size() - 3),
+          alpha(alpha), padding(includeEndpoints ? 0 : 1), endConditions(endConditions)
     {
-        size_t size = points.size();
-        size_t firstPoint;
-        size_t numSegments;
+        SplineScratch<InterpolationType, floating_t> scratch;
+        build(scratch);
+    }
+
+    //same as above, but use the given scratch object for temporary storage, so that building many splines in a row doesn't allocate temporary arrays for each one
+    NaturalSpline(const std::vector<InterpolationType> &points,
+                  SplineScratch<InterpolationType, floating_t> &scratch,
+                  bool includeEndpoints = true,
+                  floating_t alpha = 0.0,
+                  EndConditions endConditions = Natural)
+        :SplineImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, includeEndpoints ? points.size()- 1 : points.size() - 3),
+          alpha(alpha), padding(includeEndpoints ? 0 : 1), endConditions(endConditions)
+    {
+        build(scratch);
+    }
+
+    //build one natural spline for each list of points, IE one for each animation channel of a rig. every list must have the same number of points
+    //the splines are built with an alpha of 0 and natural end conditions, so they all have the same knots, and share the same system of equations:
+    //it's only factored once, and solved for every spline together. the splines are identical to building each one separately
+    static std::vector<NaturalSpline> buildUniformBatch(const std::vector<std::vector<InterpolationType>> &pointLists, bool includeEndpoints = true);
+
+//editing
+public:
+    //add a point to the end of the spline, IE for a live stream of points. this adds one segment to the end of the spline
+    //every curvature on a natural spline depends on every point, but the effect of a point shrinks by at least half with every point after it
+    //so instead of solving for every curvature again, this only solves for the last updateWindow curvatures, and keeps the rest as they are
+    //the error this introduces is at most 2^-updateWindow times the change in curvature at the end of the spline, which is far below floating point precision by default
+    //if alpha is nonzero, every knot is also rescaled so that maxT is still the number of segments
+    //only available for splines with natural end conditions
+    void appendPoint(const InterpolationType &point, size_t updateWindow = defaultUpdateWindow)
+    {
+        SplineScratch<InterpolationType, floating_t> scratch;
+        appendPoint(point, scratch, updateWindow);
+    }
+
+    //replace the point at the given index (an index into getOriginalPoints()). curvatures within updateWindow points of the edit are recomputed
+    //only available for splines with natural end conditions
+    void replacePoint(size_t index, const InterpolationType &point, size_t updateWindow = defaultUpdateWindow)
+    {
+        SplineScratch<InterpolationType, floating_t> scratch;
+        replacePoint(index, point, scratch, updateWindow);
+    }
+
+    //same as above, but use the given scratch object to solve for the curvatures, so that a stream of edits doesn't allocate temporary arrays for each one
+    void appendPoint(const InterpolationType &point, SplineScratch<InterpolationType, floating_t> &scratch, size_t updateWindow = defaultUpdateWindow);
+    void replacePoint(size_t index, const InterpolationType &point, SplineScratch<InterpolationType, floating_t> &scratch, size_t updateWindow = defaultUpdateWindow);
+
+private: //methods
+    //for buildUniformBatch: build a spline with an alpha of 0 and natural end conditions from curvatures that were already computed
+    //the curvature of point i is at curvatures[i * curvatureStride]
+    NaturalSpline(const std::vector<InterpolationType> &points, bool includeEndpoints, const InterpolationType *curvatures, size_t curvatureStride)
+        :SplineImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, includeEndpoints ? points.size()- 1 : points.size() - 3),
+          alpha(0), padding(includeEndpoints ? 0 : 1), endConditions(Natural)
+    {
+        initKnots();
+        buildSegments(curvatures, curvatureStride);
+        releaseRawKnots();
+    }
+
+    void build(SplineScratch<InterpolationType, floating_t> &scratch);
+    void initKnots(void);
+
+    //the raw T values are only needed to edit the spline, so the constructors free them, and the first edit computes them again from the unchanged points
+    //this has to happen before the edit changes any points
+    void releaseRawKnots(void) { rawKnots = std::vector<floating_t>(); }
+    void prepareRawKnots(void)
+    {
+        if(rawKnots.empty())
+            initKnots();
+    }
+
+    void buildSegments(const InterpolationType *curvatures, size_t curvatureStride);
+
+    //write the curvature of every original point to curvatures, using float slots 1 and up in scratch for temporary storage
+    void computeCurvaturesNatural(const floating_t *tValues, InterpolationType *curvatures, SplineScratch<InterpolationType, floating_t> &scratch) const;
+    void computeCurvaturesNotAKnot(const floating_t *tValues, InterpolationType *curvatures, SplineScratch<InterpolationType, floating_t> &scratch) const;
+
+    //the T value of the original point at the given index, normalized the same way the spline's knots were
+    floating_t paddedKnot(size_t index) const { return rawKnots[index] * knotScale; }
+
+    //same normalization as SplineCommon::computeTValuesWithInnerPadding
+    floating_t computeKnotScale(void) const
+    {
+        size_t desiredMaxT = rawKnots.size() - 2 * padding - 1;
+        return desiredMaxT / rawKnots[rawKnots.size() - 1 - padding];
+    }
+
+    //the curvature of the original point at the given index. points that aren't interpolated have a curvature of 0
+    InterpolationType paddedCurvature(size_t index) const
+    {
+        if(index < padding || index - padding > this->common.segmentCount())
+            return InterpolationType();
+        else
+            return this->common.getSegment(index - padding).c;
+    }
+
+    //update the spline's knots after the raw T values in [changedBegin, changedEnd) changed
+    //if the normalization changed, every knot changes with it. scaling every T distance by s scales every curvature by 1 / s^2, so curvatures are rescaled rather than solved again
+    void updateKnots(size_t changedBegin, size_t changedEnd);
+
+    //solve for the curvatures of the original points in [first, last], keeping the curvatures of the points on either side fixed
+    void solveCurvatures(size_t first, size_t last, SplineScratch<InterpolationType, floating_t> &scratch);
+
+private: //data
+    floating_t alpha;
+
+    //1 if the first and last points aren't interpolated, 0 if they are
+    size_t padding;
+
+    EndConditions endConditions;
+
+    //T values of every original point before they're normalized, so that moving a point only changes the T values next to it
+    //empty until the spline is first edited, so that splines that are never edited don't store a second copy of their knots
+    std::vector<floating_t> rawKnots;
+    floating_t knotScale;
+};
+
+template<class InterpolationType, typename floating_t>
+constexpr size_t NaturalSpline<InterpolationType,floating_t>::defaultUpdateWindow;
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::build(SplineScratch<InterpolationType, floating_t> &scratch)
+{
+    const auto &points = this->getOriginalPoints();
+    size_t size = points.size();
 
-        if(includeEndpoints)
+    assert(points.size() >= 3 + padding);
+
+    initKnots();
+
+    floating_t *paddedKnots = scratch.floats(0, size);
+    for(size_t i = 0; i < size; i++)
+    {
+        paddedKnots[i] = paddedKnot(i);
+    }
+
+    //next we compute curvatures
+    InterpolationType *curvatures = scratch.points(0, size);
+    if(endConditions == Natural)
+        computeCurvaturesNatural(paddedKnots, curvatures, scratch);
+    else
+        computeCurvaturesNotAKnot(paddedKnots, curvatures, scratch);
+
+    buildSegments(curvatures, 1);
+    releaseRawKnots();
+}
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::initKnots(void)
+{
+    //compute the T values for each point. keep the unnormalized T values around, so that edits only need to recompute the T values next to them
+    const auto &points = this->getOriginalPoints();
+    rawKnots.resize(points.size());
+    SplineCommon::computeUnnormalizedTValuesWithInnerPadding(points, alpha, padding, rawKnots.data());
+    knotScale = computeKnotScale();
+}
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::buildSegments(const InterpolationType *curvatures, size_t curvatureStride)
+{
+    const auto &points = this->getOriginalPoints();
+    size_t firstPoint = padding;
+    size_t numSegments = points.size() - 1 - 2 * padding;
+
+    //we now have 0 curvature for index 0 and n - 1, and the final (usually nonzero) curvature for every other point
+    //use this curvature to determine a,b,c,and d to build each segment
+    std::vector<floating_t> knots(numSegments + 1);
+    std::vector<SegmentData> segments(numSegments + 1);
+    for(size_t i = firstPoint; i < numSegments + firstPoint + 1; i++) {
+
+        knots[i - firstPoint] = paddedKnot(i);
+        segments[i - firstPoint].a = points[i];
+        segments[i - firstPoint].c = curvatures[i * curvatureStride];
+    }
+
+    this->common = NaturalSplineCommon<InterpolationType, floating_t>(std::move(segments), std::move(knots));
+}
+
+template<class InterpolationType, typename floating_t>
+std::vector<NaturalSpline<InterpolationType,floating_t>> NaturalSpline<InterpolationType,floating_t>::buildUniformBatch(
+        const std::vector<std::vector<InterpolationType>> &pointLists, bool includeEndpoints)
+{
+    std::vector<NaturalSpline> result;
+    if(pointLists.empty())
+        return result;
+
+    size_t count = pointLists.size();
+    size_t size = pointLists[0].size();
+    size_t padding = includeEndpoints ? 0 : 1;
+    assert(size >= 3 + padding);
+
+    //with an alpha of 0, the T values only depend on the number of points, so every spline has the same T values, and the same matrix
+    std::vector<floating_t> tValues = SplineCommon::computeTValuesWithInnerPadding(pointLists[0], floating_t(0), padding);
+
+    //this is the same system as computeCurvaturesNatural, except that every spline's input vector is interleaved into one array
+    size_t innerSize = size - 2;
+    std::vector<floating_t> diagonal(innerSize);
+    std::vector<floating_t> secondaryDiagonal(innerSize);
+    std::vector<InterpolationType> curvatures(size * count);
+    for(size_t i = 1; i < size - 1; i++)
+    {
+        floating_t deltaBefore = tValues[i] - tValues[i - 1];
+        floating_t deltaAfter = tValues[i + 1] - tValues[i];
+
+        diagonal[i - 1] = floating_t(2) * (deltaBefore + deltaAfter);
+        secondaryDiagonal[i - 1] = deltaAfter;
+
+        for(size_t r = 0; r < count; r++)
         {
-            assert(points.size() >= 3);
-            numSegments = size - 1;
-            firstPoint = 0;
+            const auto &points = pointLists[r];
+            assert(points.size() == size);
+
+            InterpolationType deltaPointBefore = (points[i] - points[i - 1]) / deltaBefore;
+            InterpolationType deltaPointAfter = (points[i + 1] - points[i]) / deltaAfter;
+            curvatures[i * count + r] = floating_t(3) * (deltaPointAfter - deltaPointBefore);
         }
-        else
+    }
+
+    //factor the shared matrix once, and solve every spline's curvatures with it. the first and last curvatures of each spline stay 0
+    std::vector<floating_t> multipliers(innerSize);
+    LinearAlgebra::factorSymmetricTridiagonalInPlace(diagonal.data(), secondaryDiagonal.data(), multipliers.data(), innerSize);
+    LinearAlgebra::solveFactoredSymmetricTridiagonalInPlace(diagonal.data(), secondaryDiagonal.data(), multipliers.data(), curvatures.data() + count, innerSize, count);
+
+    result.reserve(count);
+    for(size_t r = 0; r < count; r++)
+    {
+        result.push_back(NaturalSpline(pointLists[r], includeEndpoints, curvatures.data() + r, count));
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::appendPoint(const InterpolationType &point, SplineScratch<InterpolationType, floating_t> &scratch, size_t updateWindow)
+{
+    assert(endConditions == Natural);
+    prepareRawKnots();
+
+    auto &points = this->getEditableOriginalPoints();
+    points.push_back(point);
+
+    size_t index = points.size() - 1;
+    rawKnots.push_back(rawKnots[index - 1] + SplineCommon::computeTDiff(points[index], points[index - 1], alpha));
+
+    //if the first and last points aren't interpolated, the previous last point becomes the end of the spline
+    //the new end of the spline starts with a curvature of 0, like every other natural spline endpoint, until it's solved for below
+    this->common.appendSegment(SegmentData{points[index - padding], InterpolationType()}, 0);
+    updateKnots(index - padding, index + 1);
+
+    //the previous last point had its curvature fixed at 0, and now it doesn't, so solve for the curvatures near the end
+    //the new last point keeps its curvature of 0
+    size_t last = index - 1;
+    size_t first = std::max(size_t(1), index > updateWindow ? index - updateWindow : size_t(1));
+    solveCurvatures(first, last, scratch);
+}
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::replacePoint(size_t index, const InterpolationType &point, SplineScratch<InterpolationType, floating_t> &scratch, size_t updateWindow)
+{
+    assert(endConditions == Natural);
+    prepareRawKnots();
+
+    auto &points = this->getEditableOriginalPoints();
+    assert(index < points.size());
+    points[index] = point;
+
+    if(index >= padding && index - padding <= this->common.segmentCount())
+    {
+        SegmentData data = this->common.getSegment(index - padding);
+        data.a = point;
+        this->common.setSegment(index - padding, data);
+    }
+
+    //the point at index 'padding' always has a T value of 0. points before it have T values relative to the point after them,
+    //and points after it have T values relative to the point before them
+    if(index > padding)
+        rawKnots[index] = rawKnots[index - 1] + SplineCommon::computeTDiff(points[index], points[index - 1], alpha);
+    else if(index < padding)
+        rawKnots[index] = rawKnots[index + 1] - SplineCommon::computeTDiff(points[index], points[index + 1], alpha);
+
+    if(index > 0 && index <= padding)
+        rawKnots[index - 1] = rawKnots[index] - SplineCommon::computeTDiff(points[index - 1], points[index], alpha);
+
+    //the T distance to the next point changed, so every later T value moves by the same amount
+    size_t changedEnd = std::min(index + 2, points.size());
+    if(index >= padding && index + 1 < points.size())
+    {
+        floating_t nextKnot = rawKnots[index] + SplineCommon::computeTDiff(points[index + 1], points[index], alpha);
+        floating_t delta = nextKnot - rawKnots[index + 1];
+        if(delta != 0)
         {
-            assert(points.size() >= 4);
-            numSegments = size - 3;
-            firstPoint = 1;
+            for(size_t i = index + 1; i < points.size(); i++)
+                rawKnots[i] += delta;
+            changedEnd = points.size();
         }
+    }
+    updateKnots(std::max(index, size_t(1)) - 1, changedEnd);
 
-        //compute the T values for each point
-        std::vector<floating_t> paddedKnots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, firstPoint);
+    //the first and last points always have a curvature of 0, so only solve for the ones in between
+    size_t first = std::max(size_t(1), index > updateWindow ? index - updateWindow : size_t(1));
+    size_t last = std::min(points.size() - 2, index + updateWindow);
+    solveCurvatures(first, last, scratch);
+}
 
-        //next we compute curvatures
-        std::vector<InterpolationType> curvatures;
-        if(endConditions == Natural)
-            curvatures = computeCurvaturesNatural(paddedKnots);
-        else
-            curvatures = computeCurvaturesNotAKnot(paddedKnots);
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::updateKnots(size_t changedBegin, size_t changedEnd)
+{
+    size_t numSegments = rawKnots.size() - 2 * padding - 1;
+    this->maxT = numSegments;
 
-        //we now have 0 curvature for index 0 and n - 1, and the final (usually nonzero) curvature for every other point
-        //use this curvature to determine a,b,c,and d to build each segment
-        std::vector<floating_t> knots(numSegments + 1);
-        std::vector<typename NaturalSplineCommon<InterpolationType, floating_t>::NaturalSplineSegment> segments(numSegments + 1);
-        for(size_t i = firstPoint; i < numSegments + firstPoint + 1; i++) {
+    floating_t newScale = computeKnotScale();
+    if(newScale != knotScale)
+    {
+        floating_t curvatureScale = (knotScale / newScale) * (knotScale / newScale);
+        knotScale = newScale;
+
+        changedBegin = 0;
+        changedEnd = rawKnots.size();
 
-            knots[i - firstPoint] = paddedKnots[i];
-            segments[i - firstPoint].a = points.at(i);
-            segments[i - firstPoint].c = curvatures.at(i);
+        for(size_t i = 0; i <= numSegments; i++)
+        {
+            SegmentData data = this->common.getSegment(i);
+            data.c = data.c * curvatureScale;
+            this->common.setSegment(i, data);
         }
+    }
 
-        this->common = NaturalSplineCommon<InterpolationType, floating_t>(std::move(segments), std::move(knots));
+    //only the knots of interpolated points are stored in the spline
+    changedBegin = std::max(changedBegin, padding);
+    changedEnd = std::min(changedEnd, numSegments + 1 + padding);
+    for(size_t i = changedBegin; i < changedEnd; i++)
+        this->common.setKnot(i - padding, paddedKnot(i));
+}
+
+template<class InterpolationType, typename floating_t>
+void NaturalSpline<InterpolationType,floating_t>::solveCurvatures(size_t first, size_t last, SplineScratch<InterpolationType, floating_t> &scratch)
+{
+    if(first > last)
+        return;
+
+    const auto &points = this->getOriginalPoints();
+    size_t size = last - first + 1;
+
+    //this is the same system that computeCurvaturesNatural builds, restricted to the rows from first to last
+    floating_t *diagonal = scratch.floats(0, size);
+    floating_t *upperDiagonal = scratch.floats(1, size);
+    InterpolationType *curvatures = scratch.points(0, size);
+    for(size_t i = first; i <= last; i++)
+    {
+        floating_t deltaBefore = paddedKnot(i) - paddedKnot(i - 1);
+        floating_t deltaAfter = paddedKnot(i + 1) - paddedKnot(i);
+
+        diagonal[i - first] = floating_t(2) * (deltaBefore + deltaAfter);
+        if(i < last)
+            upperDiagonal[i - first] = deltaAfter;
+
+        InterpolationType deltaPointBefore = (points[i] - points[i - 1]) / deltaBefore;
+        InterpolationType deltaPointAfter = (points[i + 1] - points[i]) / deltaAfter;
+        curvatures[i - first] = floating_t(3) * (deltaPointAfter - deltaPointBefore);
     }
-private:
-    std::vector<InterpolationType> computeCurvaturesNatural(const std::vector<floating_t> tValues) const;
-    std::vector<InterpolationType> computeCurvaturesNotAKnot(const std::vector<floating_t> tValues) const;
-};
+
+    //the curvatures just outside the window are fixed, so move their terms to the other side of the equation
+    curvatures[0] = curvatures[0] - (paddedKnot(first) - paddedKnot(first - 1)) * paddedCurvature(first - 1);
+    curvatures[size - 1] = curvatures[size - 1] - (paddedKnot(last + 1) - paddedKnot(last)) * paddedCurvature(last + 1);
+
+    LinearAlgebra::solveSymmetricTridiagonalInPlace(diagonal, upperDiagonal, curvatures, size);
+
+    for(size_t i = first; i <= last; i++)
+    {
+        if(i >= padding && i - padding <= this->common.segmentCount())
+        {
+            SegmentData data = this->common.getSegment(i - padding);
+            data.c = curvatures[i - first];
+            this->common.setSegment(i - padding, data);
+        }
+    }
+}
 
 template<class InterpolationType, typename floating_t=float>
 class LoopingNaturalSpline final : public SplineLoopingImpl<NaturalSplineCommon, InterpolationType, floating_t>
@@ -238,6 +646,20 @@ class LoopingNaturalSpline final : public SplineLoopingImpl<NaturalSplineCommon,
 public:
     LoopingNaturalSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0)
         :SplineLoopingImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, points.size())
+    {
+        SplineScratch<InterpolationType, floating_t> scratch;
+        build(points, alpha, scratch);
+    }
+
+    //same as above, but use the given scratch object for temporary storage, so that building many splines in a row doesn't allocate temporary arrays for each one
+    LoopingNaturalSpline(const std::vector<InterpolationType> &points, SplineScratch<InterpolationType, floating_t> &scratch, floating_t alpha = 0.0)
+        :SplineLoopingImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, points.size())
+    {
+        build(points, alpha, scratch);
+    }
+
+private:
+    void build(const std::vector<InterpolationType> &points, floating_t alpha, SplineScratch<InterpolationType, floating_t> &scratch)
     {
         size_t size = points.size();
 
@@ -252,7 +674,7 @@ public:
         //the list of values to solve for will be neighborDeltaPoint
 
         //create an array of the differences in T between one point and the next
-        std::vector<floating_t> upperDiagonal(size);
+        floating_t *upperDiagonal = scratch.floats(0, size);
         for(size_t i = 0; i < size; i++)
         {
             floating_t delta = knots[i + 1] - knots[i];
@@ -261,52 +683,118 @@ public:
 
         //create an array that stores 2 * (deltaT.at(i - 1) + deltaT.at(i))
         //when i = 0, wrap i - 1 back around to the end of the list
-        std::vector<floating_t> diagonal(size);
+        floating_t *diagonal = scratch.floats(1, size);
         for(size_t i = 0; i < size; i++)
         {
-            floating_t neighborDelta = 2 * (upperDiagonal.at((i - 1 + size)%size) + upperDiagonal.at(i));
+            floating_t neighborDelta = 2 * (upperDiagonal[(i - 1 + size)%size] + upperDiagonal[i]);
             diagonal[i] = neighborDelta;
         }
 
         //create an array of displacement between each point, divided by delta t
-        std::vector<InterpolationType> deltaPoint(size);
+        InterpolationType *deltaPoint = scratch.points(0, size);
         for(size_t i = 0; i < size; i++)
         {
-            InterpolationType displacement = points.at((i + 1)%size) - points.at(i);
-            deltaPoint[i] = displacement / upperDiagonal.at(i);
+            InterpolationType displacement = points[(i + 1)%size] - points[i];
+            deltaPoint[i] = displacement / upperDiagonal[i];
         }
 
         //create an array that stores 3 * (deltaPoint(i - 1) + deltaPoint(i))
         //when i = 0, wrap i - 1 back around to the end of the list
-        std::vector<InterpolationType> inputVector(size);
+        InterpolationType *curvatures = scratch.points(1, size);
         for(size_t i = 0; i < size; i++)
         {
-            InterpolationType neighborDelta = floating_t(3) * (deltaPoint.at(i) - deltaPoint.at((i - 1 + size) % size));
-            inputVector[i] = neighborDelta;
+            InterpolationType neighborDelta = floating_t(3) * (deltaPoint[i] - deltaPoint[(i - 1 + size) % size]);
+            curvatures[i] = neighborDelta;
         }
 
         //solve the cyclic tridiagonal system to get the curvature at each point
-        std::vector<InterpolationType> curvatures = LinearAlgebra::solveCyclicSymmetricTridiagonal(
-                    std::move(diagonal),
-                    std::move(upperDiagonal),
-                    std::move(inputVector)
-                    );
+        LinearAlgebra::solveCyclicSymmetricTridiagonalInPlace(diagonal, upperDiagonal, curvatures, scratch.floats(2, size * 2), size);
+
+        buildSegments(points, std::move(knots), curvatures, 1);
+    }
+
+    //the curvature of point i is at curvatures[i * curvatureStride]
+    void buildSegments(const std::vector<InterpolationType> &points, std::vector<floating_t> knots, const InterpolationType *curvatures, size_t curvatureStride)
+    {
+        size_t size = points.size();
 
         //we now have the curvature for every point
         //use this curvature to determine a,b,c,and d to build each segment
         std::vector<typename NaturalSplineCommon<InterpolationType, floating_t>::NaturalSplineSegment> segments(size + 1);
         for(size_t i = 0; i < size + 1; i++)
         {
-            segments[i].a = points.at(i%size);
-            segments[i].c = curvatures.at(i%size);
+            segments[i].a = points[i%size];
+            segments[i].c = curvatures[(i%size) * curvatureStride];
         }
 
         this->common = NaturalSplineCommon<InterpolationType, floating_t>(std::move(segments), std::move(knots));
     }
+
+    //for buildUniformBatch: build a spline with an alpha of 0 from curvatures that were already computed
+    LoopingNaturalSpline(const std::vector<InterpolationType> &points, std::vector<floating_t> knots, const InterpolationType *curvatures, size_t curvatureStride)
+        :SplineLoopingImpl<NaturalSplineCommon, InterpolationType,floating_t>(points, points.size())
+    {
+        buildSegments(points, std::move(knots), curvatures, curvatureStride);
+    }
+
+public:
+    //build one looping natural spline for each list of points, IE one for each animation channel of a rig. every list must have the same number of points
+    //the splines are built with an alpha of 0, so they all have the same knots, and share the same system of equations:
+    //it's only factored once, and solved for every spline together. the splines are identical to building each one separately
+    static std::vector<LoopingNaturalSpline> buildUniformBatch(const std::vector<std::vector<InterpolationType>> &pointLists)
+    {
+        std::vector<LoopingNaturalSpline> result;
+        if(pointLists.empty())
+            return result;
+
+        size_t count = pointLists.size();
+        size_t size = pointLists[0].size();
+
+        //with an alpha of 0, the T values only depend on the number of points, so every spline has the same T values, and the same matrix
+        std::vector<floating_t> knots = SplineCommon::computeLoopingTValues(pointLists[0], floating_t(0), 0);
+
+        //this is the same system as the constructor builds, except that every spline's input vector is interleaved into one array
+        std::vector<floating_t> upperDiagonal(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            upperDiagonal[i] = knots[i + 1] - knots[i];
+        }
+
+        std::vector<floating_t> diagonal(size);
+        for(size_t i = 0; i < size; i++)
+        {
+            diagonal[i] = 2 * (upperDiagonal[(i - 1 + size)%size] + upperDiagonal[i]);
+        }
+
+        std::vector<InterpolationType> curvatures(size * count);
+        for(size_t r = 0; r < count; r++)
+        {
+            const auto &points = pointLists[r];
+            assert(points.size() == size);
+
+            for(size_t i = 0; i < size; i++)
+            {
+                InterpolationType deltaPointBefore = (points[i] - points[(i - 1 + size)%size]) / upperDiagonal[(i - 1 + size)%size];
+                InterpolationType deltaPointAfter = (points[(i + 1)%size] - points[i]) / upperDiagonal[i];
+                curvatures[i * count + r] = floating_t(3) * (deltaPointAfter - deltaPointBefore);
+            }
+        }
+
+        std::vector<floating_t> scratch(size * 2);
+        LinearAlgebra::solveCyclicSymmetricTridiagonalBatchInPlace(diagonal.data(), upperDiagonal.data(), curvatures.data(), scratch.data(), size, count);
+
+        result.reserve(count);
+        for(size_t r = 0; r < count; r++)
+        {
+            result.push_back(LoopingNaturalSpline(pointLists[r], knots, curvatures.data() + r, count));
+        }
+        return result;
+    }
 };
 
 template<class InterpolationType, typename floating_t>
-std::vector<InterpolationType> NaturalSpline<InterpolationType,floating_t>::computeCurvaturesNatural(const std::vector<floating_t> tValues) const
+void NaturalSpline<InterpolationType,floating_t>::computeCurvaturesNatural(
+        const floating_t *tValues, InterpolationType *curvatures, SplineScratch<InterpolationType, floating_t> &scratch) const
 {
 
     //now that we know the t values, we need to prepare the tridiagonal matrix calculation
@@ -316,60 +804,43 @@ std::vector<InterpolationType> NaturalSpline<InterpolationType,floating_t>::comp
     //the tridiagonal matrix's main diagonal will be neighborDeltaT, and the secondary diagonals will be deltaT
     //the list of values to solve for will be neighborDeltaPoint
 
-    size_t loop_limit = this->getOriginalPoints().size() - 1;
-
-    //create an array of the differences in T between one point and the next
-    std::vector<floating_t> upperDiagonal(loop_limit);
-    for(size_t i = 0; i < loop_limit; i++)
-    {
-        floating_t delta = tValues[i + 1] - tValues[i];
-        upperDiagonal[i] = delta;
-    }
+    const auto &points = this->getOriginalPoints();
+    size_t size = points.size();
 
-    //create an array that stores 2 * (deltaT.at(i - 1) + deltaT.at(i))
-    std::vector<floating_t> diagonal(loop_limit - 1);
-    for(size_t i = 1; i < loop_limit; i++)
-    {
-        floating_t neighborDelta = floating_t(2) * (upperDiagonal[i - 1] + upperDiagonal[i]);
-        diagonal[i - 1] = neighborDelta;
-    }
-
-    //create an array of displacement between each point, divided by delta t
-    std::vector<InterpolationType> deltaPoint(loop_limit);
-    for(size_t i = 0; i < loop_limit; i++)
-    {
-        InterpolationType displacement = this->getOriginalPoints()[i + 1] - this->getOriginalPoints()[i];
-        deltaPoint[i] = displacement / upperDiagonal[i];
-    }
+    //the first and last curvatures are 0, so we only solve for the ones in between
+    size_t innerSize = size - 2;
+    floating_t *diagonal = scratch.floats(1, innerSize);
+    floating_t *secondaryDiagonal = scratch.floats(2, innerSize);
 
-    //create an array that stores 3 * (deltaPoint(i - 1) + deltaPoint(i))
-    std::vector<InterpolationType> inputVector(loop_limit - 1);
-    for(size_t i = 1; i < loop_limit; i++)
+    for(size_t i = 1; i < size - 1; i++)
     {
-        InterpolationType neighborDelta = floating_t(3) * (deltaPoint[i] - deltaPoint[i - 1]);
-        inputVector[i - 1] = neighborDelta;
+        //the differences in T between this point and its neighbors
+        floating_t deltaBefore = tValues[i] - tValues[i - 1];
+        floating_t deltaAfter = tValues[i + 1] - tValues[i];
+
+        //the main diagonal stores 2 * (deltaT(i - 1) + deltaT(i)), and the secondary diagonal stores deltaT(i). the final secondary diagonal value isn't used
+        diagonal[i - 1] = floating_t(2) * (deltaBefore + deltaAfter);
+        secondaryDiagonal[i - 1] = deltaAfter;
+
+        //the input vector stores 3 * (deltaPoint(i) - deltaPoint(i - 1)), where deltaPoint is the displacement between each point, divided by delta t
+        //it's stored straight into the curvature array, where the solver will replace it with the curvature
+        InterpolationType deltaPointBefore = (points[i] - points[i - 1]) / deltaBefore;
+        InterpolationType deltaPointAfter = (points[i + 1] - points[i]) / deltaAfter;
+        curvatures[i] = floating_t(3) * (deltaPointAfter - deltaPointBefore);
     }
 
-    //the first element in upperDiagonal is garbage, so remove it
-    upperDiagonal.erase(upperDiagonal.begin());
-
     //solve the tridiagonal system to get the curvature at each point
-    std::vector<InterpolationType> curvatures = LinearAlgebra::solveSymmetricTridiagonal(
-                std::move(diagonal),
-                std::move(upperDiagonal),
-                std::move(inputVector)
-                );
+    LinearAlgebra::solveSymmetricTridiagonalInPlace(diagonal, secondaryDiagonal, curvatures + 1, innerSize);
 
     //we didn't compute the first or last curvature, which will be 0
-    curvatures.insert(curvatures.begin(), InterpolationType());
-    curvatures.push_back(InterpolationType());
-
-    return curvatures;
+    curvatures[0] = InterpolationType();
+    curvatures[size - 1] = InterpolationType();
 }
 
 
 template<class InterpolationType, typename floating_t>
-std::vector<InterpolationType> NaturalSpline<InterpolationType,floating_t>::computeCurvaturesNotAKnot(const std::vector<floating_t> tValues) const
+void NaturalSpline<InterpolationType,floating_t>::computeCurvaturesNotAKnot(
+        const floating_t *tValues, InterpolationType *curvatures, SplineScratch<InterpolationType, floating_t> &scratch) const
 {
     //now that we know the t values, we need to prepare the tridiagonal matrix calculation
     //note that there several ways to formulate this matrix; for "not a knot" i chose the following:
@@ -378,44 +849,45 @@ std::vector<InterpolationType> NaturalSpline<InterpolationType,floating_t>::comp
     //the tridiagonal matrix's main diagonal will be neighborDeltaT, and the secondary diagonals will be deltaT
     //the list of values to solve for will be neighborDeltaPoint
 
-    size_t size = this->getOriginalPoints().size() - 1;
+    const auto &points = this->getOriginalPoints();
+    size_t size = points.size() - 1;
 
     //create an array of the differences in T between one point and the next
-    std::vector<floating_t> deltaT(size);
+    floating_t *deltaT = scratch.floats(1, size);
     for(size_t i = 0; i < size; i++)
     {
         deltaT[i] = tValues[i + 1] - tValues[i];
     }
 
     //the main diagonal of the tridiagonal will be 2 * (deltaT[i] + deltaT[i + 1])
-    float mainDiagonalSize = size - 1;
-    std::vector<floating_t> mainDiagonal(mainDiagonalSize);
+    size_t mainDiagonalSize = size - 1;
+    floating_t *mainDiagonal = scratch.floats(2, mainDiagonalSize);
     for(size_t i = 0; i < mainDiagonalSize; i++)
     {
         mainDiagonal[i] = 2 * (deltaT[i] + deltaT[i + 1]);
     }
 
-    //the upper diagonal will just be deltaT[i + 1]
-    float secondaryDiagonalSize = size - 2;
-    std::vector<floating_t> upperDiagonal(secondaryDiagonalSize);
+    //the upper diagonal will just be deltaT[i + 1], and the lower diagonal starts as a copy of the upper diagonal
+    size_t secondaryDiagonalSize = size - 2;
+    floating_t *upperDiagonal = scratch.floats(3, secondaryDiagonalSize);
+    floating_t *lowerDiagonal = scratch.floats(4, secondaryDiagonalSize);
     for(size_t i = 0; i < secondaryDiagonalSize; i++)
     {
         upperDiagonal[i] = deltaT[i + 1];
+        lowerDiagonal[i] = deltaT[i + 1];
     }
 
-    //the lower diagonal is just a copy of the upper diagonal
-    std::vector<floating_t> lowerDiagonal = upperDiagonal;
-
     //create an array of displacement between each point, divided by delta t
-    std::vector<InterpolationType> deltaPoint(size);
+    InterpolationType *deltaPoint = scratch.points(1, size);
     for(size_t i = 0; i < size; i++)
     {
-        InterpolationType displacement = this->getOriginalPoints()[i + 1] - this->getOriginalPoints()[i];
+        InterpolationType displacement = points[i + 1] - points[i];
         deltaPoint[i] = displacement / deltaT[i];
     }
 
     //create an array that stores 3 * (deltaPoint(i - 1) + deltaPoint(i))
-    std::vector<InterpolationType> inputVector(mainDiagonalSize);
+    //it's stored straight into the curvature array, where the solver will replace it with the curvature
+    InterpolationType *inputVector = curvatures + 1;
     for(size_t i = 0; i < mainDiagonalSize; i++)
     {
         inputVector[i] = floating_t(3) * (deltaPoint[i + 1] - deltaPoint[i]);
@@ -432,17 +904,10 @@ std::vector<InterpolationType> NaturalSpline<InterpolationType,floating_t>::comp
     lowerDiagonal[secondaryDiagonalSize - 1] = deltaT[size - 2] - deltaT[size - 1]*deltaT[size - 1]/deltaT[size - 2];
 
     //solve the tridiagonal system to get the curvature at each point
-    std::vector<InterpolationType> curvatures = LinearAlgebra::solveTridiagonal(
-                std::move(mainDiagonal),
-                std::move(upperDiagonal),
-                std::move(lowerDiagonal),
-                std::move(inputVector)
-                );
+    LinearAlgebra::solveTridiagonalInPlace(mainDiagonal, upperDiagonal, lowerDiagonal, inputVector, mainDiagonalSize);
 
     //we didn't compute the first or last curvature, which will be calculated based on the others
-    curvatures.insert(curvatures.begin(), curvatures[0] * (1 + deltaT[0]/deltaT[1]) - curvatures[1] * (deltaT[0]/deltaT[1]));
-    curvatures.push_back(curvatures.back() * (1 + deltaT[size - 1]/deltaT[size - 2])
-            - curvatures[curvatures.size() - 2] * (deltaT[size - 1]/deltaT[size - 2]));
-
-    return curvatures;
+    curvatures[0] = curvatures[1] * (1 + deltaT[0]/deltaT[1]) - curvatures[2] * (deltaT[0]/deltaT[1]);
+    curvatures[size] = curvatures[size - 1] * (1 + deltaT[size - 1]/deltaT[size - 2])
+            - curvatures[size - 2] * (deltaT[size - 1]/deltaT[size - 2]);
 }
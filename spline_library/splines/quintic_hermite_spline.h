@@ -3,6 +3,9 @@
 #include <cassert>
 
 #include "../spline.h"
+#include "../utils/splinescratch.h"
+#include "../utils/lazysplinecore.h"
+#include "cubic_hermite_spline.h"
 
 template<class InterpolationType, typename floating_t>
 class QuinticHermiteSplineCommon
@@ -23,9 +26,14 @@ public:
         return points.size() - 1;
     }
 
+    inline size_t degree(void) const
+    {
+        return 5;
+    }
+
     inline size_t segmentForT(floating_t t) const
     {
-        size_t segmentIndex = SplineCommon::getIndexForT(knots, t);
+        size_t segmentIndex = SplineCommon::getIndexForT(knots, knotIndex, t);
         if(segmentIndex >= segmentCount())
             return segmentCount() - 1;
         else
@@ -37,26 +45,52 @@ public:
         return knots[segmentIndex];
     }
 
+    //for cores whose tangents and curvatures are filled in after construction, IE by LazySplineCore
+    inline QuinticHermiteSplinePoint *pointData(void) { return points.data(); }
+
+    //optional index of the knots, for faster segment lookups on splines whose knot spacing is very uneven
+    inline void buildKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(knots); }
+    inline void clearKnotIndex(void) { knotIndex = SplineCommon::KnotIndex<floating_t>(); }
+    inline bool hasKnotIndex(void) const { return !knotIndex.empty(); }
+
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        //get the knot index. if it's the final knot, back it up by one
-        size_t knotIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(knotIndex >= knots.size() - 1)
-            knotIndex--;
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
 
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t knotIndex, floating_t globalT) const
+    {
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
         return computePosition(knotIndex, tDiff, localT);
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t knotIndex, floating_t globalT) const
     {
-        //get the knot index. if it's the final knot, back it up by one
-        size_t knotIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(knotIndex >= knots.size() - 1)
-            knotIndex--;
-
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -66,13 +100,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t knotIndex, floating_t globalT) const
     {
-        //get the knot index. if it's the final knot, back it up by one
-        size_t knotIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(knotIndex >= knots.size() - 1)
-            knotIndex--;
-
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -83,13 +112,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t knotIndex, floating_t globalT) const
     {
-        //get the knot index. if it's the final knot, back it up by one
-        size_t knotIndex = SplineCommon::getIndexForT(knots, globalT);
-        if(knotIndex >= knots.size() - 1)
-            knotIndex--;
-
         floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
         floating_t localT = (globalT - knots[knotIndex]) / tDiff;
 
@@ -101,7 +125,26 @@ public:
                     );
     }
 
-    inline floating_t segmentLength(size_t index, floating_t a, floating_t b) const
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t knotIndex, floating_t globalT) const
+    {
+        floating_t tDiff = (knots[knotIndex + 1] - knots[knotIndex]);
+        floating_t localT = (globalT - knots[knotIndex]) / tDiff;
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(knotIndex, tDiff, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(knotIndex, tDiff, localT);
+        return result;
+    }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t index, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
     {
         floating_t tDiff = knots[index + 1] - knots[index];
         auto segmentFunction = [this, index, tDiff](floating_t t) -> floating_t {
@@ -112,7 +155,7 @@ public:
         floating_t localA = (a - knots[index]) / tDiff;
         floating_t localB = (b - knots[index]) / tDiff;
 
-        return tDiff * SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, localA, localB);
+        return quadrature(segmentFunction, localA, localB, tDiff);
     }
 
 private: //methods
@@ -219,6 +262,9 @@ private: //methods
 private: //data
     std::vector<QuinticHermiteSplinePoint> points;
     std::vector<floating_t> knots;
+
+    //empty unless buildKnotIndex() has been called
+    SplineCommon::KnotIndex<floating_t> knotIndex;
 };
 
 
@@ -255,6 +301,20 @@ public:
 
     QuinticHermiteSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0f)
         :SplineImpl<QuinticHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 5)
+    {
+        SplineScratch<InterpolationType, floating_t> scratch;
+        build(points, alpha, scratch);
+    }
+
+    //same as above, but use the given scratch object for temporary storage, so that building many splines in a row doesn't allocate temporary arrays for each one
+    QuinticHermiteSpline(const std::vector<InterpolationType> &points, SplineScratch<InterpolationType, floating_t> &scratch, floating_t alpha = 0.0f)
+        :SplineImpl<QuinticHermiteSplineCommon, InterpolationType,floating_t>(points, points.size() - 5)
+    {
+        build(points, alpha, scratch);
+    }
+
+private:
+    void build(const std::vector<InterpolationType> &points, floating_t alpha, SplineScratch<InterpolationType, floating_t> &scratch)
     {
         assert(points.size() >= 6);
 
@@ -263,10 +323,11 @@ public:
 
         //compute the T values for each point
         size_t padding = 2;
-        std::vector<floating_t> paddedKnots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, padding);
+        floating_t *paddedKnots = scratch.floats(0, size);
+        SplineCommon::computeTValuesWithInnerPadding(points, alpha, padding, paddedKnots);
 
         //compute the tangents
-        std::vector<InterpolationType> tangents(size);
+        InterpolationType *tangents = scratch.points(0, size);
         size_t firstTangent = 1;
         size_t lastTangent = points.size() - 2;
         for(size_t i = firstTangent; i <= lastTangent; i++)
@@ -291,7 +352,7 @@ public:
         }
 
         //compute the curvatures
-        std::vector<InterpolationType> curves(size);
+        InterpolationType *curves = scratch.points(1, size);
         size_t firstCurvature = padding = 2;
         size_t lastCurvature = points.size() - 3;
         for(size_t i = firstCurvature; i <= lastCurvature; i++)
@@ -300,9 +361,9 @@ public:
             floating_t tCurrent = paddedKnots[i];
             floating_t tNext = paddedKnots[i + 1];
 
-            InterpolationType pPrev = tangents.at(i - 1);
-            InterpolationType pCurrent = tangents.at(i);
-            InterpolationType pNext = tangents.at(i + 1);
+            InterpolationType pPrev = tangents[i - 1];
+            InterpolationType pCurrent = tangents[i];
+            InterpolationType pNext = tangents[i + 1];
 
             //the tangent is the standard catmull-rom spline tangent calculation
             curves[i] =
@@ -333,6 +394,74 @@ public:
 
 
 
+template<class InterpolationType, typename floating_t>
+using LazyQuinticHermiteSplineCore = LazySplineCore<QuinticHermiteSplineCommon, InterpolationType, floating_t>;
+
+//a QuinticHermiteSpline whose tangents and curvatures are computed one block of points at a time, the first time a segment in the block is evaluated,
+//instead of all at once in the constructor. for very large splines where only a small part is ever evaluated. the results are identical to QuinticHermiteSpline's
+template<class InterpolationType, typename floating_t=float>
+class LazyQuinticHermiteSpline final : public SplineImpl<LazyQuinticHermiteSplineCore, InterpolationType, floating_t>
+{
+    typedef QuinticHermiteSplineCommon<InterpolationType, floating_t> CommonType;
+    typedef typename CommonType::QuinticHermiteSplinePoint PointData;
+
+//constructors
+public:
+    LazyQuinticHermiteSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0f, size_t blockSize = 1024)
+        :SplineImpl<LazyQuinticHermiteSplineCore, InterpolationType,floating_t>(points, points.size() - 5)
+    {
+        assert(points.size() >= 6);
+
+        size_t padding = 2;
+        size_t numSegments = points.size() - 5;
+
+        //compute the T values for each point
+        std::vector<floating_t> paddedKnots = SplineCommon::computeTValuesWithInnerPadding(points, alpha, padding);
+
+        //the positions and knots are arranged now, and the tangents and curvatures are left empty until their block is needed
+        std::vector<floating_t> knots(paddedKnots.begin() + padding, paddedKnots.begin() + padding + numSegments + 1);
+        std::vector<PointData> positionData(numSegments + 1);
+        for(size_t i = 0; i < positionData.size(); i++)
+        {
+            positionData[i].position = points[i + padding];
+        }
+
+        //this spline can't be copied or moved, so the block function can keep a view of its original points
+        SplinePointView<InterpolationType> originalPoints = this->getOriginalPointsView();
+        auto computeBlock = [originalPoints, paddedKnots = std::move(paddedKnots), padding](CommonType &core, size_t beginPoint, size_t endPoint) {
+            //each curvature is the catmull-rom tangent of the neighboring tangents, so the block needs one extra tangent on each side
+            size_t firstTangent = beginPoint + padding - 1;
+            std::vector<InterpolationType> tangents(endPoint - beginPoint + 2);
+            for(size_t i = 0; i < tangents.size(); i++)
+            {
+                size_t index = firstTangent + i;
+                tangents[i] = CubicHermiteSplineCommon<InterpolationType, floating_t>::computeCatmullRomTangent(
+                            originalPoints[index - 1], originalPoints[index], originalPoints[index + 1],
+                            paddedKnots[index - 1], paddedKnots[index], paddedKnots[index + 1]);
+            }
+
+            PointData *pointData = core.pointData();
+            for(size_t i = beginPoint; i < endPoint; i++)
+            {
+                size_t index = i + padding;
+                size_t tangentIndex = i - beginPoint + 1;
+                pointData[i].tangent = tangents[tangentIndex];
+                pointData[i].curvature = CubicHermiteSplineCommon<InterpolationType, floating_t>::computeCatmullRomTangent(
+                            tangents[tangentIndex - 1], tangents[tangentIndex], tangents[tangentIndex + 1],
+                            paddedKnots[index - 1], paddedKnots[index], paddedKnots[index + 1]);
+            }
+        };
+
+        this->common = LazyQuinticHermiteSplineCore<InterpolationType, floating_t>(
+                    CommonType(std::move(positionData), std::move(knots)), numSegments + 1, blockSize, std::move(computeBlock));
+    }
+
+    //compute every tangent and curvature that hasn't been computed yet
+    void prepareAll(void) const { this->common.prepareAll(); }
+    size_t preparedBlockCount(void) const { return this->common.preparedBlockCount(); }
+};
+
+
 template<class InterpolationType, typename floating_t=float>
 class LoopingQuinticHermiteSpline final : public SplineLoopingImpl<QuinticHermiteSplineCommon, InterpolationType, floating_t>
 {
@@ -367,6 +496,20 @@ public:
 
     LoopingQuinticHermiteSpline(const std::vector<InterpolationType> &points, floating_t alpha = 0.0)
         :SplineLoopingImpl<QuinticHermiteSplineCommon, InterpolationType,floating_t>(points, points.size())
+    {
+        SplineScratch<InterpolationType, floating_t> scratch;
+        build(points, alpha, scratch);
+    }
+
+    //same as above, but use the given scratch object for temporary storage, so that building many splines in a row doesn't allocate temporary arrays for each one
+    LoopingQuinticHermiteSpline(const std::vector<InterpolationType> &points, SplineScratch<InterpolationType, floating_t> &scratch, floating_t alpha = 0.0)
+        :SplineLoopingImpl<QuinticHermiteSplineCommon, InterpolationType,floating_t>(points, points.size())
+    {
+        build(points, alpha, scratch);
+    }
+
+private:
+    void build(const std::vector<InterpolationType> &points, floating_t alpha, SplineScratch<InterpolationType, floating_t> &scratch)
     {
         assert(points.size() >= 3);
 
@@ -374,10 +517,11 @@ public:
 
         //compute the T values for each point
         size_t padding = 2;
-        std::vector<floating_t> paddedKnots = SplineCommon::computeLoopingTValues(points, alpha, padding);
+        floating_t *paddedKnots = scratch.floats(0, size + padding * 2 + 1);
+        SplineCommon::computeLoopingTValues(points, alpha, padding, paddedKnots);
 
         //compute the tangents
-        std::vector<InterpolationType> tangents(size);
+        InterpolationType *tangents = scratch.points(0, size);
         for(int i = 0; i < size; i++)
         {
             floating_t tPrev = paddedKnots[i - 1 + padding];
@@ -400,7 +544,7 @@ public:
         }
 
         //compute the curvatures
-        std::vector<InterpolationType> curves(size);
+        InterpolationType *curves = scratch.points(1, size);
         for(int i = 0; i < size; i++)
         {
             floating_t tPrev = paddedKnots[i - 1 + padding];
@@ -1,16 +1,39 @@
 #pragma once
 
 #include <cassert>
+#include <algorithm>
 
 #include "../spline.h"
+#include "../utils/speedpolynomial.h"
+#include "../utils/uniformsegmentquadrature.h"
 
-template<class InterpolationType, typename floating_t>
+//the weights of a segment's 4 control points in its tangent: the same expression as computeTangent, with the catmull-rom tangents expanded
+struct UniformCRTangentBasis
+{
+    static constexpr __UniformSegmentQuadraturePrivate::BasisWeights tangentWeights(double t)
+    {
+        double d_basis00 = 6 * t * (t - 1);
+        double d_basis10 = (1 - 3*t) * (1 - t);
+        double d_basis11 = t * (3 * t - 2);
+        double d_basis01 = -d_basis00;
+
+        return __UniformSegmentQuadraturePrivate::BasisWeights{{
+                -d_basis10 / 2,
+                d_basis00 - d_basis11 / 2,
+                d_basis10 / 2 + d_basis01,
+                d_basis11 / 2
+            }};
+    }
+};
+
+//PointStorage is std::vector for splines that own their points, or SplinePointView for view splines that evaluate straight from the caller's points
+template<class InterpolationType, typename floating_t, class PointStorage>
 class UniformCRSplineCommon
 {
 public:
 
     inline UniformCRSplineCommon(void) = default;
-    inline UniformCRSplineCommon(std::vector<InterpolationType> points)
+    inline UniformCRSplineCommon(PointStorage points)
         :points(std::move(points))
     {}
 
@@ -19,6 +42,11 @@ public:
         return points.size() - 3;
     }
 
+    inline size_t degree(void) const
+    {
+        return 3;
+    }
+
     inline size_t segmentForT(floating_t t) const
     {
         if(t < 0)
@@ -36,18 +64,48 @@ public:
         return segmentIndex;
     }
 
+    //for editable splines. each segment is computed from its 4 nearby points when it's evaluated, so changing a point doesn't require any other updates
+    inline void appendPoint(const InterpolationType &point) { points.push_back(point); speedPolynomials.clear(); }
+    inline void replacePoint(size_t index, const InterpolationType &point) { points[index] = point; speedPolynomials.clear(); }
+
 
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
         floating_t localT = globalT - segmentIndex;
 
         return computePosition(segmentIndex + 1, localT);
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPT(
@@ -56,9 +114,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPTC(
@@ -68,9 +125,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPTCW(
@@ -81,17 +137,48 @@ public:
                     );
     }
 
-    inline floating_t segmentLength(size_t index, floating_t a, floating_t b) const
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
     {
+        floating_t localT = globalT - segmentIndex;
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(segmentIndex + 1, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(segmentIndex + 1, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(segmentIndex + 1, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(segmentIndex + 1);
+        return result;
+    }
+
+    //optional cache of each segment's speed polynomial, which segmentLength integrates instead of the tangent. appendPoint and replacePoint discard it
+    inline void cacheSpeedPolynomials(void) { speedPolynomials = SpeedPolynomial<floating_t>::computeForCore(*this); }
+    inline void clearSpeedPolynomials(void) { speedPolynomials.clear(); }
+    inline bool hasSpeedPolynomials(void) const { return !speedPolynomials.empty(); }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t index, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
+    {
+        if(!speedPolynomials.empty())
+            return speedPolynomials[index].integrate(a - segmentT(index), b - segmentT(index), quadrature);
+
+        floating_t localA = a - index;
+        floating_t localB = b - index;
+
+        //every segment has the same basis functions, so a whole segment can be integrated from a table of them, IE when computing the total length
+        floating_t wholeSegmentLength;
+        if(localA == 0 && localB == 1 && UniformSegmentQuadrature::wholeSegmentLength<UniformCRTangentBasis>(quadrature, points, index, wholeSegmentLength))
+            return wholeSegmentLength;
+
         auto segmentFunction = [this, index](floating_t t) -> floating_t {
             auto tangent = computeTangent(index + 1, t);
             return tangent.length();
         };
 
-        floating_t localA = a - index;
-        floating_t localB = b - index;
-
-        return SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, localA, localB);
+        return quadrature(segmentFunction, localA, localB);
     }
 
 
@@ -180,34 +267,69 @@ private: //methods
     }
 
 private: //data
-    std::vector<InterpolationType> points;
+    PointStorage points;
+
+    //empty unless cacheSpeedPolynomials() has been called
+    std::vector<SpeedPolynomial<floating_t>> speedPolynomials;
+};
+
+//SplineImpl expects a core with two template parameters, so bind the storage with an alias
+struct UniformCRSplineOwningCommon
+{
+    template<class InterpolationType, typename floating_t>
+    using type = UniformCRSplineCommon<InterpolationType, floating_t, std::vector<InterpolationType>>;
+};
+
+struct UniformCRSplineViewCommon
+{
+    template<class InterpolationType, typename floating_t>
+    using type = UniformCRSplineCommon<InterpolationType, floating_t, SplinePointView<InterpolationType>>;
 };
 
 
 
 
 template<class InterpolationType, typename floating_t=float>
-class UniformCRSpline final : public SplineImpl<UniformCRSplineCommon, InterpolationType, floating_t>
+class UniformCRSpline final : public SplineImpl<UniformCRSplineOwningCommon::type, InterpolationType, floating_t>
 {
 //constructors
 public:
     UniformCRSpline(const std::vector<InterpolationType> &points)
-        :SplineImpl<UniformCRSplineCommon, InterpolationType, floating_t>(points, points.size() - 3)
+        :SplineImpl<UniformCRSplineOwningCommon::type, InterpolationType, floating_t>(points, points.size() - 3)
     {
         assert(points.size() >= 4);
 
-        this->common = UniformCRSplineCommon<InterpolationType, floating_t>(points);
+        this->common = UniformCRSplineCommon<InterpolationType, floating_t, std::vector<InterpolationType>>(points);
+    }
+
+//editing
+public:
+    //add a point to the end of the spline, IE for a live stream of points. this adds one segment to the end of the spline, and maxT increases by 1
+    //segments are computed from their 4 nearest points when they're evaluated, so this is O(1)
+    void appendPoint(const InterpolationType &point)
+    {
+        this->getEditableOriginalPoints().push_back(point);
+        this->common.appendPoint(point);
+        this->maxT += 1;
+    }
+
+    //replace the point at the given index (an index into getOriginalPoints()). this changes the 4 segments that use the point, and is O(1)
+    void replacePoint(size_t index, const InterpolationType &point)
+    {
+        assert(index < this->getOriginalPoints().size());
+        this->getEditableOriginalPoints()[index] = point;
+        this->common.replacePoint(index, point);
     }
 };
 
 
 template<class InterpolationType, typename floating_t=float>
-class LoopingUniformCRSpline final : public SplineLoopingImpl<UniformCRSplineCommon, InterpolationType, floating_t>
+class LoopingUniformCRSpline final : public SplineLoopingImpl<UniformCRSplineOwningCommon::type, InterpolationType, floating_t>
 {
 //constructors
 public:
     LoopingUniformCRSpline(const std::vector<InterpolationType> &points)
-        :SplineLoopingImpl<UniformCRSplineCommon, InterpolationType,floating_t>(points, points.size())
+        :SplineLoopingImpl<UniformCRSplineOwningCommon::type, InterpolationType,floating_t>(points, points.size())
     {
         assert(points.size() >= 4);
 
@@ -222,6 +344,23 @@ public:
         std::copy(points.begin(), points.end(), positions.begin() + 1);
         std::copy_n(points.begin(), 2, positions.end() - 2);
 
-        this->common = UniformCRSplineCommon<InterpolationType, floating_t>(std::move(positions));
+        this->common = UniformCRSplineCommon<InterpolationType, floating_t, std::vector<InterpolationType>>(std::move(positions));
+    }
+};
+
+
+//same as UniformCRSpline, but borrows the given points instead of copying them, IE to evaluate a memory-mapped file of points in place
+//no copy of the points is made at all, so the points must not be modified or freed while the spline exists
+template<class InterpolationType, typename floating_t=float>
+class UniformCRSplineView final : public SplineImpl<UniformCRSplineViewCommon::type, InterpolationType, floating_t>
+{
+//constructors
+public:
+    UniformCRSplineView(SplinePointView<InterpolationType> points)
+        :SplineImpl<UniformCRSplineViewCommon::type, InterpolationType, floating_t>(points, points.size() - 3)
+    {
+        assert(points.size() >= 4);
+
+        this->common = UniformCRSplineCommon<InterpolationType, floating_t, SplinePointView<InterpolationType>>(points);
     }
 };
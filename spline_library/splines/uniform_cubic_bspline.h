@@ -3,6 +3,22 @@
 #include <cassert>
 
 #include "../spline.h"
+#include "../utils/speedpolynomial.h"
+#include "../utils/uniformsegmentquadrature.h"
+
+//the weights of a segment's 4 control points in its tangent: the same expression as computeTangent
+struct UniformCubicBSplineTangentBasis
+{
+    static constexpr __UniformSegmentQuadraturePrivate::BasisWeights tangentWeights(double t)
+    {
+        return __UniformSegmentQuadraturePrivate::BasisWeights{{
+                -(1 - t) * (1 - t) / 2,
+                t * (3 * t - 4) / 2,
+                (3 * t + 1) * (1 - t) / 2,
+                t * t / 2
+            }};
+    }
+};
 
 template<class InterpolationType, typename floating_t>
 class UniformCubicBSplineCommon
@@ -19,6 +35,11 @@ public:
         return points.size() - 3;
     }
 
+    inline size_t degree(void) const
+    {
+        return 3;
+    }
+
     inline size_t segmentForT(floating_t t) const
     {
         if(t < 0)
@@ -38,15 +59,41 @@ public:
 
     inline InterpolationType getPosition(floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    //compute only the outputs chosen by derivatives, a combination of SplineDerivatives flags, IE evaluate<SplineDerivatives::Tangent>(t) for just the tangent
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    //versions of the above that skip the segment lookup, for callers that already know which segment globalT is in
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
         floating_t localT = globalT - segmentIndex;
 
         return computePosition(segmentIndex, localT);
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPT(
@@ -55,9 +102,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPTC(
@@ -67,9 +113,8 @@ public:
                     );
     }
 
-    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
     {
-        size_t segmentIndex = segmentForT(globalT);
         floating_t localT = globalT - segmentIndex;
 
         return typename Spline<InterpolationType,floating_t>::InterpolatedPTCW(
@@ -80,17 +125,48 @@ public:
                     );
     }
 
-    inline floating_t segmentLength(size_t index, floating_t a, floating_t b) const
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
+    {
+        floating_t localT = globalT - segmentIndex;
+
+        typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives result;
+        if(derivatives & SplineDerivatives::Position)
+            result.position = computePosition(segmentIndex, localT);
+        if(derivatives & SplineDerivatives::Tangent)
+            result.tangent = computeTangent(segmentIndex, localT);
+        if(derivatives & SplineDerivatives::Curvature)
+            result.curvature = computeCurvature(segmentIndex, localT);
+        if(derivatives & SplineDerivatives::Wiggle)
+            result.wiggle = computeWiggle(segmentIndex);
+        return result;
+    }
+
+    //optional cache of each segment's speed polynomial, which segmentLength integrates instead of the tangent
+    inline void cacheSpeedPolynomials(void) { speedPolynomials = SpeedPolynomial<floating_t>::computeForCore(*this); }
+    inline void clearSpeedPolynomials(void) { speedPolynomials.clear(); }
+    inline bool hasSpeedPolynomials(void) const { return !speedPolynomials.empty(); }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t index, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
     {
+        if(!speedPolynomials.empty())
+            return speedPolynomials[index].integrate(a - segmentT(index), b - segmentT(index), quadrature);
+
+        floating_t localA = a - index;
+        floating_t localB = b - index;
+
+        //every segment has the same basis functions, so a whole segment can be integrated from a table of them, IE when computing the total length
+        floating_t wholeSegmentLength;
+        if(localA == 0 && localB == 1 && UniformSegmentQuadrature::wholeSegmentLength<UniformCubicBSplineTangentBasis>(quadrature, points, index, wholeSegmentLength))
+            return wholeSegmentLength;
+
         auto segmentFunction = [this, index](floating_t t) -> floating_t {
             auto tangent = computeTangent(index, t);
             return tangent.length();
         };
 
-        floating_t localA = a - index;
-        floating_t localB = b - index;
-
-        return SplineLibraryCalculus::gaussLegendreQuadratureIntegral<floating_t>(segmentFunction, localA, localB);
+        return quadrature(segmentFunction, localA, localB);
     }
 
 private: //methods
@@ -131,6 +207,9 @@ private: //methods
 
 private: //data
     std::vector<InterpolationType> points;
+
+    //empty unless cacheSpeedPolynomials() has been called
+    std::vector<SpeedPolynomial<floating_t>> speedPolynomials;
 };
 
 
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
 #include <boost/math/tools/roots.hpp>
 
 #include "spline_common.h"
+#include "arclengthindex.h"
+#include "workstealing.h"
 
 namespace __ArcLengthSolvePrivate
 {
@@ -17,10 +23,13 @@ namespace __ArcLengthSolvePrivate
         floating_t bGuess = segmentA + desiredPercent * (bEnd - segmentA);
 
         auto solveFunction = [&](floating_t b) {
+            SPLINE_INSTRUMENT_COUNT(HalleyIterations);
+
             floating_t value = spline.segmentArcLength(segmentIndex, segmentA, b) - desiredLength;
 
             //the derivative will be the length of the tangent
-            auto interpolationResult = spline.getCurvature(b);
+            //we already know which segment b is in, so skip the segment lookup. the position isn't needed, so don't compute it
+            auto interpolationResult = spline.template segmentEvaluate<SplineDerivatives::Tangent | SplineDerivatives::Curvature>(segmentIndex, b);
             floating_t tangentLength = interpolationResult.tangent.length();
 
             //the second derivative will be the curvature projected onto the tangent
@@ -32,6 +41,110 @@ namespace __ArcLengthSolvePrivate
 
         return boost::math::tools::halley_iterate(solveFunction, bGuess, segmentA, bEnd, int(std::numeric_limits<floating_t>::digits * 0.5));
     }
+
+    //compute the arc length of each segment in [begin, end), and write it to lengths[i + 1]
+    //each segment's length is stored one entry later than its cumulative length will be, so that prefixSum can turn the list into cumulative lengths in place
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    void segmentLengthRange(const Spline<InterpolationType, floating_t>& spline, std::vector<floating_t> &lengths, size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+        {
+            lengths[i + 1] = spline.segmentArcLength(i, spline.segmentT(i), spline.segmentT(i+1));
+        }
+    }
+
+    template<typename floating_t>
+    void prefixSum(std::vector<floating_t> &lengths)
+    {
+        for(size_t i = 1; i < lengths.size(); i++)
+        {
+            lengths[i] += lengths[i - 1];
+        }
+    }
+
+    //compute the arc length of every segment in parallel, and return the arc length from the beginning of the spline to the beginning of each segment
+    //the returned list has segmentCount() + 1 entries, so the last entry is the total arc length
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    std::vector<floating_t> cumulativeSegmentLengths(const Spline<InterpolationType, floating_t>& spline, size_t threadCount)
+    {
+        size_t segmentCount = spline.segmentCount();
+        std::vector<floating_t> cumulativeLengths(segmentCount + 1);
+
+        SplineParallel::workStealingFor(segmentCount, threadCount, [&spline, &cumulativeLengths](size_t segmentIndex, size_t) {
+            segmentLengthRange(spline, cumulativeLengths, segmentIndex, segmentIndex + 1);
+        });
+
+        //the prefix sum is a single addition per segment, so it isn't worth splitting up
+        prefixSum(cumulativeLengths);
+        return cumulativeLengths;
+    }
+
+    //for each piece boundary i in [begin, end), find the T value where the arc length from the beginning of the spline is i * lengthPerPiece, and write it to pieces[i]
+    //each boundary is found independently, by binary searching the cumulative lengths for its segment, so any range of boundaries can be solved on its own
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    void solvePieceRange(const Spline<InterpolationType, floating_t>& spline, const std::vector<floating_t> &cumulativeLengths,
+                         floating_t lengthPerPiece, std::vector<floating_t> &pieces, size_t begin, size_t end)
+    {
+        size_t segmentCount = spline.segmentCount();
+        for(size_t i = begin; i < end; i++)
+        {
+            floating_t targetLength = i * lengthPerPiece;
+
+            //find the first segment whose end is at or past the target. rounding can put the target past the end of the spline, so clamp to the last segment
+            auto segmentEnd = std::lower_bound(cumulativeLengths.begin() + 1, cumulativeLengths.end(), targetLength);
+            size_t segmentIndex = std::min(size_t(segmentEnd - cumulativeLengths.begin()) - 1, segmentCount - 1);
+
+            floating_t segmentLength = cumulativeLengths[segmentIndex + 1] - cumulativeLengths[segmentIndex];
+            floating_t desiredLength = std::min(targetLength - cumulativeLengths[segmentIndex], segmentLength);
+            pieces[i] = solveSegment(spline, segmentIndex, desiredLength, segmentLength, spline.segmentT(segmentIndex));
+        }
+    }
+
+    //for each piece boundary i in [1, pieceCount), find the T value where the arc length from the beginning of the spline is i * lengthPerPiece, and write it to pieces[i]
+    //the boundaries are split between threads
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    void solvePiecesParallel(const Spline<InterpolationType, floating_t>& spline, const std::vector<floating_t> &cumulativeLengths,
+                             floating_t lengthPerPiece, std::vector<floating_t> &pieces, size_t pieceCount, size_t threadCount)
+    {
+        SplineParallel::workStealingFor(pieceCount - 1, threadCount, [&](size_t boundary, size_t) {
+            solvePieceRange(spline, cumulativeLengths, lengthPerPiece, pieces, boundary + 1, boundary + 2);
+        });
+    }
+
+    //for each target arc length from the beginning of the spline, find the T value where the spline reaches it, using the segment lengths stored in the given index
+    //the targets must be sorted in increasing order: each target's segment is found by walking forward from the previous target's segment, so every target shares one pass over the segments
+    template<class InterpolationType, typename floating_t>
+    void solveSortedTargets(const ArcLengthIndex<InterpolationType, floating_t> &index, const std::vector<floating_t> &targets, std::vector<floating_t> &output)
+    {
+        const Spline<InterpolationType, floating_t> &spline = index.getSpline();
+        size_t lastSegment = spline.segmentCount() - 1;
+        size_t segmentIndex = 0;
+
+        output.resize(targets.size());
+        for(size_t i = 0; i < targets.size(); i++)
+        {
+            //rounding can put the target past the end of the spline, so stop at the last segment
+            while(segmentIndex < lastSegment && index.lengthBeforeSegment(segmentIndex + 1) < targets[i])
+            {
+                segmentIndex++;
+            }
+
+            floating_t segmentLength = index.segmentLength(segmentIndex);
+            floating_t desiredLength = std::min(targets[i] - index.lengthBeforeSegment(segmentIndex), segmentLength);
+            output[i] = solveSegment(spline, segmentIndex, desiredLength, segmentLength, spline.segmentT(segmentIndex));
+        }
+    }
+
+    inline size_t greatestCommonDivisor(size_t a, size_t b)
+    {
+        while(b != 0)
+        {
+            size_t remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
 }
 
 namespace ArcLength
@@ -40,6 +153,8 @@ namespace ArcLength
     template<template <class, typename> class SplineT, class InterpolationType, typename floating_t>
     floating_t solveLength(const SplineT<InterpolationType, floating_t>& spline, floating_t a, floating_t desiredLength)
     {
+        SPLINE_INSTRUMENT_TIMER(SolveLength);
+
         size_t index = spline.segmentForT(a);
 
         floating_t segmentLength;
@@ -72,11 +187,67 @@ namespace ArcLength
         return __ArcLengthSolvePrivate::solveSegment(spline, index, desiredLength, segmentLength, segmentBegin);
     }
 
+    //same as solveLength, but for many desired lengths at once: output[i] is solveLength(spline, a, desiredLengths[i]). the desired lengths must be sorted in increasing order
+    //instead of scanning the spline from a for every length, the spline is walked once: each length is solved starting from the previous length's solution,
+    //the same way partition solves each piece from the end of the previous piece. the results can differ from solveLength by floating point rounding
+    template<template <class, typename> class SplineT, class InterpolationType, typename floating_t>
+    void solveLengths(const SplineT<InterpolationType, floating_t>& spline, floating_t a, const floating_t *desiredLengths, size_t count, floating_t *output)
+    {
+        SPLINE_INSTRUMENT_TIMER(SolveLength);
+
+        size_t index = spline.segmentForT(a);
+        floating_t segmentRemainder = spline.segmentArcLength(index, a, spline.segmentT(index + 1));
+
+        floating_t previousT = a;
+        floating_t previousLength = 0;
+        for(size_t i = 0; i < count; i++)
+        {
+            assert(desiredLengths[i] >= previousLength);
+
+            floating_t desiredLength = desiredLengths[i] - previousLength;
+            floating_t segmentBegin = previousT;
+
+            //scan forward from the previous solution's segment until we find the segment that contains b
+            while(segmentRemainder < desiredLength)
+            {
+                index++;
+
+                //if we've hit the end of the spline, this length and every longer one are past the end, so they're all maxT
+                if(index == spline.segmentCount())
+                {
+                    std::fill(output + i, output + count, spline.getMaxT());
+                    return;
+                }
+
+                desiredLength -= segmentRemainder;
+                segmentBegin = spline.segmentT(index);
+                segmentRemainder = spline.segmentArcLength(index, segmentBegin, spline.segmentT(index + 1));
+            }
+
+            output[i] = __ArcLengthSolvePrivate::solveSegment(spline, index, desiredLength, segmentRemainder, segmentBegin);
+
+            //set up the next length
+            segmentRemainder -= desiredLength;
+            previousT = output[i];
+            previousLength = desiredLengths[i];
+        }
+    }
+
+    template<template <class, typename> class SplineT, class InterpolationType, typename floating_t>
+    std::vector<floating_t> solveLengths(const SplineT<InterpolationType, floating_t>& spline, floating_t a, const std::vector<floating_t> &desiredLengths)
+    {
+        std::vector<floating_t> result(desiredLengths.size());
+        solveLengths(spline, a, desiredLengths.data(), desiredLengths.size(), result.data());
+        return result;
+    }
+
     //compute b such that cyclicArcLength(a,b) == desiredLength, respecting the cyclic semantics of a looping spline
     //IE, a can be out of range, if desiredLength is totalLength*2 + 1, the result will be equal to solveCyclic(a,1) + maxT*2
     template<template <class, typename> class LoopingSplineT, class InterpolationType, typename floating_t>
     floating_t solveLengthCyclic(const LoopingSplineT<InterpolationType, floating_t>& spline, floating_t a, floating_t desiredLength)
     {
+        SPLINE_INSTRUMENT_TIMER(SolveLength);
+
         size_t index = spline.segmentForT(a);
 
         floating_t wrappedA = spline.wrapT(a);
@@ -201,4 +372,119 @@ namespace ArcLength
         pieces[n] = spline.getMaxT();
         return pieces;
     }
+
+    //same as partition, but split the work between threadCount threads, for very long splines
+    //every segment's arc length is computed in parallel, and then each piece boundary is solved independently, so the results can differ
+    //from partition by floating point rounding. if threadCount is 0, one thread per hardware thread is used
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    std::vector<floating_t> partitionParallel(const Spline<InterpolationType, floating_t>& spline, floating_t lengthPerPiece, size_t threadCount = 0)
+    {
+        std::vector<floating_t> cumulativeLengths = __ArcLengthSolvePrivate::cumulativeSegmentLengths(spline, threadCount);
+
+        size_t n = size_t(cumulativeLengths.back() / lengthPerPiece) + 1;
+        std::vector<floating_t> pieces(n);
+        __ArcLengthSolvePrivate::solvePiecesParallel(spline, cumulativeLengths, lengthPerPiece, pieces, n, threadCount);
+        return pieces;
+    }
+
+    //same as partitionN, but split the work between threadCount threads, for very long splines
+    //every segment's arc length is computed in parallel, and then each piece boundary is solved independently, so the results can differ
+    //from partitionN by floating point rounding. if threadCount is 0, one thread per hardware thread is used
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    std::vector<floating_t> partitionNParallel(const Spline<InterpolationType, floating_t>& spline, size_t n, size_t threadCount = 0)
+    {
+        //there are no boundaries to solve, so return the same single T value as partitionN
+        if(n == 0)
+            return std::vector<floating_t>{spline.getMaxT()};
+
+        std::vector<floating_t> cumulativeLengths = __ArcLengthSolvePrivate::cumulativeSegmentLengths(spline, threadCount);
+
+        std::vector<floating_t> pieces(n + 1);
+        __ArcLengthSolvePrivate::solvePiecesParallel(spline, cumulativeLengths, cumulativeLengths.back() / n, pieces, n, threadCount);
+        pieces[n] = spline.getMaxT();
+        return pieces;
+    }
+
+    //same as partition, but take the segment lengths from the given index instead of integrating every segment again,
+    //so that partitioning the same spline several times only integrates it once. each boundary is solved from the index's running total of segment lengths,
+    //so the results can differ from partition by floating point rounding
+    template<class InterpolationType, typename floating_t>
+    std::vector<floating_t> partition(const ArcLengthIndex<InterpolationType, floating_t> &index, floating_t lengthPerPiece)
+    {
+        size_t n = size_t(index.totalLength() / lengthPerPiece) + 1;
+
+        std::vector<floating_t> targets(n - 1);
+        for(size_t i = 1; i < n; i++)
+        {
+            targets[i - 1] = i * lengthPerPiece;
+        }
+
+        std::vector<floating_t> boundaries;
+        __ArcLengthSolvePrivate::solveSortedTargets(index, targets, boundaries);
+
+        std::vector<floating_t> pieces(n);
+        std::copy(boundaries.begin(), boundaries.end(), pieces.begin() + 1);
+        return pieces;
+    }
+
+    //partitionN for several values of n at once, IE for generating levels of detail. result[i] is the partitionN of counts[i], using the segment lengths from the given index
+    //the boundaries of every partition are solved in a single pass over the segments, and a boundary shared by several partitions
+    //(IE the middle of the spline, if counts contains both 2 and 4) is only solved once
+    template<class InterpolationType, typename floating_t>
+    std::vector<std::vector<floating_t>> partitionMultiN(const ArcLengthIndex<InterpolationType, floating_t> &index, const std::vector<size_t> &counts)
+    {
+        //identify each boundary by its fraction of the total length, in lowest terms, so that boundaries shared between partitions compare equal
+        struct Fraction
+        {
+            size_t numerator, denominator;
+
+            bool operator<(const Fraction &other) const { return numerator * other.denominator < other.numerator * denominator; }
+            bool operator==(const Fraction &other) const { return numerator == other.numerator && denominator == other.denominator; }
+        };
+
+        std::vector<Fraction> fractions;
+        for(size_t n : counts)
+        {
+            for(size_t i = 1; i < n; i++)
+            {
+                size_t divisor = __ArcLengthSolvePrivate::greatestCommonDivisor(i, n);
+                fractions.push_back(Fraction{i / divisor, n / divisor});
+            }
+        }
+        std::sort(fractions.begin(), fractions.end());
+        fractions.erase(std::unique(fractions.begin(), fractions.end()), fractions.end());
+
+        std::vector<floating_t> targets(fractions.size());
+        for(size_t i = 0; i < fractions.size(); i++)
+        {
+            targets[i] = index.totalLength() * fractions[i].numerator / fractions[i].denominator;
+        }
+
+        std::vector<floating_t> boundaries;
+        __ArcLengthSolvePrivate::solveSortedTargets(index, targets, boundaries);
+
+        std::vector<std::vector<floating_t>> result;
+        result.reserve(counts.size());
+        for(size_t n : counts)
+        {
+            std::vector<floating_t> pieces(n + 1);
+            for(size_t i = 1; i < n; i++)
+            {
+                size_t divisor = __ArcLengthSolvePrivate::greatestCommonDivisor(i, n);
+                auto fraction = std::lower_bound(fractions.begin(), fractions.end(), Fraction{i / divisor, n / divisor});
+                pieces[i] = boundaries[fraction - fractions.begin()];
+            }
+            pieces[n] = index.getSpline().getMaxT();
+            result.push_back(std::move(pieces));
+        }
+        return result;
+    }
+
+    //same as partitionN, but take the segment lengths from the given index instead of integrating every segment again. see partition above
+    //the results are identical to the matching entry of partitionMultiN
+    template<class InterpolationType, typename floating_t>
+    std::vector<floating_t> partitionN(const ArcLengthIndex<InterpolationType, floating_t> &index, size_t n)
+    {
+        return std::move(partitionMultiN(index, std::vector<size_t>{n}).front());
+    }
 }
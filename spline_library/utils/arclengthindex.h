@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "../spline.h"
+
+//the spline's own arcLength methods integrate every segment between a and b on every call
+//this object computes the length of every segment once, and stores a running total of them
+//so that whole segments between a and b become a table lookup, and only the partial segments at each end need to be integrated
+template<class InterpolationType, typename floating_t=float>
+class ArcLengthIndex
+{
+public:
+    ArcLengthIndex(const Spline<InterpolationType, floating_t> &spline);
+
+    //same results as the spline's methods of the same names
+    floating_t arcLength(floating_t a, floating_t b) const;
+    floating_t totalLength(void) const { return cumulativeLengths.back(); }
+
+    //for looping splines only!
+    floating_t cyclicArcLength(floating_t a, floating_t b) const;
+
+    //arc length of the whole segment at the given index
+    floating_t segmentLength(size_t segmentIndex) const { return cumulativeLengths[segmentIndex + 1] - cumulativeLengths[segmentIndex]; }
+
+    //arc length from the beginning of the spline to the beginning of the given segment. segmentIndex may be equal to segmentCount()
+    floating_t lengthBeforeSegment(size_t segmentIndex) const { return cumulativeLengths[segmentIndex]; }
+
+    //index of the segment that contains the given arc length from the beginning of the spline, in O(log n)
+    size_t segmentForLength(floating_t length) const;
+
+    const Spline<InterpolationType, floating_t> &getSpline(void) const { return spline; }
+
+private: //methods
+    floating_t wrapT(floating_t t) const { return loopingSpline ? loopingSpline->wrapT(t) : t; }
+
+private: //data
+    const Spline<InterpolationType, floating_t> &spline;
+
+    //null if the spline isn't looping
+    const LoopingSpline<InterpolationType, floating_t> *loopingSpline;
+
+    //cumulativeLengths[i] is the arc length from T = 0 to segmentT(i). it has segmentCount() + 1 entries
+    std::vector<floating_t> cumulativeLengths;
+};
+
+template<class InterpolationType, typename floating_t>
+ArcLengthIndex<InterpolationType, floating_t>::ArcLengthIndex(const Spline<InterpolationType, floating_t> &spline)
+    :spline(spline),
+      loopingSpline(dynamic_cast<const LoopingSpline<InterpolationType, floating_t>*>(&spline)),
+      cumulativeLengths(spline.segmentCount() + 1)
+{
+    cumulativeLengths[0] = 0;
+    for(size_t i = 0; i < spline.segmentCount(); i++)
+    {
+        cumulativeLengths[i + 1] = cumulativeLengths[i] + spline.segmentArcLength(i, spline.segmentT(i), spline.segmentT(i + 1));
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+floating_t ArcLengthIndex<InterpolationType, floating_t>::arcLength(floating_t a, floating_t b) const
+{
+    a = wrapT(a);
+    b = wrapT(b);
+
+    if(a > b) {
+        std::swap(a,b);
+    }
+
+    //get the knot indices for the beginning and end
+    size_t aIndex = spline.segmentForT(a);
+    size_t bIndex = spline.segmentForT(b);
+
+    //if a and b occur inside the same segment, compute the length within that segment
+    if(aIndex == bIndex) {
+        return spline.segmentArcLength(aIndex, a, b);
+    }
+    else {
+        //a and b occur in different segments: integrate the partial segment at each end, and look up the segments in between
+        floating_t aEnd = spline.segmentT(aIndex + 1);
+        floating_t bBegin = spline.segmentT(bIndex);
+
+        return spline.segmentArcLength(aIndex, a, aEnd)
+                + (cumulativeLengths[bIndex] - cumulativeLengths[aIndex + 1])
+                + spline.segmentArcLength(bIndex, bBegin, b);
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+floating_t ArcLengthIndex<InterpolationType, floating_t>::cyclicArcLength(floating_t a, floating_t b) const
+{
+    floating_t wrappedA = wrapT(a);
+    floating_t wrappedB = wrapT(b);
+
+    //if wrapped A is less than wrapped B, then we can use the normal arc legth formula
+    if(wrappedA <= wrappedB)
+    {
+        return arcLength(wrappedA, wrappedB);
+    }
+    else
+    {
+        //we wrap around the end of the spline, so the result is everything except the piece from b to a
+        return totalLength() - arcLength(wrappedB, wrappedA);
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+size_t ArcLengthIndex<InterpolationType, floating_t>::segmentForLength(floating_t length) const
+{
+    //find the first segment whose end is past the given length
+    auto it = std::upper_bound(cumulativeLengths.begin() + 1, cumulativeLengths.end(), length);
+    size_t segmentIndex = size_t(it - (cumulativeLengths.begin() + 1));
+
+    //lengths past the end of the spline belong to the last segment
+    if(segmentIndex >= spline.segmentCount())
+        return spline.segmentCount() - 1;
+    else
+        return segmentIndex;
+}
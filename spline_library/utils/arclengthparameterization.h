@@ -0,0 +1,298 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "../spline.h"
+#include "arclength.h"
+#include "arclengthindex.h"
+
+//the arc length solver runs a root finder for every query, which is expensive when objects need to move along a spline at constant speed
+//this object precomputes the mapping from arc length to T, so that converting an arc length to a T value is O(1) with no root finding
+//the mapping is a monotone piecewise cubic hermite fit of T as a function of arc length
+template<class InterpolationType, typename floating_t=float>
+class ArcLengthParameterization
+{
+public:
+    //maxError is the largest acceptable difference between the requested arc length and the arc length of the returned T value
+    //pieces of the fit are subdivided until the error at the middle of every piece is below maxError, or maxPieces is reached,
+    //or the pieces are so small that the spline's own arc length integration isn't precise enough to tell the difference
+    ArcLengthParameterization(const Spline<InterpolationType, floating_t> &spline, floating_t maxError = 0.001, size_t maxPieces = 1 << 16);
+
+    //compute t such that arcLength(0, t) ~= length, in O(1)
+    //for non-looping splines, lengths outside [0, totalLength] are clamped
+    //for looping splines, lengths outside [0, totalLength] wrap around the spline the same way solveLengthCyclic does,
+    //IE if length is totalLength*2 + x the result will be tForLength(x) + maxT*2
+    floating_t tForLength(floating_t length) const;
+
+    //same as tForLength, but runs the arc length solver to get full precision. the solver starts from the beginning of the piece containing
+    //the given length rather than the beginning of the spline, so it only ever has to integrate over a single piece
+    floating_t solveLength(floating_t length) const;
+
+    floating_t totalLength(void) const { return lengths.back(); }
+    size_t pieceCount(void) const { return times.size() - 1; }
+
+    //the largest error found at the middle of each piece when the fit was built
+    floating_t measuredError(void) const { return fitError; }
+
+private: //types
+    struct FitPoint
+    {
+        floating_t t;
+        floating_t length;
+        floating_t slope;
+    };
+
+private: //methods
+    FitPoint makePoint(floating_t t, floating_t length) const;
+
+    //find the piece that contains the given length, and the number of times the length wrapped around the spline
+    //length is wrapped or clamped to be within [0, totalLength]
+    size_t findPiece(floating_t &length, floating_t &wrapOffset) const;
+
+    //the fit for a single piece, given the T value and the (already limited) slopes at each end
+    static floating_t evaluatePiece(floating_t beginT, floating_t endT, floating_t beginSlope, floating_t endSlope, floating_t pieceLength, floating_t x);
+
+private: //data
+    const Spline<InterpolationType, floating_t> &spline;
+
+    //times[i] is the T value where arcLength(0, T) == lengths[i]
+    std::vector<floating_t> times;
+    std::vector<floating_t> lengths;
+
+    //the derivative of T with respect to arc length at the beginning and end of each piece
+    //these are limited per piece so that each piece is monotonic, so the two pieces on either side of a point might disagree
+    std::vector<floating_t> beginSlopes, endSlopes;
+
+    //the spline is divided into buckets of equal arc length, and buckets[i] is the first piece that overlaps bucket i
+    //most buckets contain a single piece, so this finds the piece for a given length without searching
+    floating_t bucketLength;
+    std::vector<size_t> buckets;
+
+    floating_t fitError;
+};
+
+template<class InterpolationType, typename floating_t>
+ArcLengthParameterization<InterpolationType, floating_t>::ArcLengthParameterization(
+        const Spline<InterpolationType, floating_t> &spline, floating_t maxError, size_t maxPieces)
+    :spline(spline), fitError(0)
+{
+    ArcLengthIndex<InterpolationType, floating_t> index(spline);
+    floating_t total = index.totalLength();
+
+    //if every point of the spline is the same, there's nothing to fit: use a single piece with no length, so that every length maps to T = 0
+    if(total <= 0)
+    {
+        times = {0, spline.getMaxT()};
+        lengths = {0, 0};
+        beginSlopes = {0};
+        endSlopes = {0};
+        bucketLength = 0;
+        buckets = {0};
+        return;
+    }
+
+    //start from a few pieces of equal arc length per segment
+    size_t n = std::max(size_t(1), spline.segmentCount() * 4);
+    std::vector<floating_t> equalTimes = ArcLength::partitionN(spline, n);
+
+    //T as a function of arc length isn't smooth across segment boundaries, so merge the segment boundaries into the list of points
+    //the arc length at each T value is measured with the index rather than trusted from partitionN, since partitionN's root finder
+    //only solves to about half the precision of floating_t
+    //the numerical integration of a partial segment doesn't always agree exactly with the integration of the whole segment,
+    //so a point from partitionN can end up measured slightly past the segment boundary after it. segment boundaries take priority
+    std::vector<FitPoint> initialPoints;
+    initialPoints.push_back(makePoint(0, 0));
+    auto addPoint = [&](floating_t t, floating_t length) {
+        while(initialPoints.size() > 1 && initialPoints.back().length >= length)
+            initialPoints.pop_back();
+        if(t > initialPoints.back().t && length > initialPoints.back().length)
+            initialPoints.push_back(makePoint(t, length));
+    };
+
+    size_t segmentIndex = 0;
+    for(size_t i = 1; i <= n; i++)
+    {
+        floating_t nextT = i < n ? equalTimes[i] : spline.getMaxT();
+        while(segmentIndex + 1 < spline.segmentCount() && spline.segmentT(segmentIndex + 1) <= nextT)
+        {
+            segmentIndex++;
+            addPoint(spline.segmentT(segmentIndex), index.lengthBeforeSegment(segmentIndex));
+        }
+
+        if(i == n)
+            addPoint(nextT, total);
+        else
+            addPoint(nextT, index.lengthBeforeSegment(segmentIndex) + spline.segmentArcLength(segmentIndex, spline.segmentT(segmentIndex), nextT));
+    }
+
+    //build each piece, splitting it in half (by T) whenever the error at the middle of the piece is too large
+    //every piece lies within a single spline segment, so the split points can be measured directly
+    times.push_back(initialPoints[0].t);
+    lengths.push_back(initialPoints[0].length);
+
+    std::vector<FitPoint> stack;
+    for(size_t i = 1; i < initialPoints.size(); i++)
+    {
+        FitPoint begin = initialPoints[i - 1];
+        segmentIndex = spline.segmentForT(begin.t);
+
+        stack.push_back(initialPoints[i]);
+        while(!stack.empty())
+        {
+            FitPoint end = stack.back();
+
+            floating_t pieceLength = end.length - begin.length;
+            floating_t pieceT = end.t - begin.t;
+
+            //limit the slopes on this piece so that it's monotonic, using the fritsch-carlson method
+            floating_t beginSlope = 0, endSlope = 0;
+            if(pieceLength > 0 && pieceT > 0)
+            {
+                floating_t secant = pieceT / pieceLength;
+                beginSlope = std::min(begin.slope, 3 * secant);
+                endSlope = std::min(end.slope, 3 * secant);
+
+                floating_t alpha = beginSlope / secant;
+                floating_t beta = endSlope / secant;
+                floating_t magnitude = alpha * alpha + beta * beta;
+                if(magnitude > 9)
+                {
+                    floating_t scale = 3 / std::sqrt(magnitude);
+                    beginSlope *= scale;
+                    endSlope *= scale;
+                }
+            }
+
+            //measure the error at the middle of the piece
+            floating_t middleT = evaluatePiece(begin.t, end.t, beginSlope, endSlope, pieceLength, 0.5);
+            floating_t error = std::abs(spline.segmentArcLength(segmentIndex, begin.t, middleT) - pieceLength / 2);
+
+            //split the piece if it's not accurate enough. if the integration is too imprecise to place the split point strictly inside the piece,
+            //we've reached the limit of the spline's own arc length precision, so there's no point in splitting further
+            floating_t splitT = (begin.t + end.t) / 2;
+            floating_t splitLength = begin.length + spline.segmentArcLength(segmentIndex, begin.t, splitT);
+            bool canSplit = splitT > begin.t && splitT < end.t
+                    && splitLength > begin.length && splitLength < end.length
+                    && times.size() + stack.size() < maxPieces;
+            if(error > maxError && canSplit)
+            {
+                stack.push_back(makePoint(splitT, splitLength));
+            }
+            else
+            {
+                times.push_back(end.t);
+                lengths.push_back(end.length);
+                beginSlopes.push_back(beginSlope);
+                endSlopes.push_back(endSlope);
+                fitError = std::max(fitError, error);
+
+                begin = end;
+                stack.pop_back();
+            }
+        }
+    }
+
+    //sort the pieces into buckets
+    bucketLength = total / n;
+    buckets.resize(n);
+    size_t pieceIndex = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        while(pieceIndex + 1 < pieceCount() && lengths[pieceIndex + 1] <= i * bucketLength)
+            pieceIndex++;
+        buckets[i] = pieceIndex;
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+typename ArcLengthParameterization<InterpolationType, floating_t>::FitPoint
+    ArcLengthParameterization<InterpolationType, floating_t>::makePoint(floating_t t, floating_t length) const
+{
+    //the derivative of T with respect to arc length is 1 / the length of the tangent
+    floating_t speed = spline.template evaluate<SplineDerivatives::Tangent>(t).tangent.length();
+    floating_t slope = speed > 0 ? 1 / speed : std::numeric_limits<floating_t>::infinity();
+    return FitPoint{t, length, slope};
+}
+
+template<class InterpolationType, typename floating_t>
+size_t ArcLengthParameterization<InterpolationType, floating_t>::findPiece(floating_t &length, floating_t &wrapOffset) const
+{
+    floating_t total = totalLength();
+    wrapOffset = 0;
+
+    //a spline with no length has a single piece, and dividing by its length would be undefined
+    if(total <= 0)
+    {
+        length = 0;
+        return 0;
+    }
+
+    if(spline.isLooping())
+    {
+        floating_t numCycles = std::floor(length / total);
+        length -= numCycles * total;
+        wrapOffset = numCycles * spline.getMaxT();
+    }
+    else
+    {
+        length = std::max(floating_t(0), std::min(length, total));
+    }
+
+    //look up the first piece in this length's bucket, then step through the (usually zero or one) other pieces in the bucket
+    size_t lastPiece = pieceCount() - 1;
+    size_t pieceIndex = buckets[std::min(size_t(length / bucketLength), buckets.size() - 1)];
+    while(pieceIndex > 0 && lengths[pieceIndex] > length)
+        pieceIndex--;
+    while(pieceIndex < lastPiece && lengths[pieceIndex + 1] <= length)
+        pieceIndex++;
+
+    return pieceIndex;
+}
+
+template<class InterpolationType, typename floating_t>
+floating_t ArcLengthParameterization<InterpolationType, floating_t>::evaluatePiece(
+        floating_t beginT, floating_t endT, floating_t beginSlope, floating_t endSlope, floating_t pieceLength, floating_t x)
+{
+    floating_t oneMinusX = 1 - x;
+
+    //cubic hermite basis functions
+    floating_t basis00 = (1 + 2 * x) * oneMinusX * oneMinusX;
+    floating_t basis10 = x * oneMinusX * oneMinusX;
+    floating_t basis01 = x * x * (3 - 2 * x);
+    floating_t basis11 = x * x * (x - 1);
+
+    return basis00 * beginT
+            + basis10 * pieceLength * beginSlope
+            + basis01 * endT
+            + basis11 * pieceLength * endSlope;
+}
+
+template<class InterpolationType, typename floating_t>
+floating_t ArcLengthParameterization<InterpolationType, floating_t>::tForLength(floating_t length) const
+{
+    floating_t wrapOffset;
+    size_t pieceIndex = findPiece(length, wrapOffset);
+
+    floating_t pieceLength = lengths[pieceIndex + 1] - lengths[pieceIndex];
+    if(pieceLength <= 0)
+        return times[pieceIndex] + wrapOffset;
+
+    floating_t x = (length - lengths[pieceIndex]) / pieceLength;
+    return evaluatePiece(times[pieceIndex], times[pieceIndex + 1], beginSlopes[pieceIndex], endSlopes[pieceIndex], pieceLength, x) + wrapOffset;
+}
+
+template<class InterpolationType, typename floating_t>
+floating_t ArcLengthParameterization<InterpolationType, floating_t>::solveLength(floating_t length) const
+{
+    floating_t wrapOffset;
+    size_t pieceIndex = findPiece(length, wrapOffset);
+
+    //the solver divides by the length of the segment, so a spline with no length can't be solved
+    if(totalLength() <= 0)
+        return times[pieceIndex];
+
+    return ArcLength::solveLength(spline, times[pieceIndex], length - lengths[pieceIndex]) + wrapOffset;
+}
@@ -2,62 +2,284 @@
 
 #include <cmath>
 #include <array>
+#include <limits>
+#include <algorithm>
+
+#include "instrumentation.h"
+
+namespace __CalculusPrivate
+{
+    //the tables are computed in long double where it's more precise than double, so that the rounding of the recurrence doesn't show up in the stored values
+    typedef long double TableFloat;
+
+    constexpr TableFloat pi = 3.141592653589793238462643383279502884L;
+
+    //cos for x in [0, pi], from its taylor series. std::cos isn't constexpr, and this is only the starting guess for newton's method, so it doesn't need to be exact
+    constexpr TableFloat constexprCos(TableFloat x)
+    {
+        TableFloat term = 1;
+        TableFloat sum = 1;
+        for(int i = 1; i < 30; i++)
+        {
+            term *= -x * x / TableFloat((2 * i - 1) * (2 * i));
+            sum += term;
+        }
+        return sum;
+    }
+
+    //the points of an n point gauss-legendre rule, in ascending order, and their weights
+    template<size_t n>
+    struct GaussLegendreTable
+    {
+        double points[n];
+        double weights[n];
+    };
+
+    struct LegendreResult
+    {
+        TableFloat value;
+        TableFloat derivative;
+    };
+
+    //evaluate the legendre polynomial P_n and its derivative at x, with the polynomials' three-term recurrence
+    constexpr LegendreResult evaluateLegendre(size_t n, TableFloat x)
+    {
+        TableFloat previous = 1;
+        TableFloat current = x;
+        for(size_t k = 2; k <= n; k++)
+        {
+            TableFloat next = (TableFloat(2 * k - 1) * x * current - TableFloat(k - 1) * previous) / TableFloat(k);
+            previous = current;
+            current = next;
+        }
+        return LegendreResult{current, TableFloat(n) * (x * current - previous) / (x * x - 1)};
+    }
+
+    //the points are the roots of P_n, and the weight of each point x is 2 / ((1 - x^2) * P_n'(x)^2)
+    //the roots are symmetric around 0, so we only search for the positive half, with newton's method
+    template<size_t n>
+    constexpr GaussLegendreTable<n> computeGaussLegendreTable(void)
+    {
+        GaussLegendreTable<n> result{};
+        for(size_t i = 0; i < (n + 1) / 2; i++)
+        {
+            //the middle root of an odd rule is exactly 0. for the others, start from a classic approximation of the i'th largest root,
+            //which is close enough that newton's method converges to it in a handful of steps
+            TableFloat x = 0;
+            if(2 * i + 1 != n)
+            {
+                x = constexprCos(pi * (TableFloat(i) + 0.75) / (TableFloat(n) + 0.5));
+                for(int iteration = 0; iteration < 100; iteration++)
+                {
+                    LegendreResult legendre = evaluateLegendre(n, x);
+                    TableFloat step = legendre.value / legendre.derivative;
+                    x -= step;
+                    if(step < 1e-18L && step > -1e-18L)
+                        break;
+                }
+            }
+
+            TableFloat derivative = evaluateLegendre(n, x).derivative;
+            TableFloat weight = 2 / ((1 - x) * (1 + x) * derivative * derivative);
+            result.points[i] = double(-x);
+            result.points[n - 1 - i] = double(x);
+            result.weights[i] = double(weight);
+            result.weights[n - 1 - i] = double(weight);
+        }
+        return result;
+    }
+}
 
 class SplineLibraryCalculus {
 private:
     SplineLibraryCalculus() = default;
 
 public:
-    //use the gauss-legendre quadrature algorithm to numerically integrate f from a to b
-    //as of this writing, hardcoded to use 13 points
+    //an n point gauss-legendre rule, which is exact for polynomials up to degree 2n - 1. the points and weights are computed at compile time
+    //more points are more accurate for integrands that aren't polynomials, IE the speed of a spline segment, at the cost of an evaluation per point
+    template<size_t n>
+    struct GaussLegendreRule
+    {
+        static_assert(n > 0, "A gauss-legendre rule needs at least one point");
+
+        static constexpr size_t pointCount = n;
+        static constexpr __CalculusPrivate::GaussLegendreTable<n> table = __CalculusPrivate::computeGaussLegendreTable<n>();
+
+        //numerically integrate f from a to b
+        template<class IntegrandType, class Function, typename floating_t>
+        inline static IntegrandType integrate(Function f, floating_t a, floating_t b)
+        {
+            floating_t halfDiff = (b - a) / 2;
+            floating_t halfSum = (a + b) / 2;
+
+            SPLINE_INSTRUMENT_COUNT(QuadratureCalls);
+            SPLINE_INSTRUMENT_COUNT_N(IntegrandEvaluations, n);
+
+            IntegrandType sum{};
+            for(size_t i = 0; i < n; i++)
+            {
+                sum += floating_t(table.weights[i]) * f(halfDiff * floating_t(table.points[i]) + halfSum);
+            }
+            return halfDiff * sum;
+        }
+    };
+
+    //use the gauss-legendre quadrature algorithm to numerically integrate f from a to b, with 13 points
     template<class IntegrandType, class Function, typename floating_t>
     inline static IntegrandType gaussLegendreQuadratureIntegral(Function f, floating_t a, floating_t b)
     {
-        const size_t NUM_POINTS = 13;
-
-        //these are precomputed :( It would be cool to compute these at compile time, but apparently
-        //it's not easy to compute the points/weights just given the number of points.
-        //it involves computing every root of a polynomial. which can obviously be done, but not in a reasonable amount of code
-        std::array<floating_t, NUM_POINTS> quadraturePoints = {
-            floating_t( 0.0000000000000000),
-            floating_t(-0.2304583159551348),
-            floating_t( 0.2304583159551348),
-            floating_t(-0.4484927510364469),
-            floating_t( 0.4484927510364469),
-            floating_t(-0.6423493394403402),
-            floating_t( 0.6423493394403402),
-            floating_t(-0.8015780907333099),
-            floating_t( 0.8015780907333099),
-            floating_t(-0.9175983992229779),
-            floating_t( 0.9175983992229779),
-            floating_t(-0.9841830547185881),
-            floating_t( 0.9841830547185881)
+        return GaussLegendreRule<13>::integrate<IntegrandType>(f, a, b);
+    }
+
+    //same as gaussLegendreQuadratureIntegral, but with only 5 points. exact for polynomials up to degree 9, so this is plenty for
+    //nearly straight segments, but can be noticeably off for segments whose speed changes sharply
+    template<class IntegrandType, class Function, typename floating_t>
+    inline static IntegrandType fastGaussLegendreQuadratureIntegral(Function f, floating_t a, floating_t b)
+    {
+        return GaussLegendreRule<5>::integrate<IntegrandType>(f, a, b);
+    }
+
+    //numerically integrate the scalar function f from a to b, to within roughly 'tolerance' of the true value
+    //each interval is integrated with a 15 point gauss-kronrod rule, and the 7 point gauss-legendre rule embedded in it gives an error estimate for free
+    //intervals whose estimate is larger than their share of the tolerance are split in half, up to maxDepth times
+    template<class Function, typename floating_t>
+    static floating_t adaptiveGaussKronrodIntegral(Function f, floating_t a, floating_t b, floating_t tolerance, size_t maxDepth = 10)
+    {
+        floating_t gaussResult;
+        floating_t kronrodResult = gaussKronrodIntegral(f, a, b, gaussResult);
+
+        //the error estimate can't get much smaller than the rounding error of the sum itself, so don't keep splitting to chase a tolerance we can't reach
+        floating_t roundingLimit = 50 * std::numeric_limits<floating_t>::epsilon() * std::abs(kronrodResult);
+        if(maxDepth == 0 || std::abs(kronrodResult - gaussResult) <= std::max(tolerance, roundingLimit))
+        {
+            return kronrodResult;
+        }
+        else
+        {
+            floating_t middle = (a + b) / 2;
+            return adaptiveGaussKronrodIntegral(f, a, middle, tolerance / 2, maxDepth - 1)
+                 + adaptiveGaussKronrodIntegral(f, middle, b, tolerance / 2, maxDepth - 1);
+        }
+    }
+
+    //integrates with an n point GaussLegendreRule. spline cores' segmentLength methods accept this as their quadrature, to pick a different order than the default
+    //if scale is given, the integral is multiplied by scale: cores that integrate over a normalized T use it to convert back to arc length
+    template<size_t n>
+    struct GaussLegendreQuadrature
+    {
+        template<class Function, typename floating_t>
+        inline floating_t operator()(Function f, floating_t a, floating_t b) const
+        {
+            return GaussLegendreRule<n>::template integrate<floating_t>(f, a, b);
+        }
+
+        template<class Function, typename floating_t>
+        inline floating_t operator()(Function f, floating_t a, floating_t b, floating_t scale) const
+        {
+            return scale * GaussLegendreRule<n>::template integrate<floating_t>(f, a, b);
+        }
+    };
+
+    //integrates with gaussLegendreQuadratureIntegral. spline cores use this for segment lengths unless they're given a different quadrature
+    typedef GaussLegendreQuadrature<13> DefaultQuadrature;
+
+    //chooses between the integration methods above at runtime, so that arc length queries can trade precision for throughput
+    //Fast uses fastGaussLegendreQuadratureIntegral, and Adaptive uses adaptiveGaussKronrodIntegral with the given tolerance, in units of arc length
+    template<typename floating_t>
+    struct Quadrature
+    {
+        enum class Method { GaussLegendre, Fast, Adaptive };
+
+        Method method = Method::GaussLegendre;
+        floating_t tolerance = 0;
+        size_t maxDepth = 0;
+
+        static Quadrature gaussLegendre(void) { return Quadrature(); }
+        static Quadrature fast(void) { Quadrature result; result.method = Method::Fast; return result; }
+        static Quadrature adaptive(floating_t tolerance, size_t maxDepth = 10)
+        {
+            Quadrature result;
+            result.method = Method::Adaptive;
+            result.tolerance = tolerance;
+            result.maxDepth = maxDepth;
+            return result;
+        }
+
+        template<class Function>
+        floating_t operator()(Function f, floating_t a, floating_t b, floating_t scale = 1) const
+        {
+            switch(method)
+            {
+            case Method::Fast:
+                return scale * fastGaussLegendreQuadratureIntegral<floating_t>(f, a, b);
+            case Method::Adaptive:
+                //the tolerance is in units of arc length, so undo the scale before integrating
+                return scale * adaptiveGaussKronrodIntegral(f, a, b, tolerance / std::abs(scale), maxDepth);
+            default:
+                return scale * gaussLegendreQuadratureIntegral<floating_t>(f, a, b);
+            }
+        }
+    };
+
+private:
+    //integrate f from a to b with the 15 point gauss-kronrod rule, and write the result of the embedded 7 point gauss-legendre rule to gaussResult
+    template<class Function, typename floating_t>
+    static floating_t gaussKronrodIntegral(Function f, floating_t a, floating_t b, floating_t &gaussResult)
+    {
+        //kronrod points, from the outside in. the odd-indexed points are also the 7 point gauss-legendre points
+        std::array<floating_t, 8> kronrodPoints = {
+            floating_t(0.9914553711208126),
+            floating_t(0.9491079123427585),
+            floating_t(0.8648644233597691),
+            floating_t(0.7415311855993944),
+            floating_t(0.5860872354676911),
+            floating_t(0.4058451513773972),
+            floating_t(0.2077849550078985),
+            floating_t(0.0000000000000000)
+        };
+
+        std::array<floating_t, 8> kronrodWeights = {
+            floating_t(0.0229353220105292),
+            floating_t(0.0630920926299786),
+            floating_t(0.1047900103222502),
+            floating_t(0.1406532597155259),
+            floating_t(0.1690047266392679),
+            floating_t(0.1903505780647854),
+            floating_t(0.2044329400752989),
+            floating_t(0.2094821410847278)
         };
 
-        std::array<floating_t, NUM_POINTS> quadratureWeights = {
-            floating_t(0.2325515532308739),
-            floating_t(0.2262831802628972),
-            floating_t(0.2262831802628972),
-            floating_t(0.2078160475368885),
-            floating_t(0.2078160475368885),
-            floating_t(0.1781459807619457),
-            floating_t(0.1781459807619457),
-            floating_t(0.1388735102197872),
-            floating_t(0.1388735102197872),
-            floating_t(0.0921214998377285),
-            floating_t(0.0921214998377285),
-            floating_t(0.0404840047653159),
-            floating_t(0.0404840047653159)
+        //weights of the gauss-legendre points kronrodPoints[1], [3], [5], and [7]
+        std::array<floating_t, 4> gaussWeights = {
+            floating_t(0.1294849661688697),
+            floating_t(0.2797053914892767),
+            floating_t(0.3818300505051189),
+            floating_t(0.4179591836734694)
         };
 
         floating_t halfDiff = (b - a) / 2;
         floating_t halfSum = (a + b) / 2;
 
-        IntegrandType sum{};
-        for(size_t i = 0; i < NUM_POINTS; i++)
+        SPLINE_INSTRUMENT_COUNT(QuadratureCalls);
+        SPLINE_INSTRUMENT_COUNT_N(IntegrandEvaluations, 15);
+
+        floating_t centerValue = f(halfSum);
+        floating_t kronrodSum = kronrodWeights[7] * centerValue;
+        floating_t gaussSum = gaussWeights[3] * centerValue;
+        for(size_t i = 0; i < 7; i++)
         {
-            sum += quadratureWeights[i] * f(halfDiff * quadraturePoints[i] + halfSum);
+            floating_t offset = halfDiff * kronrodPoints[i];
+            floating_t pairSum = f(halfSum - offset) + f(halfSum + offset);
+
+            kronrodSum += kronrodWeights[i] * pairSum;
+            if(i % 2 == 1)
+                gaussSum += gaussWeights[i / 2] * pairSum;
         }
-        return halfDiff * sum;
+
+        gaussResult = halfDiff * gaussSum;
+        return halfDiff * kronrodSum;
     }
 };
+
+template<size_t n>
+constexpr __CalculusPrivate::GaussLegendreTable<n> SplineLibraryCalculus::GaussLegendreRule<n>::table;
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "splineinverter.h"
+#include "workstealing.h"
+
+//computes the closest point on a spline for every pixel of an image, IE to render distance fields, or to color an image by the T of the closest point
+//the image covers the first two dimensions of the spline: pixel (x, y) covers the square from origin + (x, y) * pixelSize to origin + (x + 1, y + 1) * pixelSize,
+//and each pixel is sampled supersampling * supersampling times, on an evenly spaced grid inside the pixel
+//
+//the image is processed in square tiles, which are spread across threads with a work-stealing loop. instead of searching the inverter's kd-tree for every sample,
+//each tile does a single search for every inverter sample that could possibly be the closest sample to any point in the tile, and each point is only compared against those.
+//within a tile, each point's closest T is also used to begin the refinement of the next point, which with newton refinement usually saves an iteration or two
+template<class InterpolationType, typename floating_t=float, class SplineType=Spline<InterpolationType, floating_t>>
+class DistanceField
+{
+public:
+    typedef SplineInverter<InterpolationType, floating_t, 2, SplineType> InverterType;
+
+    struct Settings
+    {
+        size_t width = 0;
+        size_t height = 0;
+
+        //the spline-space position of the top left corner of pixel (0, 0), and the width of each pixel in spline space
+        floating_t originX = 0;
+        floating_t originY = 0;
+        floating_t pixelSize = 1;
+
+        //the number of samples per pixel in each direction, so 2 takes 4 samples per pixel. 1 samples the center of each pixel
+        size_t supersampling = 1;
+
+        //the width and height of each tile, in pixels
+        size_t tileSize = 16;
+
+        //if 0, one thread per hardware thread is used
+        size_t threadCount = 0;
+    };
+
+    //query points are compared against the samples of an inverter with the given settings. newton refinement is the default, because it can start from the previous point's result
+    DistanceField(const SplineType &spline, Settings settings, int samplesPerT = 10,
+                  typename InverterType::RefinementMethod refinement = InverterType::RefinementMethod::Newton,
+                  typename InverterType::SamplingMethod sampling = InverterType::SamplingMethod::Uniform);
+
+    const Settings &getSettings(void) const { return settings; }
+    const InverterType &getInverter(void) const { return inverter; }
+
+    size_t samplesPerPixel(void) const { return settings.supersampling * settings.supersampling; }
+
+    //the spline-space position of the given sample of the given pixel
+    InterpolationType samplePosition(size_t x, size_t y, size_t sampleIndex) const;
+
+    //write the closest T of every sample to output, which must have room for width * height * samplesPerPixel() values
+    //the samples of each pixel are consecutive, and pixels are in row-major order
+    void computeClosestT(floating_t *output) const;
+
+    //write the distance from each pixel to the spline, averaged over the pixel's samples, to output, which must have room for width * height values, in row-major order
+    void computeDistances(float *output) const;
+
+    //write the color of each pixel, as 4 bytes of red, green, blue, and alpha, to output, which must have room for width * height * 4 bytes, in row-major order
+    //colorFunction(t) returns the color of a sample whose closest T is t, as something that can be indexed from 0 to 3, IE a std::array<float, 4>, with each channel from 0 to 1
+    //the colors of each pixel's samples are averaged before they're converted to bytes
+    template<class ColorFunction>
+    void computeColors(ColorFunction colorFunction, uint8_t *output) const;
+
+private: //methods
+    //call pixelFunction(pixelIndex, queryPoints, closestT) for every pixel, where queryPoints and closestT are arrays with one entry for each of the pixel's samples
+    //pixels are processed in parallel, so pixelFunction must only write to data that belongs to its own pixel
+    template<class PixelFunction>
+    void forEachPixel(PixelFunction pixelFunction) const;
+
+private: //data
+    const SplineType &spline;
+    Settings settings;
+    InverterType inverter;
+};
+
+template<class InterpolationType, typename floating_t, class SplineType>
+DistanceField<InterpolationType, floating_t, SplineType>::DistanceField(
+        const SplineType &spline, Settings settings, int samplesPerT,
+        typename InverterType::RefinementMethod refinement,
+        typename InverterType::SamplingMethod sampling)
+    :spline(spline), settings(settings), inverter(spline, samplesPerT, refinement, sampling)
+{
+    assert(settings.supersampling > 0);
+    assert(settings.tileSize > 0);
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+InterpolationType DistanceField<InterpolationType, floating_t, SplineType>::samplePosition(size_t x, size_t y, size_t sampleIndex) const
+{
+    size_t supersampling = settings.supersampling;
+    floating_t offsetX = (floating_t(sampleIndex % supersampling) + floating_t(0.5)) / floating_t(supersampling);
+    floating_t offsetY = (floating_t(sampleIndex / supersampling) + floating_t(0.5)) / floating_t(supersampling);
+
+    InterpolationType result;
+    result[0] = settings.originX + (floating_t(x) + offsetX) * settings.pixelSize;
+    result[1] = settings.originY + (floating_t(y) + offsetY) * settings.pixelSize;
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+template<class PixelFunction>
+void DistanceField<InterpolationType, floating_t, SplineType>::forEachPixel(PixelFunction pixelFunction) const
+{
+    const auto &sampleTree = inverter.getSampleTree();
+
+    size_t tileSize = settings.tileSize;
+    size_t tilesPerRow = (settings.width + tileSize - 1) / tileSize;
+    size_t tilesPerColumn = (settings.height + tileSize - 1) / tileSize;
+    size_t tileCount = tilesPerRow * tilesPerColumn;
+    size_t threadCount = settings.threadCount;
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    //each thread keeps its candidate list between tiles, so that it's only allocated a few times
+    std::vector<std::vector<size_t>> workerCandidates(std::max(size_t(1), std::min(threadCount, tileCount)));
+
+    SplineParallel::workStealingFor(tileCount, threadCount, [&](size_t tileIndex, size_t worker) {
+        size_t beginX = (tileIndex % tilesPerRow) * tileSize;
+        size_t beginY = (tileIndex / tilesPerRow) * tileSize;
+        size_t endX = std::min(beginX + tileSize, settings.width);
+        size_t endY = std::min(beginY + tileSize, settings.height);
+
+        //every sample point in the tile is within halfDiagonal of the tile's center. so if the center's closest sample is at distance d,
+        //no point in the tile is farther than d + halfDiagonal from its own closest sample, and that sample is at most d + 2 * halfDiagonal from the center
+        floating_t tileWidth = floating_t(endX - beginX) * settings.pixelSize;
+        floating_t tileHeight = floating_t(endY - beginY) * settings.pixelSize;
+        std::array<floating_t, 2> center = {{
+            settings.originX + floating_t(beginX) * settings.pixelSize + tileWidth / 2,
+            settings.originY + floating_t(beginY) * settings.pixelSize + tileHeight / 2
+        }};
+        floating_t halfDiagonal = std::sqrt(tileWidth * tileWidth + tileHeight * tileHeight) / 2;
+
+        size_t centerSample = sampleTree.findClosestSampleIndex(center);
+        const auto &centerSamplePosition = sampleTree.samplePosition(centerSample);
+        floating_t centerDistance = std::sqrt((centerSamplePosition[0] - center[0]) * (centerSamplePosition[0] - center[0])
+                + (centerSamplePosition[1] - center[1]) * (centerSamplePosition[1] - center[1]));
+
+        //pad the radius slightly, so that rounding can't leave out a sample that's exactly on the boundary
+        floating_t radius = (centerDistance + 2 * halfDiagonal) * floating_t(1.0001) + std::numeric_limits<floating_t>::epsilon();
+
+        std::vector<size_t> &candidates = workerCandidates[worker];
+        candidates.clear();
+        sampleTree.findSamplesWithin(center, radius, candidates);
+
+        //the kd-tree returns candidates in an arbitrary order. sorting them makes ties between equally close samples resolve the same way as everywhere else
+        std::sort(candidates.begin(), candidates.end());
+
+        std::vector<InterpolationType> queryPoints(samplesPerPixel());
+        std::vector<floating_t> closestTs(samplesPerPixel());
+
+        size_t previousSample = centerSample;
+        floating_t previousT = sampleTree.sampleT(centerSample);
+
+        //walk each row in alternating directions, so that consecutive pixels are always neighbors
+        for(size_t y = beginY; y < endY; y++)
+        {
+            bool reverse = (y - beginY) % 2 == 1;
+            for(size_t i = beginX; i < endX; i++)
+            {
+                size_t x = reverse ? endX - 1 - (i - beginX) : i;
+                size_t pixelIndex = y * settings.width + x;
+
+                for(size_t sampleIndex = 0; sampleIndex < samplesPerPixel(); sampleIndex++)
+                {
+                    const InterpolationType &queryPoint = queryPoints[sampleIndex] = samplePosition(x, y, sampleIndex);
+
+                    size_t closestSample = candidates.front();
+                    floating_t closestDistanceSquared = std::numeric_limits<floating_t>::max();
+                    for(size_t candidate : candidates)
+                    {
+                        const auto &position = sampleTree.samplePosition(candidate);
+                        floating_t dx = position[0] - floating_t(queryPoint[0]);
+                        floating_t dy = position[1] - floating_t(queryPoint[1]);
+                        floating_t distanceSquared = dx * dx + dy * dy;
+                        if(distanceSquared < closestDistanceSquared)
+                        {
+                            closestDistanceSquared = distanceSquared;
+                            closestSample = candidate;
+                        }
+                    }
+
+                    //the previous point's result is only a useful guess if it's near the same part of the spline
+                    floating_t startT = closestSample == previousSample ? previousT : sampleTree.sampleT(closestSample);
+                    floating_t closestT = inverter.refineClosestT(queryPoint, closestSample, startT);
+
+                    previousSample = closestSample;
+                    previousT = closestT;
+
+                    closestTs[sampleIndex] = closestT;
+                }
+
+                pixelFunction(pixelIndex, queryPoints.data(), closestTs.data());
+            }
+        }
+    });
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+void DistanceField<InterpolationType, floating_t, SplineType>::computeClosestT(floating_t *output) const
+{
+    size_t perPixel = samplesPerPixel();
+    forEachPixel([output, perPixel](size_t pixelIndex, const InterpolationType *, const floating_t *closestT) {
+        std::copy_n(closestT, perPixel, output + pixelIndex * perPixel);
+    });
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+void DistanceField<InterpolationType, floating_t, SplineType>::computeDistances(float *output) const
+{
+    size_t perPixel = samplesPerPixel();
+    forEachPixel([this, output, perPixel](size_t pixelIndex, const InterpolationType *queryPoints, const floating_t *closestT) {
+        floating_t sum = 0;
+        for(size_t i = 0; i < perPixel; i++)
+        {
+            InterpolationType displacement = spline.getPosition(closestT[i]) - queryPoints[i];
+
+            //the image only covers the first two dimensions, so ignore the others
+            sum += std::sqrt(floating_t(displacement[0]) * floating_t(displacement[0]) + floating_t(displacement[1]) * floating_t(displacement[1]));
+        }
+        output[pixelIndex] = float(sum / floating_t(perPixel));
+    });
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+template<class ColorFunction>
+void DistanceField<InterpolationType, floating_t, SplineType>::computeColors(ColorFunction colorFunction, uint8_t *output) const
+{
+    size_t perPixel = samplesPerPixel();
+    forEachPixel([&colorFunction, output, perPixel](size_t pixelIndex, const InterpolationType *, const floating_t *closestT) {
+        std::array<float, 4> sum = {{ 0, 0, 0, 0 }};
+        for(size_t i = 0; i < perPixel; i++)
+        {
+            auto color = colorFunction(closestT[i]);
+            for(size_t c = 0; c < 4; c++)
+            {
+                sum[c] += float(color[c]);
+            }
+        }
+
+        for(size_t c = 0; c < 4; c++)
+        {
+            float value = std::min(1.0f, std::max(0.0f, sum[c] / float(perPixel)));
+            output[pixelIndex * 4 + c] = uint8_t(value * 255.0f + 0.5f);
+        }
+    });
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cassert>
+
+#include "../spline.h"
+#include "splinesample_adaptor.h"
+#include "splineinverter.h"
+
+//a version of SplineInverter for splines that are edited after the inverter is created, IE by a track editor
+//instead of one kd-tree for the whole spline, the segments are split into blocks, and each block gets its own small kd-tree and bounding box
+//after an edit, only the blocks that contain the edited segments are resampled, so the cost of an edit doesn't grow with the size of the spline
+//
+//the blocks' bounding boxes are the leaves of a bounding volume hierarchy, which persists between updates: resampling a block only updates the boxes above it
+//queries walk the hierarchy nearest child first, and skip any box that's farther away than the closest sample so far
+//the closest sample is then refined with brent's method, the same way SplineInverter's default refinement does
+template<class InterpolationType, typename floating_t=float, size_t sampleDimension=2, class SplineType=Spline<InterpolationType, floating_t>>
+class DynamicSplineInverter
+{
+public:
+    //each segment gets max(1, round(samplesPerT * segment length in T)) evenly spaced samples, so resampling one segment never moves the samples of another
+    DynamicSplineInverter(const SplineType &spline, int samplesPerT = 10, size_t segmentsPerBlock = 64);
+
+    //the given segments have changed, and need to be resampled the next time update() is called
+    //every segment whose shape depends on an edited point must be included, IE segments index - 3 through index for UniformCRSpline::replacePoint(index)
+    void invalidateSegments(size_t firstSegment, size_t lastSegment);
+
+    //every segment has changed, IE because an edit to a spline with nonzero alpha rescaled every knot
+    void invalidateAll(void);
+
+    //resample every invalidated block, and add blocks for any segments that were appended to the spline since the last update
+    //queries are only valid once every edit has been followed by a call to update
+    void update(void);
+
+    //for looping splines, the result is wrapped to [0, maxT), the same way the spline wraps T values
+    floating_t findClosestT(const InterpolationType &queryPoint) const;
+
+    size_t blockCount(void) const { return blocks.size(); }
+    size_t sampleCount(void) const;
+
+    //memory used by the samples and the trees that index them, in bytes
+    size_t usedMemory(void) const;
+
+private: //types
+    typedef SplineSampleTree<sampleDimension, floating_t> TreeType;
+
+    struct Bounds
+    {
+        std::array<floating_t, sampleDimension> min;
+        std::array<floating_t, sampleDimension> max;
+    };
+
+    struct Block
+    {
+        //the block covers segments [firstSegment, endSegment)
+        size_t firstSegment;
+        size_t endSegment;
+
+        //the tree stores a copy of the samples, and its kd-tree points into that copy, so it can't be moved once it's built
+        std::unique_ptr<TreeType> tree;
+
+        //bounding box of the block's samples
+        Bounds bounds;
+
+        bool dirty;
+    };
+
+    //the hierarchy is a complete binary tree stored in an array: node 1 is the root, node i's children are 2i and 2i + 1,
+    //and the leaves start at hierarchyLeafCount, with one leaf per block. leaves past the last block have empty bounds
+    //blocks are never removed, so the leaf count only changes when appended blocks fill it up, and then it doubles
+    static constexpr size_t maxHierarchyDepth = 64;
+
+private: //methods
+    void resampleBlock(Block &block) const;
+
+    //rebuild the whole hierarchy, with room for every block
+    void rebuildHierarchy(void);
+
+    //copy the given block's bounds into its leaf, and update every node above it
+    void updateHierarchy(size_t blockIndex);
+
+    //bounds that contain nothing, so that merging them with other bounds does nothing, and every point is infinitely far from them
+    static Bounds emptyBounds(void);
+    static Bounds mergeBounds(const Bounds &left, const Bounds &right);
+
+    //the squared distance from the query point to the bounding box, which is a lower bound on the squared distance to anything inside it
+    static floating_t boundsDistanceSquared(const Bounds &bounds, const std::array<floating_t, sampleDimension> &queryPoint);
+
+    //the T values of the samples before and after the given sample, which may be in the neighboring blocks
+    //for looping splines, the T values are unwrapped, so the previous T of the first sample is negative. for other splines, the ends are clamped to the sample itself
+    floating_t previousSampleT(size_t blockIndex, size_t sampleIndex) const;
+    floating_t nextSampleT(size_t blockIndex, size_t sampleIndex) const;
+
+    static std::array<floating_t, sampleDimension> convertPoint(const InterpolationType &p) { return __SplineInverterPrivate::convertPoint<floating_t, sampleDimension>(p); }
+
+private: //data
+    const SplineType &spline;
+
+    int samplesPerT;
+    size_t segmentsPerBlock;
+
+    std::vector<Block> blocks;
+
+    std::vector<Bounds> hierarchy;
+    size_t hierarchyLeafCount;
+};
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+constexpr size_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::maxHierarchyDepth;
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::DynamicSplineInverter(
+        const SplineType &spline,
+        int samplesPerT,
+        size_t segmentsPerBlock)
+    :spline(spline), samplesPerT(samplesPerT), segmentsPerBlock(std::max(segmentsPerBlock, size_t(1))), hierarchyLeafCount(0)
+{
+    update();
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::invalidateSegments(size_t firstSegment, size_t lastSegment)
+{
+    //segments past the end of the last block were appended, and will get new blocks in update() regardless
+    for(size_t i = firstSegment / segmentsPerBlock; i <= lastSegment / segmentsPerBlock && i < blocks.size(); i++)
+    {
+        blocks[i].dirty = true;
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::invalidateAll(void)
+{
+    for(Block &block : blocks)
+    {
+        block.dirty = true;
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::update(void)
+{
+    size_t segmentCount = spline.segmentCount();
+    assert(blocks.empty() || blocks.back().endSegment <= segmentCount);
+
+    //the last block of a non-looping spline owns the sample at maxT, and appended segments may also fill up the rest of the last block,
+    //so if the spline has grown, the last block has to be resampled along with the new ones
+    if(!blocks.empty() && blocks.back().endSegment < segmentCount)
+    {
+        Block &last = blocks.back();
+        last.endSegment = std::min(segmentCount, last.firstSegment + segmentsPerBlock);
+        last.dirty = true;
+    }
+    while(blocks.empty() || blocks.back().endSegment < segmentCount)
+    {
+        Block block = Block();
+        block.firstSegment = blocks.empty() ? 0 : blocks.back().endSegment;
+        block.endSegment = std::min(segmentCount, block.firstSegment + segmentsPerBlock);
+        block.dirty = true;
+        blocks.push_back(std::move(block));
+    }
+
+    bool grown = blocks.size() > hierarchyLeafCount;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        if(blocks[i].dirty)
+        {
+            resampleBlock(blocks[i]);
+            if(!grown)
+                updateHierarchy(i);
+        }
+    }
+
+    if(grown)
+        rebuildHierarchy();
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::rebuildHierarchy(void)
+{
+    hierarchyLeafCount = 1;
+    while(hierarchyLeafCount < blocks.size())
+        hierarchyLeafCount *= 2;
+
+    hierarchy.assign(hierarchyLeafCount * 2, emptyBounds());
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        hierarchy[hierarchyLeafCount + i] = blocks[i].bounds;
+    }
+    for(size_t node = hierarchyLeafCount - 1; node > 0; node--)
+    {
+        hierarchy[node] = mergeBounds(hierarchy[node * 2], hierarchy[node * 2 + 1]);
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::updateHierarchy(size_t blockIndex)
+{
+    size_t node = hierarchyLeafCount + blockIndex;
+    hierarchy[node] = blocks[blockIndex].bounds;
+    for(node /= 2; node > 0; node /= 2)
+    {
+        hierarchy[node] = mergeBounds(hierarchy[node * 2], hierarchy[node * 2 + 1]);
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::resampleBlock(Block &block) const
+{
+    SplineSamples<sampleDimension, floating_t> samples;
+    for(size_t segment = block.firstSegment; segment < block.endSegment; segment++)
+    {
+        floating_t beginT = spline.segmentT(segment);
+        floating_t endT = spline.segmentT(segment + 1);
+        size_t count = std::max(size_t(1), size_t(std::round((endT - beginT) * samplesPerT)));
+
+        for(size_t i = 0; i < count; i++)
+        {
+            floating_t t = beginT + (endT - beginT) * i / count;
+            samples.pts.emplace_back(convertPoint(spline.segmentPosition(segment, t)), t, segment);
+        }
+    }
+
+    //if the spline isn't a loop, the last block gets a sample for maxT
+    if(!spline.isLooping() && block.endSegment == spline.segmentCount())
+    {
+        size_t lastSegment = block.endSegment - 1;
+        floating_t maxT = spline.getMaxT();
+        samples.pts.emplace_back(convertPoint(spline.segmentPosition(lastSegment, maxT)), maxT, lastSegment);
+    }
+
+    block.bounds.min = block.bounds.max = samples.pts.front().coords;
+    for(const auto &point : samples.pts)
+    {
+        for(size_t d = 0; d < sampleDimension; d++)
+        {
+            block.bounds.min[d] = std::min(block.bounds.min[d], point.coords[d]);
+            block.bounds.max[d] = std::max(block.bounds.max[d], point.coords[d]);
+        }
+    }
+
+    samples.pts.shrink_to_fit();
+    block.tree.reset(new TreeType(samples));
+    block.dirty = false;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::findClosestT(const InterpolationType &queryPoint) const
+{
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    auto convertedQueryPoint = convertPoint(queryPoint);
+
+    //walk the hierarchy depth first, visiting the closer child of each node first, so that the closest sample is usually found in the first block,
+    //and most of the others can be skipped. each node pushes at most one more entry than it pops, so the stack never holds more than the depth of the tree plus one
+    std::array<std::pair<floating_t, size_t>, maxHierarchyDepth + 1> stack;
+    size_t stackSize = 0;
+    stack[stackSize++] = std::make_pair(boundsDistanceSquared(hierarchy[1], convertedQueryPoint), size_t(1));
+
+    floating_t closestDistance = std::numeric_limits<floating_t>::max();
+    size_t closestBlock = 0;
+    size_t closestSample = 0;
+    while(stackSize > 0)
+    {
+        auto entry = stack[--stackSize];
+        if(entry.first >= closestDistance)
+            continue;
+
+        size_t node = entry.second;
+        if(node < hierarchyLeafCount)
+        {
+            floating_t leftDistance = boundsDistanceSquared(hierarchy[node * 2], convertedQueryPoint);
+            floating_t rightDistance = boundsDistanceSquared(hierarchy[node * 2 + 1], convertedQueryPoint);
+
+            //the stack is last in first out, so push the farther child first
+            if(leftDistance <= rightDistance)
+            {
+                stack[stackSize++] = std::make_pair(rightDistance, node * 2 + 1);
+                stack[stackSize++] = std::make_pair(leftDistance, node * 2);
+            }
+            else
+            {
+                stack[stackSize++] = std::make_pair(leftDistance, node * 2);
+                stack[stackSize++] = std::make_pair(rightDistance, node * 2 + 1);
+            }
+            continue;
+        }
+
+        size_t blockIndex = node - hierarchyLeafCount;
+        assert(!blocks[blockIndex].dirty);
+
+        const TreeType &tree = *blocks[blockIndex].tree;
+        size_t sample = tree.findClosestSampleIndex(convertedQueryPoint);
+
+        const auto &position = tree.samplePosition(sample);
+        floating_t distance = 0;
+        for(size_t d = 0; d < sampleDimension; d++)
+        {
+            floating_t diff = position[d] - convertedQueryPoint[d];
+            distance += diff * diff;
+        }
+
+        if(distance < closestDistance)
+        {
+            closestDistance = distance;
+            closestBlock = blockIndex;
+            closestSample = sample;
+        }
+    }
+
+    //the closest point is somewhere between the closest sample's neighbors
+    floating_t a = previousSampleT(closestBlock, closestSample);
+    floating_t b = nextSampleT(closestBlock, closestSample);
+
+    //start each evaluation's segment search from the closest sample's segment, the same way SplineInverter does
+    size_t segment = blocks[closestBlock].tree->sampleSegment(closestSample);
+    auto distanceFunction = [this, queryPoint, &segment](floating_t t) {
+        floating_t localT = __SplineInverterPrivate::seekSegment(spline, t, segment);
+        return (spline.segmentPosition(segment, localT) - queryPoint).lengthSquared();
+    };
+    floating_t result = __SplineInverterPrivate::refineBrent(distanceFunction, a, b);
+
+    //the neighbors of the first and last samples of a looping spline are unwrapped, so the result can be slightly before 0 or past maxT
+    if(spline.isLooping())
+    {
+        floating_t maxT = spline.getMaxT();
+        result = std::fmod(result, maxT);
+        if(result < 0)
+            result += maxT;
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+typename DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::Bounds
+DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::emptyBounds(void)
+{
+    Bounds result;
+    result.min.fill(std::numeric_limits<floating_t>::infinity());
+    result.max.fill(-std::numeric_limits<floating_t>::infinity());
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+typename DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::Bounds
+DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::mergeBounds(const Bounds &left, const Bounds &right)
+{
+    Bounds result;
+    for(size_t d = 0; d < sampleDimension; d++)
+    {
+        result.min[d] = std::min(left.min[d], right.min[d]);
+        result.max[d] = std::max(left.max[d], right.max[d]);
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::boundsDistanceSquared(
+        const Bounds &bounds, const std::array<floating_t, sampleDimension> &queryPoint)
+{
+    floating_t result = 0;
+    for(size_t d = 0; d < sampleDimension; d++)
+    {
+        floating_t diff = std::max(floating_t(0), std::max(bounds.min[d] - queryPoint[d], queryPoint[d] - bounds.max[d]));
+        result += diff * diff;
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::previousSampleT(size_t blockIndex, size_t sampleIndex) const
+{
+    const TreeType &tree = *blocks[blockIndex].tree;
+    if(sampleIndex > 0)
+        return tree.sampleT(sampleIndex - 1);
+    else if(blockIndex > 0)
+    {
+        const TreeType &previous = *blocks[blockIndex - 1].tree;
+        return previous.sampleT(previous.sampleCount() - 1);
+    }
+    else if(spline.isLooping())
+    {
+        const TreeType &previous = *blocks.back().tree;
+        return previous.sampleT(previous.sampleCount() - 1) - spline.getMaxT();
+    }
+    else
+        return tree.sampleT(sampleIndex);
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::nextSampleT(size_t blockIndex, size_t sampleIndex) const
+{
+    const TreeType &tree = *blocks[blockIndex].tree;
+    if(sampleIndex + 1 < tree.sampleCount())
+        return tree.sampleT(sampleIndex + 1);
+    else if(blockIndex + 1 < blocks.size())
+        return blocks[blockIndex + 1].tree->sampleT(0);
+    else if(spline.isLooping())
+        return spline.getMaxT(); //the next sample is the first one, which is at maxT after wrapping
+    else
+        return tree.sampleT(sampleIndex);
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+size_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::sampleCount(void) const
+{
+    size_t result = 0;
+    for(const Block &block : blocks)
+    {
+        result += block.tree->sampleCount();
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+size_t DynamicSplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::usedMemory(void) const
+{
+    size_t result = blocks.capacity() * sizeof(Block) + hierarchy.capacity() * sizeof(Bounds);
+    for(const Block &block : blocks)
+    {
+        result += sizeof(TreeType) + block.tree->usedMemory();
+    }
+    return result;
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION_TIMERS
+#ifndef SPLINE_LIBRARY_INSTRUMENTATION
+#define SPLINE_LIBRARY_INSTRUMENTATION
+#endif
+#include <chrono>
+#endif
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION
+#include <mutex>
+#endif
+
+//opt-in counters for the library's hot paths, for finding out where the time goes in calls like ArcLength::solveLength or SplineInverter::findClosestT
+//define SPLINE_LIBRARY_INSTRUMENTATION before including any spline header to enable the counters,
+//and SPLINE_LIBRARY_INSTRUMENTATION_TIMERS to also enable the scoped timers. timers read the clock twice per timed call, so they're separate from the counters
+//without those macros, every SPLINE_INSTRUMENT_* macro expands to nothing, and snapshot() always returns zeros
+//the macros change the code of every spline template, so they have to be defined the same way in every file of a program
+//
+//counters are thread-local, so counting never needs any synchronization.
+//when a thread exits, its counts are added to a shared total, so work done by the library's worker threads (IE partitionParallel) shows up in snapshot() once they've been joined
+namespace SplineInstrumentation
+{
+    enum class Counter : size_t
+    {
+        //calls to getPosition/getTangent/etc and segmentPosition/segmentTangent/etc through a spline, and each T of a batch evaluation
+        //code that calls a spline core directly through core() isn't counted
+        PositionEvaluations,
+        TangentEvaluations,
+        CurvatureEvaluations,
+        WiggleEvaluations,
+
+        //searches of a knot list for the segment containing a T value, and the galloping steps taken by those searches
+        //uniform splines compute their segment index directly, so they never do any lookups
+        SegmentLookups,
+        SegmentLookupSteps,
+
+        //applications of a quadrature rule, and the integrand evaluations of those rules. adaptive quadrature applies its rule once per subinterval
+        QuadratureCalls,
+        IntegrandEvaluations,
+
+        //iterations of the arc length solver, and of the inverter's refinement methods
+        HalleyIterations,
+        NewtonIterations,
+        BrentIterations,
+
+        //nearest sample searches of the inverter's kd-tree
+        KdTreeSearches,
+
+        Count
+    };
+
+    enum class Timer : size_t
+    {
+        ArcLength,
+        SolveLength,
+        FindClosestT,
+        KdTreeSearch,
+
+        Count
+    };
+
+    constexpr size_t counterCount = size_t(Counter::Count);
+    constexpr size_t timerCount = size_t(Timer::Count);
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION_TIMERS
+    constexpr bool timersEnabled = true;
+#else
+    constexpr bool timersEnabled = false;
+#endif
+
+    inline const char *counterName(Counter counter)
+    {
+        static const char *names[counterCount] = {
+            "PositionEvaluations",
+            "TangentEvaluations",
+            "CurvatureEvaluations",
+            "WiggleEvaluations",
+            "SegmentLookups",
+            "SegmentLookupSteps",
+            "QuadratureCalls",
+            "IntegrandEvaluations",
+            "HalleyIterations",
+            "NewtonIterations",
+            "BrentIterations",
+            "KdTreeSearches"
+        };
+        return names[size_t(counter)];
+    }
+
+    inline const char *timerName(Timer timer)
+    {
+        static const char *names[timerCount] = {
+            "ArcLength",
+            "SolveLength",
+            "FindClosestT",
+            "KdTreeSearch"
+        };
+        return names[size_t(timer)];
+    }
+
+    struct Snapshot
+    {
+        std::array<uint64_t, counterCount> counters = {};
+
+        //total time spent inside each timer's scope, and the number of times the scope was entered
+        //nested scopes of the same timer (IE an arc length computed inside solveLength) are each timed separately
+        std::array<uint64_t, timerCount> timerNanoseconds = {};
+        std::array<uint64_t, timerCount> timerCalls = {};
+
+        uint64_t operator[](Counter counter) const { return counters[size_t(counter)]; }
+        uint64_t nanoseconds(Timer timer) const { return timerNanoseconds[size_t(timer)]; }
+        uint64_t calls(Timer timer) const { return timerCalls[size_t(timer)]; }
+
+        Snapshot &operator+=(const Snapshot &other)
+        {
+            for(size_t i = 0; i < counterCount; i++)
+            {
+                counters[i] += other.counters[i];
+            }
+            for(size_t i = 0; i < timerCount; i++)
+            {
+                timerNanoseconds[i] += other.timerNanoseconds[i];
+                timerCalls[i] += other.timerCalls[i];
+            }
+            return *this;
+        }
+
+        //the change in every count since an earlier snapshot
+        Snapshot operator-(const Snapshot &earlier) const
+        {
+            Snapshot result;
+            for(size_t i = 0; i < counterCount; i++)
+            {
+                result.counters[i] = counters[i] - earlier.counters[i];
+            }
+            for(size_t i = 0; i < timerCount; i++)
+            {
+                result.timerNanoseconds[i] = timerNanoseconds[i] - earlier.timerNanoseconds[i];
+                result.timerCalls[i] = timerCalls[i] - earlier.timerCalls[i];
+            }
+            return result;
+        }
+    };
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION
+    namespace __InstrumentationPrivate
+    {
+        //the counts of every thread that has exited since the last reset
+        struct RetiredTotals
+        {
+            std::mutex mutex;
+            Snapshot totals;
+        };
+
+        inline RetiredTotals &retiredTotals(void)
+        {
+            static RetiredTotals totals;
+            return totals;
+        }
+
+        struct ThreadCounters
+        {
+            Snapshot counts;
+
+            ThreadCounters(void)
+            {
+                //make sure the totals are constructed first, so that they're still alive when the main thread's counters are destroyed
+                retiredTotals();
+            }
+
+            ~ThreadCounters(void)
+            {
+                RetiredTotals &totals = retiredTotals();
+                std::lock_guard<std::mutex> lock(totals.mutex);
+                totals.totals += counts;
+            }
+        };
+
+        inline Snapshot &threadCounts(void)
+        {
+            thread_local ThreadCounters counters;
+            return counters.counts;
+        }
+    }
+
+    inline void increment(Counter counter, uint64_t amount = 1)
+    {
+        __InstrumentationPrivate::threadCounts().counters[size_t(counter)] += amount;
+    }
+
+    //the counts of the calling thread only
+    inline Snapshot threadSnapshot(void)
+    {
+        return __InstrumentationPrivate::threadCounts();
+    }
+
+    //the counts of the calling thread, plus the counts of every thread that has exited since the last reset
+    //other threads that are still running aren't included, because their counters can't be read without synchronizing every increment
+    inline Snapshot snapshot(void)
+    {
+        Snapshot result = __InstrumentationPrivate::threadCounts();
+
+        auto &retired = __InstrumentationPrivate::retiredTotals();
+        std::lock_guard<std::mutex> lock(retired.mutex);
+        result += retired.totals;
+        return result;
+    }
+
+    //zero the calling thread's counts, and the totals of exited threads
+    inline void reset(void)
+    {
+        __InstrumentationPrivate::threadCounts() = Snapshot();
+
+        auto &retired = __InstrumentationPrivate::retiredTotals();
+        std::lock_guard<std::mutex> lock(retired.mutex);
+        retired.totals = Snapshot();
+    }
+#else
+    inline void increment(Counter, uint64_t = 1) {}
+    inline Snapshot threadSnapshot(void) { return Snapshot(); }
+    inline Snapshot snapshot(void) { return Snapshot(); }
+    inline void reset(void) {}
+#endif
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION_TIMERS
+    //adds the time between its construction and destruction to the given timer
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(Timer timer)
+            :timer(timer), begin(std::chrono::steady_clock::now())
+        {}
+
+        ~ScopedTimer(void)
+        {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+            Snapshot &counts = __InstrumentationPrivate::threadCounts();
+            counts.timerNanoseconds[size_t(timer)] += uint64_t(elapsed.count());
+            counts.timerCalls[size_t(timer)]++;
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        Timer timer;
+        std::chrono::steady_clock::time_point begin;
+    };
+#endif
+}
+
+#define SPLINE_INSTRUMENT_CONCAT_INNER(a, b) a##b
+#define SPLINE_INSTRUMENT_CONCAT(a, b) SPLINE_INSTRUMENT_CONCAT_INNER(a, b)
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION
+#define SPLINE_INSTRUMENT_COUNT(counter) ::SplineInstrumentation::increment(::SplineInstrumentation::Counter::counter)
+#define SPLINE_INSTRUMENT_COUNT_N(counter, amount) ::SplineInstrumentation::increment(::SplineInstrumentation::Counter::counter, uint64_t(amount))
+#else
+#define SPLINE_INSTRUMENT_COUNT(counter)
+#define SPLINE_INSTRUMENT_COUNT_N(counter, amount)
+#endif
+
+#ifdef SPLINE_LIBRARY_INSTRUMENTATION_TIMERS
+#define SPLINE_INSTRUMENT_TIMER(timer) ::SplineInstrumentation::ScopedTimer SPLINE_INSTRUMENT_CONCAT(splineInstrumentTimer, __LINE__)(::SplineInstrumentation::Timer::timer)
+#else
+#define SPLINE_INSTRUMENT_TIMER(timer)
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+#include "../spline.h"
+
+//wraps a spline core whose per-point data (IE the tangents of a catmull-rom spline) is computed one block of points at a time,
+//the first time a segment that uses the block is evaluated, instead of for every point when the spline is built
+//segment i uses points i and i + 1, so evaluating a segment computes the block containing each of them
+//
+//each block is computed exactly once, even when several threads evaluate the spline at the same time: the first thread to reach it computes it,
+//and the others wait for it to finish
+template<template<class, typename> class SplineCore, class InterpolationType, typename floating_t>
+class LazySplineCore
+{
+public:
+    typedef SplineCore<InterpolationType, floating_t> CoreType;
+
+    //computes the data of points [beginPoint, endPoint) of the core, using core.pointData()
+    typedef std::function<void(CoreType &core, size_t beginPoint, size_t endPoint)> BlockFunction;
+
+    LazySplineCore(void) = default;
+    LazySplineCore(CoreType core, size_t pointCount, size_t blockSize, BlockFunction computeBlock)
+        :core(std::move(core)), computeBlock(std::move(computeBlock)), pointCount(pointCount), blockSize(std::max(blockSize, size_t(1))),
+          blocks(new BlockState[(pointCount + this->blockSize - 1) / this->blockSize])
+    {}
+
+    inline size_t segmentCount(void) const { return core.segmentCount(); }
+    inline size_t degree(void) const { return core.degree(); }
+    inline size_t segmentForT(floating_t t) const { return core.segmentForT(t); }
+    inline floating_t segmentT(size_t segmentIndex) const { return core.segmentT(segmentIndex); }
+
+    inline void buildKnotIndex(void) { core.buildKnotIndex(); }
+    inline void clearKnotIndex(void) { core.clearKnotIndex(); }
+    inline bool hasKnotIndex(void) const { return core.hasKnotIndex(); }
+
+    //the speed polynomials are computed from every segment, so this computes every block first
+    inline void cacheSpeedPolynomials(void) { prepareAll(); core.cacheSpeedPolynomials(); }
+    inline void clearSpeedPolynomials(void) { core.clearSpeedPolynomials(); }
+    inline bool hasSpeedPolynomials(void) const { return core.hasSpeedPolynomials(); }
+
+    inline InterpolationType getPosition(floating_t globalT) const
+    {
+        return segmentPosition(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t globalT) const
+    {
+        return segmentTangent(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t globalT) const
+    {
+        return segmentCurvature(segmentForT(globalT), globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t globalT) const
+    {
+        return segmentWiggle(segmentForT(globalT), globalT);
+    }
+
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives evaluate(floating_t globalT) const
+    {
+        return segmentEvaluate<derivatives>(segmentForT(globalT), globalT);
+    }
+
+    inline InterpolationType segmentPosition(size_t segmentIndex, floating_t globalT) const
+    {
+        prepareSegment(segmentIndex);
+        return core.segmentPosition(segmentIndex, globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPT segmentTangent(size_t segmentIndex, floating_t globalT) const
+    {
+        prepareSegment(segmentIndex);
+        return core.segmentTangent(segmentIndex, globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTC segmentCurvature(size_t segmentIndex, floating_t globalT) const
+    {
+        prepareSegment(segmentIndex);
+        return core.segmentCurvature(segmentIndex, globalT);
+    }
+
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedPTCW segmentWiggle(size_t segmentIndex, floating_t globalT) const
+    {
+        prepareSegment(segmentIndex);
+        return core.segmentWiggle(segmentIndex, globalT);
+    }
+
+    template<unsigned derivatives>
+    inline typename Spline<InterpolationType,floating_t>::InterpolatedDerivatives segmentEvaluate(size_t segmentIndex, floating_t globalT) const
+    {
+        prepareSegment(segmentIndex);
+        return core.template segmentEvaluate<derivatives>(segmentIndex, globalT);
+    }
+
+    template<class Quadrature = SplineLibraryCalculus::DefaultQuadrature>
+    inline floating_t segmentLength(size_t segmentIndex, floating_t a, floating_t b, const Quadrature &quadrature = Quadrature()) const
+    {
+        prepareSegment(segmentIndex);
+        return core.segmentLength(segmentIndex, a, b, quadrature);
+    }
+
+    //compute every block that hasn't been computed yet, IE before handing the spline to a latency-sensitive thread
+    void prepareAll(void) const
+    {
+        for(size_t block = 0; block * blockSize < pointCount; block++)
+            prepareBlock(block);
+    }
+
+    //the number of blocks that have been computed so far. blocks may be computed by other threads while this counts them, so it's only for diagnostics
+    size_t preparedBlockCount(void) const
+    {
+        size_t result = 0;
+        for(size_t block = 0; block * blockSize < pointCount; block++)
+        {
+            if(blocks[block].prepared)
+                result++;
+        }
+        return result;
+    }
+
+private: //types
+    struct BlockState
+    {
+        std::once_flag flag;
+
+        //read by preparedBlockCount without taking the once_flag, so it has to be atomic
+        std::atomic<bool> prepared{false};
+    };
+
+private: //methods
+    inline void prepareSegment(size_t segmentIndex) const
+    {
+        size_t firstBlock = segmentIndex / blockSize;
+        size_t secondBlock = (segmentIndex + 1) / blockSize;
+        prepareBlock(firstBlock);
+        if(secondBlock != firstBlock)
+            prepareBlock(secondBlock);
+    }
+
+    inline void prepareBlock(size_t block) const
+    {
+        std::call_once(blocks[block].flag, [this, block]() {
+            size_t begin = block * blockSize;
+            computeBlock(core, begin, std::min(begin + blockSize, pointCount));
+            blocks[block].prepared = true;
+        });
+    }
+
+private: //data
+    //the core is filled in as blocks are computed, which happens inside const evaluation methods
+    mutable CoreType core;
+
+    BlockFunction computeBlock;
+    size_t pointCount = 0;
+    size_t blockSize = 1;
+
+    //once_flags can't be moved, so they're kept behind a pointer to keep the core movable
+    std::unique_ptr<BlockState[]> blocks;
+};
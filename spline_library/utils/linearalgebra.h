@@ -1,6 +1,10 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <thread>
+
+#include "workstealing.h"
 
 class LinearAlgebra
 {
@@ -35,6 +39,77 @@ public:
             std::vector<floating_t> mainDiagonal,
             std::vector<floating_t> secondaryDiagonal,
             std::vector<OutputType> inputVector);
+
+    //in-place versions of the above, for callers that want to avoid allocating, IE by reusing a SplineScratch
+    //each array holds 'size' elements, except for the secondary diagonals, which hold size - 1 (size for the cyclic system, where the last element is the corner value)
+    //the solution is written to inputVector, and mainDiagonal is overwritten with intermediate values
+    template<class OutputType, typename floating_t>
+    static void solveSymmetricTridiagonalInPlace(
+            floating_t *mainDiagonal,
+            const floating_t *secondaryDiagonal,
+            OutputType *inputVector,
+            size_t size);
+
+    template<class OutputType, typename floating_t>
+    static void solveTridiagonalInPlace(
+            floating_t *mainDiagonal,
+            const floating_t *upperDiagonal,
+            const floating_t *lowerDiagonal,
+            OutputType *inputVector,
+            size_t size);
+
+    //scratch must have room for 2 * size elements
+    template<class OutputType, typename floating_t>
+    static void solveCyclicSymmetricTridiagonalInPlace(
+            floating_t *mainDiagonal,
+            const floating_t *secondaryDiagonal,
+            OutputType *inputVector,
+            floating_t *scratch,
+            size_t size);
+
+    //batched solvers, for many systems that share the same matrix but have different inputs, IE natural splines that share the same knots
+    //the matrix is factored once, and every input is solved together. the inputs are interleaved, so that the inner loop runs over contiguous memory:
+    //element i of input r is at inputs[i * rhsCount + r]
+
+    //factor the given symmetric tridiagonal matrix with the thomas algorithm. mainDiagonal is overwritten with the factored main diagonal,
+    //and the size - 1 elimination multipliers are written to multipliers. the result can be passed to solveFactoredSymmetricTridiagonalInPlace
+    template<typename floating_t>
+    static void factorSymmetricTridiagonalInPlace(
+            floating_t *mainDiagonal,
+            const floating_t *secondaryDiagonal,
+            floating_t *multipliers,
+            size_t size);
+
+    template<class OutputType, typename floating_t>
+    static void solveFactoredSymmetricTridiagonalInPlace(
+            const floating_t *factoredDiagonal,
+            const floating_t *secondaryDiagonal,
+            const floating_t *multipliers,
+            OutputType *inputs,
+            size_t size,
+            size_t rhsCount);
+
+    //batched version of solveCyclicSymmetricTridiagonalInPlace. the sherman-morrison correction only depends on the matrix, so it's only computed once
+    //mainDiagonal is overwritten, and scratch must have room for 2 * size elements
+    template<class OutputType, typename floating_t>
+    static void solveCyclicSymmetricTridiagonalBatchInPlace(
+            floating_t *mainDiagonal,
+            const floating_t *secondaryDiagonal,
+            OutputType *inputs,
+            floating_t *scratch,
+            size_t size,
+            size_t rhsCount);
+
+    //solve the given symmetric tridiagonal system by splitting it into threadCount blocks, which are solved in parallel
+    //the blocks are separated by single rows, which are solved afterwards as a much smaller tridiagonal system, and then each block is finished in parallel
+    //this does about 3 times as much work as solveSymmetricTridiagonal, so it's only faster for very large systems, IE hundreds of thousands of rows
+    //if threadCount is 0, one thread per hardware thread is used
+    template<class OutputType, typename floating_t>
+    static std::vector<OutputType> solveSymmetricTridiagonalParallel(
+            std::vector<floating_t> mainDiagonal,
+            const std::vector<floating_t> &secondaryDiagonal,
+            std::vector<OutputType> inputVector,
+            size_t threadCount = 0);
 };
 
 template<class OutputType, typename floating_t>
@@ -44,12 +119,47 @@ std::vector<OutputType> LinearAlgebra::solveTridiagonal(
         const std::vector<floating_t> upperDiagonal,
         const std::vector<floating_t> lowerDiagonal,
         std::vector<OutputType> inputVector)
+{
+    solveTridiagonalInPlace(mainDiagonal.data(), upperDiagonal.data(), lowerDiagonal.data(), inputVector.data(), inputVector.size());
+    return inputVector;
+}
+
+template<class OutputType, typename floating_t>
+std::vector<OutputType> LinearAlgebra::solveSymmetricTridiagonal(
+
+        std::vector<floating_t> mainDiagonal,
+        const std::vector<floating_t> secondaryDiagonal,
+        std::vector<OutputType> inputVector)
+{
+    solveSymmetricTridiagonalInPlace(mainDiagonal.data(), secondaryDiagonal.data(), inputVector.data(), inputVector.size());
+    return inputVector;
+}
+
+template<class OutputType, typename floating_t>
+std::vector<OutputType> LinearAlgebra::solveCyclicSymmetricTridiagonal(
+
+        std::vector<floating_t> mainDiagonal,
+        std::vector<floating_t> secondaryDiagonal,
+        std::vector<OutputType> inputVector)
+{
+    std::vector<floating_t> scratch(inputVector.size() * 2);
+    solveCyclicSymmetricTridiagonalInPlace(mainDiagonal.data(), secondaryDiagonal.data(), inputVector.data(), scratch.data(), inputVector.size());
+    return inputVector;
+}
+
+template<class OutputType, typename floating_t>
+void LinearAlgebra::solveTridiagonalInPlace(
+        floating_t *mainDiagonal,
+        const floating_t *upperDiagonal,
+        const floating_t *lowerDiagonal,
+        OutputType *inputVector,
+        size_t size)
 {
     //use the thomas algorithm to solve the tridiagonal matrix
     // http://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm
 
     //forward sweep
-    for(size_t i = 1; i < inputVector.size(); i++)
+    for(size_t i = 1; i < size; i++)
     {
         floating_t m = lowerDiagonal[i - 1] / mainDiagonal[i - 1];
         mainDiagonal[i] -= m * upperDiagonal[i - 1];
@@ -57,29 +167,27 @@ std::vector<OutputType> LinearAlgebra::solveTridiagonal(
     }
 
     //back substitution
-    size_t finalIndex = inputVector.size();
+    size_t finalIndex = size;
     inputVector[finalIndex - 1] /= mainDiagonal[finalIndex - 1];
 
     for(size_t i = finalIndex - 1; i > 0; i--)
     {
         inputVector[i - 1] = (inputVector[i - 1] - upperDiagonal[i - 1] * inputVector[i]) / mainDiagonal[i - 1];
     }
-
-    return inputVector;
 }
 
 template<class OutputType, typename floating_t>
-std::vector<OutputType> LinearAlgebra::solveSymmetricTridiagonal(
-
-        std::vector<floating_t> mainDiagonal,
-        const std::vector<floating_t> secondaryDiagonal,
-        std::vector<OutputType> inputVector)
+void LinearAlgebra::solveSymmetricTridiagonalInPlace(
+        floating_t *mainDiagonal,
+        const floating_t *secondaryDiagonal,
+        OutputType *inputVector,
+        size_t size)
 {
     //use the thomas algorithm to solve the tridiagonal matrix
     // http://en.wikipedia.org/wiki/Tridiagonal_matrix_algorithm
 
     //forward sweep
-    for(size_t i = 1; i < inputVector.size(); i++)
+    for(size_t i = 1; i < size; i++)
     {
         floating_t m = secondaryDiagonal[i - 1] / mainDiagonal[i - 1];
         mainDiagonal[i] -= m * secondaryDiagonal[i - 1];
@@ -87,77 +195,225 @@ std::vector<OutputType> LinearAlgebra::solveSymmetricTridiagonal(
     }
 
     //back substitution
-    size_t finalIndex = inputVector.size();
+    size_t finalIndex = size;
     inputVector[finalIndex - 1] /= mainDiagonal[finalIndex - 1];
 
     for(size_t i = finalIndex - 1; i > 0; i--)
     {
         inputVector[i - 1] = (inputVector[i - 1] - secondaryDiagonal[i - 1] * inputVector[i]) / mainDiagonal[i - 1];
     }
+}
 
-    return inputVector;
+template<class OutputType, typename floating_t>
+void LinearAlgebra::solveCyclicSymmetricTridiagonalInPlace(
+        floating_t *mainDiagonal,
+        const floating_t *secondaryDiagonal,
+        OutputType *inputVector,
+        floating_t *scratch,
+        size_t size)
+{
+    solveCyclicSymmetricTridiagonalBatchInPlace(mainDiagonal, secondaryDiagonal, inputVector, scratch, size, 1);
+}
+
+template<typename floating_t>
+void LinearAlgebra::factorSymmetricTridiagonalInPlace(
+        floating_t *mainDiagonal,
+        const floating_t *secondaryDiagonal,
+        floating_t *multipliers,
+        size_t size)
+{
+    //this is the forward sweep of the thomas algorithm, without the input vector
+    for(size_t i = 1; i < size; i++)
+    {
+        floating_t m = secondaryDiagonal[i - 1] / mainDiagonal[i - 1];
+        mainDiagonal[i] -= m * secondaryDiagonal[i - 1];
+        multipliers[i - 1] = m;
+    }
 }
 
 template<class OutputType, typename floating_t>
-std::vector<OutputType> LinearAlgebra::solveCyclicSymmetricTridiagonal(
+void LinearAlgebra::solveFactoredSymmetricTridiagonalInPlace(
+        const floating_t *factoredDiagonal,
+        const floating_t *secondaryDiagonal,
+        const floating_t *multipliers,
+        OutputType *inputs,
+        size_t size,
+        size_t rhsCount)
+{
+    //forward sweep, using the multipliers from the factorization
+    for(size_t i = 1; i < size; i++)
+    {
+        floating_t m = multipliers[i - 1];
+        OutputType *row = inputs + i * rhsCount;
+        const OutputType *previousRow = row - rhsCount;
+        for(size_t r = 0; r < rhsCount; r++)
+        {
+            row[r] -= m * previousRow[r];
+        }
+    }
 
-        std::vector<floating_t> mainDiagonal,
-        std::vector<floating_t> secondaryDiagonal,
-        std::vector<OutputType> inputVector)
+    //back substitution
+    OutputType *finalRow = inputs + (size - 1) * rhsCount;
+    for(size_t r = 0; r < rhsCount; r++)
+    {
+        finalRow[r] /= factoredDiagonal[size - 1];
+    }
+
+    for(size_t i = size - 1; i > 0; i--)
+    {
+        OutputType *row = inputs + (i - 1) * rhsCount;
+        const OutputType *nextRow = row + rhsCount;
+        for(size_t r = 0; r < rhsCount; r++)
+        {
+            row[r] = (row[r] - secondaryDiagonal[i - 1] * nextRow[r]) / factoredDiagonal[i - 1];
+        }
+    }
+}
+
+template<class OutputType, typename floating_t>
+void LinearAlgebra::solveCyclicSymmetricTridiagonalBatchInPlace(
+        floating_t *mainDiagonal,
+        const floating_t *secondaryDiagonal,
+        OutputType *inputs,
+        floating_t *scratch,
+        size_t size,
+        size_t rhsCount)
 {
     //apply the sherman-morrison algorithm to the cyclic tridiagonal matrix so that we can use the standard tridiagonal algorithm
     //we're getting this algorithm from http://www.cs.princeton.edu/courses/archive/fall11/cos323/notes/cos323_f11_lecture06_linsys2.pdf
     //basically, we're going to solve two different non-cyclic versions of this system and then combine the results
 
-    size_t size = inputVector.size();
-
-
     //the value at the upper right and lower left of the input matrix. it's at the end of the secondary diagonal array because almost all
     //cyclic tridiagonal papers treat it as an extension of the secondary diagonals
-    floating_t cornerValue = secondaryDiagonal.at(size - 1);
+    floating_t cornerValue = secondaryDiagonal[size - 1];
 
     //gamma value - doesn't affect actual output (the algorithm makes sure it cancels out), but a good choice for this value can reduce floating point errors
-    floating_t gamma = -mainDiagonal.at(0);
+    floating_t gamma = -mainDiagonal[0];
     floating_t cornerMultiplier = cornerValue/gamma;
 
     //corrective vector U: should be all 0, except for gamma in the first element, and cornerValue at the end
-    std::vector<floating_t> correctionInputU(size);
-    correctionInputU[0] = gamma;
-    correctionInputU[size - 1] = cornerValue;
+    floating_t *correctionOutput = scratch;
+    std::fill(correctionOutput, correctionOutput + size, floating_t(0));
+    correctionOutput[0] = gamma;
+    correctionOutput[size - 1] = cornerValue;
 
     //modify the main diagonal of the matrix to account for the correction vector
     mainDiagonal[0] -= gamma;
     mainDiagonal[size - 1] -= cornerValue * cornerMultiplier;
 
-    //solve the modified system for the input vector
-    std::vector<OutputType> initialOutput = solveSymmetricTridiagonal(
-                mainDiagonal,
-                secondaryDiagonal,
-                std::move(inputVector)
-                );
-
-    //solve the modified system for the correction vector
-    std::vector<floating_t> correctionOutput = solveSymmetricTridiagonal(
-                std::move(mainDiagonal),
-                std::move(secondaryDiagonal),
-                std::move(correctionInputU)
-                );
+    //both systems use the same modified matrix, so factor it once, then solve the correction vector and every input with it
+    floating_t *multipliers = scratch + size;
+    factorSymmetricTridiagonalInPlace(mainDiagonal, secondaryDiagonal, multipliers, size);
+    solveFactoredSymmetricTridiagonalInPlace(mainDiagonal, secondaryDiagonal, multipliers, correctionOutput, size, 1);
+    solveFactoredSymmetricTridiagonalInPlace(mainDiagonal, secondaryDiagonal, multipliers, inputs, size, rhsCount);
 
     //compute the corrective OutputType to apply to each initial output
     //this involves a couple dot products, but all of the elements on the correctionV vector are 0 except the first and last
     //so just compute those directly instead of looping through and multplying a bunch of 0s
-    OutputType factor = (initialOutput.at(0) + initialOutput.at(size - 1) * cornerMultiplier) / (1 + correctionOutput.at(0) + correctionOutput.at(size - 1) * cornerMultiplier);
+    floating_t denominator = 1 + correctionOutput[0] + correctionOutput[size - 1] * cornerMultiplier;
+    const OutputType *firstRow = inputs;
+    const OutputType *finalRow = inputs + (size - 1) * rhsCount;
+    for(size_t r = 0; r < rhsCount; r++)
+    {
+        OutputType factor = (firstRow[r] + finalRow[r] * cornerMultiplier) / denominator;
+
+        //use the correction factor to modify the result
+        for(size_t i = 0; i < size; i++)
+        {
+            inputs[i * rhsCount + r] -= factor * correctionOutput[i];
+        }
+    }
+}
+
+template<class OutputType, typename floating_t>
+std::vector<OutputType> LinearAlgebra::solveSymmetricTridiagonalParallel(
+        std::vector<floating_t> mainDiagonal,
+        const std::vector<floating_t> &secondaryDiagonal,
+        std::vector<OutputType> inputVector,
+        size_t threadCount)
+{
+    size_t size = inputVector.size();
 
-    /*std::vector<floating_t> correctionV(size);
-    correctionV[0] = 1;
-    correctionV[size - 1] = cornerMultiplier;
-    OutputType factor = vectorDotProduct(initialOutput, correctionV) / (1 + vectorDotProduct(correctionV, correctionOutput));*/
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
 
-    //use the correction factor to modify the result
-    for(size_t i = 0; i < size; i++)
+    //every block needs at least one row, so we need at least 2 rows per block to make room for the separators
+    size_t blockCount = std::min(threadCount, size / 2);
+    if(blockCount <= 1)
     {
-        initialOutput[i] -= factor * correctionOutput.at(i);
+        solveSymmetricTridiagonalInPlace(mainDiagonal.data(), secondaryDiagonal.data(), inputVector.data(), size);
+        return inputVector;
     }
 
-    return initialOutput;
+    //block k covers the rows in [blockBegin(k), blockEnd(k)), and the row at blockEnd(k) is the separator between block k and block k + 1
+    auto blockEnd = [size, blockCount](size_t k) { return k + 1 == blockCount ? size : size * (k + 1) / blockCount; };
+    auto blockBegin = [&blockEnd](size_t k) { return k == 0 ? 0 : blockEnd(k - 1) + 1; };
+
+    //within a block, x = y - (previous separator) * couplingBefore * v - (next separator) * couplingAfter * w
+    //where y solves the block's own system, and v and w solve it with an input of 1 in the block's first and last row respectively
+    std::vector<floating_t> v(size), w(size), multipliers(size);
+
+    //solve each block's system for y, v, and w
+    SplineParallel::workStealingFor(blockCount, blockCount, [&](size_t k, size_t) {
+        size_t begin = blockBegin(k);
+        size_t length = blockEnd(k) - begin;
+
+        floating_t *blockDiagonal = mainDiagonal.data() + begin;
+        const floating_t *blockSecondary = secondaryDiagonal.data() + begin;
+        floating_t *blockMultipliers = multipliers.data() + begin;
+
+        std::fill(v.begin() + begin, v.begin() + begin + length, floating_t(0));
+        std::fill(w.begin() + begin, w.begin() + begin + length, floating_t(0));
+        v[begin] = 1;
+        w[begin + length - 1] = 1;
+
+        factorSymmetricTridiagonalInPlace(blockDiagonal, blockSecondary, blockMultipliers, length);
+        solveFactoredSymmetricTridiagonalInPlace(blockDiagonal, blockSecondary, blockMultipliers, inputVector.data() + begin, length, 1);
+        solveFactoredSymmetricTridiagonalInPlace(blockDiagonal, blockSecondary, blockMultipliers, v.data() + begin, length, 1);
+        solveFactoredSymmetricTridiagonalInPlace(blockDiagonal, blockSecondary, blockMultipliers, w.data() + begin, length, 1);
+    });
+
+    //substitute each block's solution into the separator rows, which gives a tridiagonal system with one row per separator
+    size_t separatorCount = blockCount - 1;
+    std::vector<floating_t> reducedDiagonal(separatorCount), reducedUpper(separatorCount), reducedLower(separatorCount);
+    std::vector<OutputType> reducedInput(separatorCount);
+    for(size_t k = 0; k < separatorCount; k++)
+    {
+        size_t row = blockEnd(k);
+        size_t before = row - 1;
+        size_t after = row + 1;
+
+        //the coupling between each neighboring block and its other separator. blocks at the ends of the system don't have another separator
+        floating_t beforeCoupling = k > 0 ? secondaryDiagonal[blockBegin(k) - 1] : floating_t(0);
+        floating_t afterCoupling = k + 1 < separatorCount ? secondaryDiagonal[blockEnd(k + 1) - 1] : floating_t(0);
+
+        reducedDiagonal[k] = mainDiagonal[row]
+                - secondaryDiagonal[before] * secondaryDiagonal[before] * w[before]
+                - secondaryDiagonal[row] * secondaryDiagonal[row] * v[after];
+        if(k > 0)
+            reducedLower[k - 1] = -secondaryDiagonal[before] * beforeCoupling * v[before];
+        if(k + 1 < separatorCount)
+            reducedUpper[k] = -secondaryDiagonal[row] * afterCoupling * w[after];
+        reducedInput[k] = inputVector[row] - secondaryDiagonal[before] * inputVector[before] - secondaryDiagonal[row] * inputVector[after];
+    }
+    solveTridiagonalInPlace(reducedDiagonal.data(), reducedUpper.data(), reducedLower.data(), reducedInput.data(), separatorCount);
+    for(size_t k = 0; k < separatorCount; k++)
+    {
+        inputVector[blockEnd(k)] = reducedInput[k];
+    }
+
+    //now that the separators are known, finish each block
+    SplineParallel::workStealingFor(blockCount, blockCount, [&](size_t k, size_t) {
+        size_t begin = blockBegin(k);
+        size_t end = blockEnd(k);
+
+        OutputType separatorBefore = k > 0 ? inputVector[begin - 1] * secondaryDiagonal[begin - 1] : OutputType();
+        OutputType separatorAfter = k + 1 < blockCount ? inputVector[end] * secondaryDiagonal[end - 1] : OutputType();
+        for(size_t i = begin; i < end; i++)
+        {
+            inputVector[i] = inputVector[i] - separatorBefore * v[i] - separatorAfter * w[i];
+        }
+    });
+
+    return inputVector;
 }
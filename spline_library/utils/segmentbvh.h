@@ -0,0 +1,619 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <limits>
+#include <cassert>
+#include <stdexcept>
+
+#include "../spline.h"
+
+//tight axis-aligned bounding boxes for every segment of a spline, and a bounding volume hierarchy over them
+//every segment of every spline type is a polynomial, so each segment's polynomial is recovered from spline.degree() + 1 position evaluations,
+//and its box is spanned by the segment's endpoints and the points where the derivative of each coordinate is zero
+//
+//maxDegree is the highest spline degree the BVH accepts. it sizes the fixed buffers that the root finding works in, so that nothing is allocated per segment or per query
+//the default covers every spline type in the library, except generic B-splines with a degree higher than 5
+//
+//the hierarchy answers the queries that need guaranteed results instead of sampled ones: which segments are inside a box or a set of planes (IE a view frustum),
+//which segments a ray might hit, and the exact closest point on the spline, which only examines segments whose bounds are closer than the best point so far
+template<class InterpolationType, typename floating_t=float, size_t dimension=2, class SplineType=Spline<InterpolationType, floating_t>, size_t maxDegree=5>
+class SegmentBVH
+{
+public:
+    typedef std::array<floating_t, dimension> Point;
+
+    struct Box
+    {
+        Point minimum;
+        Point maximum;
+    };
+
+    //a half-space: a point p is inside the plane if dot(normal, p) + offset >= 0
+    struct Plane
+    {
+        Point normal;
+        floating_t offset;
+    };
+
+    //throws std::invalid_argument if the spline's degree is higher than maxDegree
+    SegmentBVH(const SplineType &spline);
+
+    size_t segmentCount(void) const { return segmentBoxes.size(); }
+    const Box &segmentBounds(size_t segmentIndex) const { return segmentBoxes[segmentIndex]; }
+    const Box &bounds(void) const { return nodes.front().box; }
+
+    //append the index of every segment whose bounding box overlaps the given box to output, in no particular order
+    void findSegmentsInBox(const Box &box, std::vector<size_t> &output) const;
+
+    //append the index of every segment whose bounding box is at least partly inside all of the given planes to output, in no particular order
+    //for frustum culling, pass the 6 planes of the frustum with their normals pointing inwards
+    void findSegmentsInsidePlanes(const std::vector<Plane> &planes, std::vector<size_t> &output) const;
+
+    //append the index of every segment whose bounding box is hit by the ray origin + s * direction, for s between 0 and maxDistance, to output, in no particular order
+    void findSegmentsAlongRay(const InterpolationType &origin, const InterpolationType &direction, floating_t maxDistance, std::vector<size_t> &output) const;
+
+    //find the T of the closest point on the spline to the query point
+    //unlike SplineInverter, this is the global closest point: every segment that could contain a closer point than the best so far is solved exactly
+    floating_t findClosestT(const InterpolationType &queryPoint) const;
+
+    //memory used by the boxes, the hierarchy, and the segment polynomials, in bytes
+    size_t usedMemory(void) const;
+
+private: //types
+    //the highest degree findRoots is ever given: the derivative of the squared distance to a segment of degree maxDegree
+    static constexpr size_t maxPolynomialDegree = 2 * maxDegree - 1;
+
+    //a list of at most 'capacity' roots, stored inline
+    template<size_t capacity>
+    struct RootList
+    {
+        std::array<double, capacity> values;
+        size_t count = 0;
+
+        void push_back(double value) { assert(count < capacity); values[count++] = value; }
+        double *begin(void) { return values.data(); }
+        double *end(void) { return values.data() + count; }
+    };
+
+    //every root of a polynomial in (0, 1), plus the ends of the range
+    typedef RootList<maxPolynomialDegree + 2> PolynomialRoots;
+
+    //the ends of the segment, plus every root of the derivative of each coordinate
+    typedef RootList<2 + dimension * (maxDegree - 1)> SegmentExtremes;
+
+    struct Node
+    {
+        Box box;
+
+        //the node covers segmentOrder[begin, end). if it isn't a leaf, its children are nodes[firstChild] and nodes[firstChild + 1]
+        size_t begin;
+        size_t end;
+        size_t firstChild;
+
+        bool isLeaf(void) const { return firstChild == 0; }
+    };
+
+private: //methods
+    //the coefficients of the given segment's polynomial for the given dimension, in increasing powers of u, where u goes from 0 to 1 across the segment
+    const double *segmentPolynomial(size_t segmentIndex, size_t d) const { return polynomials.data() + (segmentIndex * dimension + d) * (degree + 1); }
+
+    Box computeSegmentBox(size_t segmentIndex) const;
+    void buildNode(size_t nodeIndex, size_t begin, size_t end);
+
+    //the T of the closest point to the query point on the given segment, and write its squared distance to distanceSquared
+    floating_t closestTOnSegment(size_t segmentIndex, const InterpolationType &queryPoint, floating_t &distanceSquared) const;
+
+    //visit every leaf whose box passes the given test, and append its segments whose boxes also pass the test to output
+    void collectSegments(const std::function<bool(const Box&)> &test, std::vector<size_t> &output) const;
+
+    static floating_t distanceSquared(const Box &box, const InterpolationType &point);
+    static Box unite(const Box &a, const Box &b);
+
+    //append every root of the polynomial with the given coefficients (in increasing powers) in the open interval (0, 1) to roots
+    //the polynomial is monotonic between the roots of its derivative, so each root is isolated by the derivative's roots, then bisected
+    //polynomialDegree must be at most maxPolynomialDegree, and roots must have room for polynomialDegree more roots
+    template<size_t capacity>
+    static void findRoots(const double *coefficients, size_t polynomialDegree, RootList<capacity> &roots);
+    static double evaluate(const double *coefficients, size_t polynomialDegree, double u);
+
+private: //data
+    const SplineType &spline;
+
+    size_t degree;
+
+    //(degree + 1) coefficients for each dimension of each segment
+    std::vector<double> polynomials;
+
+    std::vector<Box> segmentBoxes;
+
+    //the segment indexes, reordered so that each node covers a contiguous range
+    std::vector<size_t> segmentOrder;
+    std::vector<Node> nodes;
+
+    static const size_t leafSize = 4;
+};
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+constexpr size_t SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::maxPolynomialDegree;
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::SegmentBVH(const SplineType &spline)
+    :spline(spline), degree(std::max(spline.degree(), size_t(1)))
+{
+    static_assert(maxDegree >= 1, "maxDegree must be at least 1");
+    if(degree > maxDegree)
+        throw std::invalid_argument("The spline's degree is higher than the SegmentBVH's maxDegree");
+
+    size_t count = spline.segmentCount();
+    size_t nodeCount = degree + 1;
+
+    //fit the polynomials at chebyshev nodes, which keeps the fit well conditioned. every segment uses the same nodes,
+    //so invert the vandermonde matrix once, and each segment's coefficients are a matrix multiply away from its positions
+    const double pi = std::acos(-1.0);
+    std::vector<double> u(nodeCount);
+    for(size_t i = 0; i < nodeCount; i++)
+    {
+        u[i] = 0.5 - 0.5 * std::cos((2 * i + 1) * pi / (2 * nodeCount));
+    }
+
+    //gauss-jordan elimination with partial pivoting on [V | I]
+    std::vector<double> vandermonde(nodeCount * nodeCount), inverse(nodeCount * nodeCount, 0);
+    for(size_t row = 0; row < nodeCount; row++)
+    {
+        double power = 1;
+        for(size_t column = 0; column < nodeCount; column++)
+        {
+            vandermonde[row * nodeCount + column] = power;
+            power *= u[row];
+        }
+        inverse[row * nodeCount + row] = 1;
+    }
+    for(size_t column = 0; column < nodeCount; column++)
+    {
+        size_t pivot = column;
+        for(size_t row = column + 1; row < nodeCount; row++)
+        {
+            if(std::abs(vandermonde[row * nodeCount + column]) > std::abs(vandermonde[pivot * nodeCount + column]))
+                pivot = row;
+        }
+        for(size_t k = 0; k < nodeCount; k++)
+        {
+            std::swap(vandermonde[column * nodeCount + k], vandermonde[pivot * nodeCount + k]);
+            std::swap(inverse[column * nodeCount + k], inverse[pivot * nodeCount + k]);
+        }
+
+        double scale = 1 / vandermonde[column * nodeCount + column];
+        for(size_t k = 0; k < nodeCount; k++)
+        {
+            vandermonde[column * nodeCount + k] *= scale;
+            inverse[column * nodeCount + k] *= scale;
+        }
+        for(size_t row = 0; row < nodeCount; row++)
+        {
+            double factor = vandermonde[row * nodeCount + column];
+            if(row == column || factor == 0)
+                continue;
+            for(size_t k = 0; k < nodeCount; k++)
+            {
+                vandermonde[row * nodeCount + k] -= factor * vandermonde[column * nodeCount + k];
+                inverse[row * nodeCount + k] -= factor * inverse[column * nodeCount + k];
+            }
+        }
+    }
+
+    polynomials.resize(count * dimension * nodeCount);
+    std::vector<double> positions(nodeCount * dimension);
+    for(size_t segment = 0; segment < count; segment++)
+    {
+        floating_t beginT = spline.segmentT(segment);
+        floating_t endT = spline.segmentT(segment + 1);
+        for(size_t i = 0; i < nodeCount; i++)
+        {
+            InterpolationType position = spline.segmentPosition(segment, floating_t(beginT + (endT - beginT) * u[i]));
+            for(size_t d = 0; d < dimension; d++)
+            {
+                positions[d * nodeCount + i] = position[d];
+            }
+        }
+
+        for(size_t d = 0; d < dimension; d++)
+        {
+            double *coefficients = polynomials.data() + (segment * dimension + d) * nodeCount;
+            for(size_t power = 0; power < nodeCount; power++)
+            {
+                double sum = 0;
+                for(size_t i = 0; i < nodeCount; i++)
+                {
+                    sum += inverse[power * nodeCount + i] * positions[d * nodeCount + i];
+                }
+                coefficients[power] = sum;
+            }
+        }
+    }
+
+    segmentBoxes.resize(count);
+    for(size_t segment = 0; segment < count; segment++)
+    {
+        segmentBoxes[segment] = computeSegmentBox(segment);
+    }
+
+    segmentOrder.resize(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        segmentOrder[i] = i;
+    }
+
+    //a binary tree with n leaves has 2n - 1 nodes
+    nodes.reserve(2 * (count / leafSize + 1));
+    nodes.push_back(Node());
+    buildNode(0, 0, count);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+typename SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::Box SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::computeSegmentBox(size_t segmentIndex) const
+{
+    floating_t beginT = spline.segmentT(segmentIndex);
+    floating_t endT = spline.segmentT(segmentIndex + 1);
+
+    //the polynomial is only used to find where each coordinate turns around. the box itself is made of positions from the spline,
+    //so that it contains the spline's own evaluations exactly, instead of the polynomial's approximation of them
+    SegmentExtremes extremes;
+    extremes.push_back(0);
+    extremes.push_back(1);
+    std::array<double, maxDegree> derivative;
+    for(size_t d = 0; d < dimension; d++)
+    {
+        const double *coefficients = segmentPolynomial(segmentIndex, d);
+        for(size_t power = 1; power <= degree; power++)
+        {
+            derivative[power - 1] = coefficients[power] * power;
+        }
+        findRoots(derivative.data(), degree - 1, extremes);
+    }
+
+    Box result;
+    for(size_t i = 0; i < extremes.count; i++)
+    {
+        InterpolationType position = spline.segmentPosition(segmentIndex, floating_t(beginT + (endT - beginT) * extremes.values[i]));
+        for(size_t d = 0; d < dimension; d++)
+        {
+            if(i == 0 || position[d] < result.minimum[d])
+                result.minimum[d] = position[d];
+            if(i == 0 || position[d] > result.maximum[d])
+                result.maximum[d] = position[d];
+        }
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::buildNode(size_t nodeIndex, size_t begin, size_t end)
+{
+    Box box = segmentBoxes[segmentOrder[begin]];
+    for(size_t i = begin + 1; i < end; i++)
+    {
+        box = unite(box, segmentBoxes[segmentOrder[i]]);
+    }
+
+    //building the children can reallocate the node list, so write to nodes[nodeIndex] instead of holding a reference to it
+    nodes[nodeIndex].box = box;
+    nodes[nodeIndex].begin = begin;
+    nodes[nodeIndex].end = end;
+    nodes[nodeIndex].firstChild = 0;
+
+    if(end - begin <= leafSize)
+        return;
+
+    //split at the median of the box centers along the longest axis
+    size_t axis = 0;
+    for(size_t d = 1; d < dimension; d++)
+    {
+        if(box.maximum[d] - box.minimum[d] > box.maximum[axis] - box.minimum[axis])
+            axis = d;
+    }
+
+    auto center = [this, axis](size_t segment) { return segmentBoxes[segment].minimum[axis] + segmentBoxes[segment].maximum[axis]; };
+    size_t middle = begin + (end - begin) / 2;
+    std::nth_element(segmentOrder.begin() + begin, segmentOrder.begin() + middle, segmentOrder.begin() + end,
+                     [&center](size_t a, size_t b) { return center(a) < center(b); });
+
+    //the children are next to each other, so reserve both slots before building either one
+    size_t firstChild = nodes.size();
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    nodes[nodeIndex].firstChild = firstChild;
+
+    buildNode(firstChild, begin, middle);
+    buildNode(firstChild + 1, middle, end);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::findSegmentsInBox(const Box &box, std::vector<size_t> &output) const
+{
+    collectSegments([&box](const Box &other) {
+        for(size_t d = 0; d < dimension; d++)
+        {
+            if(other.maximum[d] < box.minimum[d] || other.minimum[d] > box.maximum[d])
+                return false;
+        }
+        return true;
+    }, output);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::findSegmentsInsidePlanes(const std::vector<Plane> &planes, std::vector<size_t> &output) const
+{
+    collectSegments([&planes](const Box &box) {
+        //the box is entirely outside a plane if its corner farthest along the plane's normal is outside it
+        for(const Plane &plane : planes)
+        {
+            floating_t distance = plane.offset;
+            for(size_t d = 0; d < dimension; d++)
+            {
+                distance += plane.normal[d] * (plane.normal[d] > 0 ? box.maximum[d] : box.minimum[d]);
+            }
+            if(distance < 0)
+                return false;
+        }
+        return true;
+    }, output);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::findSegmentsAlongRay(
+        const InterpolationType &origin, const InterpolationType &direction, floating_t maxDistance, std::vector<size_t> &output) const
+{
+    collectSegments([&origin, &direction, maxDistance](const Box &box) {
+        //clip the ray against the slab between the box's faces in each dimension
+        floating_t near = 0, far = maxDistance;
+        for(size_t d = 0; d < dimension; d++)
+        {
+            if(direction[d] == 0)
+            {
+                if(origin[d] < box.minimum[d] || origin[d] > box.maximum[d])
+                    return false;
+            }
+            else
+            {
+                floating_t a = (box.minimum[d] - origin[d]) / direction[d];
+                floating_t b = (box.maximum[d] - origin[d]) / direction[d];
+                near = std::max(near, std::min(a, b));
+                far = std::min(far, std::max(a, b));
+                if(near > far)
+                    return false;
+            }
+        }
+        return true;
+    }, output);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::collectSegments(const std::function<bool(const Box&)> &test, std::vector<size_t> &output) const
+{
+    std::vector<size_t> stack = {0};
+    while(!stack.empty())
+    {
+        const Node &node = nodes[stack.back()];
+        stack.pop_back();
+
+        if(!test(node.box))
+            continue;
+
+        if(node.isLeaf())
+        {
+            for(size_t i = node.begin; i < node.end; i++)
+            {
+                if(test(segmentBoxes[segmentOrder[i]]))
+                    output.push_back(segmentOrder[i]);
+            }
+        }
+        else
+        {
+            stack.push_back(node.firstChild);
+            stack.push_back(node.firstChild + 1);
+        }
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+floating_t SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::findClosestT(const InterpolationType &queryPoint) const
+{
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    //visit the nodes closest first, and skip any node whose box is farther away than the closest point so far
+    typedef std::pair<floating_t, size_t> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    queue.emplace(distanceSquared(nodes.front().box, queryPoint), 0);
+
+    floating_t closestDistance = std::numeric_limits<floating_t>::max();
+    floating_t closestT = 0;
+    while(!queue.empty())
+    {
+        Entry entry = queue.top();
+        queue.pop();
+        if(entry.first >= closestDistance)
+            break;
+
+        const Node &node = nodes[entry.second];
+        if(node.isLeaf())
+        {
+            for(size_t i = node.begin; i < node.end; i++)
+            {
+                size_t segment = segmentOrder[i];
+                if(distanceSquared(segmentBoxes[segment], queryPoint) >= closestDistance)
+                    continue;
+
+                floating_t segmentDistance;
+                floating_t t = closestTOnSegment(segment, queryPoint, segmentDistance);
+                if(segmentDistance < closestDistance)
+                {
+                    closestDistance = segmentDistance;
+                    closestT = t;
+                }
+            }
+        }
+        else
+        {
+            for(size_t child = node.firstChild; child < node.firstChild + 2; child++)
+            {
+                floating_t childDistance = distanceSquared(nodes[child].box, queryPoint);
+                if(childDistance < closestDistance)
+                    queue.emplace(childDistance, child);
+            }
+        }
+    }
+
+    return closestT;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+floating_t SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::closestTOnSegment(size_t segmentIndex, const InterpolationType &queryPoint, floating_t &distanceSquared) const
+{
+    //the squared distance is sum((P(u) - q)^2), so half of its derivative is sum((P(u) - q) * P'(u)), a polynomial of degree 2 * degree - 1
+    //its roots, along with the ends of the segment, are the only places the closest point can be
+    size_t productDegree = 2 * degree - 1;
+    std::array<double, maxPolynomialDegree + 1> slope;
+    std::fill(slope.begin(), slope.begin() + productDegree + 1, 0.0);
+    for(size_t d = 0; d < dimension; d++)
+    {
+        const double *coefficients = segmentPolynomial(segmentIndex, d);
+        for(size_t i = 0; i <= degree; i++)
+        {
+            double offset = i == 0 ? coefficients[0] - double(queryPoint[d]) : coefficients[i];
+            for(size_t j = 1; j <= degree; j++)
+            {
+                slope[i + j - 1] += offset * coefficients[j] * j;
+            }
+        }
+    }
+
+    PolynomialRoots candidates;
+    candidates.push_back(0);
+    candidates.push_back(1);
+    findRoots(slope.data(), productDegree, candidates);
+
+    //like the bounding boxes, the distances come from the spline itself
+    floating_t beginT = spline.segmentT(segmentIndex);
+    floating_t endT = spline.segmentT(segmentIndex + 1);
+    floating_t closestT = beginT;
+    distanceSquared = std::numeric_limits<floating_t>::max();
+    for(double u : candidates)
+    {
+        floating_t t = floating_t(beginT + (endT - beginT) * u);
+        floating_t candidateDistance = (spline.segmentPosition(segmentIndex, t) - queryPoint).lengthSquared();
+        if(candidateDistance < distanceSquared)
+        {
+            distanceSquared = candidateDistance;
+            closestT = t;
+        }
+    }
+    return closestT;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+floating_t SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::distanceSquared(const Box &box, const InterpolationType &point)
+{
+    floating_t result = 0;
+    for(size_t d = 0; d < dimension; d++)
+    {
+        floating_t diff = std::max(floating_t(0), std::max(box.minimum[d] - point[d], point[d] - box.maximum[d]));
+        result += diff * diff;
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+typename SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::Box SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::unite(const Box &a, const Box &b)
+{
+    Box result;
+    for(size_t d = 0; d < dimension; d++)
+    {
+        result.minimum[d] = std::min(a.minimum[d], b.minimum[d]);
+        result.maximum[d] = std::max(a.maximum[d], b.maximum[d]);
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+template<size_t capacity>
+void SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::findRoots(const double *coefficients, size_t polynomialDegree, RootList<capacity> &roots)
+{
+    assert(polynomialDegree <= maxPolynomialDegree);
+
+    if(polynomialDegree == 0)
+        return;
+
+    if(polynomialDegree == 1)
+    {
+        if(coefficients[1] != 0)
+        {
+            double root = -coefficients[0] / coefficients[1];
+            if(root > 0 && root < 1)
+                roots.push_back(root);
+        }
+        return;
+    }
+
+    std::array<double, maxPolynomialDegree> derivative;
+    for(size_t power = 1; power <= polynomialDegree; power++)
+    {
+        derivative[power - 1] = coefficients[power] * power;
+    }
+
+    PolynomialRoots breaks;
+    breaks.push_back(0);
+    breaks.push_back(1);
+    findRoots(derivative.data(), polynomialDegree - 1, breaks);
+    std::sort(breaks.begin(), breaks.end());
+
+    for(size_t i = 0; i + 1 < breaks.count; i++)
+    {
+        double a = breaks.values[i], b = breaks.values[i + 1];
+        double valueA = evaluate(coefficients, polynomialDegree, a);
+        double valueB = evaluate(coefficients, polynomialDegree, b);
+        if(valueA == 0 && a > 0)
+            roots.push_back(a);
+        if((valueA < 0) == (valueB < 0) || valueA == 0 || valueB == 0)
+            continue;
+
+        //bisect down to the precision of a double, which takes at most 64 steps
+        for(int iteration = 0; iteration < 64 && b - a > std::numeric_limits<double>::epsilon(); iteration++)
+        {
+            double middle = (a + b) / 2;
+            double valueMiddle = evaluate(coefficients, polynomialDegree, middle);
+            if((valueMiddle < 0) == (valueA < 0))
+            {
+                a = middle;
+                valueA = valueMiddle;
+            }
+            else
+            {
+                b = middle;
+            }
+        }
+        roots.push_back((a + b) / 2);
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+double SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::evaluate(const double *coefficients, size_t polynomialDegree, double u)
+{
+    double result = coefficients[polynomialDegree];
+    for(size_t power = polynomialDegree; power > 0; power--)
+    {
+        result = result * u + coefficients[power - 1];
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension, class SplineType, size_t maxDegree>
+size_t SegmentBVH<InterpolationType, floating_t, dimension, SplineType, maxDegree>::usedMemory(void) const
+{
+    return polynomials.capacity() * sizeof(double) + segmentBoxes.capacity() * sizeof(Box)
+            + segmentOrder.capacity() * sizeof(size_t) + nodes.capacity() * sizeof(Node);
+}
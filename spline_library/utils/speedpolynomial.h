@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "../spline.h"
+
+//the squared speed |P'(s)|^2 of one cubic segment, where s = t - the segment's begin T
+//if P(s) = a + b*s + c*s^2 + d*s^3, then P'(s) = b + 2c*s + 3d*s^2, and its squared length is a quartic in s
+//so integrating the speed of a segment only needs a quartic and a sqrt at each quadrature point, with no basis functions or tangent evaluation
+template<typename floating_t>
+class SpeedPolynomial
+{
+public:
+    SpeedPolynomial(void) = default;
+
+    //build the polynomial from the segment's derivatives at s = 0. for a cubic, these are exact everywhere in the segment
+    template<class InterpolationType>
+    SpeedPolynomial(const InterpolationType &tangent, const InterpolationType &curvature, const InterpolationType &wiggle)
+    {
+        //power basis derivative coefficients: P'(s) = b + c2*s + d3*s^2, where c2 = 2c and d3 = 3d
+        InterpolationType c2 = curvature;
+        InterpolationType d3 = wiggle / floating_t(2);
+
+        coefficients[0] = InterpolationType::dotProduct(tangent, tangent);
+        coefficients[1] = 2 * InterpolationType::dotProduct(tangent, c2);
+        coefficients[2] = InterpolationType::dotProduct(c2, c2) + 2 * InterpolationType::dotProduct(tangent, d3);
+        coefficients[3] = 2 * InterpolationType::dotProduct(c2, d3);
+        coefficients[4] = InterpolationType::dotProduct(d3, d3);
+    }
+
+    //compute the polynomial of every segment of a spline core whose segments are all cubic polynomials
+    template<class SplineCore>
+    static std::vector<SpeedPolynomial> computeForCore(const SplineCore &core)
+    {
+        std::vector<SpeedPolynomial> result(core.segmentCount());
+        for(size_t i = 0; i < result.size(); i++)
+        {
+            auto derivatives = core.template segmentEvaluate<SplineDerivatives::Tangent | SplineDerivatives::Curvature | SplineDerivatives::Wiggle>(i, core.segmentT(i));
+            result[i] = SpeedPolynomial(derivatives.tangent, derivatives.curvature, derivatives.wiggle);
+        }
+        return result;
+    }
+
+    inline floating_t speedSquared(floating_t s) const
+    {
+        return coefficients[0] + s * (coefficients[1] + s * (coefficients[2] + s * (coefficients[3] + s * coefficients[4])));
+    }
+
+    inline floating_t speed(floating_t s) const
+    {
+        //rounding can push the polynomial slightly below zero where the spline comes to a stop
+        return std::sqrt(std::max(floating_t(0), speedSquared(s)));
+    }
+
+    //the arc length from s = localA to s = localB, integrated with the given quadrature
+    template<class Quadrature>
+    inline floating_t integrate(floating_t localA, floating_t localB, const Quadrature &quadrature) const
+    {
+        auto speedFunction = [this](floating_t s) -> floating_t {
+            return speed(s);
+        };
+        return quadrature(speedFunction, localA, localB);
+    }
+
+private:
+    std::array<floating_t, 5> coefficients = {};
+};
@@ -4,6 +4,8 @@
 #include <vector>
 #include <cmath>
 
+#include "instrumentation.h"
+
 namespace SplineCommon
 {
     //compute the T values for the given points, with the given alpha.
@@ -23,6 +25,15 @@ namespace SplineCommon
             size_t innerPadding
             );
 
+    //same as computeTValuesWithInnerPadding, but skip the normalization step, so that the T distance between adjacent points is exactly computeTDiff
+    //splines that can be edited keep these, so that adding or moving a point only has to recompute the T values next to it
+    template<class InterpolationType, typename floating_t>
+    std::vector<floating_t> computeUnnormalizedTValuesWithInnerPadding(
+            const std::vector<InterpolationType> &points,
+            floating_t alpha,
+            size_t innerPadding
+            );
+
     //compute the T values for the given points, with the given alpha, for use in a looping spline
     //if padding is zero, this method will return points.size() + 1 points
     //the "extra" point is because the first point in the list is represented at the beginning AND end
@@ -31,11 +42,56 @@ namespace SplineCommon
     template<class InterpolationType, typename floating_t>
     std::vector<floating_t> computeLoopingTValues(const std::vector<InterpolationType> &points, floating_t alpha, size_t padding);
 
+    //versions of the above that write points.size() (or points.size() + padding * 2 + 1 for the looping version) T values to output, instead of allocating a vector
+    template<class InterpolationType, typename floating_t>
+    void computeTValuesWithInnerPadding(const std::vector<InterpolationType> &points, floating_t alpha, size_t innerPadding, floating_t *output);
+    template<class InterpolationType, typename floating_t>
+    void computeUnnormalizedTValuesWithInnerPadding(const std::vector<InterpolationType> &points, floating_t alpha, size_t innerPadding, floating_t *output);
+    template<class InterpolationType, typename floating_t>
+    void computeLoopingTValues(const std::vector<InterpolationType> &points, floating_t alpha, size_t padding, floating_t *output);
+
 
 
     //given a list of knots and a t value, return the index of the knot the t value falls within
+    //knotData can be a std::vector, or anything else with size(), front(), back(), and operator[], IE a SplinePointView
+    template<class KnotList, typename floating_t>
+    size_t getIndexForT(const KnotList &knotData, floating_t t);
+
+    //optional acceleration structure for getIndexForT, for knots whose spacing varies by orders of magnitude, IE a GPS trace with long gaps
+    //getIndexForT's first guess assumes the knots are about 1 apart, so on knots like those it can take dozens of galloping steps, each a cache miss on a large spline
+    //this splits the knots' T range into one evenly sized bucket per knot, and records which knots each bucket overlaps,
+    //so a lookup is one multiplication to find the bucket, and a binary search of the few knots in that bucket
+    //the index only stores knot indexes, so it has to be rebuilt if the knots it was built from change
     template<typename floating_t>
-    size_t getIndexForT(const std::vector<floating_t> &knotData, floating_t t);
+    class KnotIndex
+    {
+    public:
+        KnotIndex(void) = default;
+
+        template<class KnotList>
+        explicit KnotIndex(const KnotList &knotData);
+
+        //an empty index, IE a default-constructed one, makes getIndexForT fall back to searching without it
+        bool empty(void) const { return bucketStarts.empty(); }
+
+        //return the same index as getIndexForT(knotData, t). knotData must be the knots this was built from
+        template<class KnotList>
+        size_t find(const KnotList &knotData, floating_t t) const;
+
+    private:
+        size_t bucketForT(floating_t t) const;
+
+        floating_t firstKnot = 0;
+        floating_t bucketsPerT = 0;
+
+        //bucketStarts[b] is the last knot before bucket b, or 0 if there isn't one. so every T in bucket b belongs to a knot
+        //from bucketStarts[b] to bucketStarts[b + 1], inclusive. there's one more entry than there are buckets
+        std::vector<size_t> bucketStarts;
+    };
+
+    //same as getIndexForT above, but use the given index if it isn't empty
+    template<class KnotList, typename floating_t>
+    size_t getIndexForT(const KnotList &knotData, const KnotIndex<floating_t> &index, floating_t t);
 }
 
 template<class InterpolationType, typename floating_t>
@@ -71,12 +127,58 @@ std::vector<floating_t> SplineCommon::computeTValuesWithInnerPadding(
         floating_t alpha,
         size_t innerPadding
         )
+{
+    std::vector<floating_t> tValues(points.size());
+    computeTValuesWithInnerPadding(points, alpha, innerPadding, tValues.data());
+    return tValues;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplineCommon::computeTValuesWithInnerPadding(
+        const std::vector<InterpolationType> &points,
+        floating_t alpha,
+        size_t innerPadding,
+        floating_t *tValues
+        )
 {
     size_t size = points.size();
     size_t endPaddingIndex = size - 1 - innerPadding;
     size_t desiredMaxT = size - 2 * innerPadding - 1;
 
-    std::vector<floating_t> tValues(size);
+    computeUnnormalizedTValuesWithInnerPadding(points, alpha, innerPadding, tValues);
+
+    //we want to know the t value of the last segment so that we can normalize them all
+    floating_t maxTRaw = tValues[endPaddingIndex];
+
+    //now that we have all ouf our t values and indexes figured out, normalize the t values by dividing them by maxT
+    floating_t multiplier = desiredMaxT / maxTRaw;
+    for(size_t i = 0; i < size; i++)
+    {
+        tValues[i] *= multiplier;
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+std::vector<floating_t> SplineCommon::computeUnnormalizedTValuesWithInnerPadding(
+        const std::vector<InterpolationType> &points,
+        floating_t alpha,
+        size_t innerPadding
+        )
+{
+    std::vector<floating_t> tValues(points.size());
+    computeUnnormalizedTValuesWithInnerPadding(points, alpha, innerPadding, tValues.data());
+    return tValues;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplineCommon::computeUnnormalizedTValuesWithInnerPadding(
+        const std::vector<InterpolationType> &points,
+        floating_t alpha,
+        size_t innerPadding,
+        floating_t *tValues
+        )
+{
+    size_t size = points.size();
 
     //we know points[padding] will have a t value of 0
     tValues[innerPadding] = 0;
@@ -94,18 +196,6 @@ std::vector<floating_t> SplineCommon::computeTValuesWithInnerPadding(
     {
         tValues[i] = tValues[i - 1] + computeTDiff(points[i], points[i - 1], alpha);
     }
-
-    //we want to know the t value of the last segment so that we can normalize them all
-    floating_t maxTRaw = tValues[endPaddingIndex];
-
-    //now that we have all ouf our t values and indexes figured out, normalize the t values by dividing them by maxT
-    floating_t multiplier = desiredMaxT / maxTRaw;
-    for(auto &entry: tValues)
-    {
-        entry *= multiplier;
-    }
-
-    return tValues;
 }
 
 template<class InterpolationType, typename floating_t>
@@ -113,10 +203,21 @@ std::vector<floating_t> SplineCommon::computeLoopingTValues(
         const std::vector<InterpolationType> &points,
         floating_t alpha,
         size_t padding)
+{
+    std::vector<floating_t> tValues(points.size() + padding * 2 + 1);
+    computeLoopingTValues(points, alpha, padding, tValues.data());
+    return tValues;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplineCommon::computeLoopingTValues(
+        const std::vector<InterpolationType> &points,
+        floating_t alpha,
+        size_t padding,
+        floating_t *tValues)
 {
     size_t size = points.size();
     floating_t maxT = floating_t(size);
-    std::vector<floating_t> tValues(size + padding * 2 + 1);
 
     //compute the t values each point
     tValues[padding] = 0;
@@ -144,15 +245,14 @@ std::vector<floating_t> SplineCommon::computeLoopingTValues(
         tValues[i] = tValues[i + size] - maxT;
         tValues[i + size + padding + 1] = tValues[i + padding + 1] + maxT;
     }
-
-    return tValues;
 }
 
 
-template<typename floating_t>
-size_t SplineCommon::getIndexForT(const std::vector<floating_t> &knotData, floating_t t)
+template<class KnotList, typename floating_t>
+size_t SplineCommon::getIndexForT(const KnotList &knotData, floating_t t)
 {
     //we want to find the segment whos t0 and t1 values bound x
+    SPLINE_INSTRUMENT_COUNT(SegmentLookups);
 
     //if no segments bound x, return -1
     if(t <= knotData.front())
@@ -172,6 +272,7 @@ size_t SplineCommon::getIndexForT(const std::vector<floating_t> &knotData, float
         {
             searchSize++;
             currentIndex -= searchSize;
+            SPLINE_INSTRUMENT_COUNT(SegmentLookupSteps);
         }
         if(currentIndex < 0 || t > knotData[currentIndex + 1])
         {
@@ -186,6 +287,7 @@ size_t SplineCommon::getIndexForT(const std::vector<floating_t> &knotData, float
         {
             searchSize++;
             currentIndex += searchSize;
+            SPLINE_INSTRUMENT_COUNT(SegmentLookupSteps);
         }
         if(currentIndex >= size || t < knotData[currentIndex])
         {
@@ -195,3 +297,82 @@ size_t SplineCommon::getIndexForT(const std::vector<floating_t> &knotData, float
     }
     return currentIndex;
 }
+
+template<class KnotList, typename floating_t>
+size_t SplineCommon::getIndexForT(const KnotList &knotData, const KnotIndex<floating_t> &index, floating_t t)
+{
+    if(index.empty())
+        return getIndexForT(knotData, t);
+    else
+        return index.find(knotData, t);
+}
+
+template<typename floating_t>
+template<class KnotList>
+SplineCommon::KnotIndex<floating_t>::KnotIndex(const KnotList &knotData)
+{
+    size_t knotCount = knotData.size();
+    floating_t range = knotData.back() - knotData.front();
+
+    //getIndexForT never needs to search when every knot has the same T, so neither do we
+    if(knotCount < 2 || !(range > 0))
+        return;
+
+    size_t bucketCount = knotCount;
+    firstKnot = knotData.front();
+    bucketsPerT = floating_t(bucketCount) / range;
+
+    //find buckets with the same function as find() does, instead of computing each bucket's boundaries, so that rounding can't put a knot in a different bucket here than there
+    //bucketForT never decreases as T increases, so every knot in an earlier bucket is less than every T in a later one
+    bucketStarts.resize(bucketCount + 1);
+    size_t knotIndex = 0;
+    for(size_t bucket = 0; bucket <= bucketCount; bucket++)
+    {
+        while(knotIndex < knotCount && bucketForT(knotData[knotIndex]) < bucket)
+        {
+            knotIndex++;
+        }
+        bucketStarts[bucket] = knotIndex > 0 ? knotIndex - 1 : 0;
+    }
+}
+
+template<typename floating_t>
+size_t SplineCommon::KnotIndex<floating_t>::bucketForT(floating_t t) const
+{
+    floating_t bucket = (t - firstKnot) * bucketsPerT;
+    if(!(bucket > 0))
+        return 0;
+
+    size_t lastBucket = bucketStarts.size() - 2;
+    if(bucket >= floating_t(lastBucket))
+        return lastBucket;
+    return size_t(bucket);
+}
+
+template<typename floating_t>
+template<class KnotList>
+size_t SplineCommon::KnotIndex<floating_t>::find(const KnotList &knotData, floating_t t) const
+{
+    SPLINE_INSTRUMENT_COUNT(SegmentLookups);
+
+    //same special cases as getIndexForT
+    if(t <= knotData.front())
+        return 0;
+    if(t >= knotData.back())
+        return knotData.size() - 1;
+
+    //find the last knot <= t. bucketStarts[bucket] is known to be <= t, and the knot after bucketStarts[bucket + 1] is known to be > t
+    size_t bucket = bucketForT(t);
+    size_t low = bucketStarts[bucket];
+    size_t high = bucketStarts[bucket + 1] + 1;
+    while(high - low > 1)
+    {
+        size_t middle = low + (high - low) / 2;
+        if(t < knotData[middle])
+            high = middle;
+        else
+            low = middle;
+        SPLINE_INSTRUMENT_COUNT(SegmentLookupSteps);
+    }
+    return low;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../spline.h"
+
+//evaluates a spline at a sequence of T values, remembering which segment the previous T value fell in
+//meant for sweeps that are (mostly) sorted by T, like drawing or sampling a spline:
+//as long as T stays in the current segment or moves into the next one, no segment search is performed
+//if SplineType is a concrete spline class like UniformCRSpline instead of the Spline base class, every call to the spline is resolved at compile time and can be inlined
+template<class InterpolationType, typename floating_t=float, class SplineType=Spline<InterpolationType, floating_t>>
+class SplineCursor
+{
+public:
+    SplineCursor(const SplineType &spline);
+
+    InterpolationType getPosition(floating_t t);
+    typename Spline<InterpolationType,floating_t>::InterpolatedPT getTangent(floating_t t);
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTC getCurvature(floating_t t);
+    typename Spline<InterpolationType,floating_t>::InterpolatedPTCW getWiggle(floating_t t);
+
+    //the index of the segment that the most recent T value fell in
+    size_t currentSegment(void) const { return tracker.index; }
+
+private: //methods
+    //wrap t if the spline is looping, and move the tracker to the segment containing t. returns the wrapped t
+    floating_t seek(floating_t t);
+
+private: //data
+    const SplineType &spline;
+
+    //null if the spline isn't looping
+    const LoopingSpline<InterpolationType, floating_t> *loopingSpline;
+
+    __SplinePrivate::SegmentTracker<floating_t> tracker;
+};
+
+template<class InterpolationType, typename floating_t, class SplineType>
+SplineCursor<InterpolationType, floating_t, SplineType>::SplineCursor(const SplineType &spline)
+    :spline(spline), loopingSpline(__SplinePrivate::asLoopingSpline(&spline))
+{
+
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+InterpolationType SplineCursor<InterpolationType, floating_t, SplineType>::getPosition(floating_t t)
+{
+    t = seek(t);
+    return spline.segmentPosition(tracker.index, t);
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+typename Spline<InterpolationType,floating_t>::InterpolatedPT SplineCursor<InterpolationType, floating_t, SplineType>::getTangent(floating_t t)
+{
+    t = seek(t);
+    return spline.segmentTangent(tracker.index, t);
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+typename Spline<InterpolationType,floating_t>::InterpolatedPTC SplineCursor<InterpolationType, floating_t, SplineType>::getCurvature(floating_t t)
+{
+    t = seek(t);
+    return spline.segmentCurvature(tracker.index, t);
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+typename Spline<InterpolationType,floating_t>::InterpolatedPTCW SplineCursor<InterpolationType, floating_t, SplineType>::getWiggle(floating_t t)
+{
+    t = seek(t);
+    return spline.segmentWiggle(tracker.index, t);
+}
+
+template<class InterpolationType, typename floating_t, class SplineType>
+floating_t SplineCursor<InterpolationType, floating_t, SplineType>::seek(floating_t t)
+{
+    if(loopingSpline)
+    {
+        t = loopingSpline->wrapT(t);
+    }
+
+    tracker.seek(spline, t);
+    return t;
+}
@@ -0,0 +1,414 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "../spline.h"
+#include "../splines/baked_cubic_spline.h"
+
+//a compact binary file format for built splines
+//building some spline types is expensive -- natural splines solve a linear system, hermite splines compute their knots and tangents, etc
+//so splines are written in their baked cubic form: the original points, the knots, and the power-basis coefficients of every segment
+//loading a file memory-maps it, and the loaded splines evaluate straight from the mapped memory, with no solving and no copies of the data
+//the file stores raw floating_t and InterpolationType values, so it must be read with the same types, on a machine with the same byte order
+namespace __SplineFilePrivate
+{
+    static const char fileMagic[8] = {'S', 'P', 'L', 'N', 'F', 'I', 'L', 'E'};
+    static const uint32_t fileVersion = 1;
+
+    //every array in the file begins at a multiple of this, so that the mapped segments are correctly aligned
+    static const uint64_t arrayAlignment = 16;
+
+    enum SplineTypeTag : uint32_t
+    {
+        BakedCubic = 1
+    };
+
+    enum SplineFlags : uint32_t
+    {
+        Looping = 1
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t splineCount;
+
+        //sizes of the types the file was written with. the file can only be read with types of the same sizes
+        uint32_t pointSize;
+        uint32_t floatSize;
+        uint32_t segmentSize;
+        uint32_t reserved;
+    };
+
+    //one of these for each spline, directly after the file header. offsets are in bytes from the beginning of the file
+    struct SplineRecord
+    {
+        uint32_t typeTag;
+        uint32_t flags;
+        double maxT;
+
+        uint64_t pointCount;
+        uint64_t segmentCount;
+
+        uint64_t pointOffset;
+        uint64_t knotOffset;
+        uint64_t segmentOffset;
+    };
+
+    inline uint64_t alignOffset(uint64_t offset)
+    {
+        return (offset + arrayAlignment - 1) / arrayAlignment * arrayAlignment;
+    }
+}
+
+//collects splines, then writes them all to a single file
+template<class InterpolationType, typename floating_t=float>
+class SplineFileWriter
+{
+public:
+    //bake the given spline and add it to the file. the spline must be cubic: see BakedCubicSpline for the list of cubic spline types
+    //throws std::invalid_argument if the spline's degree is higher than 3, since the file only stores cubic segments
+    void addSpline(const Spline<InterpolationType, floating_t> &cubicSpline);
+
+    size_t splineCount(void) const { return entries.size(); }
+
+    //returns false if the file couldn't be written
+    bool write(std::ostream &stream) const;
+    bool save(const std::string &filename) const;
+
+private: //types
+    typedef BakedCubicSplineOwningCommon::type<InterpolationType, floating_t> BakedType;
+
+    struct Entry
+    {
+        std::vector<InterpolationType> points;
+        BakedType baked;
+        floating_t maxT;
+        bool looping;
+    };
+
+private: //data
+    std::vector<Entry> entries;
+};
+
+//reads a file written by SplineFileWriter
+//the splines returned by getSpline and getLoopingSpline point into the file's memory, so they must not outlive the SplineFile
+template<class InterpolationType, typename floating_t=float>
+class SplineFile
+{
+public:
+    SplineFile(void) = default;
+    ~SplineFile(void) { close(); }
+
+    SplineFile(const SplineFile&) = delete;
+    SplineFile &operator=(const SplineFile&) = delete;
+
+    //memory-map the given file. returns false if the file can't be mapped, or isn't a valid spline file for these types
+    bool open(const std::string &filename);
+
+    //read splines from a buffer that's already in memory. the buffer must stay alive while the SplineFile is in use,
+    //and it must be aligned at least as strictly as BakedCubicSegment. returns false if the buffer isn't a valid spline file for these types
+    bool openBuffer(const void *data, size_t size);
+
+    void close(void);
+
+    bool isValid(void) const { return fileData != nullptr; }
+    size_t splineCount(void) const { return isValid() ? header().splineCount : 0; }
+    bool isLooping(size_t index) const { return (record(index).flags & __SplineFilePrivate::Looping) != 0; }
+
+    //create a spline that evaluates straight from the file's memory. no data is copied, and nothing is allocated
+    //getSpline is for non-looping splines only, and getLoopingSpline is for looping splines only
+    BakedCubicSplineView<InterpolationType, floating_t> getSpline(size_t index) const;
+    LoopingBakedCubicSplineView<InterpolationType, floating_t> getLoopingSpline(size_t index) const;
+
+private: //methods
+    const __SplineFilePrivate::FileHeader &header(void) const { return *reinterpret_cast<const __SplineFilePrivate::FileHeader*>(fileData); }
+    const __SplineFilePrivate::SplineRecord &record(size_t index) const
+    {
+        assert(index < splineCount());
+        return reinterpret_cast<const __SplineFilePrivate::SplineRecord*>(fileData + sizeof(__SplineFilePrivate::FileHeader))[index];
+    }
+
+    template<class T>
+    SplinePointView<T> arrayView(uint64_t offset, uint64_t count) const { return SplinePointView<T>(reinterpret_cast<const T*>(fileData + offset), count); }
+
+    //check every header and record against the size of the buffer, so that a truncated or corrupt file can't cause out-of-bounds reads
+    static bool validate(const unsigned char *data, size_t size);
+
+    void unmap(void);
+
+private: //data
+    const unsigned char *fileData = nullptr;
+    size_t fileSize = 0;
+
+    //non-null if this object mapped the file itself, and is responsible for unmapping it
+    void *mappedData = nullptr;
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE mappingHandle = nullptr;
+#endif
+};
+
+
+
+template<class InterpolationType, typename floating_t>
+void SplineFileWriter<InterpolationType, floating_t>::addSpline(const Spline<InterpolationType, floating_t> &cubicSpline)
+{
+    BakedType::requireCubic(cubicSpline);
+
+    auto points = cubicSpline.getOriginalPointsView();
+
+    entries.push_back(Entry{
+        std::vector<InterpolationType>(points.begin(), points.end()),
+        BakedType(cubicSpline),
+        cubicSpline.getMaxT(),
+        cubicSpline.isLooping()
+    });
+}
+
+template<class InterpolationType, typename floating_t>
+bool SplineFileWriter<InterpolationType, floating_t>::write(std::ostream &stream) const
+{
+    using namespace __SplineFilePrivate;
+    typedef typename BakedType::Segment Segment;
+
+    FileHeader fileHeader;
+    std::memcpy(fileHeader.magic, fileMagic, sizeof(fileMagic));
+    fileHeader.version = fileVersion;
+    fileHeader.splineCount = uint32_t(entries.size());
+    fileHeader.pointSize = sizeof(InterpolationType);
+    fileHeader.floatSize = sizeof(floating_t);
+    fileHeader.segmentSize = sizeof(Segment);
+    fileHeader.reserved = 0;
+
+    //lay out the arrays of every spline after the table of records
+    std::vector<SplineRecord> records(entries.size());
+    uint64_t offset = sizeof(FileHeader) + sizeof(SplineRecord) * entries.size();
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry &entry = entries[i];
+        SplineRecord &splineRecord = records[i];
+
+        splineRecord.typeTag = BakedCubic;
+        splineRecord.flags = entry.looping ? uint32_t(Looping) : 0;
+        splineRecord.maxT = entry.maxT;
+        splineRecord.pointCount = entry.points.size();
+        splineRecord.segmentCount = entry.baked.segmentCount();
+
+        splineRecord.pointOffset = alignOffset(offset);
+        splineRecord.knotOffset = alignOffset(splineRecord.pointOffset + sizeof(InterpolationType) * splineRecord.pointCount);
+        splineRecord.segmentOffset = alignOffset(splineRecord.knotOffset + sizeof(floating_t) * (splineRecord.segmentCount + 1));
+        offset = splineRecord.segmentOffset + sizeof(Segment) * splineRecord.segmentCount;
+    }
+
+    //write everything in order, padding with zeroes up to the beginning of each array
+    uint64_t position = 0;
+    auto writeBytes = [&](uint64_t destination, const void *data, size_t size) {
+        static const char padding[arrayAlignment] = {};
+        while(position < destination)
+        {
+            size_t paddingSize = size_t(std::min(destination - position, arrayAlignment));
+            stream.write(padding, paddingSize);
+            position += paddingSize;
+        }
+        stream.write(reinterpret_cast<const char*>(data), size);
+        position += size;
+    };
+
+    writeBytes(0, &fileHeader, sizeof(FileHeader));
+    writeBytes(position, records.data(), sizeof(SplineRecord) * records.size());
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry &entry = entries[i];
+        writeBytes(records[i].pointOffset, entry.points.data(), sizeof(InterpolationType) * entry.points.size());
+        writeBytes(records[i].knotOffset, entry.baked.getKnots().data(), sizeof(floating_t) * entry.baked.getKnots().size());
+        writeBytes(records[i].segmentOffset, entry.baked.getSegments().data(), sizeof(Segment) * entry.baked.getSegments().size());
+    }
+
+    return bool(stream);
+}
+
+template<class InterpolationType, typename floating_t>
+bool SplineFileWriter<InterpolationType, floating_t>::save(const std::string &filename) const
+{
+    std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+    return stream && write(stream);
+}
+
+
+
+template<class InterpolationType, typename floating_t>
+bool SplineFile<InterpolationType, floating_t>::validate(const unsigned char *data, size_t size)
+{
+    using namespace __SplineFilePrivate;
+
+    //the records are read in place, so the buffer needs to satisfy their alignment as well as the segments'
+    size_t bufferAlignment = std::max(alignof(SplineRecord), alignof(BakedCubicSegment<InterpolationType>));
+    if(data == nullptr || size < sizeof(FileHeader) || reinterpret_cast<uintptr_t>(data) % bufferAlignment != 0)
+        return false;
+
+    const FileHeader &fileHeader = *reinterpret_cast<const FileHeader*>(data);
+    if(std::memcmp(fileHeader.magic, fileMagic, sizeof(fileMagic)) != 0
+            || fileHeader.version != fileVersion
+            || fileHeader.pointSize != sizeof(InterpolationType)
+            || fileHeader.floatSize != sizeof(floating_t)
+            || fileHeader.segmentSize != sizeof(BakedCubicSegment<InterpolationType>))
+        return false;
+
+    if((size - sizeof(FileHeader)) / sizeof(SplineRecord) < fileHeader.splineCount)
+        return false;
+
+    //make sure every array fits in the buffer, and is aligned. compare counts against the remaining size rather than multiplying, so that huge counts can't overflow
+    auto arrayFits = [size](uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t alignment) {
+        return offset % alignment == 0 && offset <= size && count <= (size - offset) / elementSize;
+    };
+
+    const SplineRecord *records = reinterpret_cast<const SplineRecord*>(data + sizeof(FileHeader));
+    for(size_t i = 0; i < fileHeader.splineCount; i++)
+    {
+        const SplineRecord &splineRecord = records[i];
+        if(splineRecord.typeTag != BakedCubic || splineRecord.segmentCount == 0)
+            return false;
+        if(!arrayFits(splineRecord.pointOffset, splineRecord.pointCount, sizeof(InterpolationType), alignof(InterpolationType))
+                || !arrayFits(splineRecord.knotOffset, splineRecord.segmentCount + 1, sizeof(floating_t), alignof(floating_t))
+                || !arrayFits(splineRecord.segmentOffset, splineRecord.segmentCount, sizeof(BakedCubicSegment<InterpolationType>), alignof(BakedCubicSegment<InterpolationType>)))
+            return false;
+    }
+
+    return true;
+}
+
+template<class InterpolationType, typename floating_t>
+bool SplineFile<InterpolationType, floating_t>::openBuffer(const void *data, size_t size)
+{
+    close();
+
+    if(!validate(reinterpret_cast<const unsigned char*>(data), size))
+        return false;
+
+    fileData = reinterpret_cast<const unsigned char*>(data);
+    fileSize = size;
+    return true;
+}
+
+template<class InterpolationType, typename floating_t>
+bool SplineFile<InterpolationType, floating_t>::open(const std::string &filename)
+{
+    close();
+
+    size_t size = 0;
+#ifdef _WIN32
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSizeInfo;
+    if(GetFileSizeEx(fileHandle, &fileSizeInfo) && fileSizeInfo.QuadPart > 0)
+    {
+        size = size_t(fileSizeInfo.QuadPart);
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(mappingHandle != nullptr)
+            mappedData = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+    if(fileDescriptor < 0)
+        return false;
+
+    struct stat fileInfo;
+    if(fstat(fileDescriptor, &fileInfo) == 0 && fileInfo.st_size > 0)
+    {
+        size = size_t(fileInfo.st_size);
+        void *result = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if(result != MAP_FAILED)
+            mappedData = result;
+    }
+
+    //the mapping stays valid after the file is closed
+    ::close(fileDescriptor);
+#endif
+
+    if(mappedData == nullptr || !validate(reinterpret_cast<const unsigned char*>(mappedData), size))
+    {
+        fileSize = size;
+        unmap();
+        return false;
+    }
+
+    fileData = reinterpret_cast<const unsigned char*>(mappedData);
+    fileSize = size;
+    return true;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplineFile<InterpolationType, floating_t>::close(void)
+{
+    unmap();
+    fileData = nullptr;
+    fileSize = 0;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplineFile<InterpolationType, floating_t>::unmap(void)
+{
+#ifdef _WIN32
+    if(mappedData != nullptr)
+        UnmapViewOfFile(mappedData);
+    if(mappingHandle != nullptr)
+        CloseHandle(mappingHandle);
+    if(fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if(mappedData != nullptr)
+        munmap(mappedData, fileSize);
+#endif
+    mappedData = nullptr;
+}
+
+template<class InterpolationType, typename floating_t>
+BakedCubicSplineView<InterpolationType, floating_t> SplineFile<InterpolationType, floating_t>::getSpline(size_t index) const
+{
+    const __SplineFilePrivate::SplineRecord &splineRecord = record(index);
+    assert(!isLooping(index));
+
+    return BakedCubicSplineView<InterpolationType, floating_t>(
+                arrayView<InterpolationType>(splineRecord.pointOffset, splineRecord.pointCount),
+                arrayView<floating_t>(splineRecord.knotOffset, splineRecord.segmentCount + 1),
+                arrayView<BakedCubicSegment<InterpolationType>>(splineRecord.segmentOffset, splineRecord.segmentCount),
+                floating_t(splineRecord.maxT)
+                );
+}
+
+template<class InterpolationType, typename floating_t>
+LoopingBakedCubicSplineView<InterpolationType, floating_t> SplineFile<InterpolationType, floating_t>::getLoopingSpline(size_t index) const
+{
+    const __SplineFilePrivate::SplineRecord &splineRecord = record(index);
+    assert(isLooping(index));
+
+    return LoopingBakedCubicSplineView<InterpolationType, floating_t>(
+                arrayView<InterpolationType>(splineRecord.pointOffset, splineRecord.pointCount),
+                arrayView<floating_t>(splineRecord.knotOffset, splineRecord.segmentCount + 1),
+                arrayView<BakedCubicSegment<InterpolationType>>(splineRecord.segmentOffset, splineRecord.segmentCount),
+                floating_t(splineRecord.maxT)
+                );
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "../spline.h"
+#include "../splines/baked_cubic_spline.h"
+
+//packs splines into a flat array of 32-bit words, for evaluating splines in vertex and compute shaders
+//the layout is compatible with a std430 storage buffer declared as "uint words[]" (see spline_library/shaders/spline_eval.glsl), or an HLSL ByteAddressBuffer (spline_eval.hlsl)
+//every spline is converted to power-basis polynomials, so one shader evaluates every spline type: each segment stores degree+1 vec4 coefficients
+//
+//layout of one spline, starting at the word offset returned by addSpline. offsets are in words, relative to the beginning of the buffer
+//  [0] typeTag (SplineGpuBuffer::PowerBasis)
+//  [1] degree
+//  [2] segmentCount
+//  [3] flags (SplineGpuBuffer::Looping)
+//  [4] maxT, as float bits
+//  [5] knotOffset: segmentCount + 1 floats, the T value at the beginning of each segment and the end of the last one
+//  [6] coefficientOffset: segmentCount * (degree + 1) vec4s. coefficient k of segment i is at coefficientOffset + 4 * (i * (degree + 1) + k)
+//  [7] reserved
+//
+//position = sum over k of coefficient[k] * s^k, where s = t - knot[i]. points with fewer than 4 dimensions leave the unused components 0
+//every spline starts at a multiple of 4 words, and every coefficient array is aligned to 16 bytes, so the coefficients can also be read as vec4s
+template<class InterpolationType, typename floating_t=float, size_t dimension=2>
+class SplineGpuBuffer
+{
+public:
+    static_assert(dimension > 0 && dimension <= 4, "The GPU buffer stores each point in a vec4");
+
+    enum TypeTag : uint32_t
+    {
+        PowerBasis = 1
+    };
+
+    enum Flags : uint32_t
+    {
+        Looping = 1
+    };
+
+    static constexpr size_t headerWords = 8;
+    static constexpr size_t maxDegree = 7;
+
+    //convert the given spline to power-basis polynomials of the spline's own degree, and append it to the buffer. returns the word offset of the spline
+    //throws std::invalid_argument if the spline's degree is higher than maxDegree, since the shaders can't evaluate it
+    uint32_t addSpline(const Spline<InterpolationType, floating_t> &spline);
+
+    //same as above, but store the segments as polynomials of the given degree, which must be at least the spline's degree and at most maxDegree
+    //cubic segments are converted exactly from the derivatives at the segment's beginning, other degrees by interpolating degree + 1 points in each segment
+    //throws std::invalid_argument if the degree is out of range
+    uint32_t addSpline(const Spline<InterpolationType, floating_t> &spline, size_t degree);
+
+    const std::vector<uint32_t> &getWords(void) const { return words; }
+    const uint32_t *data(void) const { return words.data(); }
+    size_t sizeInBytes(void) const { return words.size() * sizeof(uint32_t); }
+
+    //CPU implementations of the reference shaders, which read the buffer exactly the way spline_eval.glsl and spline_eval.hlsl do
+    //for validating the buffer, and the shaders, against the original spline. the results are vec4s, with the unused components 0
+    std::array<float, 4> evaluatePosition(uint32_t splineOffset, float t) const;
+    std::array<float, 4> evaluateTangent(uint32_t splineOffset, float t) const;
+
+private: //methods
+    void appendFloat(float value);
+    float readFloat(uint32_t offset) const;
+
+    //return the segment index and the local s value of the given T, wrapping T for looping splines
+    uint32_t findSegment(uint32_t splineOffset, float t, float &s) const;
+
+    //compute power-basis coefficients for one segment, in floating_t, from s = 0 to s = segmentLength
+    static void computeCoefficients(const Spline<InterpolationType, floating_t> &spline, size_t segmentIndex, size_t degree, InterpolationType *output);
+
+private: //data
+    std::vector<uint32_t> words;
+};
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+constexpr size_t SplineGpuBuffer<InterpolationType, floating_t, dimension>::headerWords;
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+constexpr size_t SplineGpuBuffer<InterpolationType, floating_t, dimension>::maxDegree;
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+uint32_t SplineGpuBuffer<InterpolationType, floating_t, dimension>::addSpline(const Spline<InterpolationType, floating_t> &spline)
+{
+    return addSpline(spline, spline.degree());
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+uint32_t SplineGpuBuffer<InterpolationType, floating_t, dimension>::addSpline(const Spline<InterpolationType, floating_t> &spline, size_t degree)
+{
+    if(spline.degree() > maxDegree)
+        throw std::invalid_argument("The GPU buffer can't store splines of degree higher than 7");
+    if(degree < spline.degree() || degree > maxDegree)
+        throw std::invalid_argument("The GPU buffer degree must be at least the spline's degree, and at most 7");
+
+    uint32_t splineOffset = uint32_t(words.size());
+    uint32_t segmentCount = uint32_t(spline.segmentCount());
+
+    uint32_t knotOffset = splineOffset + headerWords;
+    uint32_t coefficientOffset = (knotOffset + segmentCount + 1 + 3) / 4 * 4;
+
+    words.push_back(PowerBasis);
+    words.push_back(uint32_t(degree));
+    words.push_back(segmentCount);
+    words.push_back(spline.isLooping() ? uint32_t(Looping) : uint32_t(0));
+    appendFloat(float(spline.getMaxT()));
+    words.push_back(knotOffset);
+    words.push_back(coefficientOffset);
+    words.push_back(0);
+
+    for(size_t i = 0; i <= segmentCount; i++)
+    {
+        appendFloat(float(spline.segmentT(i)));
+    }
+    words.resize(coefficientOffset, 0);
+
+    std::array<InterpolationType, maxDegree + 1> coefficients;
+    for(size_t i = 0; i < segmentCount; i++)
+    {
+        computeCoefficients(spline, i, degree, coefficients.data());
+        for(size_t k = 0; k <= degree; k++)
+        {
+            for(size_t c = 0; c < 4; c++)
+            {
+                appendFloat(c < dimension ? float(coefficients[k][c]) : 0.0f);
+            }
+        }
+    }
+
+    //keep the next spline aligned to a vec4 as well
+    words.resize((words.size() + 3) / 4 * 4, 0);
+
+    return splineOffset;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void SplineGpuBuffer<InterpolationType, floating_t, dimension>::computeCoefficients(
+        const Spline<InterpolationType, floating_t> &spline, size_t segmentIndex, size_t degree, InterpolationType *output)
+{
+    floating_t segmentBegin = spline.segmentT(segmentIndex);
+    floating_t segmentLength = spline.segmentT(segmentIndex + 1) - segmentBegin;
+
+    //cubics, and anything lower, are exactly their Taylor expansion at the beginning of the segment, the same as BakedCubicSpline
+    if(degree <= 3)
+    {
+        auto segment = BakedCubicSplineOwningCommon::type<InterpolationType, floating_t>::bakeSegment(spline, segmentIndex);
+        std::array<InterpolationType, 4> taylor = {{ segment.a, segment.b, segment.c, segment.d }};
+        std::copy_n(taylor.begin(), degree + 1, output);
+        return;
+    }
+
+    //b-splines can have segments with no T distance. they're never evaluated, but they still need coefficients
+    if(segmentLength <= 0)
+    {
+        output[0] = spline.segmentPosition(segmentIndex, segmentBegin);
+        std::fill(output + 1, output + degree + 1, InterpolationType());
+        return;
+    }
+
+    //for higher degrees we don't have enough derivatives, so interpolate the segment at degree + 1 chebyshev nodes instead
+    //newton's divided differences give the interpolating polynomial in newton form, which we then expand into the power basis
+    size_t n = degree + 1;
+    std::array<floating_t, maxDegree + 1> nodes;
+    std::array<InterpolationType, maxDegree + 1> differences;
+    for(size_t j = 0; j < n; j++)
+    {
+        floating_t angle = floating_t(3.14159265358979323846) * floating_t(2 * j + 1) / floating_t(2 * n);
+        nodes[j] = segmentLength * (1 - std::cos(angle)) / 2;
+        differences[j] = spline.segmentPosition(segmentIndex, segmentBegin + nodes[j]);
+    }
+    for(size_t level = 1; level < n; level++)
+    {
+        for(size_t j = n - 1; j >= level; j--)
+        {
+            differences[j] = (differences[j] - differences[j - 1]) / (nodes[j] - nodes[j - level]);
+        }
+    }
+
+    //horner's method on the newton form: p = d[n-1], then p = p * (s - x[k]) + d[k] for each lower k
+    for(size_t k = 0; k < n; k++)
+    {
+        output[k] = InterpolationType();
+    }
+    output[0] = differences[n - 1];
+    for(size_t level = n - 1; level-- > 0;)
+    {
+        //multiply the current polynomial, which has degree n - 2 - level, by (s - nodes[level])
+        size_t currentDegree = n - 2 - level;
+        output[currentDegree + 1] = output[currentDegree];
+        for(size_t k = currentDegree; k > 0; k--)
+        {
+            output[k] = output[k - 1] - nodes[level] * output[k];
+        }
+        output[0] = differences[level] - nodes[level] * output[0];
+    }
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+void SplineGpuBuffer<InterpolationType, floating_t, dimension>::appendFloat(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    words.push_back(bits);
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+float SplineGpuBuffer<InterpolationType, floating_t, dimension>::readFloat(uint32_t offset) const
+{
+    float value;
+    std::memcpy(&value, &words[offset], sizeof(value));
+    return value;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+uint32_t SplineGpuBuffer<InterpolationType, floating_t, dimension>::findSegment(uint32_t splineOffset, float t, float &s) const
+{
+    uint32_t segmentCount = words[splineOffset + 2];
+    uint32_t flags = words[splineOffset + 3];
+    float maxT = readFloat(splineOffset + 4);
+    uint32_t knotOffset = words[splineOffset + 5];
+
+    if(flags & Looping)
+    {
+        t = t - maxT * std::floor(t / maxT);
+    }
+
+    //binary search for the last knot at or before t, clamped to a valid segment
+    uint32_t low = 0;
+    uint32_t high = segmentCount - 1;
+    while(low < high)
+    {
+        uint32_t middle = (low + high + 1) / 2;
+        if(readFloat(knotOffset + middle) <= t)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    s = t - readFloat(knotOffset + low);
+    return low;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+std::array<float, 4> SplineGpuBuffer<InterpolationType, floating_t, dimension>::evaluatePosition(uint32_t splineOffset, float t) const
+{
+    uint32_t degree = words[splineOffset + 1];
+    uint32_t coefficientOffset = words[splineOffset + 6];
+
+    float s;
+    uint32_t segmentIndex = findSegment(splineOffset, t, s);
+    uint32_t base = coefficientOffset + 4 * segmentIndex * (degree + 1);
+
+    std::array<float, 4> result = {{ 0, 0, 0, 0 }};
+    for(uint32_t k = degree + 1; k-- > 0;)
+    {
+        for(size_t c = 0; c < 4; c++)
+        {
+            result[c] = result[c] * s + readFloat(base + 4 * k + c);
+        }
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t dimension>
+std::array<float, 4> SplineGpuBuffer<InterpolationType, floating_t, dimension>::evaluateTangent(uint32_t splineOffset, float t) const
+{
+    uint32_t degree = words[splineOffset + 1];
+    uint32_t coefficientOffset = words[splineOffset + 6];
+
+    float s;
+    uint32_t segmentIndex = findSegment(splineOffset, t, s);
+    uint32_t base = coefficientOffset + 4 * segmentIndex * (degree + 1);
+
+    std::array<float, 4> result = {{ 0, 0, 0, 0 }};
+    for(uint32_t k = degree; k > 0; k--)
+    {
+        for(size_t c = 0; c < 4; c++)
+        {
+            result[c] = result[c] * s + float(k) * readFloat(base + 4 * k + c);
+        }
+    }
+    return result;
+}
@@ -2,77 +2,525 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <limits>
 
 #include <boost/math/tools/minima.hpp>
 
 #include "../spline.h"
+#include "splinecursor.h"
 #include "splinesample_adaptor.h"
+#include "workstealing.h"
 
-template<class InterpolationType, typename floating_t=float, size_t sampleDimension=2>
+//shared with DynamicSplineInverter
+namespace __SplineInverterPrivate
+{
+    //the samples are stored as arrays of floating_t, so that nanoflann can index them
+    template<typename floating_t, size_t sampleDimension, class InterpolationType>
+    std::array<floating_t, sampleDimension> convertPoint(const InterpolationType &p)
+    {
+        std::array<floating_t, sampleDimension> result;
+        for(size_t i = 0; i < sampleDimension; i++) {
+            result[i] = p[i];
+        }
+        return result;
+    }
+
+    //use brent's method to find the T between a and b where distanceSquared(t) is smallest. a and b are the neighbors of the closest sample,
+    //which are close enough together that 16 bits of precision is plenty. brent's method evaluates the distance once per iteration, plus a single evaluation to get started
+    template<typename floating_t, class DistanceFunction>
+    floating_t refineBrent(const DistanceFunction &distanceSquared, floating_t a, floating_t b)
+    {
+        auto countedDistance = [&distanceSquared](floating_t t) {
+            SPLINE_INSTRUMENT_COUNT(BrentIterations);
+            return distanceSquared(t);
+        };
+        return boost::math::tools::brent_find_minima(countedDistance, a, b, 16).first;
+    }
+
+    //wrap t if the spline is looping, and step segment to the segment containing it. returns the wrapped t
+    //refinement never leaves the neighboring samples of the closest sample, so this is only ever a step or two, instead of a full segment search
+    template<class SplineType, typename floating_t>
+    floating_t seekSegment(const SplineType &spline, floating_t t, size_t &segment)
+    {
+        //the bracket of a looping spline's first or last sample extends past the end of the spline, so those T values wrap to the other end
+        if(spline.isLooping())
+        {
+            floating_t maxT = spline.getMaxT();
+            if(t < 0)
+            {
+                t += maxT;
+                segment = spline.segmentCount() - 1;
+            }
+            else if(t >= maxT)
+            {
+                t -= maxT;
+                segment = 0;
+            }
+        }
+
+        //each segment covers the half-open range [begin, end), except for the last one, which also covers maxT
+        while(segment > 0 && t < spline.segmentT(segment))
+            segment--;
+        while(segment + 1 < spline.segmentCount() && t >= spline.segmentT(segment + 1))
+            segment++;
+
+        return t;
+    }
+}
+
+//if SplineType is a concrete spline class like UniformCRSpline instead of the Spline base class, every call to the spline is resolved at compile time and can be inlined
+template<class InterpolationType, typename floating_t=float, size_t sampleDimension=2, class SplineType=Spline<InterpolationType, floating_t>>
 class SplineInverter
 {
 public:
-    SplineInverter(const Spline<InterpolationType, floating_t> &spline, int samplesPerT = 10);
+    //the method used to refine the closest sample into the actual closest T
+    enum class RefinementMethod
+    {
+        //brent's method on the squared distance to the query point. only evaluates positions
+        Brent,
+
+        //newton's method on the derivative of the squared distance, which uses the spline's tangent and curvature
+        //usually converges in 2-3 iterations. steps that would leave the bracket around the closest sample are replaced by bisection,
+        //and if it still fails to converge, brent's method is used instead
+        Newton
+    };
+
+    //the method used to place the samples that the query points are compared against
+    enum class SamplingMethod
+    {
+        //samplesPerT samples in every unit of T, regardless of the shape of the spline
+        Uniform,
+
+        //samples are placed by arc length and curvature: the straight-line distance between samples is at most twice the average distance between
+        //uniform samples with the same samplesPerT, and the tangent turns by at most about 30 degrees between samples
+        //long, straight segments get fewer samples, and tight curves get more
+        Adaptive
+    };
+
+    SplineInverter(const SplineType &spline, int samplesPerT = 10,
+                   RefinementMethod refinement = RefinementMethod::Brent, SamplingMethod sampling = SamplingMethod::Uniform);
 
     floating_t findClosestT(const InterpolationType &queryPoint) const;
 
+    //find the closest T for each of the query points, and write them to the corresponding element of output
+    //queries are processed in spatially coherent tiles, and each query's closest sample is used to speed up the search for the next query in the tile
+    //if threadCount is greater than 1, the tiles are split between that many threads. if threadCount is 0, one thread per hardware thread is used
+    void findClosestT(const InterpolationType *queryPoints, size_t count, floating_t *output, size_t threadCount = 1) const;
+
+    //find every part of the spline within radius of the query point, and return the closest T of each part, sorted by T
+    //each part is a local minimum of the distance to the query point, so a spline that passes near the query point several times returns one T per pass
+    std::vector<floating_t> findAllWithin(const InterpolationType &queryPoint, floating_t radius) const;
+
+    //find the k parts of the spline closest to the query point, and return the closest T of each part, closest first
+    //like findAllWithin, each part is a local minimum of the distance, so for a self-intersecting spline, every branch near the query point gets its own T
+    std::vector<floating_t> findKClosest(const InterpolationType &queryPoint, size_t k) const;
+
+    size_t sampleCount(void) const { return sampleTree.sampleCount(); }
+
+    //for callers that find the closest sample some other way, IE DistanceField, which compares each pixel against a short list of candidate samples instead of searching the whole tree
+    const SplineSampleTree<sampleDimension, floating_t> &getSampleTree(void) const { return sampleTree; }
+
+    //given the closest sample to the query point, refine it to find the actual closest T
+    //with newton refinement, the iteration starts at startT instead of the sample's T, if startT is between the sample's neighbors: IE the result of a neighboring query
+    floating_t refineClosestT(const InterpolationType &queryPoint, size_t closestSample, floating_t startT) const;
+
+    //memory used by the samples and the tree that indexes them, in bytes
+    size_t usedMemory(void) const { return sampleTree.usedMemory(); }
+
 private: //methods
-    SplineSamples<sampleDimension, floating_t> makeSplineSamples(int samplesPerT) const;
+    floating_t refineClosestT(const InterpolationType &queryPoint, size_t closestSample) const { return refineClosestT(queryPoint, closestSample, sampleTree.sampleT(closestSample)); }
+
+    //run newton's method (safeguarded by bisection) starting at startT, and write the result to result. returns false if it failed to converge inside [a, b]
+    //segment is the segment of the closest sample, which is where the search for each iteration's segment begins
+    bool refineNewton(const InterpolationType &queryPoint, floating_t startT, floating_t a, floating_t b, size_t segment, floating_t &result) const;
+
+    //see __SplineInverterPrivate::seekSegment
+    floating_t seekSegment(floating_t t, size_t &segment) const;
+
+    //true if the given sample is closer to the query point than the samples on either side of it. a run of samples at the same distance is only counted once
+    //samples are sorted by T, so the neighboring samples are the neighboring entries in the sample list, wrapping around if the spline is looping
+    bool isLocalMinimum(const std::array<floating_t, sampleDimension> &convertedQueryPoint, size_t sampleIndex) const;
+
+    //sort the query points into tiles, and return the indexes of the query points in tile order
+    std::vector<size_t> computeTileOrder(const InterpolationType *queryPoints, size_t count) const;
 
-    static std::array<floating_t, sampleDimension> convertPoint(const InterpolationType &p);
+    SplineSamples<sampleDimension, floating_t> makeSplineSamples(int samplesPerT, SamplingMethod sampling) const;
+    SplineSamples<sampleDimension, floating_t> makeUniformSamples(int samplesPerT) const;
+    SplineSamples<sampleDimension, floating_t> makeAdaptiveSamples(int samplesPerT) const;
+
+    static std::array<floating_t, sampleDimension> convertPoint(const InterpolationType &p) { return __SplineInverterPrivate::convertPoint<floating_t, sampleDimension>(p); }
 
 private: //data
-    const Spline<InterpolationType, floating_t> &spline;
+    const SplineType &spline;
 
-    //distance in t between samples
-    floating_t sampleStep;
+    RefinementMethod refinement;
 
     SplineSampleTree<sampleDimension, floating_t> sampleTree;
 };
 
-template<class InterpolationType, typename floating_t, size_t sampleDimension>
-SplineInverter<InterpolationType, floating_t, sampleDimension>::SplineInverter(
-        const Spline<InterpolationType, floating_t> &spline,
-        int samplesPerT)
-    :spline(spline), sampleStep(1.0 / samplesPerT), sampleTree(makeSplineSamples(samplesPerT))
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::SplineInverter(
+        const SplineType &spline,
+        int samplesPerT,
+        RefinementMethod refinement,
+        SamplingMethod sampling)
+    :spline(spline), refinement(refinement), sampleTree(makeSplineSamples(samplesPerT, sampling))
 {
 
 }
 
-template<class InterpolationType, typename floating_t, size_t sampleDimension>
-SplineSamples<sampleDimension, floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension>::makeSplineSamples(int samplesPerT) const
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+SplineSamples<sampleDimension, floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::makeSplineSamples(int samplesPerT, SamplingMethod sampling) const
+{
+    if(sampling == SamplingMethod::Adaptive)
+        return makeAdaptiveSamples(samplesPerT);
+    else
+        return makeUniformSamples(samplesPerT);
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+SplineSamples<sampleDimension, floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::makeUniformSamples(int samplesPerT) const
 {
     SplineSamples<sampleDimension, floating_t> samples;
     floating_t maxT = spline.getMaxT();
+    floating_t sampleStep = floating_t(1.0 / samplesPerT);
 
     //find the number of segments we're going to use
     int numSegments = std::round(maxT * samplesPerT);
 
+    //the samples are sorted by T, so use a cursor to avoid searching for each sample's segment
+    SplineCursor<InterpolationType, floating_t, SplineType> cursor(spline);
+
     for(int i = 0; i < numSegments; i++)
     {
         floating_t currentT = i * sampleStep;
-        auto sampledPoint = convertPoint(spline.getPosition(currentT));
-        samples.pts.emplace_back(sampledPoint, currentT);
+        auto sampledPoint = convertPoint(cursor.getPosition(currentT));
+        samples.pts.emplace_back(sampledPoint, currentT, cursor.currentSegment());
     }
 
     //if the spline isn't a loop, add a sample for maxT
     if(!spline.isLooping())
     {
-        auto sampledPoint = convertPoint(spline.getPosition(maxT));
-        samples.pts.emplace_back(sampledPoint, maxT);
+        auto sampledPoint = convertPoint(cursor.getPosition(maxT));
+        samples.pts.emplace_back(sampledPoint, maxT, cursor.currentSegment());
     }
 
     return samples;
 }
 
-template<class InterpolationType, typename floating_t, size_t sampleDimension>
-floating_t SplineInverter<InterpolationType, floating_t, sampleDimension>::findClosestT(const InterpolationType &queryPoint) const
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+SplineSamples<sampleDimension, floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::makeAdaptiveSamples(int samplesPerT) const
+{
+    SplineSamples<sampleDimension, floating_t> samples;
+    floating_t maxT = spline.getMaxT();
+
+    //the largest allowed distance between samples is twice the average distance between samples in uniform mode
+    //uniform sampling needs its density for the tight curves, but with the curvature limit below, the straight parts can get by with far fewer
+    const floating_t maxSpacing = 2 * spline.totalLength() / (maxT * samplesPerT);
+
+    //the largest allowed turn of the tangent between samples (about 30 degrees). expressed as the cosine of the angle, since that's what a dot product gives us
+    const floating_t minCosine = floating_t(std::cos(0.5));
+
+    //don't subdivide any interval more than this many times, in case the spline has a cusp or a zero-length tangent
+    const int maxDepth = 16;
+
+    struct Interval
+    {
+        floating_t t;
+        InterpolationType position;
+        InterpolationType tangent;
+        int depth;
+    };
+
+    auto makeInterval = [this](size_t segmentIndex, floating_t t, int depth) {
+        auto result = spline.segmentTangent(segmentIndex, t);
+        return Interval{t, result.position, result.tangent, depth};
+    };
+
+    //every segment boundary is a sample, and each segment is subdivided until its samples are close enough together, and the tangent doesn't turn too far between them
+    std::vector<Interval> stack;
+    for(size_t segmentIndex = 0; segmentIndex < spline.segmentCount(); segmentIndex++)
+    {
+        Interval begin = makeInterval(segmentIndex, spline.segmentT(segmentIndex), 0);
+        stack.push_back(makeInterval(segmentIndex, spline.segmentT(segmentIndex + 1), 0));
+
+        while(!stack.empty())
+        {
+            Interval end = stack.back();
+
+            floating_t tangentLengths = begin.tangent.length() * end.tangent.length();
+            floating_t cosine = tangentLengths > 0 ? InterpolationType::dotProduct(begin.tangent, end.tangent) / tangentLengths : 1;
+            bool tooFar = (end.position - begin.position).length() > maxSpacing;
+            bool tooCurved = cosine < minCosine;
+
+            int depth = std::max(begin.depth, end.depth);
+            if((tooFar || tooCurved) && depth < maxDepth)
+            {
+                stack.push_back(makeInterval(segmentIndex, (begin.t + end.t) / 2, depth + 1));
+            }
+            else
+            {
+                samples.pts.emplace_back(convertPoint(begin.position), begin.t, segmentIndex);
+                begin = end;
+                stack.pop_back();
+            }
+        }
+    }
+
+    //if the spline isn't a loop, add a sample for maxT
+    if(!spline.isLooping())
+    {
+        size_t lastSegment = spline.segmentCount() - 1;
+        samples.pts.emplace_back(convertPoint(spline.segmentPosition(lastSegment, maxT)), maxT, lastSegment);
+    }
+
+    //we didn't know how many samples there would be ahead of time, so free the excess capacity
+    samples.pts.shrink_to_fit();
+
+    return samples;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::findClosestT(const InterpolationType &queryPoint) const
+{
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    auto convertedQueryPoint = convertPoint(queryPoint);
+    size_t closestSample = sampleTree.findClosestSampleIndex(convertedQueryPoint);
+    return refineClosestT(queryPoint, closestSample);
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+void SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::findClosestT(
+        const InterpolationType *queryPoints, size_t count, floating_t *output, size_t threadCount) const
+{
+    if(count == 0)
+        return;
+
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    std::vector<size_t> order = computeTileOrder(queryPoints, count);
+
+    //the tree and spline are never modified after construction, so any number of threads can search them at once
+    //the threads take contiguous runs of the tile order, so that the queries in each run are still spatially coherent
+    auto processRange = [this, queryPoints, output, &order](size_t begin, size_t end, size_t) {
+        size_t previousSample = 0;
+        for(size_t i = begin; i < end; i++)
+        {
+            size_t queryIndex = order[i];
+            auto convertedQueryPoint = convertPoint(queryPoints[queryIndex]);
+
+            //the previous query is nearby, so its closest sample is a good hint for this one
+            size_t closestSample;
+            if(i == begin)
+                closestSample = sampleTree.findClosestSampleIndex(convertedQueryPoint);
+            else
+                closestSample = sampleTree.findClosestSampleIndex(convertedQueryPoint, previousSample);
+            previousSample = closestSample;
+
+            output[queryIndex] = refineClosestT(queryPoints[queryIndex], closestSample);
+        }
+    };
+
+    //queries near complicated parts of the spline take longer, so hand the runs out with work stealing rather than splitting them evenly up front
+    //each run restarts the closest-sample hint, so the runs are long enough that the restart doesn't matter
+    const size_t runLength = 256;
+    SplineParallel::workStealingForRanges(count, runLength, threadCount, processRange);
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+std::vector<floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::findAllWithin(const InterpolationType &queryPoint, floating_t radius) const
+{
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    auto convertedQueryPoint = convertPoint(queryPoint);
+    std::vector<size_t> candidates;
+    sampleTree.findSamplesWithin(convertedQueryPoint, radius, candidates);
+
+    //each run of samples inside the radius is a part of the spline, but a run can have several local minima if it curves around the query point
+    //so instead of grouping the candidates into runs, refine every candidate that's a local minimum
+    std::vector<floating_t> result;
+    for(size_t sample : candidates)
+    {
+        if(isLocalMinimum(convertedQueryPoint, sample))
+        {
+            floating_t t = refineClosestT(queryPoint, sample);
+            if((spline.getPosition(t) - queryPoint).lengthSquared() <= radius * radius)
+                result.push_back(t);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+std::vector<floating_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::findKClosest(const InterpolationType &queryPoint, size_t k) const
 {
+    SPLINE_INSTRUMENT_TIMER(FindClosestT);
+
+    if(k == 0)
+        return std::vector<floating_t>();
+
+    //most of the closest samples are neighbors of the closest local minima, so search for a few samples per minimum,
+    //and double the search until it finds k minima. any closer minimum would have been one of the samples searched, so these are the k closest
     auto convertedQueryPoint = convertPoint(queryPoint);
-    floating_t closestSampleT = sampleTree.findClosestSample(convertedQueryPoint);
+    std::vector<size_t> candidates;
+    std::vector<size_t> minima;
+    size_t searchCount = std::min(sampleTree.sampleCount(), k * 4);
+    while(true)
+    {
+        candidates.clear();
+        sampleTree.findClosestSampleIndices(convertedQueryPoint, searchCount, candidates);
+
+        minima.clear();
+        for(size_t sample : candidates)
+        {
+            if(isLocalMinimum(convertedQueryPoint, sample))
+                minima.push_back(sample);
+        }
+
+        if(minima.size() >= k || searchCount == sampleTree.sampleCount())
+            break;
+        searchCount = std::min(sampleTree.sampleCount(), searchCount * 2);
+    }
+
+    //if every sample is the same distance away (IE the query point is the center of a circle), there's no local minimum, so fall back to the closest sample
+    if(minima.empty())
+        minima.push_back(candidates.front());
+
+    //refining can change the order of minima that are almost the same distance away, so refine all of them before sorting
+    std::vector<std::pair<floating_t, floating_t>> refined;
+    for(size_t sample : minima)
+    {
+        floating_t t = refineClosestT(queryPoint, sample);
+        refined.emplace_back((spline.getPosition(t) - queryPoint).lengthSquared(), t);
+    }
+    std::sort(refined.begin(), refined.end());
+
+    std::vector<floating_t> result;
+    for(size_t i = 0; i < std::min(k, refined.size()); i++)
+    {
+        result.push_back(refined[i].second);
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+bool SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::isLocalMinimum(const std::array<floating_t, sampleDimension> &convertedQueryPoint, size_t sampleIndex) const
+{
+    auto distanceSquared = [&convertedQueryPoint, this](size_t index) {
+        const auto &position = sampleTree.samplePosition(index);
+        floating_t sum = 0;
+        for(size_t d = 0; d < sampleDimension; d++)
+        {
+            floating_t diff = position[d] - convertedQueryPoint[d];
+            sum += diff * diff;
+        }
+        return sum;
+    };
+
+    size_t lastSample = sampleTree.sampleCount() - 1;
+    floating_t sampleDistance = distanceSquared(sampleIndex);
+
+    //ties are broken towards the earlier sample: it has to be strictly closer than the previous sample, but only as close as the next one
+    if(sampleIndex > 0)
+    {
+        if(distanceSquared(sampleIndex - 1) <= sampleDistance)
+            return false;
+    }
+    else if(spline.isLooping() && lastSample > 0)
+    {
+        if(distanceSquared(lastSample) <= sampleDistance)
+            return false;
+    }
+
+    if(sampleIndex < lastSample)
+    {
+        if(distanceSquared(sampleIndex + 1) < sampleDistance)
+            return false;
+    }
+    else if(spline.isLooping() && lastSample > 0)
+    {
+        if(distanceSquared(0) < sampleDistance)
+            return false;
+    }
+
+    return true;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+std::vector<size_t> SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::computeTileOrder(const InterpolationType *queryPoints, size_t count) const
+{
+    //tiles are formed from (at most) the first two dimensions of the query points
+    const size_t tileDimension = std::min(sampleDimension, size_t(2));
+
+    //find the bounding box of the query points
+    std::array<floating_t, 2> minimum, maximum;
+    for(size_t d = 0; d < tileDimension; d++)
+    {
+        minimum[d] = maximum[d] = queryPoints[0][d];
+    }
+    for(size_t i = 1; i < count; i++)
+    {
+        for(size_t d = 0; d < tileDimension; d++)
+        {
+            minimum[d] = std::min(minimum[d], floating_t(queryPoints[i][d]));
+            maximum[d] = std::max(maximum[d], floating_t(queryPoints[i][d]));
+        }
+    }
+
+    //divide the bounding box into a grid with roughly 64 query points per tile
+    const size_t pointsPerTile = 64;
+    size_t tilesPerRow = std::max(size_t(1), size_t(std::sqrt(floating_t(count) / pointsPerTile)));
+    std::array<floating_t, 2> tileScale;
+    for(size_t d = 0; d < tileDimension; d++)
+    {
+        floating_t extent = maximum[d] - minimum[d];
+        tileScale[d] = extent > 0 ? tilesPerRow / extent : 0;
+    }
+
+    std::vector<size_t> tiles(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t tile = 0;
+        for(size_t d = 0; d < tileDimension; d++)
+        {
+            size_t cell = std::min(tilesPerRow - 1, size_t((queryPoints[i][d] - minimum[d]) * tileScale[d]));
+            tile = tile * tilesPerRow + cell;
+        }
+        tiles[i] = tile;
+    }
+
+    //counting sort the query points by tile. this keeps the original order within each tile,
+    //since callers often provide queries in a coherent order already (IE scanlines of an image)
+    size_t tileCount = tileDimension == 2 ? tilesPerRow * tilesPerRow : tilesPerRow;
+    std::vector<size_t> tileOffsets(tileCount + 1, 0);
+    for(size_t i = 0; i < count; i++)
+    {
+        tileOffsets[tiles[i] + 1]++;
+    }
+    std::partial_sum(tileOffsets.begin(), tileOffsets.end(), tileOffsets.begin());
+
+    std::vector<size_t> order(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        order[tileOffsets[tiles[i]]++] = i;
+    }
+    return order;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::refineClosestT(const InterpolationType &queryPoint, size_t closestSample, floating_t startT) const
+{
+    floating_t closestSampleT = sampleTree.sampleT(closestSample);
+    size_t closestSegment = sampleTree.sampleSegment(closestSample);
 
     //compute the first derivative of distance to spline at the sample point
-    auto sampleResult = spline.getTangent(closestSampleT);
+    auto sampleResult = spline.template segmentEvaluate<SplineDerivatives::Position | SplineDerivatives::Tangent>(closestSegment, closestSampleT);
     InterpolationType sampleDisplacement = sampleResult.position - queryPoint;
     floating_t sampleDistanceSlope = InterpolationType::dotProduct(sampleDisplacement.normalized(), sampleResult.tangent);
 
@@ -94,34 +542,114 @@ floating_t SplineInverter<InterpolationType, floating_t, sampleDimension>::findC
     //note: this assumption is only true if the samples are close together
 
     //if sample distance slope is positive we want to move backwards in t, otherwise forwards
+    //samples aren't necessarily evenly spaced, so the bracket extends to the neighboring sample in each direction
+    //the samples are sorted by T, so the neighboring samples are the neighboring entries in the sample list
+    size_t lastSample = sampleTree.sampleCount() - 1;
     floating_t a, b;
     if(sampleDistanceSlope > 0)
     {
-        a = closestSampleT - sampleStep;
+        if(closestSample > 0)
+            a = sampleTree.sampleT(closestSample - 1);
+        else
+            a = sampleTree.sampleT(lastSample) - spline.getMaxT(); //only reachable for looping splines
+
         b = closestSampleT;
     }
     else
     {
         a = closestSampleT;
-        b = closestSampleT + sampleStep;
-    }
 
-    auto distanceFunction = [this, queryPoint](floating_t t) {
-        return (spline.getPosition(t) - queryPoint).lengthSquared();
-    };
+        if(closestSample < lastSample)
+            b = sampleTree.sampleT(closestSample + 1);
+        else
+            b = spline.getMaxT(); //only reachable for looping splines. the next sample is the first one, which is at maxT after wrapping
+    }
 
     //we know that the actual closest T is now between a and b
+    if(refinement == RefinementMethod::Newton)
+    {
+        if(startT < a || startT > b)
+            startT = closestSampleT;
+
+        floating_t result;
+        if(refineNewton(queryPoint, startT, a, b, closestSegment, result))
+            return result;
+    }
+
     //use brent's method to find the actual closest point, using a and b as bounds
-    auto result = boost::math::tools::brent_find_minima(distanceFunction, a, b, 16);
-    return result.first;
+    size_t segment = closestSegment;
+    auto distanceFunction = [this, queryPoint, &segment](floating_t t) {
+        floating_t localT = seekSegment(t, segment);
+        return (spline.segmentPosition(segment, localT) - queryPoint).lengthSquared();
+    };
+    return __SplineInverterPrivate::refineBrent(distanceFunction, a, b);
 }
 
-template<class InterpolationType, typename floating_t, size_t sampleDimension>
-std::array<floating_t, sampleDimension> SplineInverter<InterpolationType, floating_t, sampleDimension>::convertPoint(const InterpolationType &p)
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+bool SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::refineNewton(
+        const InterpolationType &queryPoint, floating_t startT, floating_t a, floating_t b, size_t segment, floating_t &result) const
 {
-    std::array<floating_t, sampleDimension> result;
-    for(size_t i = 0; i < sampleDimension; i++) {
-        result[i] = p[i];
+    //the closest point is where the derivative of the squared distance is zero. we'll leave off the factor of 2 since it cancels out
+    //f(t) = dot(position - queryPoint, tangent)
+    //f'(t) = dot(tangent, tangent) + dot(position - queryPoint, curvature)
+    //so a single evaluation of the position, tangent, and curvature gives us everything we need for each iteration
+    const int maxIterations = 16;
+
+    //stop once the steps are smaller than the 16 bits of precision brent's method is asked for
+    //newton's method converges quadratically, so by then the result is already much more precise than that
+    const floating_t tolerance = std::ldexp(floating_t(1), -16);
+
+    //f is negative before the closest point and positive after it, so every evaluation of f also narrows down the bracket
+    //if a newton step would leave the bracket, or the distance function isn't convex at t (so newton's method could walk towards a maximum), bisect instead
+    floating_t t = startT;
+    for(int i = 0; i < maxIterations; i++)
+    {
+        SPLINE_INSTRUMENT_COUNT(NewtonIterations);
+
+        floating_t localT = seekSegment(t, segment);
+        auto interpolationResult = spline.template segmentEvaluate<SplineDerivatives::Position | SplineDerivatives::Tangent | SplineDerivatives::Curvature>(segment, localT);
+        InterpolationType displacement = interpolationResult.position - queryPoint;
+
+        floating_t slope = InterpolationType::dotProduct(displacement, interpolationResult.tangent);
+        floating_t secondDerivative = InterpolationType::dotProduct(interpolationResult.tangent, interpolationResult.tangent)
+                + InterpolationType::dotProduct(displacement, interpolationResult.curvature);
+
+        if(slope > 0)
+            b = t;
+        else
+            a = t;
+
+        floating_t scale = std::max(floating_t(1), std::abs(t));
+        floating_t nextT = t - slope / secondDerivative;
+        if(secondDerivative > 0 && nextT >= a && nextT <= b)
+        {
+            floating_t step = nextT - t;
+            t = nextT;
+
+            if(std::abs(step) <= tolerance * scale)
+            {
+                result = t;
+                return true;
+            }
+        }
+        else
+        {
+            //bisection only converges linearly, so it's only done once the bracket itself is as small as floating_t can resolve
+            t = (a + b) / 2;
+
+            if(b - a <= std::numeric_limits<floating_t>::epsilon() * 16 * scale)
+            {
+                result = t;
+                return true;
+            }
+        }
     }
-    return result;
+
+    return false;
+}
+
+template<class InterpolationType, typename floating_t, size_t sampleDimension, class SplineType>
+floating_t SplineInverter<InterpolationType, floating_t, sampleDimension, SplineType>::seekSegment(floating_t t, size_t &segment) const
+{
+    return __SplineInverterPrivate::seekSegment(spline, t, segment);
 }
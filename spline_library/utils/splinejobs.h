@@ -0,0 +1,510 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <exception>
+#include <algorithm>
+
+#include "../spline.h"
+#include "arclength.h"
+#include "splineinverter.h"
+
+//long operations, like building a spline from millions of points, partitioning a very long spline, or building an inverter, block the thread that calls them
+//the functions in SplineJobs start them as jobs instead: the work is handed to an executor as tasks, and the caller immediately gets a Job, which holds a future for the result
+//jobs can be cancelled, and report their progress as their tasks finish
+//
+//the spline passed to a job is used by reference, so it must outlive the job. cancelling doesn't interrupt tasks that are already running, so wait() for the job even after cancelling it
+namespace SplineJobs
+{
+    //runs a task, on any thread, at any time, IE a thread pool's submit method or an event loop's post method. every task must eventually run, because a job finishes when its last task does
+    typedef std::function<void(std::function<void(void)>)> Executor;
+
+    //called with the fraction of the job that's done, in [0, 1], each time a task finishes. calls are never concurrent and the fraction never decreases,
+    //but they come from the executor's threads
+    typedef std::function<void(float)> ProgressCallback;
+
+    struct JobOptions
+    {
+        //the number of segments or piece boundaries handled by each task of a chunked job. smaller chunks notice cancellation and report progress sooner,
+        //and spread out better across the executor's threads, but each chunk is a separate task. only partition and partitionN are chunked: see build and makeInverter
+        size_t chunkSize = 1024;
+
+        ProgressCallback progress;
+    };
+
+    //run every task immediately, on the thread that submits it. a job started with this executor has finished by the time the function that starts it returns
+    inline Executor inlineExecutor(void)
+    {
+        return [](std::function<void(void)> task) { task(); };
+    }
+
+    //a fixed set of threads that run tasks in the order they were submitted. the pool must outlive every job that uses its executor
+    //the destructor runs every task that's still queued, including tasks submitted by those tasks, before joining the threads
+    class ThreadPool
+    {
+    public:
+        //if threadCount is 0, one thread per hardware thread is used
+        explicit ThreadPool(size_t threadCount = 0);
+        ~ThreadPool(void);
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        void submit(std::function<void(void)> task);
+        Executor executor(void) { return [this](std::function<void(void)> task) { submit(std::move(task)); }; }
+
+        size_t threadCount(void) const { return threads.size(); }
+
+    private:
+        void workerLoop(void);
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<std::function<void(void)>> tasks;
+        bool stopping = false;
+
+        std::vector<std::thread> threads;
+    };
+}
+
+namespace __SplineJobsPrivate
+{
+    //one step of a job. prepare runs first, by itself, and returns the number of chunks. then runChunk is called once for each chunk index, possibly in parallel
+    //if prepare is empty, the stage has a single chunk
+    struct Stage
+    {
+        std::function<size_t(void)> prepare;
+        std::function<void(size_t)> runChunk;
+    };
+
+    //runs a job's stages one after the other on the executor. the last chunk of each stage to finish starts the next stage,
+    //so nothing ever blocks waiting for a stage to finish. the state is shared by every queued task, so it lives until the last of them has run
+    class JobStateBase : public std::enable_shared_from_this<JobStateBase>
+    {
+    public:
+        JobStateBase(SplineJobs::Executor executor, std::vector<Stage> stages, SplineJobs::ProgressCallback progressCallback)
+            :executor(std::move(executor)), stages(std::move(stages)), progressCallback(std::move(progressCallback))
+        {}
+        virtual ~JobStateBase(void) = default;
+
+        void start(void)
+        {
+            auto self = shared_from_this();
+            executor([self]() { self->startStage(0); });
+        }
+
+        void cancel(void) { cancelled = true; }
+        bool isCancelled(void) const { return cancelled; }
+        float progress(void) const { return currentProgress; }
+
+    protected:
+        //called exactly once, after the last stage, or as soon as the job is cancelled between stages. error is null unless a task threw an exception
+        virtual void finish(std::exception_ptr error) = 0;
+
+    private:
+        void startStage(size_t stageIndex)
+        {
+            if(cancelled || stageIndex == stages.size())
+            {
+                complete();
+                return;
+            }
+
+            size_t chunkCount = 1;
+            if(stages[stageIndex].prepare)
+            {
+                try
+                {
+                    chunkCount = stages[stageIndex].prepare();
+                }
+                catch(...)
+                {
+                    recordError(std::current_exception());
+                    complete();
+                    return;
+                }
+            }
+
+            if(chunkCount == 0)
+            {
+                startStage(stageIndex + 1);
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(progressMutex);
+                stageChunkCount = chunkCount;
+                finishedChunks = 0;
+            }
+            remainingChunks = chunkCount;
+
+            auto self = shared_from_this();
+            for(size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                executor([self, stageIndex, chunk]() { self->runChunk(stageIndex, chunk); });
+            }
+        }
+
+        void runChunk(size_t stageIndex, size_t chunk)
+        {
+            //once the job is cancelled, the remaining chunks are skipped, but they still count down so that the job can finish
+            if(!cancelled)
+            {
+                try
+                {
+                    stages[stageIndex].runChunk(chunk);
+                }
+                catch(...)
+                {
+                    recordError(std::current_exception());
+                }
+            }
+
+            reportProgress(stageIndex);
+
+            if(remainingChunks.fetch_sub(1) == 1)
+                startStage(stageIndex + 1);
+        }
+
+        void reportProgress(size_t stageIndex)
+        {
+            //each stage counts as an equal share of the job
+            std::lock_guard<std::mutex> lock(progressMutex);
+            finishedChunks++;
+            currentProgress = (stageIndex + float(finishedChunks) / stageChunkCount) / stages.size();
+
+            if(progressCallback)
+                progressCallback(currentProgress);
+        }
+
+        void recordError(std::exception_ptr exception)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if(!error)
+                error = exception;
+            cancelled = true;
+        }
+
+        void complete(void)
+        {
+            std::exception_ptr finalError;
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                finalError = error;
+            }
+            finish(finalError);
+
+            //every task has run by now, so the stages and anything they hold on to can be released, even if the Job object is kept around
+            stages.clear();
+        }
+
+    private:
+        SplineJobs::Executor executor;
+        std::vector<Stage> stages;
+        SplineJobs::ProgressCallback progressCallback;
+
+        std::atomic<bool> cancelled{false};
+        std::atomic<size_t> remainingChunks{0};
+        std::atomic<float> currentProgress{0};
+
+        //guards the chunk counts of the current stage, and serializes calls to the progress callback
+        std::mutex progressMutex;
+        size_t stageChunkCount = 0;
+        size_t finishedChunks = 0;
+
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    template<class Result>
+    class JobState : public JobStateBase
+    {
+    public:
+        JobState(SplineJobs::Executor executor, std::vector<Stage> stages, std::function<Result(void)> makeResult, SplineJobs::ProgressCallback progressCallback)
+            :JobStateBase(std::move(executor), std::move(stages), std::move(progressCallback)), makeResult(std::move(makeResult))
+        {}
+
+        std::future<Result> getFuture(void) { return promise.get_future(); }
+
+    protected:
+        void finish(std::exception_ptr error) override
+        {
+            if(error)
+            {
+                promise.set_exception(error);
+            }
+            else if(isCancelled())
+            {
+                promise.set_value(Result());
+            }
+            else
+            {
+                try
+                {
+                    promise.set_value(makeResult());
+                }
+                catch(...)
+                {
+                    promise.set_exception(std::current_exception());
+                }
+            }
+            makeResult = nullptr;
+        }
+
+    private:
+        std::promise<Result> promise;
+        std::function<Result(void)> makeResult;
+    };
+
+    inline size_t chunksFor(size_t count, size_t chunkSize)
+    {
+        return (count + chunkSize - 1) / chunkSize;
+    }
+}
+
+namespace SplineJobs
+{
+    //a handle to a running job. destroying it doesn't cancel the job or wait for it
+    template<class Result>
+    class Job
+    {
+    public:
+        Job(void) = default;
+        Job(std::shared_ptr<__SplineJobsPrivate::JobStateBase> state, std::future<Result> future)
+            :state(std::move(state)), future(std::move(future))
+        {}
+
+        //wait for the job to finish, and return its result. if the job was cancelled, the result is default-constructed, IE an empty list or a null pointer
+        //if one of the job's tasks threw an exception, it's rethrown here. like std::future::get, this can only be called once
+        Result get(void) { return future.get(); }
+
+        void wait(void) const { future.wait(); }
+
+        //returns true if the job finished within the timeout
+        template<class Rep, class Period>
+        bool waitFor(const std::chrono::duration<Rep, Period> &timeout) const { return future.wait_for(timeout) == std::future_status::ready; }
+
+        bool isReady(void) const { return waitFor(std::chrono::seconds(0)); }
+
+        //stop the job as soon as possible. tasks that haven't started yet do nothing, but tasks that are already running finish first
+        //a job whose task threw an exception is also cancelled
+        void cancel(void) { state->cancel(); }
+        bool isCancelled(void) const { return state->isCancelled(); }
+
+        //the fraction of the job that's done, in [0, 1]
+        float progress(void) const { return state->progress(); }
+
+        //the future itself, for code that already works with std::future. after this, get() and wait() can't be used
+        std::future<Result> takeFuture(void) { return std::move(future); }
+
+    private:
+        std::shared_ptr<__SplineJobsPrivate::JobStateBase> state;
+        std::future<Result> future;
+    };
+
+    //run any function as a single task, IE to build something that doesn't have its own function below. Result must be default-constructible, for when the job is cancelled
+    //cancelling only helps before the task starts, and the progress goes straight from 0 to 1
+    template<class Function>
+    auto run(const Executor &executor, Function function, const JobOptions &options = JobOptions()) -> Job<decltype(function())>
+    {
+        typedef decltype(function()) Result;
+        auto result = std::make_shared<Result>();
+
+        std::vector<__SplineJobsPrivate::Stage> stages(1);
+        stages[0].runChunk = [result, function](size_t) mutable { *result = function(); };
+
+        auto state = std::make_shared<__SplineJobsPrivate::JobState<Result>>(executor, std::move(stages), [result]() { return std::move(*result); }, options.progress);
+        Job<Result> job(state, state->getFuture());
+        state->start();
+        return job;
+    }
+
+    //build a spline of the given type from the given points, IE SplineJobs::build<NaturalSpline<Vector2>>(executor, options, std::move(points), true, 0.5f)
+    //the extra arguments are copied, and passed to the spline's constructor after the points. the options come before the points, since the constructor arguments have to be last
+    //limitation: the build is a single task, the same as run(). spline constructors build the whole spline at once (natural splines solve one system for every point),
+    //so there's nothing to split into chunks without a separate chunked constructor for each spline type. cancelling only helps before the task starts,
+    //the progress goes straight from 0 to 1, and options.chunkSize is ignored
+    template<class SplineType, class InterpolationType, class... Args>
+    Job<std::shared_ptr<SplineType>> build(const Executor &executor, const JobOptions &options, std::vector<InterpolationType> points, const Args &...args)
+    {
+        auto makeSpline = std::bind([](std::vector<InterpolationType> &points, const Args &...args) {
+            return std::make_shared<SplineType>(std::move(points), args...);
+        }, std::move(points), args...);
+
+        return run(executor, std::move(makeSpline), options);
+    }
+
+    //same as above, with the default options
+    template<class SplineType, class InterpolationType, class... Args>
+    Job<std::shared_ptr<SplineType>> build(const Executor &executor, std::vector<InterpolationType> points, const Args &...args)
+    {
+        return build<SplineType>(executor, JobOptions(), std::move(points), args...);
+    }
+
+    //build a SplineInverter for the given spline. the arguments are the same as SplineInverter's constructor
+    //limitation: like build, this is a single task. the samples could be taken in chunks, but the kd-tree over them is built in one pass by nanoflann,
+    //and the inverter can only be constructed from a spline, so cancelling only helps before the task starts, and options.chunkSize is ignored
+    template<class InterpolationType, typename floating_t>
+    Job<std::shared_ptr<SplineInverter<InterpolationType, floating_t>>> makeInverter(const Executor &executor, const Spline<InterpolationType, floating_t> &spline, int samplesPerT = 10,
+            typename SplineInverter<InterpolationType, floating_t>::RefinementMethod refinement = SplineInverter<InterpolationType, floating_t>::RefinementMethod::Brent,
+            typename SplineInverter<InterpolationType, floating_t>::SamplingMethod sampling = SplineInverter<InterpolationType, floating_t>::SamplingMethod::Uniform,
+            const JobOptions &options = JobOptions())
+    {
+        const Spline<InterpolationType, floating_t> *splinePointer = &spline;
+        return run(executor, [splinePointer, samplesPerT, refinement, sampling]() {
+            return std::make_shared<SplineInverter<InterpolationType, floating_t>>(*splinePointer, samplesPerT, refinement, sampling);
+        }, options);
+    }
+}
+
+namespace __SplineJobsPrivate
+{
+    //the two stages of partitionParallel: integrate options.chunkSize segments per chunk, then solve options.chunkSize piece boundaries per chunk
+    //if byLength is true, the pieces are lengthPerPiece long, like partition, and pieceCount is ignored. otherwise there are pieceCount pieces of equal length, like partitionN
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    SplineJobs::Job<std::vector<floating_t>> partition(const SplineJobs::Executor &executor, const Spline<InterpolationType, floating_t> &spline,
+                                                       bool byLength, floating_t lengthPerPiece, size_t pieceCount, const SplineJobs::JobOptions &options)
+    {
+        struct Work
+        {
+            std::vector<floating_t> cumulativeLengths;
+            std::vector<floating_t> pieces;
+            floating_t lengthPerPiece;
+        };
+        auto work = std::make_shared<Work>();
+        work->lengthPerPiece = lengthPerPiece;
+
+        const Spline<InterpolationType, floating_t> *splinePointer = &spline;
+        size_t chunkSize = std::max(size_t(1), options.chunkSize);
+        size_t segmentCount = spline.segmentCount();
+        floating_t maxT = spline.getMaxT();
+
+        std::vector<Stage> stages(2);
+        stages[0].prepare = [work, segmentCount, chunkSize]() {
+            work->cumulativeLengths.resize(segmentCount + 1);
+            return chunksFor(segmentCount, chunkSize);
+        };
+        stages[0].runChunk = [work, splinePointer, segmentCount, chunkSize](size_t chunk) {
+            size_t begin = chunk * chunkSize;
+            __ArcLengthSolvePrivate::segmentLengthRange(*splinePointer, work->cumulativeLengths, begin, std::min(begin + chunkSize, segmentCount));
+        };
+
+        //the first boundary is always 0, and partitionN's last boundary is always maxT, so neither needs to be solved
+        //partitionN with 0 pieces has a single boundary, which is maxT, the same as ArcLength::partitionN
+        stages[1].prepare = [work, byLength, pieceCount, chunkSize]() {
+            __ArcLengthSolvePrivate::prefixSum(work->cumulativeLengths);
+
+            size_t solvedCount;
+            if(byLength)
+            {
+                work->pieces.resize(size_t(work->cumulativeLengths.back() / work->lengthPerPiece) + 1);
+                solvedCount = work->pieces.size() - 1;
+            }
+            else
+            {
+                if(pieceCount > 0)
+                    work->lengthPerPiece = work->cumulativeLengths.back() / pieceCount;
+                work->pieces.resize(pieceCount + 1);
+                solvedCount = pieceCount > 0 ? pieceCount - 1 : 0;
+            }
+            return chunksFor(solvedCount, chunkSize);
+        };
+        stages[1].runChunk = [work, splinePointer, byLength, chunkSize](size_t chunk) {
+            size_t solvedEnd = byLength ? work->pieces.size() : work->pieces.size() - 1;
+            size_t begin = 1 + chunk * chunkSize;
+            __ArcLengthSolvePrivate::solvePieceRange(*splinePointer, work->cumulativeLengths, work->lengthPerPiece, work->pieces, begin, std::min(begin + chunkSize, solvedEnd));
+        };
+
+        auto state = std::make_shared<JobState<std::vector<floating_t>>>(executor, std::move(stages), [work, byLength, maxT]() {
+            if(!byLength)
+                work->pieces.back() = maxT;
+            return std::move(work->pieces);
+        }, options.progress);
+
+        SplineJobs::Job<std::vector<floating_t>> job(state, state->getFuture());
+        state->start();
+        return job;
+    }
+}
+
+namespace SplineJobs
+{
+    //same as ArcLength::partitionParallel, as a job: one task per options.chunkSize segments computes their arc lengths,
+    //then one task per options.chunkSize piece boundaries solves them. the results match partitionParallel exactly
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    Job<std::vector<floating_t>> partition(const Executor &executor, const Spline<InterpolationType, floating_t> &spline, floating_t lengthPerPiece, const JobOptions &options = JobOptions())
+    {
+        return __SplineJobsPrivate::partition(executor, spline, true, lengthPerPiece, 0, options);
+    }
+
+    //same as ArcLength::partitionNParallel, as a job
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    Job<std::vector<floating_t>> partitionN(const Executor &executor, const Spline<InterpolationType, floating_t> &spline, size_t n, const JobOptions &options = JobOptions())
+    {
+        return __SplineJobsPrivate::partition(executor, spline, false, floating_t(0), n, options);
+    }
+
+
+
+    inline ThreadPool::ThreadPool(size_t threadCount)
+    {
+        if(threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for(size_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    inline ThreadPool::~ThreadPool(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        condition.notify_all();
+
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    inline void ThreadPool::submit(std::function<void(void)> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    inline void ThreadPool::workerLoop(void)
+    {
+        while(true)
+        {
+            std::function<void(void)> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+                //keep going after the pool starts stopping until the queue is empty, so that jobs that are still running can finish
+                if(tasks.empty())
+                    return;
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+}
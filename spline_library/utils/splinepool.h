@@ -0,0 +1,240 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+
+#include "../spline.h"
+#include "../splines/baked_cubic_spline.h"
+
+//stores many small cubic splines in a few contiguous arrays, IE thousands of animation channels
+//a separately built spline allocates its points, knots, and segments separately, and is usually held through a shared_ptr with a control block of its own,
+//so a large collection of short splines is scattered across the heap. the pool bakes every spline it's given (see BakedCubicSpline) and appends
+//its points, knots, and segments to arrays shared by every spline in the pool, with a table of offsets to find each spline's part of them
+//
+//splines are identified by their index in the pool. the pool can evaluate one T value per spline in a single pass over the arrays,
+//or any spline can be wrapped in a view that evaluates straight from the pool's memory. views must not outlive the pool, or be used after more splines are added
+template<class InterpolationType, typename floating_t=float>
+class SplinePool
+{
+public:
+    typedef BakedCubicSplineViewCommon::type<InterpolationType, floating_t> CoreType;
+
+    SplinePool(void) = default;
+
+    //build a spline of the given type from each list of points, then add it to the pool. the extra arguments are passed to every spline's constructor after the points,
+    //IE SplinePool<Vector2>::build<NaturalSpline<Vector2>>(pointLists, true, 0.5f). the spline type must be cubic: see BakedCubicSpline for the list of cubic spline types
+    template<class SplineType, class... Args>
+    static SplinePool build(const std::vector<std::vector<InterpolationType>> &pointLists, const Args &...args);
+
+    //bake the given spline and add it to the pool. returns the index of the new spline. the spline must be cubic: see BakedCubicSpline for the list of cubic spline types
+    //throws std::invalid_argument if the spline's degree is higher than 3, without adding anything to the pool
+    size_t addSpline(const Spline<InterpolationType, floating_t> &cubicSpline);
+
+    //allocate room for the given totals ahead of time, so that adding splines doesn't reallocate the arrays
+    void reserve(size_t splineCount, size_t pointCount, size_t segmentCount);
+
+    size_t splineCount(void) const { return records.size(); }
+    bool isLooping(size_t index) const { return records[index].looping; }
+    floating_t getMaxT(size_t index) const { return records[index].maxT; }
+    size_t segmentCount(size_t index) const { return records[index].segmentCount; }
+    SplinePointView<InterpolationType> getOriginalPoints(size_t index) const { return SplinePointView<InterpolationType>(points.data() + records[index].pointOffset, records[index].pointCount); }
+
+    //the non-virtual core of the given spline, which evaluates straight from the pool's memory. like every core, it doesn't wrap T values for looping splines
+    CoreType core(size_t index) const;
+
+    //create a spline that evaluates straight from the pool's memory. no data is copied, and nothing is allocated
+    //getSpline is for non-looping splines only, and getLoopingSpline is for looping splines only
+    BakedCubicSplineView<InterpolationType, floating_t> getSpline(size_t index) const;
+    LoopingBakedCubicSplineView<InterpolationType, floating_t> getLoopingSpline(size_t index) const;
+
+    //evaluate every spline in the pool at once: output[i] is spline i evaluated at tValues[i]. both arrays must have splineCount() entries
+    //T values of looping splines are wrapped the same way LoopingSpline wraps them
+    void getPositions(const floating_t *tValues, InterpolationType *output) const;
+    void getTangents(const floating_t *tValues, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const;
+
+    //same as above, but for a subset of the splines: output[i] is spline splineIndices[i] evaluated at tValues[i]
+    void getPositions(const size_t *splineIndices, const floating_t *tValues, size_t count, InterpolationType *output) const;
+    void getTangents(const size_t *splineIndices, const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const;
+
+    //memory used by the pool's arrays, in bytes
+    size_t usedMemory(void) const;
+
+private: //types
+    typedef BakedCubicSplineOwningCommon::type<InterpolationType, floating_t> BakedType;
+    typedef typename BakedType::Segment Segment;
+
+    //where one spline's data lives in the pool's arrays. every spline has segmentCount + 1 knots
+    struct Record
+    {
+        size_t pointOffset;
+        size_t pointCount;
+        size_t segmentOffset;
+        size_t knotOffset;
+        size_t segmentCount;
+        floating_t maxT;
+        bool looping;
+    };
+
+private: //methods
+    floating_t wrapT(const Record &record, floating_t t) const
+    {
+        if(!record.looping)
+            return t;
+
+        floating_t wrappedT = std::fmod(t, record.maxT);
+        if(wrappedT < 0)
+            return wrappedT + record.maxT;
+        else
+            return wrappedT;
+    }
+
+private: //data
+    std::vector<Record> records;
+    std::vector<InterpolationType> points;
+    std::vector<floating_t> knots;
+    std::vector<Segment> segments;
+};
+
+
+
+template<class InterpolationType, typename floating_t>
+template<class SplineType, class... Args>
+SplinePool<InterpolationType, floating_t> SplinePool<InterpolationType, floating_t>::build(const std::vector<std::vector<InterpolationType>> &pointLists, const Args &...args)
+{
+    SplinePool<InterpolationType, floating_t> result;
+    result.records.reserve(pointLists.size());
+
+    for(const auto &pointList : pointLists)
+    {
+        //each spline only lives long enough to be baked into the pool
+        SplineType spline(pointList, args...);
+        result.addSpline(spline);
+    }
+    return result;
+}
+
+template<class InterpolationType, typename floating_t>
+size_t SplinePool<InterpolationType, floating_t>::addSpline(const Spline<InterpolationType, floating_t> &cubicSpline)
+{
+    CoreType::requireCubic(cubicSpline);
+
+    auto splinePoints = cubicSpline.getOriginalPointsView();
+    size_t numSegments = cubicSpline.segmentCount();
+
+    Record record;
+    record.pointOffset = points.size();
+    record.pointCount = splinePoints.size();
+    record.segmentOffset = segments.size();
+    record.knotOffset = knots.size();
+    record.segmentCount = numSegments;
+    record.maxT = cubicSpline.getMaxT();
+    record.looping = cubicSpline.isLooping();
+
+    //bake the segments straight into the pool's arrays, the same way BakedCubicSplineCommon does
+    points.insert(points.end(), splinePoints.begin(), splinePoints.end());
+    for(size_t i = 0; i < numSegments; i++)
+    {
+        knots.push_back(cubicSpline.segmentT(i));
+        segments.push_back(CoreType::bakeSegment(cubicSpline, i));
+    }
+    knots.push_back(cubicSpline.segmentT(numSegments));
+
+    records.push_back(record);
+    return records.size() - 1;
+}
+
+template<class InterpolationType, typename floating_t>
+void SplinePool<InterpolationType, floating_t>::reserve(size_t splineCount, size_t pointCount, size_t segmentCount)
+{
+    records.reserve(splineCount);
+    points.reserve(pointCount);
+    knots.reserve(segmentCount + splineCount);
+    segments.reserve(segmentCount);
+}
+
+template<class InterpolationType, typename floating_t>
+typename SplinePool<InterpolationType, floating_t>::CoreType SplinePool<InterpolationType, floating_t>::core(size_t index) const
+{
+    assert(index < splineCount());
+    const Record &record = records[index];
+    return CoreType(
+                SplinePointView<Segment>(segments.data() + record.segmentOffset, record.segmentCount),
+                SplinePointView<floating_t>(knots.data() + record.knotOffset, record.segmentCount + 1)
+                );
+}
+
+template<class InterpolationType, typename floating_t>
+BakedCubicSplineView<InterpolationType, floating_t> SplinePool<InterpolationType, floating_t>::getSpline(size_t index) const
+{
+    assert(!isLooping(index));
+    const Record &record = records[index];
+    return BakedCubicSplineView<InterpolationType, floating_t>(
+                getOriginalPoints(index),
+                SplinePointView<floating_t>(knots.data() + record.knotOffset, record.segmentCount + 1),
+                SplinePointView<Segment>(segments.data() + record.segmentOffset, record.segmentCount),
+                record.maxT);
+}
+
+template<class InterpolationType, typename floating_t>
+LoopingBakedCubicSplineView<InterpolationType, floating_t> SplinePool<InterpolationType, floating_t>::getLoopingSpline(size_t index) const
+{
+    assert(isLooping(index));
+    const Record &record = records[index];
+    return LoopingBakedCubicSplineView<InterpolationType, floating_t>(
+                getOriginalPoints(index),
+                SplinePointView<floating_t>(knots.data() + record.knotOffset, record.segmentCount + 1),
+                SplinePointView<Segment>(segments.data() + record.segmentOffset, record.segmentCount),
+                record.maxT);
+}
+
+template<class InterpolationType, typename floating_t>
+void SplinePool<InterpolationType, floating_t>::getPositions(const floating_t *tValues, InterpolationType *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(PositionEvaluations, records.size());
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        output[i] = core(i).getPosition(wrapT(records[i], tValues[i]));
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+void SplinePool<InterpolationType, floating_t>::getTangents(const floating_t *tValues, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(TangentEvaluations, records.size());
+    for(size_t i = 0; i < records.size(); i++)
+    {
+        output[i] = core(i).getTangent(wrapT(records[i], tValues[i]));
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+void SplinePool<InterpolationType, floating_t>::getPositions(const size_t *splineIndices, const floating_t *tValues, size_t count, InterpolationType *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(PositionEvaluations, count);
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t index = splineIndices[i];
+        output[i] = core(index).getPosition(wrapT(records[index], tValues[i]));
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+void SplinePool<InterpolationType, floating_t>::getTangents(const size_t *splineIndices, const floating_t *tValues, size_t count, typename Spline<InterpolationType,floating_t>::InterpolatedPT *output) const
+{
+    SPLINE_INSTRUMENT_COUNT_N(TangentEvaluations, count);
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t index = splineIndices[i];
+        output[i] = core(index).getTangent(wrapT(records[index], tValues[i]));
+    }
+}
+
+template<class InterpolationType, typename floating_t>
+size_t SplinePool<InterpolationType, floating_t>::usedMemory(void) const
+{
+    return records.capacity() * sizeof(Record)
+            + points.capacity() * sizeof(InterpolationType)
+            + knots.capacity() * sizeof(floating_t)
+            + segments.capacity() * sizeof(Segment);
+}
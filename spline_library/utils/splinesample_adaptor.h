@@ -31,8 +31,10 @@
  *************************************************************************/
 
 #include "nanoflann.hpp"
+#include "instrumentation.h"
 #include <vector>
 #include <array>
+#include <algorithm>
 
 template<int dimension, typename floating_t>
 struct SplineSamples
@@ -44,8 +46,11 @@ struct SplineSamples
         std::array<coord_t, dimension> coords;
         coord_t t;
 
-        Point(const std::array<coord_t, dimension> &coords, coord_t ct)
-            :coords(coords), t(ct)
+        //the index of the spline segment that t is in, so that refining a sample doesn't have to search for its segment again
+        size_t segment;
+
+        Point(const std::array<coord_t, dimension> &coords, coord_t ct, size_t segment)
+            :coords(coords), t(ct), segment(segment)
         {}
     };
 
@@ -114,6 +119,14 @@ public:
 
     floating_t findClosestSample(const std::array<floating_t, dimension> &queryPoint) const
     {
+        return sampleT(findClosestSampleIndex(queryPoint));
+    }
+
+    size_t findClosestSampleIndex(const std::array<floating_t, dimension> &queryPoint) const
+    {
+        SPLINE_INSTRUMENT_COUNT(KdTreeSearches);
+        SPLINE_INSTRUMENT_TIMER(KdTreeSearch);
+
         // do a knn search
         const size_t num_results = 1;
         size_t ret_index;
@@ -122,7 +135,89 @@ public:
         resultSet.init(&ret_index, &out_dist_sqr );
         tree.findNeighbors(resultSet, queryPoint.data(), nanoflann::SearchParams());
 
-        return adaptor.derived().pts.at(ret_index).t;
+        return ret_index;
+    }
+
+    //same as above, but seed the search with a sample that's known to be close to the query point - IE the result of a neighboring query
+    //the search can then skip any part of the tree that's farther away than the hint, without changing the result
+    size_t findClosestSampleIndex(const std::array<floating_t, dimension> &queryPoint, size_t hintIndex) const
+    {
+        SPLINE_INSTRUMENT_COUNT(KdTreeSearches);
+        SPLINE_INSTRUMENT_TIMER(KdTreeSearch);
+
+        const size_t num_results = 1;
+        size_t ret_index;
+        floating_t out_dist_sqr;
+        nanoflann::KNNResultSet<floating_t> resultSet(num_results);
+        resultSet.init(&ret_index, &out_dist_sqr );
+        resultSet.addPoint(adaptor.kdtree_distance(queryPoint.data(), hintIndex, dimension), hintIndex);
+        tree.findNeighbors(resultSet, queryPoint.data(), nanoflann::SearchParams());
+
+        return ret_index;
+    }
+
+    //append the index of every sample within radius of the query point to output, in no particular order
+    void findSamplesWithin(const std::array<floating_t, dimension> &queryPoint, floating_t radius, std::vector<size_t> &output) const
+    {
+        SPLINE_INSTRUMENT_COUNT(KdTreeSearches);
+        SPLINE_INSTRUMENT_TIMER(KdTreeSearch);
+
+        //the tree's metric is the squared distance, so the search radius has to be squared too
+        std::vector<std::pair<size_t, floating_t>> matches;
+        nanoflann::SearchParams params;
+        params.sorted = false;
+        tree.radiusSearch(queryPoint.data(), radius * radius, matches, params);
+
+        for(const auto &match : matches)
+        {
+            output.push_back(match.first);
+        }
+    }
+
+    //append the indexes of the count samples closest to the query point to output, closest first
+    //if the tree has fewer than count samples, every sample is appended
+    void findClosestSampleIndices(const std::array<floating_t, dimension> &queryPoint, size_t count, std::vector<size_t> &output) const
+    {
+        SPLINE_INSTRUMENT_COUNT(KdTreeSearches);
+        SPLINE_INSTRUMENT_TIMER(KdTreeSearch);
+
+        count = std::min(count, sampleCount());
+        if(count == 0)
+            return;
+
+        std::vector<size_t> indices(count);
+        std::vector<floating_t> distances(count);
+        nanoflann::KNNResultSet<floating_t> resultSet(count);
+        resultSet.init(indices.data(), distances.data());
+        tree.findNeighbors(resultSet, queryPoint.data(), nanoflann::SearchParams());
+
+        output.insert(output.end(), indices.begin(), indices.begin() + resultSet.size());
+    }
+
+    const std::array<floating_t, dimension> &samplePosition(size_t sampleIndex) const
+    {
+        return adaptor.derived().pts[sampleIndex].coords;
+    }
+
+    floating_t sampleT(size_t sampleIndex) const
+    {
+        return adaptor.derived().pts.at(sampleIndex).t;
+    }
+
+    size_t sampleSegment(size_t sampleIndex) const
+    {
+        return adaptor.derived().pts[sampleIndex].segment;
+    }
+
+    size_t sampleCount(void) const
+    {
+        return adaptor.derived().pts.size();
+    }
+
+    //memory used by the samples and the tree, in bytes
+    size_t usedMemory(void) const
+    {
+        return adaptor.derived().pts.capacity() * sizeof(typename SplineSamples<dimension, floating_t>::Point) + tree.usedMemory();
     }
 
 private:
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+//reusable temporary storage for building splines
+//some spline constructors (IE NaturalSpline, QuinticHermiteSpline) need several temporary arrays while they compute their segments
+//when building many splines one after another, pass the same scratch object to each constructor: the arrays are only allocated the first time,
+//or when a spline with more points than any before it comes along, so a warm build allocates nothing except the spline's own storage
+//a scratch object can be shared between spline types, but can only be used by one thread at a time
+template<class InterpolationType, typename floating_t=float>
+class SplineScratch
+{
+public:
+    static constexpr size_t floatSlots = 6;
+    static constexpr size_t pointSlots = 3;
+
+    //return an array with room for at least 'size' elements. the contents are left over from whatever used the slot last
+    //each slot is a separate array, so a constructor can use several slots at once without them overlapping
+    floating_t *floats(size_t slot, size_t size)
+    {
+        assert(slot < floatSlots);
+        if(floatData[slot].size() < size)
+            floatData[slot].resize(size);
+        return floatData[slot].data();
+    }
+
+    InterpolationType *points(size_t slot, size_t size)
+    {
+        assert(slot < pointSlots);
+        if(pointData[slot].size() < size)
+            pointData[slot].resize(size);
+        return pointData[slot].data();
+    }
+
+    //memory used by every slot, in bytes
+    size_t usedMemory(void) const
+    {
+        size_t result = 0;
+        for(const auto &slot : floatData)
+            result += slot.capacity() * sizeof(floating_t);
+        for(const auto &slot : pointData)
+            result += slot.capacity() * sizeof(InterpolationType);
+        return result;
+    }
+
+private:
+    std::array<std::vector<floating_t>, floatSlots> floatData;
+    std::array<std::vector<InterpolationType>, pointSlots> pointData;
+};
+
+template<class InterpolationType, typename floating_t>
+constexpr size_t SplineScratch<InterpolationType, floating_t>::floatSlots;
+
+template<class InterpolationType, typename floating_t>
+constexpr size_t SplineScratch<InterpolationType, floating_t>::pointSlots;
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "workstealing.h"
+
+//an adaptive polyline approximation of a spline, IE for drawing it, or for collision against line segments
+//points[i] is the spline's position at tValues[i]. the points of segment i are points[segmentOffsets[i]] through points[segmentOffsets[i + 1]], inclusive,
+//so neighboring segments share their boundary point. segmentOffsets has segmentCount() + 1 entries, and the last point is always at maxT
+template<class InterpolationType, typename floating_t>
+struct SplinePolyline
+{
+    std::vector<InterpolationType> points;
+    std::vector<floating_t> tValues;
+    std::vector<size_t> segmentOffsets;
+};
+
+namespace __TessellationPrivate
+{
+    template<class InterpolationType, typename floating_t>
+    struct Sample
+    {
+        floating_t t;
+        InterpolationType position;
+    };
+
+    //where one segment's samples were written in its worker's scratch buffer
+    struct SegmentRun
+    {
+        size_t worker;
+        size_t begin;
+        size_t count;
+    };
+
+    //subdivide one segment, and append every sample except the one at the segment's end to output
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    void tessellateSegment(const Spline<InterpolationType, floating_t>& spline, size_t segmentIndex, floating_t tolerance, std::vector<Sample<InterpolationType, floating_t>> &output)
+    {
+        //the chord error test alone can't see an S-shaped piece whose midpoint is exactly on its chord, so also split wherever the tangent turns more than about 30 degrees
+        const floating_t minCosine = floating_t(std::cos(0.5));
+
+        //don't subdivide any piece more than this many times, in case the segment has a cusp
+        const int maxDepth = 16;
+
+        struct Node
+        {
+            floating_t t;
+            InterpolationType position;
+            InterpolationType tangent;
+            int depth;
+        };
+
+        auto makeNode = [&](floating_t t, int depth) {
+            auto result = spline.segmentTangent(segmentIndex, t);
+            return Node{t, result.position, result.tangent, depth};
+        };
+
+        floating_t segmentBegin = spline.segmentT(segmentIndex);
+        floating_t segmentEnd = spline.segmentT(segmentIndex + 1);
+
+        Node begin = makeNode(segmentBegin, 0);
+
+        //b-splines can have segments with no T distance, which only contribute their beginning point
+        if(segmentEnd <= segmentBegin)
+        {
+            output.push_back(Sample<InterpolationType, floating_t>{begin.t, begin.position});
+            return;
+        }
+
+        std::vector<Node> stack;
+        stack.push_back(makeNode(segmentEnd, 0));
+        while(!stack.empty())
+        {
+            Node end = stack.back();
+
+            int depth = std::max(begin.depth, end.depth);
+            bool split = false;
+            Node middle;
+            if(depth < maxDepth)
+            {
+                middle = makeNode((begin.t + end.t) / 2, depth + 1);
+
+                //the distance between the actual midpoint and the chord's midpoint. for pieces this small, this is very close to the largest distance between the piece and its chord
+                floating_t chordError = (middle.position - (begin.position + end.position) / floating_t(2)).length();
+
+                floating_t tangentLengths = begin.tangent.length() * end.tangent.length();
+                floating_t cosine = tangentLengths > 0 ? InterpolationType::dotProduct(begin.tangent, end.tangent) / tangentLengths : 1;
+
+                split = chordError > tolerance || cosine < minCosine;
+            }
+
+            if(split)
+            {
+                stack.push_back(middle);
+            }
+            else
+            {
+                output.push_back(Sample<InterpolationType, floating_t>{begin.t, begin.position});
+                begin = end;
+                stack.pop_back();
+            }
+        }
+    }
+}
+
+namespace Tessellation
+{
+    //approximate the spline with a polyline, such that the midpoint of every piece of the spline between two consecutive points is within 'tolerance' of the line between them
+    //segments are subdivided independently, using a work-stealing loop across threadCount threads, since some segments need far more points than others
+    //the results don't depend on threadCount. if threadCount is 0, one thread per hardware thread is used
+    template<template <class, typename> class Spline, class InterpolationType, typename floating_t>
+    SplinePolyline<InterpolationType, floating_t> tessellate(const Spline<InterpolationType, floating_t>& spline, floating_t tolerance, size_t threadCount = 0)
+    {
+        typedef __TessellationPrivate::Sample<InterpolationType, floating_t> Sample;
+
+        size_t segmentCount = spline.segmentCount();
+        if(threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::max(size_t(1), std::min(threadCount, segmentCount));
+
+        //we don't know how many points each segment needs until it's been subdivided, so each worker appends to its own buffer, and records where each segment went
+        std::vector<std::vector<Sample>> workerSamples(threadCount);
+        std::vector<__TessellationPrivate::SegmentRun> runs(segmentCount);
+        SplineParallel::workStealingFor(segmentCount, threadCount, [&](size_t segmentIndex, size_t worker) {
+            std::vector<Sample> &samples = workerSamples[worker];
+            size_t begin = samples.size();
+            __TessellationPrivate::tessellateSegment(spline, segmentIndex, tolerance, samples);
+            runs[segmentIndex] = __TessellationPrivate::SegmentRun{worker, begin, samples.size() - begin};
+        });
+
+        SplinePolyline<InterpolationType, floating_t> result;
+        result.segmentOffsets.resize(segmentCount + 1);
+        size_t pointCount = 0;
+        for(size_t i = 0; i < segmentCount; i++)
+        {
+            result.segmentOffsets[i] = pointCount;
+            pointCount += runs[i].count;
+        }
+        result.segmentOffsets[segmentCount] = pointCount;
+
+        //now that every segment's offset is known, each segment's samples can be copied straight to their final position, in parallel
+        result.points.resize(pointCount + 1);
+        result.tValues.resize(pointCount + 1);
+        SplineParallel::workStealingFor(segmentCount, threadCount, [&](size_t segmentIndex, size_t) {
+            const __TessellationPrivate::SegmentRun &run = runs[segmentIndex];
+            const Sample *samples = workerSamples[run.worker].data() + run.begin;
+            size_t offset = result.segmentOffsets[segmentIndex];
+            for(size_t i = 0; i < run.count; i++)
+            {
+                result.points[offset + i] = samples[i].position;
+                result.tValues[offset + i] = samples[i].t;
+            }
+        });
+
+        //every segment left off its end point, because it's the next segment's begin point. so the only one missing is the end of the spline
+        floating_t maxT = spline.segmentT(segmentCount);
+        result.points[pointCount] = spline.segmentPosition(segmentCount - 1, maxT);
+        result.tValues[pointCount] = maxT;
+
+        return result;
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+
+#include "calculus.h"
+
+//uniform spline types, IE uniform catmull-rom splines and uniform cubic b-splines, give every segment a T range of exactly 1, and the same basis functions
+//so at each point of a gauss-legendre rule, the tangent of a whole segment is the same weighted sum of the segment's 4 control points, no matter which segment it is
+//this computes those weights once per rule, at compile time, so that integrating the length of a whole segment is a small matrix-vector product of the table and the
+//segment's control points, instead of evaluating the basis functions at every point of the rule. partial segments still have to go through the quadrature itself
+namespace __UniformSegmentQuadraturePrivate
+{
+    //the weight of each of the 4 control points of a segment, in the tangent at some local T
+    struct BasisWeights
+    {
+        double values[4];
+    };
+
+    template<size_t n>
+    struct Table
+    {
+        //tangentWeights[k][j] is the weight of control point j in the tangent at point k of the rule
+        double tangentWeights[n][4];
+
+        //the rule's weights, scaled from [-1, 1] to [0, 1]
+        double quadratureWeights[n];
+    };
+
+    //Basis must have a constexpr static method "BasisWeights tangentWeights(double t)", which returns the weights of the tangent at the local T value t, in [0, 1]
+    template<class Basis, size_t n>
+    constexpr Table<n> computeTable(void)
+    {
+        Table<n> result{};
+        for(size_t k = 0; k < n; k++)
+        {
+            double t = (SplineLibraryCalculus::GaussLegendreRule<n>::table.points[k] + 1) / 2;
+            BasisWeights weights = Basis::tangentWeights(t);
+            for(size_t j = 0; j < 4; j++)
+            {
+                result.tangentWeights[k][j] = weights.values[j];
+            }
+            result.quadratureWeights[k] = SplineLibraryCalculus::GaussLegendreRule<n>::table.weights[k] / 2;
+        }
+        return result;
+    }
+
+    template<class Basis, size_t n>
+    struct UniformSegmentRule
+    {
+        static constexpr Table<n> table = computeTable<Basis, n>();
+
+        //the arc length of a whole segment, whose 4 control points begin at points[firstPoint]
+        template<typename floating_t, class PointList>
+        static inline floating_t segmentLength(const PointList &points, size_t firstPoint)
+        {
+            SPLINE_INSTRUMENT_COUNT(QuadratureCalls);
+            SPLINE_INSTRUMENT_COUNT_N(IntegrandEvaluations, n);
+
+            floating_t sum = 0;
+            for(size_t k = 0; k < n; k++)
+            {
+                auto tangent =
+                        floating_t(table.tangentWeights[k][0]) * points[firstPoint] +
+                        floating_t(table.tangentWeights[k][1]) * points[firstPoint + 1] +
+                        floating_t(table.tangentWeights[k][2]) * points[firstPoint + 2] +
+                        floating_t(table.tangentWeights[k][3]) * points[firstPoint + 3];
+                sum += floating_t(table.quadratureWeights[k]) * tangent.length();
+            }
+            return sum;
+        }
+    };
+
+    template<class Basis, size_t n>
+    constexpr Table<n> UniformSegmentRule<Basis, n>::table;
+}
+
+namespace UniformSegmentQuadrature
+{
+    //if the given quadrature is a gauss-legendre rule, write the arc length of the whole segment whose 4 control points begin at points[firstPoint] to length, and return true
+    //otherwise return false, and leave it to the caller to integrate the segment with the quadrature
+    template<class Basis, class Quadrature, typename floating_t, class PointList>
+    inline bool wholeSegmentLength(const Quadrature &/*quadrature*/, const PointList &/*points*/, size_t /*firstPoint*/, floating_t &/*length*/)
+    {
+        return false;
+    }
+
+    template<class Basis, size_t n, typename floating_t, class PointList>
+    inline bool wholeSegmentLength(const SplineLibraryCalculus::GaussLegendreQuadrature<n> &/*quadrature*/, const PointList &points, size_t firstPoint, floating_t &length)
+    {
+        length = __UniformSegmentQuadraturePrivate::UniformSegmentRule<Basis, n>::template segmentLength<floating_t>(points, firstPoint);
+        return true;
+    }
+
+    //the quadrature chosen at runtime uses the same rules as gaussLegendreQuadratureIntegral and fastGaussLegendreQuadratureIntegral, unless it's adaptive
+    template<class Basis, typename floating_t, class PointList>
+    inline bool wholeSegmentLength(const SplineLibraryCalculus::Quadrature<floating_t> &quadrature, const PointList &points, size_t firstPoint, floating_t &length)
+    {
+        typedef SplineLibraryCalculus::Quadrature<floating_t> QuadratureType;
+        switch(quadrature.method)
+        {
+        case QuadratureType::Method::GaussLegendre:
+            length = __UniformSegmentQuadraturePrivate::UniformSegmentRule<Basis, 13>::template segmentLength<floating_t>(points, firstPoint);
+            return true;
+        case QuadratureType::Method::Fast:
+            length = __UniformSegmentQuadraturePrivate::UniformSegmentRule<Basis, 5>::template segmentLength<floating_t>(points, firstPoint);
+            return true;
+        default:
+            return false;
+        }
+    }
+}
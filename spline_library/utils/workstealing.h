@@ -0,0 +1,138 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <limits>
+#include <algorithm>
+
+namespace SplineParallel
+{
+    //call function(index, workerIndex) once for every index in [0, count), spread across threadCount threads
+    //each thread starts with a contiguous range of indexes, and takes them in order from the front. a thread that runs out steals the back half of another thread's remaining range,
+    //so uneven work (IE spline segments that need very different amounts of subdivision) still keeps every thread busy until the end
+    //workerIndex is in [0, threadCount), and no two calls with the same workerIndex run at the same time, so it can index per-thread scratch data
+    //if threadCount is 0, one thread per hardware thread is used
+    //if a call throws, no more indexes are handed out, and once every thread has stopped, the first exception is rethrown on the calling thread
+    template<class Function>
+    void workStealingFor(size_t count, size_t threadCount, Function function)
+    {
+        if(threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::max(size_t(1), std::min(threadCount, count));
+
+        if(threadCount == 1)
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                function(i, size_t(0));
+            }
+            return;
+        }
+
+        struct WorkRange
+        {
+            std::mutex mutex;
+            size_t begin;
+            size_t end;
+        };
+        std::unique_ptr<WorkRange[]> ranges(new WorkRange[threadCount]);
+        for(size_t i = 0; i < threadCount; i++)
+        {
+            ranges[i].begin = count * i / threadCount;
+            ranges[i].end = count * (i + 1) / threadCount;
+        }
+
+        std::mutex exceptionMutex;
+        std::exception_ptr exception;
+        std::atomic<bool> failed(false);
+
+        const size_t none = std::numeric_limits<size_t>::max();
+        auto worker = [&](size_t workerIndex) {
+            WorkRange &own = ranges[workerIndex];
+            while(!failed)
+            {
+                size_t index = none;
+                {
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if(own.begin < own.end)
+                        index = own.begin++;
+                }
+
+                if(index != none)
+                {
+                    try
+                    {
+                        function(index, workerIndex);
+                    }
+                    catch(...)
+                    {
+                        std::lock_guard<std::mutex> lock(exceptionMutex);
+                        if(!exception)
+                            exception = std::current_exception();
+                        failed = true;
+                    }
+                    continue;
+                }
+
+                //our own range is empty, so look for another thread that still has work left. if none do, everything has been handed out and we're done
+                bool stole = false;
+                for(size_t offset = 1; offset < threadCount && !stole; offset++)
+                {
+                    WorkRange &victim = ranges[(workerIndex + offset) % threadCount];
+
+                    size_t stolenBegin, stolenEnd;
+                    {
+                        std::lock_guard<std::mutex> lock(victim.mutex);
+                        size_t remaining = victim.end - victim.begin;
+                        if(remaining == 0)
+                            continue;
+
+                        //take the back half, rounded up so that a single remaining index can be stolen too
+                        stolenBegin = victim.begin + remaining / 2;
+                        stolenEnd = victim.end;
+                        victim.end = stolenBegin;
+                    }
+
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    own.begin = stolenBegin;
+                    own.end = stolenEnd;
+                    stole = true;
+                }
+
+                if(!stole)
+                    return;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for(size_t i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(worker, i);
+        }
+        worker(0);
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        if(exception)
+            std::rethrow_exception(exception);
+    }
+
+    //same as workStealingFor, but hand out [0, count) in chunks of chunkSize indexes, and call rangeFunction(begin, end, workerIndex) for each chunk
+    //for work that's too cheap per index to be handed out one index at a time, or that benefits from consecutive indexes running together
+    template<class RangeFunction>
+    void workStealingForRanges(size_t count, size_t chunkSize, size_t threadCount, RangeFunction rangeFunction)
+    {
+        chunkSize = std::max(size_t(1), chunkSize);
+        size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+        workStealingFor(chunkCount, threadCount, [&](size_t chunkIndex, size_t workerIndex) {
+            size_t begin = chunkIndex * chunkSize;
+            rangeFunction(begin, std::min(begin + chunkSize, count), workerIndex);
+        });
+    }
+}
@@ -3,15 +3,141 @@
 #include <array>
 #include <cmath>
 
+//define SPLINE_LIBRARY_SIMD_VECTORS before including this file to store float and double vectors with 2 to 4 dimensions in a single SIMD register,
+//so that each arithmetic operator is a single instruction instead of a loop. this uses gcc and clang vector extensions, which the compiler turns into SSE, AVX, or NEON
+//instructions depending on the target: float vectors and 2 dimensional double vectors need SSE2 or NEON, and 3 or 4 dimensional double vectors need AVX
+//other compilers, targets, dimensions, and floating point types keep the plain array layout
+//3 dimensional vectors are padded to 4 lanes, so Vector<3, float> takes 16 bytes instead of 12. since this changes the layout of the vectors,
+//it has to be defined the same way in every file of a program, and spline files written with one setting can't be read with the other
+#if defined(SPLINE_LIBRARY_SIMD_VECTORS) && (defined(__GNUC__) || defined(__clang__))
+#define SPLINE_LIBRARY_SIMD_VECTORS_ENABLED
+#endif
+
+namespace __VectorPrivate
+{
+    //the type a Vector stores its components in
+    template<size_t dimension, typename floating_t>
+    struct Storage
+    {
+        static constexpr bool simd = false;
+        typedef std::array<floating_t, dimension> type;
+    };
+
+#if defined(SPLINE_LIBRARY_SIMD_VECTORS_ENABLED) && (defined(__SSE2__) || defined(__ARM_NEON))
+    template<> struct Storage<2, float> { static constexpr bool simd = true; typedef float type __attribute__((vector_size(8))); };
+    template<> struct Storage<3, float> { static constexpr bool simd = true; typedef float type __attribute__((vector_size(16))); };
+    template<> struct Storage<4, float> { static constexpr bool simd = true; typedef float type __attribute__((vector_size(16))); };
+    template<> struct Storage<2, double> { static constexpr bool simd = true; typedef double type __attribute__((vector_size(16))); };
+#endif
+
+    //3 and 4 dimensional double vectors need a 32 byte register, so they're only SIMD backed when AVX is enabled. otherwise, the compiler would split every operation in two anyway
+    //before c++17, std::vector and new only guarantee 16 byte alignment, so these registers' alignment is lowered to 16. unaligned loads cost nothing on cpus with AVX
+#if defined(SPLINE_LIBRARY_SIMD_VECTORS_ENABLED) && defined(__AVX__)
+    template<> struct Storage<3, double> { static constexpr bool simd = true; typedef double type __attribute__((vector_size(32), aligned(16))); };
+    template<> struct Storage<4, double> { static constexpr bool simd = true; typedef double type __attribute__((vector_size(32), aligned(16))); };
+#endif
+
+    //whole-vector arithmetic. SIMD registers use the vector extension's operators, which apply to every lane at once, and arrays loop over their components
+    //the array overloads are more specialized, so they're chosen whenever the storage is an array
+    //the padding lane of a 3 dimensional register goes along for the ride, and whatever ends up in it is never read
+    template<class Register> inline Register add(Register left, Register right) { return left + right; }
+    template<class Register> inline Register subtract(Register left, Register right) { return left - right; }
+    template<class Register> inline Register negate(Register v) { return -v; }
+    template<class Register> inline Register multiplyComponents(Register left, Register right) { return left * right; }
+    template<class Register, typename floating_t> inline Register scale(Register v, floating_t s) { return v * s; }
+    template<class Register, typename floating_t> inline Register divide(Register v, floating_t s) { return v / s; }
+
+    //if the target has FMA, compilers contract this to one fused multiply-add per register
+    template<class Register, typename floating_t> inline Register multiplyAdd(Register a, Register b, floating_t s) { return a + b * s; }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> add(const std::array<floating_t, dimension> &left, const std::array<floating_t, dimension> &right)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = left[i] + right[i];
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> subtract(const std::array<floating_t, dimension> &left, const std::array<floating_t, dimension> &right)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = left[i] - right[i];
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> negate(const std::array<floating_t, dimension> &v)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = -v[i];
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> multiplyComponents(const std::array<floating_t, dimension> &left, const std::array<floating_t, dimension> &right)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = left[i] * right[i];
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> scale(const std::array<floating_t, dimension> &v, floating_t s)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = v[i] * s;
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> divide(const std::array<floating_t, dimension> &v, floating_t s)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = v[i] / s;
+        }
+        return result;
+    }
+
+    template<typename floating_t, size_t dimension>
+    inline std::array<floating_t, dimension> multiplyAdd(const std::array<floating_t, dimension> &a, const std::array<floating_t, dimension> &b, floating_t s)
+    {
+        std::array<floating_t, dimension> result;
+        for(size_t i = 0; i < dimension; i++) {
+            result[i] = a[i] + b[i] * s;
+        }
+        return result;
+    }
+}
+
 template<size_t dimension, typename floating_t=float>
 class Vector
 {
 public:
+    typedef floating_t scalar_type;
+
     Vector(void) :data() {}
-    Vector(std::array<floating_t, dimension> data) :data(data) {}
+    Vector(std::array<floating_t, dimension> components) :data()
+    {
+        for(size_t i = 0; i < dimension; i++) {
+            (*this)[i] = components[i];
+        }
+    }
 
-    inline floating_t& operator[](size_t index) { return data[index]; }
-    inline floating_t operator[](size_t index) const { return data[index]; }
+    //a vector extension register can't be bound to a reference one lane at a time, but like an array, its lanes can be accessed through a pointer to the first one
+    inline floating_t& operator[](size_t index) { return reinterpret_cast<floating_t*>(&data)[index]; }
+    inline floating_t operator[](size_t index) const { return reinterpret_cast<const floating_t*>(&data)[index]; }
 
     inline Vector<dimension, floating_t> &operator+=(const Vector<dimension, floating_t> &v);
     inline Vector<dimension, floating_t> &operator-=(const Vector<dimension, floating_t> &v);
@@ -20,10 +146,12 @@ public:
 
     template<size_t d, typename f> friend inline Vector<d, f> operator+(const Vector<d, f> &left, const Vector<d, f> &right);
     template<size_t d, typename f> friend inline Vector<d, f> operator-(const Vector<d, f> &left, const Vector<d, f> &right);
-    template<size_t d, typename f> friend inline Vector<d, f> operator*(f s, const Vector<d, f> &v);
-    template<size_t d, typename f> friend inline Vector<d, f> operator*(const Vector<d, f> &v, f s);
+    //the scalar is only deduced from the vector, so other scalar types are converted to floating_t, IE a double weight times a float vector
+    //this lets splines with double precision T values use float points
+    template<size_t d, typename f> friend inline Vector<d, f> operator*(typename Vector<d, f>::scalar_type s, const Vector<d, f> &v);
+    template<size_t d, typename f> friend inline Vector<d, f> operator*(const Vector<d, f> &v, typename Vector<d, f>::scalar_type s);
     template<size_t d, typename f> friend inline Vector<d, f> operator-(const Vector<d, f> &v);
-    template<size_t d, typename f> friend inline Vector<d, f> operator/(const Vector<d, f> &v, f s);
+    template<size_t d, typename f> friend inline Vector<d, f> operator/(const Vector<d, f> &v, typename Vector<d, f>::scalar_type s);
 
 
     template<size_t d, typename f> friend inline bool operator==(const Vector<d, f> &left, const Vector<d, f> &right);
@@ -36,8 +164,14 @@ public:
 
     inline static floating_t dotProduct(const Vector<dimension, floating_t>& left, const Vector<dimension, floating_t>& right);
 
+    //a + b * s. for SIMD vectors on targets with FMA, this is a single fused multiply-add
+    inline static Vector<dimension, floating_t> multiplyAdd(const Vector<dimension, floating_t>& a, const Vector<dimension, floating_t>& b, floating_t s);
+
+    //true if this vector type is stored in a SIMD register, see SPLINE_LIBRARY_SIMD_VECTORS
+    static constexpr bool isSimd(void) { return __VectorPrivate::Storage<dimension, floating_t>::simd; }
+
 private:
-    std::array<floating_t, dimension> data;
+    typename __VectorPrivate::Storage<dimension, floating_t>::type data;
 };
 
 typedef Vector<2> Vector2;
@@ -46,36 +180,28 @@ typedef Vector<3> Vector3;
 template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> &Vector<dimension, floating_t>::operator+=(const Vector<dimension, floating_t> &other)
 {
-    for(size_t i = 0; i < dimension; i++) {
-        data[i] += other.data[i];
-    }
+    data = __VectorPrivate::add(data, other.data);
     return *this;
 }
 
 template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> &Vector<dimension, floating_t>::operator-=(const Vector<dimension, floating_t> &v)
 {
-    for(size_t i = 0; i < dimension; i++) {
-        data[i] -= v.data[i];
-    }
+    data = __VectorPrivate::subtract(data, v.data);
     return *this;
 }
 
 template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> &Vector<dimension, floating_t>::operator*=(floating_t s)
 {
-    for(size_t i = 0; i < dimension; i++) {
-        data[i] *= s;
-    }
+    data = __VectorPrivate::scale(data, s);
     return *this;
 }
 
 template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> &Vector<dimension, floating_t>::operator/=(floating_t s)
 {
-    for(size_t i = 0; i < dimension; i++) {
-        data[i] /= s;
-    }
+    data = __VectorPrivate::divide(data, s);
     return *this;
 }
 
@@ -83,9 +209,7 @@ template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> operator+(const Vector<dimension, floating_t> &left, const Vector<dimension, floating_t> &right)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = left.data[i] + right.data[i];
-    }
+    result.data = __VectorPrivate::add(left.data, right.data);
     return result;
 }
 
@@ -93,29 +217,23 @@ template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> operator-(const Vector<dimension, floating_t> &left, const Vector<dimension, floating_t> &right)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = left.data[i] - right.data[i];
-    }
+    result.data = __VectorPrivate::subtract(left.data, right.data);
     return result;
 }
 
 template<size_t dimension, typename floating_t>
-inline Vector<dimension, floating_t> operator*(floating_t s, const Vector<dimension, floating_t> &v)
+inline Vector<dimension, floating_t> operator*(typename Vector<dimension, floating_t>::scalar_type s, const Vector<dimension, floating_t> &v)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = s * v.data[i];
-    }
+    result.data = __VectorPrivate::scale(v.data, s);
     return result;
 }
 
 template<size_t dimension, typename floating_t>
-inline Vector<dimension, floating_t> operator*(const Vector<dimension, floating_t> &v, floating_t s)
+inline Vector<dimension, floating_t> operator*(const Vector<dimension, floating_t> &v, typename Vector<dimension, floating_t>::scalar_type s)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = v.data[i] * s;
-    }
+    result.data = __VectorPrivate::scale(v.data, s);
     return result;
 }
 
@@ -123,19 +241,15 @@ template<size_t dimension, typename floating_t>
 inline Vector<dimension, floating_t> operator-(const Vector<dimension, floating_t> &v)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = -v.data[i];
-    }
+    result.data = __VectorPrivate::negate(v.data);
     return result;
 }
 
 template<size_t dimension, typename floating_t>
-inline Vector<dimension, floating_t> operator/(const Vector<dimension, floating_t> &v, floating_t s)
+inline Vector<dimension, floating_t> operator/(const Vector<dimension, floating_t> &v, typename Vector<dimension, floating_t>::scalar_type s)
 {
     Vector<dimension, floating_t> result;
-    for(size_t i = 0; i < dimension; i++) {
-        result.data[i] = v.data[i] / s;
-    }
+    result.data = __VectorPrivate::divide(v.data, s);
     return result;
 }
 
@@ -143,7 +257,7 @@ template<size_t dimension, typename floating_t>
 inline bool operator==(const Vector<dimension, floating_t> &left, const Vector<dimension, floating_t> &right)
 {
     for(size_t i = 0; i < dimension; i++) {
-        if(left.data[i] != right.data[i])
+        if(left[i] != right[i])
             return false;
     }
     return true;
@@ -153,7 +267,7 @@ template<size_t dimension, typename floating_t>
 inline bool operator!=(const Vector<dimension, floating_t> &left, const Vector<dimension, floating_t> &right)
 {
     for(size_t i = 0; i < dimension; i++) {
-        if(left.data[i] != right.data[i])
+        if(left[i] != right[i])
             return true;
     }
     return false;
@@ -175,13 +289,25 @@ inline Vector<dimension, floating_t> Vector<dimension, floating_t>::normalized()
 template<size_t dimension, typename floating_t>
 inline floating_t Vector<dimension, floating_t>::dotProduct(const Vector<dimension, floating_t>& v1, const Vector<dimension, floating_t>& v2)
 {
+    //multiply every lane at once, then only sum the lanes that are part of the vector
+    Vector<dimension, floating_t> products;
+    products.data = __VectorPrivate::multiplyComponents(v1.data, v2.data);
+
     floating_t sum(0);
     for(size_t i = 0; i < dimension; i++) {
-        sum += v1.data[i] * v2.data[i];
+        sum += products[i];
     }
     return sum;
 }
 
+template<size_t dimension, typename floating_t>
+inline Vector<dimension, floating_t> Vector<dimension, floating_t>::multiplyAdd(const Vector<dimension, floating_t>& a, const Vector<dimension, floating_t>& b, floating_t s)
+{
+    Vector<dimension, floating_t> result;
+    result.data = __VectorPrivate::multiplyAdd(a.data, b.data, s);
+    return result;
+}
+
 template<size_t dimension, typename floating_t>
 inline floating_t Vector<dimension, floating_t>::length() const
 {
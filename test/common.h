@@ -14,6 +14,7 @@
 #include "spline_library/splines/quintic_hermite_spline.h"
 #include "spline_library/splines/uniform_cr_spline.h"
 #include "spline_library/splines/uniform_cubic_bspline.h"
+#include "spline_library/splines/baked_cubic_spline.h"
 
 Q_DECLARE_METATYPE(Vector2)
 Q_DECLARE_METATYPE(Vector3)
@@ -41,16 +42,17 @@ void compareFloatsLenient(T actual, T expected, T tol)
 //we have a bunch of functions to help create test data. the alternative is copy/pasting a list of snarled one-liners into 10 different tests
 //we're putting all these functions in a class so we can typedef the whole class,
 //so that every infocation doesn't need to supply template parameters
-template<typename floating_t>
+//floating_t is the type of the splines' T values, and point_t is the type of the points' coordinates
+template<typename floating_t, typename point_t=floating_t>
 class SplineCreator
 {
 public:
-    typedef Spline<Vector<2,floating_t>, floating_t> SplineT;
-    typedef LoopingSpline<Vector<2,floating_t>, floating_t> LoopingSplineT;
+    typedef Vector<2, point_t> T;
+    typedef Spline<T, floating_t> SplineT;
+    typedef LoopingSpline<T, floating_t> LoopingSplineT;
 
     typedef std::shared_ptr<SplineT> SplinePtr;
     typedef std::shared_ptr<LoopingSplineT> LoopingSplinePtr;
-    typedef Vector<2, floating_t> T;
 
     //several functions that create instances of splines
     static SplinePtr createUniformCR(std::vector<T> data) {
@@ -83,7 +85,7 @@ public:
         if(!includeEndpoints) {
             data = addPadding(data, 1);
         }
-        return std::make_shared<NaturalSpline<T, floating_t>>(data, includeEndpoints, alpha, NaturalSpline<Vector<2,floating_t>, floating_t>::NotAKnot);
+        return std::make_shared<NaturalSpline<T, floating_t>>(data, includeEndpoints, alpha, NaturalSpline<T, floating_t>::NotAKnot);
     }
     static SplinePtr createUniformBSpline(std::vector<T> data) {
         return std::make_shared<UniformCubicBSpline<T, floating_t>>(addPadding(data,1));
@@ -92,6 +94,14 @@ public:
         auto padded = addPadding(data, (degree - 1)/2);
         return std::make_shared<GenericBSpline<T, floating_t>>(padded, degree);
     }
+    template<size_t degree>
+    static SplinePtr createFixedDegreeGenericBSpline(std::vector<T> data) {
+        auto padded = addPadding(data, (degree - 1)/2);
+        return std::make_shared<GenericBSpline<T, floating_t, degree>>(padded);
+    }
+    static SplinePtr createBakedCubic(SplinePtr cubicSpline) {
+        return std::make_shared<BakedCubicSpline<T, floating_t>>(*cubicSpline);
+    }
 
 
 
@@ -123,6 +133,13 @@ public:
     static LoopingSplinePtr createLoopingGenericBSpline(std::vector<T> data, size_t degree) {
         return std::make_shared<LoopingGenericBSpline<T, floating_t>>(data, degree);
     }
+    template<size_t degree>
+    static LoopingSplinePtr createLoopingFixedDegreeGenericBSpline(std::vector<T> data) {
+        return std::make_shared<LoopingGenericBSpline<T, floating_t, degree>>(data);
+    }
+    static LoopingSplinePtr createLoopingBakedCubic(LoopingSplinePtr cubicSpline) {
+        return std::make_shared<LoopingBakedCubicSpline<T, floating_t>>(*cubicSpline);
+    }
 
     //special functions to make circular generic B splines and circular quintic splines
     //circular splines are really easy to test arc length for, and those two spline types will retain the most "circularity"
@@ -149,7 +166,7 @@ public:
     static std::vector<T> generateRandomData(size_t size, unsigned seed=10) {
         std::minstd_rand gen;
         gen.seed(seed);
-        std::uniform_real_distribution<floating_t> distribution(2,5);
+        std::uniform_real_distribution<point_t> distribution(2,5);
 
         std::vector<T> result(size);
         result[0] = T({distribution(gen), distribution(gen)});
@@ -166,7 +183,7 @@ public:
         for(size_t i = 0; i < size; i++)
         {
             currentTriangleNumber += i;
-            floating_t value = currentTriangleNumber;
+            point_t value = currentTriangleNumber;
             result[i] = T({value, value});
         }
         return result;
@@ -176,7 +193,7 @@ public:
         std::vector<T> result(size);
         for(size_t i = 0; i < size; i++)
         {
-            floating_t value = i;
+            point_t value = i;
             result[i] = T({value, value});
         }
         return result;
@@ -219,11 +236,11 @@ private:
     }
 
     static std::vector<T> generateCircularPositions(size_t size, floating_t radius) {
-        std::vector<Vector<2, floating_t>> result(size);
-        floating_t angle = 2 * floating_t(3.14159265) / size;
+        std::vector<T> result(size);
+        point_t angle = 2 * point_t(3.14159265) / size;
         for(size_t i = 0; i < size; i++)
         {
-            floating_t currentAngle = angle * i;
+            point_t currentAngle = angle * i;
 
             result[i] = T({std::cos(currentAngle), std::sin(currentAngle)}) * radius;
         }
@@ -245,6 +262,9 @@ private:
 typedef SplineCreator<float> TestDataFloat;
 typedef SplineCreator<float> TestDataDouble;
 
+//double precision T values, with float points
+typedef SplineCreator<double, float> TestDataMixed;
+
 
 
 
@@ -0,0 +1,11 @@
+#include <QtTest/QtTest>
+
+#include "testperformance.h"
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    TestPerformance performanceTests;
+
+    return QTest::qExec(&performanceTests, argc, argv);
+}
@@ -7,6 +7,8 @@
 #include "testlinalg.h"
 #include "testarclength.h"
 #include "testsplinecommon.h"
+#include "testsplineinverter.h"
+#include "testtessellation.h"
 
 int main(int argc, char** argv) {
     QApplication app(argc, argv);
@@ -17,11 +19,15 @@ int main(int argc, char** argv) {
     TestLinAlg algebraTests;
     TestArcLength lengthTests;
     TestSplineCommon commonTests;
+    TestSplineInverter inverterTests;
+    TestTessellation tessellationTests;
 
     return QTest::qExec(&calculusTests, argc, argv)
             | QTest::qExec(&vectorTests, argc, argv)
             | QTest::qExec(&splineTests, argc, argv)
             | QTest::qExec(&algebraTests, argc, argv)
             | QTest::qExec(&lengthTests, argc, argv)
-            | QTest::qExec(&commonTests, argc, argv);
+            | QTest::qExec(&commonTests, argc, argv)
+            | QTest::qExec(&inverterTests, argc, argv)
+            | QTest::qExec(&tessellationTests, argc, argv);
 }
@@ -2,6 +2,9 @@
 
 #include "common.h"
 #include "spline_library/utils/arclength.h"
+#include "spline_library/utils/arclengthindex.h"
+#include "spline_library/utils/arclengthparameterization.h"
+#include "spline_library/utils/splinejobs.h"
 
 #include "spline_library/utils/calculus.h"
 #include "spline_library/splines/uniform_cubic_bspline.h"
@@ -11,6 +14,8 @@
 #include "spline_library/splines/uniform_cr_spline.h"
 #include "spline_library/splines/quintic_hermite_spline.h"
 
+#include <thread>
+
 #include <QtTest/QtTest>
 
 TestArcLength::TestArcLength(QObject *parent) : QObject(parent)
@@ -39,6 +44,162 @@ void TestArcLength::testArcLengthTotalLength(void)
 }
 
 
+void TestArcLength::testArcLengthQuadrature_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data);
+    QTest::newRow("CubicHermiteAlpha") << TestDataFloat::createCubicHermite(data, 0.5f);
+    QTest::newRow("QuinticHermiteAlpha") << TestDataFloat::createQuinticHermite(data, 0.5f);
+    QTest::newRow("GenericBSpline degree 7") << TestDataFloat::createGenericBSpline(data, 7);
+    QTest::newRow("LoopingNatural") << std::shared_ptr<Spline<Vector2>>(TestDataFloat::createLoopingNatural(data, 0.5f));
+}
+
+void TestArcLength::testArcLengthQuadrature(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    typedef Spline<Vector2>::Quadrature Quadrature;
+
+    float a = lerp(spline->segmentT(1), spline->segmentT(2), 0.3f);
+    float b = lerp(spline->segmentT(spline->segmentCount() - 2), spline->segmentT(spline->segmentCount() - 1), 0.6f);
+
+    //the gauss-legendre quadrature is the one the default overloads use, so it should give identical results
+    QCOMPARE(spline->arcLength(a, b, Quadrature::gaussLegendre()), spline->arcLength(a, b));
+    for(size_t i = 0; i < spline->segmentCount(); i++)
+    {
+        float begin = spline->segmentT(i);
+        float end = spline->segmentT(i + 1);
+        QCOMPARE(spline->segmentArcLength(i, begin, end, Quadrature::gaussLegendre()), spline->segmentArcLength(i, begin, end));
+    }
+
+    //compare the cheaper quadratures against a very tight adaptive integral
+    float reference = spline->arcLength(a, b, Quadrature::adaptive(1e-6f));
+    QVERIFY(std::abs(spline->arcLength(a, b) - reference) < reference * 1e-4f);
+
+    //the tolerance applies to each segment separately, so the error of the whole arc can be up to segmentCount times the tolerance
+    float tolerance = 1e-3f;
+    float adaptive = spline->arcLength(a, b, Quadrature::adaptive(tolerance));
+    QVERIFY(std::abs(adaptive - reference) < tolerance * spline->segmentCount() + reference * 1e-5f);
+
+    //the fast quadrature has no error bound, but it should still be close for these smooth splines
+    float fast = spline->arcLength(a, b, Quadrature::fast());
+    QVERIFY(std::abs(fast - reference) < reference * 0.01f);
+}
+
+
+namespace
+{
+    //integrates with the same rule as the default quadrature, but isn't a type the uniform splines recognize, so they integrate their tangent with it
+    struct OpaqueGaussLegendreQuadrature
+    {
+        template<class Function, typename floating_t>
+        floating_t operator()(Function f, floating_t a, floating_t b) const
+        {
+            return SplineLibraryCalculus::GaussLegendreRule<13>::integrate<floating_t>(f, a, b);
+        }
+    };
+
+    template<class SplineType>
+    void verifyUniformSegmentQuadrature(const SplineType &spline)
+    {
+        for(size_t i = 0; i < spline.segmentCount(); i++)
+        {
+            float begin = spline.segmentT(i);
+            float end = spline.segmentT(i + 1);
+
+            float expected = spline.core().segmentLength(i, begin, end, OpaqueGaussLegendreQuadrature());
+            QVERIFY(std::abs(spline.core().segmentLength(i, begin, end) - expected) < expected * 1e-5f);
+            QVERIFY(std::abs(spline.segmentArcLength(i, begin, end, Spline<Vector2>::Quadrature::gaussLegendre()) - expected) < expected * 1e-5f);
+
+            //partial segments aren't covered by the table, so they should go through the quadrature exactly the same way
+            float middle = lerp(begin, end, 0.4f);
+            QCOMPARE(spline.core().segmentLength(i, begin, middle), spline.core().segmentLength(i, begin, middle, OpaqueGaussLegendreQuadrature()));
+        }
+    }
+}
+
+void TestArcLength::testUniformSegmentQuadrature(void)
+{
+    auto data = TestDataFloat::generateRandomData(20);
+
+    verifyUniformSegmentQuadrature(UniformCRSpline<Vector2>(data));
+    verifyUniformSegmentQuadrature(LoopingUniformCRSpline<Vector2>(data));
+    verifyUniformSegmentQuadrature(UniformCubicBSpline<Vector2>(data));
+    verifyUniformSegmentQuadrature(LoopingUniformCubicBSpline<Vector2>(data));
+}
+
+namespace
+{
+    //copy the given spline, which must be a SplineType, and cache the copy's speed polynomials
+    template<class SplineType>
+    std::shared_ptr<Spline<Vector2>> withSpeedPolynomials(std::shared_ptr<Spline<Vector2>> spline)
+    {
+        auto result = std::make_shared<SplineType>(static_cast<const SplineType&>(*spline));
+        result->cacheSpeedPolynomials();
+        return result;
+    }
+}
+
+void TestArcLength::testSpeedPolynomials_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("cachedSpline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    auto rowFunction = [](const char *name, std::shared_ptr<Spline<Vector2>> spline, std::shared_ptr<Spline<Vector2>> cachedSpline) {
+        QTest::newRow(name) << spline << cachedSpline;
+    };
+
+    auto uniformCR = TestDataFloat::createUniformCR(data);
+    auto cubicHermite = TestDataFloat::createCubicHermite(data, 0.5f);
+    auto natural = TestDataFloat::createNatural(data, true, 0.5f);
+    auto uniformBSpline = TestDataFloat::createUniformBSpline(data);
+    std::shared_ptr<Spline<Vector2>> loopingCatmullRom = TestDataFloat::createLoopingCatmullRom(data, 0.5f);
+    std::shared_ptr<Spline<Vector2>> loopingNatural = TestDataFloat::createLoopingNatural(data, 0.5f);
+
+    rowFunction("uniformCR", uniformCR, withSpeedPolynomials<UniformCRSpline<Vector2>>(uniformCR));
+    rowFunction("cubicHermiteAlpha", cubicHermite, withSpeedPolynomials<CubicHermiteSpline<Vector2>>(cubicHermite));
+    rowFunction("naturalAlpha", natural, withSpeedPolynomials<NaturalSpline<Vector2>>(natural));
+    rowFunction("uniformBSpline", uniformBSpline, withSpeedPolynomials<UniformCubicBSpline<Vector2>>(uniformBSpline));
+    rowFunction("loopingCatmullRomAlpha", loopingCatmullRom, withSpeedPolynomials<LoopingCubicHermiteSpline<Vector2>>(loopingCatmullRom));
+    rowFunction("loopingNaturalAlpha", loopingNatural, withSpeedPolynomials<LoopingNaturalSpline<Vector2>>(loopingNatural));
+}
+
+void TestArcLength::testSpeedPolynomials(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(std::shared_ptr<Spline<Vector2>>, cachedSpline);
+
+    //the polynomials are built from float coefficients, so they only match the tangent up to rounding
+    float totalLength = spline->totalLength();
+    float tolerance = totalLength * 1e-5f;
+    QVERIFY(std::abs(cachedSpline->totalLength() - totalLength) < tolerance);
+
+    for(size_t i = 0; i < spline->segmentCount(); i++)
+    {
+        float a = lerp(spline->segmentT(i), spline->segmentT(i + 1), 0.25f);
+        float b = lerp(spline->segmentT(i), spline->segmentT(i + 1), 0.8f);
+        QVERIFY(std::abs(cachedSpline->segmentArcLength(i, a, b) - spline->segmentArcLength(i, a, b)) < tolerance);
+    }
+
+    //the arc length solver uses segmentArcLength for every halley iteration, so it should give the same results
+    float a = lerp(spline->segmentT(1), spline->segmentT(2), 0.5f);
+    for(float fraction : {0.1f, 0.5f, 0.9f})
+    {
+        float desiredLength = (totalLength - spline->arcLength(0, a)) * fraction;
+        float expected = ArcLength::solveLength(*spline, a, desiredLength);
+        QVERIFY(std::abs(ArcLength::solveLength(*cachedSpline, a, desiredLength) - expected) < 1e-3f);
+    }
+
+    //the adaptive quadrature should also work on the polynomials
+    typedef Spline<Vector2>::Quadrature Quadrature;
+    QVERIFY(std::abs(cachedSpline->arcLength(0, a, Quadrature::adaptive(1e-4f)) - spline->arcLength(0, a)) < 1e-3f);
+}
+
+
 void TestArcLength::testKnownArcLength_data(void)
 {
     QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
@@ -193,6 +354,56 @@ void TestArcLength::testSolve(void)
 }
 
 
+void TestArcLength::testSolveLengths_data(void)
+{
+    auto data = TestDataFloat::generateRandomData(50);
+
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<float>("a");
+
+    auto rowFunction = [=](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+        std::string startName = QString("%1 (Start)").arg(name).toStdString();
+        QTest::newRow(startName.data()) << spline << 0.0f;
+
+        //start partway through a segment, so that the first segment is only partially used
+        std::string partialName = QString("%1 (Partial)").arg(name).toStdString();
+        QTest::newRow(partialName.data()) << spline << lerp(spline->segmentT(4), spline->segmentT(5), 0.3f);
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("cubicHermiteAlpha", TestDataFloat::createCubicHermite(data, 0.5f));
+    rowFunction("genericB", TestDataFloat::createGenericBSpline(data, 4));
+}
+
+void TestArcLength::testSolveLengths(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(float, a);
+
+    float remainingLength = spline->arcLength(a, spline->getMaxT());
+
+    //include a length of 0, a repeated length, lengths close together and far apart, and lengths past the end of the spline
+    std::vector<float> desiredLengths = { 0.0f, 0.01f, 0.01f, 0.02f };
+    for(size_t i = 1; i < 100; i++)
+    {
+        desiredLengths.push_back(remainingLength * i / 100);
+    }
+    desiredLengths.push_back(remainingLength * 1.5f);
+    desiredLengths.push_back(remainingLength * 2);
+
+    std::vector<float> actual = ArcLength::solveLengths(*spline.get(), a, desiredLengths);
+    QCOMPARE(actual.size(), desiredLengths.size());
+
+    //each length is solved relative to the previous solution instead of relative to a, so the results will only match up to rounding
+    for(size_t i = 0; i < desiredLengths.size(); i++)
+    {
+        float expected = ArcLength::solveLength(*spline.get(), a, desiredLengths[i]);
+        QVERIFY(std::abs(actual[i] - expected) < 0.001f);
+    }
+    QCOMPARE(actual.back(), spline->getMaxT());
+}
+
+
 void TestArcLength::testSolveCyclic_data(void)
 {
     auto data = TestDataFloat::generateRandomData(10);
@@ -351,3 +562,467 @@ void TestArcLength::testPartitionN(void)
         QCOMPARE(pieceLength, totalLength/n);
     }
 }
+
+
+void TestArcLength::testPartitionParallel_data(void)
+{
+    auto data = TestDataFloat::generateRandomData(50);
+
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<size_t>("threadCount");
+
+    auto rowFunction = [=](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+        //use more threads than pieces in one row, and let the library choose in another
+        for(size_t threadCount : {size_t(1), size_t(3), size_t(64), size_t(0)})
+        {
+            std::string rowName = QString("%1 (%2 threads)").arg(name).arg(threadCount).toStdString();
+            QTest::newRow(rowName.data()) << spline << threadCount;
+        }
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("cubicHermiteAlpha", TestDataFloat::createCubicHermite(data, 0.5f));
+}
+
+void TestArcLength::testPartitionParallel(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(size_t, threadCount);
+
+    float totalLength = spline->totalLength();
+
+    //the parallel version sums segment lengths in a different order, so the results will only match up to rounding
+    for(float desiredLength : {totalLength / 2.1f, totalLength / 20.5f, totalLength / 200.5f})
+    {
+        std::vector<float> expected = ArcLength::partition(*spline.get(), desiredLength);
+        std::vector<float> actual = ArcLength::partitionParallel(*spline.get(), desiredLength, threadCount);
+
+        QCOMPARE(actual.size(), expected.size());
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            QVERIFY(std::abs(actual[i] - expected[i]) < 0.001f);
+        }
+    }
+
+    for(size_t n : {size_t(1), size_t(3), size_t(20), size_t(200)})
+    {
+        std::vector<float> expected = ArcLength::partitionN(*spline.get(), n);
+        std::vector<float> actual = ArcLength::partitionNParallel(*spline.get(), n, threadCount);
+
+        QCOMPARE(actual.size(), expected.size());
+        QCOMPARE(actual.front(), 0.0f);
+        QCOMPARE(actual.back(), spline->getMaxT());
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            QVERIFY(std::abs(actual[i] - expected[i]) < 0.001f);
+        }
+    }
+
+    //zero pieces has no boundaries to solve
+    std::vector<float> expectedEmpty = ArcLength::partitionN(*spline.get(), 0);
+    std::vector<float> actualEmpty = ArcLength::partitionNParallel(*spline.get(), 0, threadCount);
+    QCOMPARE(actualEmpty.size(), expectedEmpty.size());
+    QCOMPARE(actualEmpty.back(), expectedEmpty.back());
+}
+
+
+void TestArcLength::testJobs_data(void)
+{
+    auto data = TestDataFloat::generateRandomData(50);
+
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<size_t>("chunkSize");
+
+    auto rowFunction = [=](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+        //use chunks of a single segment in one row, and chunks bigger than the whole spline in another
+        for(size_t chunkSize : {size_t(1), size_t(7), size_t(1024)})
+        {
+            std::string rowName = QString("%1 (chunks of %2)").arg(name).arg(chunkSize).toStdString();
+            QTest::newRow(rowName.data()) << spline << chunkSize;
+        }
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("cubicHermiteAlpha", TestDataFloat::createCubicHermite(data, 0.5f));
+}
+
+void TestArcLength::testJobs(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(size_t, chunkSize);
+
+    SplineJobs::ThreadPool pool(3);
+    float totalLength = spline->totalLength();
+
+    for(auto executor : {pool.executor(), SplineJobs::inlineExecutor()})
+    {
+        //the callback is never called concurrently, so it doesn't need to synchronize
+        std::vector<float> reportedProgress;
+        SplineJobs::JobOptions options;
+        options.chunkSize = chunkSize;
+        options.progress = [&reportedProgress](float progress) { reportedProgress.push_back(progress); };
+
+        //the jobs do exactly the same work as partitionParallel, so the results should match exactly
+        for(float desiredLength : {totalLength / 2.1f, totalLength / 200.5f})
+        {
+            reportedProgress.clear();
+            auto job = SplineJobs::partition(executor, *spline.get(), desiredLength, options);
+
+            std::vector<float> expected = ArcLength::partitionParallel(*spline.get(), desiredLength);
+            QCOMPARE(job.get(), expected);
+            QCOMPARE(job.progress(), 1.0f);
+            QVERIFY(!job.isCancelled());
+
+            QVERIFY(reportedProgress.size() > 0);
+            QCOMPARE(reportedProgress.back(), 1.0f);
+            QVERIFY(std::is_sorted(reportedProgress.begin(), reportedProgress.end()));
+        }
+
+        for(size_t n : {size_t(0), size_t(1), size_t(20)})
+        {
+            auto job = SplineJobs::partitionN(executor, *spline.get(), n, options);
+
+            std::vector<float> expected = ArcLength::partitionNParallel(*spline.get(), n);
+            QCOMPARE(job.get(), expected);
+        }
+    }
+
+    //hold on to the tasks instead of running them, so that the job can be cancelled before any of them start
+    std::vector<std::function<void(void)>> queuedTasks;
+    SplineJobs::Executor deferredExecutor = [&queuedTasks](std::function<void(void)> task) { queuedTasks.push_back(std::move(task)); };
+
+    SplineJobs::JobOptions options;
+    options.chunkSize = chunkSize;
+    auto cancelledJob = SplineJobs::partition(deferredExecutor, *spline.get(), totalLength / 20.5f, options);
+    QVERIFY(!cancelledJob.isReady());
+    cancelledJob.cancel();
+
+    //every task still has to run for the job to finish, but once the job is cancelled, they don't do any work
+    while(!queuedTasks.empty())
+    {
+        auto task = std::move(queuedTasks.back());
+        queuedTasks.pop_back();
+        task();
+    }
+    QVERIFY(cancelledJob.isReady());
+    QVERIFY(cancelledJob.isCancelled());
+    QVERIFY(cancelledJob.get().empty());
+
+    //the single-task jobs should build exactly what building directly does
+    auto data = TestDataFloat::generateRandomData(20);
+    auto splineJob = SplineJobs::build<CubicHermiteSpline<Vector2>>(pool.executor(), data, 0.5f);
+    std::shared_ptr<CubicHermiteSpline<Vector2>> builtSpline = splineJob.get();
+    QVERIFY(builtSpline != nullptr);
+
+    std::vector<float> buildProgress;
+    SplineJobs::JobOptions buildOptions;
+    buildOptions.progress = [&buildProgress](float progress) { buildProgress.push_back(progress); };
+    auto optionsJob = SplineJobs::build<CubicHermiteSpline<Vector2>>(SplineJobs::inlineExecutor(), buildOptions, data, 0.5f);
+    QCOMPARE(optionsJob.get()->getMaxT(), builtSpline->getMaxT());
+    QCOMPARE(buildProgress, std::vector<float>{1.0f});
+
+    CubicHermiteSpline<Vector2> expectedSpline(data, 0.5f);
+    QCOMPARE(builtSpline->getMaxT(), expectedSpline.getMaxT());
+    QCOMPARE(builtSpline->getPosition(1.5f), expectedSpline.getPosition(1.5f));
+
+    auto inverterJob = SplineJobs::makeInverter(pool.executor(), *spline.get());
+    auto inverter = inverterJob.get();
+    QVERIFY(inverter != nullptr);
+
+    SplineInverter<Vector2> expectedInverter(*spline.get());
+    for(Vector2 queryPoint : {Vector2({0, 0}), Vector2({5, 2}), Vector2({-3, 8})})
+    {
+        QCOMPARE(inverter->findClosestT(queryPoint), expectedInverter.findClosestT(queryPoint));
+    }
+}
+
+void TestArcLength::testPartitionIndex_data(void)
+{
+    auto data = TestDataFloat::generateRandomData(50);
+
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data);
+    QTest::newRow("cubicHermiteAlpha") << TestDataFloat::createCubicHermite(data, 0.5f);
+    QTest::newRow("genericB") << TestDataFloat::createGenericBSpline(data, 4);
+    QTest::newRow("loopingCubicHermiteAlpha") << TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(data, 0.5f));
+}
+
+void TestArcLength::testPartitionIndex(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    ArcLengthIndex<Vector2> index(*spline);
+    float totalLength = index.totalLength();
+
+    //the index sums segment lengths into a running total instead of subtracting each piece as it goes, so the results will only match up to rounding
+    for(float desiredLength : {totalLength / 2.1f, totalLength / 20.5f, totalLength / 200.5f})
+    {
+        std::vector<float> expected = ArcLength::partition(*spline.get(), desiredLength);
+        std::vector<float> actual = ArcLength::partition(index, desiredLength);
+
+        QCOMPARE(actual.size(), expected.size());
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            QVERIFY(std::abs(actual[i] - expected[i]) < 0.001f);
+        }
+    }
+
+    std::vector<size_t> counts = {1, 2, 3, 4, 20, 200};
+    std::vector<std::vector<float>> multiple = ArcLength::partitionMultiN(index, counts);
+    QCOMPARE(multiple.size(), counts.size());
+
+    for(size_t c = 0; c < counts.size(); c++)
+    {
+        size_t n = counts[c];
+        std::vector<float> expected = ArcLength::partitionN(*spline.get(), n);
+        std::vector<float> actual = ArcLength::partitionN(index, n);
+
+        QCOMPARE(actual.size(), expected.size());
+        QCOMPARE(actual.front(), 0.0f);
+        QCOMPARE(actual.back(), spline->getMaxT());
+        for(size_t i = 0; i < expected.size(); i++)
+        {
+            QVERIFY(std::abs(actual[i] - expected[i]) < 0.001f);
+        }
+
+        //partitions that share a boundary share its solution, so partitionMultiN should be exactly the same as partitionN for each count
+        QVERIFY(multiple[c] == actual);
+    }
+
+    //the boundary shared by the partitions into 2 and 4 pieces should be the same value
+    QCOMPARE(multiple[1][1], multiple[3][2]);
+}
+
+
+void TestArcLength::testArcLengthIndex_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<float>("a");
+    QTest::addColumn<float>("b");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    auto rowFunction = [=](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+
+        //add a row for the whole spline
+        std::string allName = QString("%1 (All)").arg(name).toStdString();
+        QTest::newRow(allName.data()) << spline << 0.0f << spline->getMaxT();
+
+        //add a row where a and b fall partway through different segments, and so the index will be used
+        float partialA = lerp(spline->segmentT(2), spline->segmentT(3), 0.75f);
+        float partialB = lerp(spline->segmentT(spline->segmentCount() - 3), spline->segmentT(spline->segmentCount() - 2), 0.25f);
+        std::string partialName = QString("%1 (DifferentSegment)").arg(name).toStdString();
+        QTest::newRow(partialName.data()) << spline << partialA << partialB;
+
+        //add a row where a and b are in the same segment
+        size_t testIndex = 3;
+        float sameSegmentA = lerp(spline->segmentT(testIndex), spline->segmentT(testIndex + 1), 0.2f);
+        float sameSegmentB = lerp(spline->segmentT(testIndex), spline->segmentT(testIndex + 1), 0.6f);
+        std::string sameSegmentName = QString("%1 (SameSegment)").arg(name).toStdString();
+        QTest::newRow(sameSegmentName.data()) << spline << sameSegmentA << sameSegmentB;
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("cubicHermiteAlpha", TestDataFloat::createCubicHermite(data, 0.5f));
+    rowFunction("genericB", TestDataFloat::createGenericBSpline(data, 4));
+    rowFunction("loopingUniformCR", TestDataFloat::createLoopingUniformCR(data));
+    rowFunction("loopingCubicHermiteAlpha", TestDataFloat::createLoopingCatmullRom(data, 0.5f));
+}
+
+void TestArcLength::testArcLengthIndex(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(float, a);
+    QFETCH(float, b);
+
+    ArcLengthIndex<Vector2> index(*spline);
+
+    QCOMPARE(index.totalLength(), spline->totalLength());
+    QCOMPARE(index.arcLength(a, b), spline->arcLength(a, b));
+    QCOMPARE(index.arcLength(b, a), spline->arcLength(b, a));
+
+    //the per-segment lengths should add up to the prefix lengths
+    float runningTotal = 0;
+    for(size_t i = 0; i < spline->segmentCount(); i++)
+    {
+        QCOMPARE(index.lengthBeforeSegment(i), runningTotal);
+
+        //note: can't use arcLength here, because looping splines would wrap the end of the last segment back to 0
+        float segmentLength = spline->segmentArcLength(i, spline->segmentT(i), spline->segmentT(i + 1));
+        QCOMPARE(index.segmentLength(i), segmentLength);
+
+        //the middle of each segment should map back to the segment itself
+        QCOMPARE(index.segmentForLength(runningTotal + segmentLength * 0.5f), i);
+
+        runningTotal += segmentLength;
+    }
+
+    //looping splines also have to match the spline's cyclic arc length, including when a and b are out of range
+    if(spline->isLooping())
+    {
+        auto loopingSpline = std::static_pointer_cast<LoopingSpline<Vector2>>(spline);
+        float maxT = spline->getMaxT();
+
+        QCOMPARE(index.cyclicArcLength(a, b), loopingSpline->cyclicArcLength(a, b));
+        QCOMPARE(index.cyclicArcLength(b, a), loopingSpline->cyclicArcLength(b, a));
+        QCOMPARE(index.cyclicArcLength(b, a + maxT), loopingSpline->cyclicArcLength(b, a + maxT));
+        QCOMPARE(index.cyclicArcLength(a - maxT, b), loopingSpline->cyclicArcLength(a - maxT, b));
+    }
+}
+
+
+void TestArcLength::testArcLengthParameterization_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<float>("maxError");
+
+    auto data = TestDataFloat::generateRandomData(10);
+    auto triangleData = TestDataFloat::generateTriangleNumberData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data) << 0.001f;
+    QTest::newRow("uniformCR (Coarse)") << TestDataFloat::createUniformCR(triangleData) << 0.01f;
+    QTest::newRow("cubicHermiteAlpha") << TestDataFloat::createCubicHermite(data, 0.5f) << 0.001f;
+    QTest::newRow("natural") << TestDataFloat::createNatural(data, true, 0.0f) << 0.001f;
+    QTest::newRow("genericB") << TestDataFloat::createGenericBSpline(data, 4) << 0.001f;
+    QTest::newRow("loopingQuinticCatmullRom") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingQuinticCatmullRom(data, 0.5f)) << 0.001f;
+    QTest::newRow("circularGenericB") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createCircularGenericBSpline(10, 3, 10.0f)) << 0.001f;
+}
+
+void TestArcLength::testArcLengthParameterization(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(float, maxError);
+
+    ArcLengthParameterization<Vector2> parameterization(*spline, maxError);
+    QVERIFY(parameterization.measuredError() <= maxError);
+    QCOMPARE(parameterization.totalLength(), spline->totalLength());
+
+    //the error is only measured at the middle of each piece, so allow some slack at arbitrary lengths
+    float totalLength = spline->totalLength();
+    size_t n = 37;
+    float previousT = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        float desiredLength = totalLength * i / n;
+
+        float t = parameterization.tForLength(desiredLength);
+        QVERIFY(std::abs(spline->arcLength(0, t) - desiredLength) <= maxError * 2);
+
+        //the fit is monotonic, so T has to increase along with arc length
+        QVERIFY(t >= previousT);
+        previousT = t;
+
+        float solvedT = parameterization.solveLength(desiredLength);
+        float expectedT = ArcLength::solveLength(*spline, 0.0f, desiredLength);
+        QCOMPARE(solvedT + 1, expectedT + 1);
+    }
+
+    if(spline->isLooping())
+    {
+        //lengths past the end should wrap around, and the result should be unwrapped by the same amount
+        float desiredLength = totalLength * 0.3f;
+        float expectedT = parameterization.tForLength(desiredLength);
+        QCOMPARE(parameterization.tForLength(desiredLength + totalLength * 2), expectedT + spline->getMaxT() * 2);
+        QCOMPARE(parameterization.tForLength(desiredLength - totalLength), expectedT - spline->getMaxT());
+    }
+    else
+    {
+        //lengths past the end should be clamped
+        QCOMPARE(parameterization.tForLength(totalLength * 2), spline->getMaxT());
+        QCOMPARE(parameterization.tForLength(-1) + 1, 1.0f);
+    }
+}
+
+
+void TestArcLength::testArcLengthParameterizationZeroLength(void)
+{
+    std::vector<Vector2> data(10, Vector2({0, 0}));
+    auto spline = TestDataFloat::createUniformCR(data);
+    auto loopingSpline = TestDataFloat::createLoopingUniformCR(data);
+
+    for(const auto &s : {spline, TestDataFloat::cast(loopingSpline)})
+    {
+        ArcLengthParameterization<Vector2> parameterization(*s);
+        QCOMPARE(parameterization.totalLength(), 0.0f);
+        QCOMPARE(parameterization.pieceCount(), size_t(1));
+
+        for(float length : {-1.0f, 0.0f, 0.5f, 10.0f})
+        {
+            QCOMPARE(parameterization.tForLength(length), 0.0f);
+            QCOMPARE(parameterization.solveLength(length), 0.0f);
+        }
+    }
+}
+
+
+void TestArcLength::testInstrumentation_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    //both of these have non-uniform knots, so they have to search for the segment of each T
+    QTest::newRow("CatmullRomAlpha") << TestDataFloat::createCatmullRom(data, 0.5f);
+    QTest::newRow("LoopingCubicHermiteAlpha") << std::shared_ptr<Spline<Vector2>>(TestDataFloat::createLoopingCubicHermite(data, 0.5f));
+}
+
+void TestArcLength::testInstrumentation(void)
+{
+    if(!SplineInstrumentation::enabled)
+        QSKIP("Built without SPLINE_LIBRARY_INSTRUMENTATION");
+
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    typedef SplineInstrumentation::Counter Counter;
+    typedef SplineInstrumentation::Timer Timer;
+
+    SplineInstrumentation::reset();
+    SplineInstrumentation::Snapshot empty = SplineInstrumentation::snapshot();
+    for(size_t i = 0; i < SplineInstrumentation::counterCount; i++)
+    {
+        QCOMPARE(empty.counters[i], uint64_t(0));
+    }
+
+    float maxT = spline->getMaxT();
+    spline->getPosition(maxT * 0.3f);
+    spline->getTangent(maxT * 0.6f);
+    spline->getTangent(maxT * 0.9f);
+    SplineInstrumentation::Snapshot evaluations = SplineInstrumentation::snapshot();
+    QCOMPARE(evaluations[Counter::PositionEvaluations], uint64_t(1));
+    QCOMPARE(evaluations[Counter::TangentEvaluations], uint64_t(2));
+    QCOMPARE(evaluations[Counter::SegmentLookups], uint64_t(3));
+    QCOMPARE(evaluations[Counter::QuadratureCalls], uint64_t(0));
+
+    //the default quadrature uses 13 points for every call
+    spline->arcLength(maxT * 0.1f, maxT * 0.7f);
+    SplineInstrumentation::Snapshot integration = SplineInstrumentation::snapshot() - evaluations;
+    QVERIFY(integration[Counter::QuadratureCalls] > 0);
+    QCOMPARE(integration[Counter::IntegrandEvaluations], integration[Counter::QuadratureCalls] * 13);
+    QCOMPARE(integration[Counter::HalleyIterations], uint64_t(0));
+
+    //every halley iteration computes an arc length and a curvature
+    ArcLength::solveLength(*spline, maxT * 0.2f, spline->totalLength() * 0.4f);
+    SplineInstrumentation::Snapshot solve = SplineInstrumentation::snapshot() - integration - evaluations;
+    QVERIFY(solve[Counter::HalleyIterations] > 0);
+    QCOMPARE(solve[Counter::CurvatureEvaluations], solve[Counter::HalleyIterations]);
+    if(SplineInstrumentation::timersEnabled)
+    {
+        QCOMPARE(solve.calls(Timer::SolveLength), uint64_t(1));
+    }
+
+    //a worker thread's counts are added to the totals when it exits, but never to this thread's own counts
+    SplineInstrumentation::Snapshot beforeThread = SplineInstrumentation::snapshot();
+    std::thread worker([spline, maxT]() {
+        for(int i = 0; i < 5; i++)
+        {
+            spline->getPosition(maxT * i / 5);
+        }
+    });
+    worker.join();
+    SplineInstrumentation::Snapshot threaded = SplineInstrumentation::snapshot() - beforeThread;
+    QCOMPARE(threaded[Counter::PositionEvaluations], uint64_t(5));
+    QCOMPARE(SplineInstrumentation::threadSnapshot()[Counter::PositionEvaluations], uint64_t(1));
+
+    SplineInstrumentation::reset();
+    QCOMPARE(SplineInstrumentation::snapshot()[Counter::PositionEvaluations], uint64_t(0));
+}
@@ -13,6 +13,17 @@ private slots:
     void testArcLengthTotalLength_data(void);
     void testArcLengthTotalLength(void);
 
+    //verify that the arcLength and segmentArcLength overloads that take a quadrature agree with the default integration
+    void testArcLengthQuadrature_data(void);
+    void testArcLengthQuadrature(void);
+
+    //verify that uniform splines' precomputed whole-segment quadrature matches integrating their tangents with the same rule
+    void testUniformSegmentQuadrature(void);
+
+    //verify that caching the speed polynomials of a cubic spline doesn't change its arc lengths, and that editing the spline discards the cache
+    void testSpeedPolynomials_data(void);
+    void testSpeedPolynomials(void);
+
     //For some known arc length values, verify that each spline gives the correct result
     void testKnownArcLength_data(void);
     void testKnownArcLength(void);
@@ -29,6 +40,10 @@ private slots:
     void testSolveCyclic_data(void);
     void testSolveCyclic(void);
 
+    //verify that solveLengths gives the same results as calling solveLength for each length
+    void testSolveLengths_data(void);
+    void testSolveLengths(void);
+
     //verify that the "partition" method works as expected
     void testPartition_data(void);
     void testPartition(void);
@@ -36,4 +51,32 @@ private slots:
     //verify that the "partitionN" method works as expected
     void testPartitionN_data(void);
     void testPartitionN(void);
+
+    //verify that partitionParallel and partitionNParallel give the same results as partition and partitionN, for several thread counts
+    void testPartitionParallel_data(void);
+    void testPartitionParallel(void);
+
+    //verify that partition jobs give the same results as partitionParallel on any executor, that they report their progress, and that they can be cancelled
+    //also verify that the single-task jobs build the same spline and inverter as building them directly
+    void testJobs_data(void);
+    void testJobs(void);
+
+    //verify that partitioning with an ArcLengthIndex gives the same results as partition and partitionN, and that partitionMultiN matches partitionN for each count
+    void testPartitionIndex_data(void);
+    void testPartitionIndex(void);
+
+    //verify that an ArcLengthIndex gives the same results as the spline's own arc length methods
+    void testArcLengthIndex_data(void);
+    void testArcLengthIndex(void);
+
+    //verify that an ArcLengthParameterization stays within its error bound, and that its refined results match the arc length solver
+    void testArcLengthParameterization_data(void);
+    void testArcLengthParameterization(void);
+
+    //verify that an ArcLengthParameterization of a spline whose points are all the same maps every length to T = 0
+    void testArcLengthParameterizationZeroLength(void);
+
+    //verify that the instrumentation counters count evaluations, segment lookups, quadrature calls, and halley iterations, including from other threads
+    void testInstrumentation_data(void);
+    void testInstrumentation(void);
 };
@@ -2,6 +2,8 @@
 
 #include "spline_library/utils/calculus.h"
 
+#include <cmath>
+
 #include <QtTest/QtTest>
 
 TestCalculus::TestCalculus(QObject *parent) : QObject(parent)
@@ -31,3 +33,113 @@ void TestCalculus::testGaussLegendre(void)
 
     QCOMPARE(result, expected);
 }
+
+void TestCalculus::testGaussKronrod_data(void)
+{
+    QTest::addColumn<float>("from");
+    QTest::addColumn<float>("to");
+    QTest::addColumn<float>("tolerance");
+
+    QTest::newRow("loose") << -1.0f << 2.0f << 0.01f;
+    QTest::newRow("tight") << -1.0f << 2.0f << 0.00001f;
+    QTest::newRow("wide") << -4.0f << 6.0f << 0.001f;
+    QTest::newRow("unreachable tolerance") << 0.0f << 3.0f << 0.0f;
+}
+
+void TestCalculus::testGaussKronrod(void)
+{
+    QFETCH(float, from);
+    QFETCH(float, to);
+    QFETCH(float, tolerance);
+
+    //polynomials of degree 9 or lower should be integrated exactly by both rules, up to rounding
+    auto polynomial = [](float x){return x*x*(x-1);};
+    QCOMPARE(SplineLibraryCalculus::fastGaussLegendreQuadratureIntegral<float>(polynomial, from, to),
+             SplineLibraryCalculus::gaussLegendreQuadratureIntegral<float>(polynomial, from, to));
+    QCOMPARE(SplineLibraryCalculus::adaptiveGaussKronrodIntegral(polynomial, from, to, tolerance),
+             SplineLibraryCalculus::gaussLegendreQuadratureIntegral<float>(polynomial, from, to));
+
+    //the speed of a spline is usually a square root of a polynomial, which no fixed rule integrates exactly
+    //the integral of sqrt(1 + x^2) is (x * sqrt(1 + x^2) + asinh(x)) / 2
+    auto speed = [](float x){return std::sqrt(1 + 16 * x * x);};
+    auto antiderivative = [](double x){return (4 * x * std::sqrt(1 + 16 * x * x) + std::asinh(4 * x)) / 8;};
+    float expected = float(antiderivative(to) - antiderivative(from));
+
+    float result = SplineLibraryCalculus::adaptiveGaussKronrodIntegral(speed, from, to, tolerance);
+
+    //a float sum can't get closer than rounding error, so allow some slack for the tight tolerances
+    float allowedError = std::max(tolerance, expected * 1e-5f);
+    QVERIFY(std::abs(result - expected) <= allowedError);
+
+    //the runtime quadrature selector should give the same results as calling each integrator directly
+    typedef SplineLibraryCalculus::Quadrature<float> Quadrature;
+    QCOMPARE(Quadrature::adaptive(tolerance)(speed, from, to), result);
+    QCOMPARE(Quadrature::fast()(speed, from, to), SplineLibraryCalculus::fastGaussLegendreQuadratureIntegral<float>(speed, from, to));
+    QCOMPARE(Quadrature::gaussLegendre()(speed, from, to), SplineLibraryCalculus::gaussLegendreQuadratureIntegral<float>(speed, from, to));
+}
+
+template<size_t n>
+static void verifyGaussLegendreRule(void)
+{
+    typedef SplineLibraryCalculus::GaussLegendreRule<n> Rule;
+
+    //the weights integrate 1 over [-1, 1], and the points are in ascending order and symmetric
+    double weightSum = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        weightSum += Rule::table.weights[i];
+        QCOMPARE(Rule::table.points[i], -Rule::table.points[n - 1 - i]);
+        if(i > 0)
+            QVERIFY(Rule::table.points[i - 1] < Rule::table.points[i]);
+    }
+    QVERIFY(std::abs(weightSum - 2) < 1e-14);
+
+    //exact for polynomials of degree 2n - 1
+    auto polynomial = [](double x){ return std::pow(x, double(2 * n - 1)) + std::pow(x, double(2 * n - 2)); };
+    double expected = (std::pow(2.0, double(2 * n)) - 1) / double(2 * n) + (std::pow(2.0, double(2 * n - 1)) + 1) / double(2 * n - 1);
+    double result = Rule::template integrate<double>(polynomial, -1.0, 2.0);
+    QVERIFY(std::abs(result - expected) < 1e-12 * expected);
+
+}
+
+template<size_t n, size_t last>
+struct VerifyGaussLegendreRules
+{
+    static void verify(void)
+    {
+        verifyGaussLegendreRule<n>();
+        VerifyGaussLegendreRules<n + 1, last>::verify();
+    }
+};
+
+template<size_t last>
+struct VerifyGaussLegendreRules<last, last>
+{
+    static void verify(void) { verifyGaussLegendreRule<last>(); }
+};
+
+void TestCalculus::testGaussLegendreRule(void)
+{
+    VerifyGaussLegendreRules<3, 32>::verify();
+
+    //published values for the 5 and 13 point rules, which used to be hardcoded
+    typedef SplineLibraryCalculus::GaussLegendreRule<5> Five;
+    QVERIFY(std::abs(Five::table.points[4] - 0.9061798459386640) < 1e-15);
+    QVERIFY(std::abs(Five::table.points[3] - 0.5384693101056831) < 1e-15);
+    QVERIFY(std::abs(Five::table.weights[4] - 0.2369268850561891) < 1e-15);
+    QVERIFY(std::abs(Five::table.weights[2] - 0.5688888888888889) < 1e-15);
+
+    typedef SplineLibraryCalculus::GaussLegendreRule<13> Thirteen;
+    QCOMPARE(Thirteen::table.points[6], 0.0);
+    QVERIFY(std::abs(Thirteen::table.points[12] - 0.9841830547185881) < 1e-15);
+    QVERIFY(std::abs(Thirteen::table.weights[12] - 0.0404840047653159) < 1e-15);
+    QVERIFY(std::abs(Thirteen::table.weights[6] - 0.2325515532308739) < 1e-15);
+
+    //the tables are constant expressions
+    static_assert(SplineLibraryCalculus::GaussLegendreRule<3>::table.weights[1] > 0.88, "the tables should be usable at compile time");
+
+    //the quadrature functor should integrate with the rule of the same order
+    auto speed = [](float x){return std::sqrt(1 + 16 * x * x);};
+    QCOMPARE(SplineLibraryCalculus::GaussLegendreQuadrature<7>()(speed, 0.5f, 2.0f), SplineLibraryCalculus::GaussLegendreRule<7>::integrate<float>(speed, 0.5f, 2.0f));
+    QCOMPARE(SplineLibraryCalculus::DefaultQuadrature()(speed, 0.5f, 2.0f, 3.0f), 3.0f * SplineLibraryCalculus::gaussLegendreQuadratureIntegral<float>(speed, 0.5f, 2.0f));
+}
@@ -13,4 +13,11 @@ signals:
 private slots:
     void testGaussLegendre_data(void);
     void testGaussLegendre(void);
+
+    //verify that the fast gauss-legendre and adaptive gauss-kronrod integrators agree with known integrals
+    void testGaussKronrod_data(void);
+    void testGaussKronrod(void);
+
+    //verify that the compile-time gauss-legendre rules from 3 to 32 points are exact for polynomials of their maximum degree, and match published tables
+    void testGaussLegendreRule(void);
 };
@@ -3,6 +3,8 @@
 #include "spline_library/utils/linearalgebra.h"
 
 #include <vector>
+#include <random>
+#include <cmath>
 
 #include <QtTest/QtTest>
 #include <QDebug>
@@ -115,3 +117,110 @@ void TestLinAlg::testCyclicTridiagonal(void)
         QCOMPARE(result[i], expected_output[i]);
     }
 }
+
+//a random diagonally dominant system, like the ones natural splines build
+static void makeRandomSystem(size_t size, unsigned seed, std::vector<float> &mainDiagonal, std::vector<float> &secondaryDiagonal, std::vector<float> &input)
+{
+    std::minstd_rand gen(seed);
+    std::uniform_real_distribution<float> distribution(0.5f, 2.0f);
+
+    secondaryDiagonal.resize(size);
+    for(auto &value : secondaryDiagonal)
+        value = distribution(gen);
+
+    mainDiagonal.resize(size);
+    for(size_t i = 0; i < size; i++)
+        mainDiagonal[i] = 2 * (secondaryDiagonal[i] + secondaryDiagonal[(i + size - 1) % size]);
+
+    input.resize(size);
+    for(auto &value : input)
+        value = distribution(gen) * 10 - 10;
+}
+
+void TestLinAlg::testBatchedTridiagonal_data(void)
+{
+    QTest::addColumn<size_t>("size");
+    QTest::addColumn<size_t>("rhsCount");
+
+    QTest::newRow("single") << size_t(10) << size_t(1);
+    QTest::newRow("few") << size_t(10) << size_t(3);
+    QTest::newRow("many") << size_t(50) << size_t(17);
+    QTest::newRow("oneRow") << size_t(1) << size_t(4);
+}
+void TestLinAlg::testBatchedTridiagonal(void)
+{
+    QFETCH(size_t, size);
+    QFETCH(size_t, rhsCount);
+
+    std::vector<float> mainDiagonal, secondaryDiagonal, unused;
+    makeRandomSystem(size, 1, mainDiagonal, secondaryDiagonal, unused);
+
+    //build several inputs, and interleave them
+    std::vector<std::vector<float>> inputs(rhsCount);
+    std::vector<float> interleaved(size * rhsCount);
+    for(size_t r = 0; r < rhsCount; r++)
+    {
+        std::vector<float> m, s;
+        makeRandomSystem(size, unsigned(r + 2), m, s, inputs[r]);
+        for(size_t i = 0; i < size; i++)
+            interleaved[i * rhsCount + r] = inputs[r][i];
+    }
+
+    //non-cyclic: factor once, then solve every input together
+    std::vector<float> factored = mainDiagonal, multipliers(size);
+    std::vector<float> noncyclicResult = interleaved;
+    LinearAlgebra::factorSymmetricTridiagonalInPlace(factored.data(), secondaryDiagonal.data(), multipliers.data(), size);
+    LinearAlgebra::solveFactoredSymmetricTridiagonalInPlace(factored.data(), secondaryDiagonal.data(), multipliers.data(), noncyclicResult.data(), size, rhsCount);
+
+    //cyclic
+    std::vector<float> cyclicDiagonal = mainDiagonal, scratch(size * 2);
+    std::vector<float> cyclicResult = interleaved;
+    if(size > 1)
+        LinearAlgebra::solveCyclicSymmetricTridiagonalBatchInPlace(cyclicDiagonal.data(), secondaryDiagonal.data(), cyclicResult.data(), scratch.data(), size, rhsCount);
+
+    for(size_t r = 0; r < rhsCount; r++)
+    {
+        auto expected = LinearAlgebra::solveSymmetricTridiagonal(mainDiagonal, secondaryDiagonal, inputs[r]);
+        for(size_t i = 0; i < size; i++) {
+            QCOMPARE(noncyclicResult[i * rhsCount + r], expected[i]);
+        }
+
+        if(size > 1)
+        {
+            auto expectedCyclic = LinearAlgebra::solveCyclicSymmetricTridiagonal(mainDiagonal, secondaryDiagonal, inputs[r]);
+            for(size_t i = 0; i < size; i++) {
+                QCOMPARE(cyclicResult[i * rhsCount + r], expectedCyclic[i]);
+            }
+        }
+    }
+}
+
+void TestLinAlg::testParallelTridiagonal_data(void)
+{
+    QTest::addColumn<size_t>("size");
+    QTest::addColumn<size_t>("threadCount");
+
+    QTest::newRow("serial") << size_t(100) << size_t(1);
+    QTest::newRow("twoThreads") << size_t(100) << size_t(2);
+    QTest::newRow("manyThreads") << size_t(1000) << size_t(7);
+    QTest::newRow("tinyBlocks") << size_t(9) << size_t(4);
+    QTest::newRow("tooManyThreads") << size_t(5) << size_t(16);
+}
+void TestLinAlg::testParallelTridiagonal(void)
+{
+    QFETCH(size_t, size);
+    QFETCH(size_t, threadCount);
+
+    std::vector<float> mainDiagonal, secondaryDiagonal, input;
+    makeRandomSystem(size, 7, mainDiagonal, secondaryDiagonal, input);
+
+    auto expected = LinearAlgebra::solveSymmetricTridiagonal(mainDiagonal, secondaryDiagonal, input);
+    auto result = LinearAlgebra::solveSymmetricTridiagonalParallel(mainDiagonal, secondaryDiagonal, input, threadCount);
+
+    //the parallel solver does its arithmetic in a different order, so allow for some rounding error
+    QCOMPARE(result.size(), expected.size());
+    for(size_t i = 0; i < result.size(); i++) {
+        QVERIFY(std::abs(result[i] - expected[i]) < 0.0001f);
+    }
+}
+
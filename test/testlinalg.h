@@ -19,4 +19,12 @@ private slots:
 
     void testCyclicTridiagonal_data(void);
     void testCyclicTridiagonal(void);
+
+    //verify that the batched solvers give the same results as solving each input separately
+    void testBatchedTridiagonal_data(void);
+    void testBatchedTridiagonal(void);
+
+    //verify that the parallel solver gives the same results as the serial one
+    void testParallelTridiagonal_data(void);
+    void testParallelTridiagonal(void);
 };
@@ -0,0 +1,258 @@
+#include "testperformance.h"
+
+#include "common.h"
+#include "benchmark/benchmarkharness.h"
+#include "spline_library/utils/splineinverter.h"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <array>
+
+#include <QtTest/QtTest>
+
+typedef std::function<TestDataFloat::SplinePtr(const std::vector<Vector2>&)> SplineFactory;
+Q_DECLARE_METATYPE(SplineFactory)
+
+namespace
+{
+    //every timing is repeated this many times, and the fastest is kept, so that a single interruption doesn't fail the test
+    const size_t repetitions = 5;
+
+    //a timing that looks like a regression is measured again this many times before it's reported, since a busy machine can slow down a whole measurement
+    const size_t retries = 2;
+
+    const double minTime = 0.02;
+    const size_t pointCount = 1000;
+    const size_t queryCount = 1000;
+}
+
+TestPerformance::TestPerformance(QObject *parent) : QObject(parent)
+{
+
+}
+
+double TestPerformance::measure(const std::string &name, size_t itemsPerIteration, const std::function<void(void)> &body)
+{
+    SplineBenchmark::Options options;
+    options.minTime = minTime;
+    SplineBenchmark::Runner runner(options);
+
+    SplineBenchmark::Result description;
+    description.name = name;
+    description.floatingType = "float";
+    description.dimension = 2;
+    description.points = pointCount;
+    for(size_t i = 0; i < repetitions; i++)
+    {
+        runner.run(description, itemsPerIteration, body);
+    }
+
+    double fastest = runner.getResults().front().nanosecondsPerItem;
+    for(const auto &result : runner.getResults())
+    {
+        fastest = std::min(fastest, result.nanosecondsPerItem);
+    }
+    return fastest;
+}
+
+void TestPerformance::initTestCase(void)
+{
+#ifndef QT_NO_DEBUG
+    QSKIP("Performance tests only run in release builds");
+#endif
+    //the counters and timers would be measured along with the code they count, and the baseline is measured without them
+    if(SplineInstrumentation::enabled)
+        QSKIP("Performance tests only run without SPLINE_LIBRARY_INSTRUMENTATION");
+
+    tolerance = 0.25;
+    if(qEnvironmentVariableIsSet("SPLINE_PERF_TOLERANCE"))
+        tolerance = qgetenv("SPLINE_PERF_TOLERANCE").toDouble();
+
+    constructionTolerance = 0.5;
+    if(qEnvironmentVariableIsSet("SPLINE_PERF_CONSTRUCTION_TOLERANCE"))
+        constructionTolerance = qgetenv("SPLINE_PERF_CONSTRUCTION_TOLERANCE").toDouble();
+
+    baselineOutputPath = qgetenv("SPLINE_PERF_BASELINE_OUT").toStdString();
+    if(baselineOutputPath.empty())
+    {
+        QString baselinePath = qEnvironmentVariableIsSet("SPLINE_PERF_BASELINE") ? QString(qgetenv("SPLINE_PERF_BASELINE")) : QFINDTESTDATA("performance_baseline.txt");
+        std::ifstream file(baselinePath.toStdString());
+        if(!file)
+            QSKIP("Couldn't find the performance baseline");
+
+        //each line is a name and a time relative to its calibration loop. lines starting with # are comments
+        std::string line;
+        while(std::getline(file, line))
+        {
+            if(line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream stream(line);
+            std::string name;
+            double relativeTime;
+            if(stream >> name >> relativeTime)
+                baseline[name] = relativeTime;
+        }
+    }
+
+    //a chain of dependent multiply-adds, which is limited by floating point latency the same way most spline evaluation is
+    std::vector<float> values(queryCount);
+    for(size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = float(i % 7) * 0.125f;
+    }
+    calibrationNanoseconds = measure("Calibration", values.size(), [&values]() {
+        float sum = 0;
+        for(float value : values)
+            sum = sum * 0.999f + value * value;
+        SplineBenchmark::sink = SplineBenchmark::sink + double(sum);
+    });
+
+    //copies the values, then grows an array of segment-sized records one at a time, the way most constructors fill their segment arrays.
+    //this is limited by the allocator and memory bandwidth the same way construction is
+    allocationCalibrationNanoseconds = measure("AllocationCalibration", values.size(), [&values]() {
+        std::vector<float> copy(values.begin(), values.end());
+        std::vector<std::array<float, 8>> segments;
+        for(size_t i = 1; i < copy.size(); i++)
+        {
+            segments.push_back({{copy[i - 1], copy[i], copy[i - 1], copy[i], copy[i - 1], copy[i], copy[i - 1], copy[i]}});
+        }
+        SplineBenchmark::sink = SplineBenchmark::sink + double(segments.back()[0]);
+    });
+}
+
+void TestPerformance::cleanupTestCase(void)
+{
+    if(baselineOutputPath.empty())
+        return;
+
+    std::ofstream file(baselineOutputPath);
+    QVERIFY2(bool(file), "Couldn't write the performance baseline");
+
+    file << "# nanoseconds per item of each TestPerformance measurement, divided by nanoseconds per item of its calibration loop" << std::endl;
+    file << "# construction is divided by the allocation calibration loop, and everything else by the arithmetic calibration loop" << std::endl;
+    for(const auto &entry : measured)
+    {
+        file << entry.first << " " << entry.second << std::endl;
+    }
+}
+
+void TestPerformance::testThroughput_data(void)
+{
+    QTest::addColumn<SplineFactory>("factory");
+
+    QTest::newRow("UniformCR") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createUniformCR(points); });
+    QTest::newRow("CatmullRom") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createCatmullRom(points, 0.5f); });
+    QTest::newRow("CubicHermite") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createCubicHermite(points, 0.5f); });
+    QTest::newRow("QuinticCatmullRom") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createQuinticCatmullRom(points, 0.5f); });
+    QTest::newRow("QuinticHermite") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createQuinticHermite(points, 0.5f); });
+    QTest::newRow("Natural") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createNatural(points, true, 0.5f); });
+    QTest::newRow("NotAKnot") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createNotAKnot(points, true, 0.5f); });
+    QTest::newRow("UniformBSpline") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createUniformBSpline(points); });
+    QTest::newRow("GenericBSpline5") << SplineFactory([](const std::vector<Vector2> &points) { return TestDataFloat::createGenericBSpline(points, 5); });
+    QTest::newRow("BakedCubic") << SplineFactory([](const std::vector<Vector2> &points) {
+        return TestDataFloat::createBakedCubic(TestDataFloat::createNatural(points, true, 0.5f)); });
+    QTest::newRow("LoopingCatmullRom") << SplineFactory([](const std::vector<Vector2> &points) {
+        return TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(points, 0.5f)); });
+    QTest::newRow("LoopingNatural") << SplineFactory([](const std::vector<Vector2> &points) {
+        return TestDataFloat::cast(TestDataFloat::createLoopingNatural(points, 0.5f)); });
+}
+
+void TestPerformance::testThroughput(void)
+{
+    QFETCH(SplineFactory, factory);
+    std::string splineName = QTest::currentDataTag();
+
+    auto points = TestDataFloat::generateRandomData(pointCount);
+    auto spline = factory(points);
+
+    std::minstd_rand gen(pointCount);
+    std::uniform_real_distribution<float> tDistribution(0, spline->getMaxT());
+    std::vector<float> tValues(queryCount);
+    for(auto &t : tValues)
+    {
+        t = tDistribution(gen);
+    }
+
+    SplineInverter<Vector2> inverter(*spline);
+    std::vector<Vector2> queryPoints(queryCount);
+    for(size_t i = 0; i < queryCount; i++)
+    {
+        queryPoints[i] = spline->getPosition(tValues[i]) + Vector2({0.5f, -0.5f});
+    }
+
+    std::vector<std::string> regressions;
+    auto check = [&](const char *operation, size_t items, double calibration, double allowed, const std::function<void(void)> &body) {
+        std::string name = splineName + "/" + operation;
+        double relativeTime = measure(name, items, body) / calibration;
+
+        auto expected = baseline.find(name);
+        if(expected == baseline.end())
+        {
+            measured[name] = relativeTime;
+            if(baselineOutputPath.empty())
+            {
+                std::string message = "No performance baseline for " + name;
+                QWARN(message.data());
+            }
+            return;
+        }
+
+        for(size_t i = 0; i < retries && relativeTime > expected->second * (1 + allowed); i++)
+        {
+            relativeTime = std::min(relativeTime, measure(name, items, body) / calibration);
+        }
+        measured[name] = relativeTime;
+
+        if(relativeTime > expected->second * (1 + allowed))
+        {
+            std::ostringstream message;
+            message << name << " took " << relativeTime << " calibration units per item, but the baseline is " << expected->second
+                    << " (" << int((relativeTime / expected->second - 1) * 100) << "% slower)";
+            regressions.push_back(message.str());
+        }
+    };
+
+    check("construction", points.size(), allocationCalibrationNanoseconds, constructionTolerance, [&]() {
+        auto built = factory(points);
+        SplineBenchmark::sink = SplineBenchmark::sink + double(built->getMaxT());
+    });
+    check("getPosition", tValues.size(), calibrationNanoseconds, tolerance, [&]() {
+        float sum = 0;
+        for(float t : tValues)
+            sum += spline->getPosition(t)[0];
+        SplineBenchmark::sink = SplineBenchmark::sink + double(sum);
+    });
+    check("getCurvature", tValues.size(), calibrationNanoseconds, tolerance, [&]() {
+        float sum = 0;
+        for(float t : tValues)
+            sum += spline->getCurvature(t).curvature[0];
+        SplineBenchmark::sink = SplineBenchmark::sink + double(sum);
+    });
+    //arc lengths of about one segment, so that each query integrates parts of two segments
+    float maxT = spline->getMaxT();
+    check("arcLength", tValues.size(), calibrationNanoseconds, tolerance, [&]() {
+        float sum = 0;
+        for(float t : tValues)
+            sum += spline->arcLength(t, std::min(t + 1, maxT));
+        SplineBenchmark::sink = SplineBenchmark::sink + double(sum);
+    });
+    check("findClosestT", queryPoints.size(), calibrationNanoseconds, tolerance, [&]() {
+        float sum = 0;
+        for(const Vector2 &queryPoint : queryPoints)
+            sum += inverter.findClosestT(queryPoint);
+        SplineBenchmark::sink = SplineBenchmark::sink + double(sum);
+    });
+
+    //report every regression of this spline type at once, rather than stopping at the first
+    if(!regressions.empty())
+    {
+        std::string message = "Performance regression:";
+        for(const std::string &regression : regressions)
+        {
+            message += "\n    " + regression;
+        }
+        QFAIL(message.data());
+    }
+}
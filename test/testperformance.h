@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QObject>
+
+#include <map>
+#include <string>
+#include <functional>
+
+//throughput regression tests. every timing is divided by the timing of a fixed reference loop measured in the same run, so that the baseline
+//carries over between machines of roughly the same kind, and is compared to test/performance_baseline.txt
+//evaluation, arc length, and inversion are divided by an arithmetic loop, and construction by a loop that allocates and fills arrays,
+//since construction depends on the allocator and memory bandwidth, which don't scale with floating point latency from one machine to the next
+//wall-clock timings depend on how busy the machine is, so these aren't part of the unit tests: they're built by themselves with qmake CONFIG+=perftest
+//environment variables:
+//  SPLINE_PERF_TOLERANCE=0.25    fail if anything is more than this fraction slower than the baseline
+//  SPLINE_PERF_CONSTRUCTION_TOLERANCE=0.5    the same for construction, which still varies more between machines
+//  SPLINE_PERF_BASELINE=path     read the baseline from path instead
+//  SPLINE_PERF_BASELINE_OUT=path write every measurement to path as a new baseline, instead of comparing
+class TestPerformance : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestPerformance(QObject *parent = 0);
+
+private slots:
+    //read the baseline, and time the calibration loops
+    void initTestCase(void);
+
+    //write the new baseline, if one was requested
+    void cleanupTestCase(void);
+
+    //time construction, evaluation, arc length, and inversion of each spline type, and verify that none of them is slower than the baseline by more than the tolerance
+    void testThroughput_data(void);
+    void testThroughput(void);
+
+private:
+    //the fastest of a few timings of body, in nanoseconds per item
+    double measure(const std::string &name, size_t itemsPerIteration, const std::function<void(void)> &body);
+
+    std::map<std::string, double> baseline;
+    std::map<std::string, double> measured;
+
+    double calibrationNanoseconds;
+    double allocationCalibrationNanoseconds;
+    double tolerance;
+    double constructionTolerance;
+    std::string baselineOutputPath;
+};
@@ -3,6 +3,7 @@
 #include "spline_library/vector.h"
 #include "spline_library/utils/spline_common.h"
 #include "spline_library/utils/calculus.h"
+#include "spline_library/utils/arclength.h"
 
 #include "spline_library/splines/uniform_cubic_bspline.h"
 #include "spline_library/splines/generic_b_spline.h"
@@ -12,14 +13,24 @@
 #include "spline_library/splines/quintic_hermite_spline.h"
 
 #include "spline_library/utils/splineinverter.h"
+#include "spline_library/utils/splinecursor.h"
+#include "spline_library/utils/splinefile.h"
+#include "spline_library/utils/splinescratch.h"
+#include "spline_library/utils/splinegpubuffer.h"
+#include "spline_library/utils/splinepool.h"
 
 #include "common.h"
 
 #include <vector>
 #include <memory>
 #include <cmath>
+#include <random>
+#include <sstream>
+#include <cstdio>
+#include <thread>
 
 #include <QtTest/QtTest>
+#include <QDir>
 
 TestSpline::TestSpline(QObject *parent) : QObject(parent)
 {
@@ -63,6 +74,10 @@ void TestSpline::testMethods_data(void)
 
     QTest::newRow("genericBCubic") <<   TestDataFloat::createGenericBSpline(data, 3) << 1 << 0.0f << data.size()-1;
     QTest::newRow("genericBQuintic") << TestDataFloat::createGenericBSpline(data, 5) << 2 << 0.0f << data.size()-1;
+    QTest::newRow("genericBFixedQuintic") << TestDataFloat::createFixedDegreeGenericBSpline<5>(data) << 2 << 0.0f << data.size()-1;
+
+    QTest::newRow("bakedCatmullRomAlpha") <<    TestDataFloat::createBakedCubic(TestDataFloat::createCatmullRom(data, 0.5f)) << 1 << 0.5f << data.size()-1;
+    QTest::newRow("bakedNaturalAlpha") <<       TestDataFloat::createBakedCubic(TestDataFloat::createNatural(data, true, 0.5f)) << 0 << 0.5f << data.size()-1;
 }
 
 void TestSpline::testMethods(void)
@@ -135,6 +150,10 @@ void TestSpline::testMethods_Cyclic_data(void)
 
     QTest::newRow("genericBCubic") <<   TestDataFloat::createLoopingGenericBSpline(data, 3) << 0.0f << data.size();
     QTest::newRow("genericBQuintic") << TestDataFloat::createLoopingGenericBSpline(data, 5) << 0.0f << data.size();
+    QTest::newRow("genericBFixedQuintic") << TestDataFloat::createLoopingFixedDegreeGenericBSpline<5>(data) << 0.0f << data.size();
+
+    QTest::newRow("bakedCatmullRomAlpha") <<    TestDataFloat::createLoopingBakedCubic(TestDataFloat::createLoopingCatmullRom(data, 0.5f)) << 0.5f << data.size();
+    QTest::newRow("bakedNaturalAlpha") <<       TestDataFloat::createLoopingBakedCubic(TestDataFloat::createLoopingNatural(data, 0.5f)) << 0.5f << data.size();
 }
 
 void TestSpline::testMethods_Cyclic(void)
@@ -200,6 +219,7 @@ void TestSpline::testDerivatives_data(void)
 
     QTest::newRow("uniformCubicB") <<       TestDataFloat::createUniformBSpline(data);
     QTest::newRow("genericB3") <<           TestDataFloat::createGenericBSpline(data,3);
+    QTest::newRow("genericBFixed3") <<      TestDataFloat::createFixedDegreeGenericBSpline<3>(data);
     QTest::newRow("natural") <<             TestDataFloat::createNatural(data, true, 0.0f);
     QTest::newRow("naturalAlpha") <<        TestDataFloat::createNatural(data, true, 0.5f);
     QTest::newRow("quinticHermite") <<      TestDataFloat::createQuinticHermite(data, 0.0f);
@@ -207,6 +227,8 @@ void TestSpline::testDerivatives_data(void)
     QTest::newRow("UniformCR") <<           TestDataFloat::createUniformCR(data);
     QTest::newRow("cubicHermite") <<        TestDataFloat::createCubicHermite(data, 0.0f);
     QTest::newRow("cubicHermiteAlpha") <<   TestDataFloat::createCubicHermite(data, 0.5f);
+    QTest::newRow("bakedNaturalAlpha") <<   TestDataFloat::createBakedCubic(TestDataFloat::createNatural(data, true, 0.5f));
+    QTest::newRow("bakedUniformCubicB") <<  TestDataFloat::createBakedCubic(TestDataFloat::createUniformBSpline(data));
 }
 
 void TestSpline::testDerivatives(void)
@@ -276,6 +298,8 @@ void TestSpline::testSegmentArcLength_data(void)
     QTest::newRow("UniformCR") <<           TestDataFloat::createUniformCR(data);
     QTest::newRow("cubicHermite") <<        TestDataFloat::createCubicHermite(data, 0.0f);
     QTest::newRow("cubicHermiteAlpha") <<   TestDataFloat::createCubicHermite(data, 0.5f);
+    QTest::newRow("bakedNaturalAlpha") <<   TestDataFloat::createBakedCubic(TestDataFloat::createNatural(data, true, 0.5f));
+    QTest::newRow("bakedUniformCR") <<      TestDataFloat::createBakedCubic(TestDataFloat::createUniformCR(data));
 }
 
 void TestSpline::testSegmentArcLength(void)
@@ -371,3 +395,1099 @@ void TestSpline::testSegmentArcLengthCyclic(void)
         compareFloatsLenient(integrated2ndDerivative + 1, expected2ndDerivativeResult + 1, 0.0001f);
     }
 }
+
+
+
+void TestSpline::testBatchEvaluation_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") <<           TestDataFloat::createUniformCR(data);
+    QTest::newRow("catmullRomAlpha") <<     TestDataFloat::createCatmullRom(data, 0.5f);
+    QTest::newRow("quinticHermiteAlpha") << TestDataFloat::createQuinticHermite(data, 0.5f);
+    QTest::newRow("naturalAlpha") <<        TestDataFloat::createNatural(data, true, 0.5f);
+    QTest::newRow("uniformB") <<            TestDataFloat::createUniformBSpline(data);
+    QTest::newRow("genericBQuintic") <<     TestDataFloat::createGenericBSpline(data, 5);
+
+    QTest::newRow("loopingUniformCR") <<        TestDataFloat::cast(TestDataFloat::createLoopingUniformCR(data));
+    QTest::newRow("loopingCatmullRomAlpha") <<  TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(data, 0.5f));
+    QTest::newRow("loopingQuinticHermite") <<   TestDataFloat::cast(TestDataFloat::createLoopingQuinticHermite(data, 0.5f));
+    QTest::newRow("loopingNaturalAlpha") <<     TestDataFloat::cast(TestDataFloat::createLoopingNatural(data, 0.5f));
+    QTest::newRow("loopingUniformB") <<         TestDataFloat::cast(TestDataFloat::createLoopingUniformBSpline(data));
+    QTest::newRow("loopingGenericBQuintic") <<  TestDataFloat::cast(TestDataFloat::createLoopingGenericBSpline(data, 5));
+    QTest::newRow("loopingGenericBFixed7") <<   TestDataFloat::cast(TestDataFloat::createLoopingFixedDegreeGenericBSpline<7>(data));
+
+    QTest::newRow("bakedNaturalAlpha") <<           TestDataFloat::createBakedCubic(TestDataFloat::createNatural(data, true, 0.5f));
+    QTest::newRow("loopingBakedCatmullRomAlpha") << TestDataFloat::cast(TestDataFloat::createLoopingBakedCubic(TestDataFloat::createLoopingCatmullRom(data, 0.5f)));
+}
+
+void TestSpline::testBatchEvaluation(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    //build a list of T values: a sorted sweep over the whole spline, each segment boundary, some out-of-range values, and some random values
+    std::vector<float> tValues;
+    for(size_t i = 0; i <= 100; i++) {
+        tValues.push_back(spline->getMaxT() * i / 100);
+    }
+    for(size_t i = 0; i <= spline->segmentCount(); i++) {
+        tValues.push_back(spline->segmentT(i));
+    }
+    tValues.push_back(-1.5f);
+    tValues.push_back(spline->getMaxT() + 1.5f);
+
+    std::minstd_rand gen(10);
+    std::uniform_real_distribution<float> distribution(0, spline->getMaxT());
+    for(size_t i = 0; i < 50; i++) {
+        tValues.push_back(distribution(gen));
+    }
+
+    std::vector<Vector2> positions(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPT> tangents(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPTC> curvatures(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPTCW> wiggles(tValues.size());
+
+    spline->getPositions(tValues.data(), tValues.size(), positions.data());
+    spline->getTangents(tValues.data(), tValues.size(), tangents.data());
+    spline->getCurvatures(tValues.data(), tValues.size(), curvatures.data());
+    spline->getWiggles(tValues.data(), tValues.size(), wiggles.data());
+
+    for(size_t i = 0; i < tValues.size(); i++)
+    {
+        auto expected = spline->getWiggle(tValues[i]);
+
+        QCOMPARE(positions[i], expected.position);
+
+        QCOMPARE(tangents[i].position, expected.position);
+        QCOMPARE(tangents[i].tangent, expected.tangent);
+
+        QCOMPARE(curvatures[i].position, expected.position);
+        QCOMPARE(curvatures[i].tangent, expected.tangent);
+        QCOMPARE(curvatures[i].curvature, expected.curvature);
+
+        QCOMPARE(wiggles[i].position, expected.position);
+        QCOMPARE(wiggles[i].tangent, expected.tangent);
+        QCOMPARE(wiggles[i].curvature, expected.curvature);
+        QCOMPARE(wiggles[i].wiggle, expected.wiggle);
+    }
+}
+
+
+
+void TestSpline::testCursor_data(void)
+{
+    //use the same splines as the batch evaluation test
+    testBatchEvaluation_data();
+}
+
+void TestSpline::testCursor(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    //build a list of T values: a sorted sweep that goes a little past the end, a reversed sweep, some out-of-range values, then some random values
+    std::vector<float> tValues;
+    for(size_t i = 0; i <= 110; i++) {
+        tValues.push_back(spline->getMaxT() * i / 100);
+    }
+    for(size_t i = 0; i <= 100; i++) {
+        tValues.push_back(spline->getMaxT() * (100 - i) / 100);
+    }
+    tValues.push_back(-1.5f);
+    tValues.push_back(spline->getMaxT() + 1.5f);
+
+    std::minstd_rand gen(10);
+    std::uniform_real_distribution<float> distribution(0, spline->getMaxT());
+    for(size_t i = 0; i < 50; i++) {
+        tValues.push_back(distribution(gen));
+    }
+
+    SplineCursor<Vector2> cursor(*spline);
+    for(float t : tValues)
+    {
+        auto expected = spline->getWiggle(t);
+
+        QCOMPARE(cursor.getPosition(t), expected.position);
+        QCOMPARE(cursor.currentSegment(), spline->segmentForT(t));
+
+        QCOMPARE(cursor.getTangent(t).tangent, expected.tangent);
+        QCOMPARE(cursor.getCurvature(t).curvature, expected.curvature);
+        QCOMPARE(cursor.getWiggle(t).wiggle, expected.wiggle);
+    }
+}
+
+
+
+//evaluate the spline with the given derivative flags, both with and without a segment lookup, and compare every requested output to getWiggle
+template<unsigned derivatives>
+static void verifyEvaluate(const Spline<Vector2> &spline, float t)
+{
+    auto expected = spline.getWiggle(t);
+    auto result = spline.evaluate<derivatives>(t);
+
+    size_t segmentIndex = spline.segmentForT(t);
+    float segmentT = spline.isLooping() ? static_cast<const LoopingSpline<Vector2>&>(spline).wrapT(t) : t;
+    auto segmentResult = spline.segmentEvaluate<derivatives>(segmentIndex, segmentT);
+
+    if(derivatives & SplineDerivatives::Position)
+    {
+        QCOMPARE(result.position, expected.position);
+        QCOMPARE(segmentResult.position, expected.position);
+    }
+    if(derivatives & SplineDerivatives::Tangent)
+    {
+        QCOMPARE(result.tangent, expected.tangent);
+        QCOMPARE(segmentResult.tangent, expected.tangent);
+    }
+    if(derivatives & SplineDerivatives::Curvature)
+    {
+        QCOMPARE(result.curvature, expected.curvature);
+        QCOMPARE(segmentResult.curvature, expected.curvature);
+    }
+    if(derivatives & SplineDerivatives::Wiggle)
+    {
+        QCOMPARE(result.wiggle, expected.wiggle);
+        QCOMPARE(segmentResult.wiggle, expected.wiggle);
+    }
+}
+
+void TestSpline::testEvaluate_data(void)
+{
+    //use the same splines as the batch evaluation test
+    testBatchEvaluation_data();
+}
+
+void TestSpline::testEvaluate(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    for(size_t i = 0; i <= 100; i++)
+    {
+        float t = spline->getMaxT() * i / 100;
+
+        verifyEvaluate<SplineDerivatives::Position>(*spline, t);
+        verifyEvaluate<SplineDerivatives::Tangent>(*spline, t);
+        verifyEvaluate<SplineDerivatives::Tangent | SplineDerivatives::Curvature>(*spline, t);
+        verifyEvaluate<SplineDerivatives::Position | SplineDerivatives::Curvature>(*spline, t);
+        verifyEvaluate<SplineDerivatives::Curvature>(*spline, t);
+        verifyEvaluate<SplineDerivatives::Wiggle>(*spline, t);
+        verifyEvaluate<SplineDerivatives::All>(*spline, t);
+    }
+
+    //outputs that weren't requested are left default-constructed
+    auto tangentOnly = spline->evaluate<SplineDerivatives::Tangent>(spline->getMaxT() * 0.5f);
+    QCOMPARE(tangentOnly.position, Vector2());
+    QCOMPARE(tangentOnly.curvature, Vector2());
+}
+
+
+
+void TestSpline::testBakedCubic_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") <<           TestDataFloat::createUniformCR(data);
+    QTest::newRow("catmullRomAlpha") <<     TestDataFloat::createCatmullRom(data, 0.5f);
+    QTest::newRow("cubicHermite") <<        TestDataFloat::createCubicHermite(data, 0.0f);
+    QTest::newRow("natural") <<             TestDataFloat::createNatural(data, true, 0.0f);
+    QTest::newRow("naturalAlpha") <<        TestDataFloat::createNatural(data, true, 0.5f);
+    QTest::newRow("naturalNotAKnot") <<     TestDataFloat::createNotAKnot(data, true, 0.0f);
+    QTest::newRow("uniformB") <<            TestDataFloat::createUniformBSpline(data);
+    QTest::newRow("genericBCubic") <<       TestDataFloat::createGenericBSpline(data, 3);
+
+    QTest::newRow("loopingUniformCR") <<        TestDataFloat::cast(TestDataFloat::createLoopingUniformCR(data));
+    QTest::newRow("loopingCatmullRomAlpha") <<  TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(data, 0.5f));
+    QTest::newRow("loopingNaturalAlpha") <<     TestDataFloat::cast(TestDataFloat::createLoopingNatural(data, 0.5f));
+    QTest::newRow("loopingUniformB") <<         TestDataFloat::cast(TestDataFloat::createLoopingUniformBSpline(data));
+    QTest::newRow("loopingGenericBCubic") <<    TestDataFloat::cast(TestDataFloat::createLoopingGenericBSpline(data, 3));
+}
+
+void TestSpline::testBakedCubic(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    std::shared_ptr<Spline<Vector2>> baked;
+    if(spline->isLooping()) {
+        baked = TestDataFloat::cast(TestDataFloat::createLoopingBakedCubic(std::static_pointer_cast<LoopingSpline<Vector2>>(spline)));
+    }
+    else {
+        baked = TestDataFloat::createBakedCubic(spline);
+    }
+
+    QCOMPARE(baked->isLooping(), spline->isLooping());
+    QCOMPARE(baked->getMaxT(), spline->getMaxT());
+    QCOMPARE(baked->segmentCount(), spline->segmentCount());
+
+    for(size_t i = 0; i <= spline->segmentCount(); i++) {
+        QCOMPARE(baked->segmentT(i), spline->segmentT(i));
+    }
+
+    //the baked coefficients are computed at the beginning of each segment, so evaluating near the end of a segment picks up a little rounding error
+    //compare with a tolerance relative to the size of the data
+    float tolerance = 0.0005f * spline->getOriginalPoints().back().length();
+    auto compareVectors = [tolerance](const Vector2 &actual, const Vector2 &expected) {
+        return (actual - expected).length() <= tolerance;
+    };
+
+    for(size_t i = 0; i <= 200; i++)
+    {
+        float t = spline->getMaxT() * i / 200;
+
+        auto expected = spline->getWiggle(t);
+        auto actual = baked->getWiggle(t);
+
+        QVERIFY(compareVectors(actual.position, expected.position));
+        QVERIFY(compareVectors(actual.tangent, expected.tangent));
+        QVERIFY(compareVectors(actual.curvature, expected.curvature));
+        QVERIFY(compareVectors(actual.wiggle, expected.wiggle));
+    }
+
+    compareFloatsLenient(baked->totalLength(), spline->totalLength(), 0.0001f);
+}
+
+
+
+void TestSpline::testBakedCubicSoA_data(void)
+{
+    //use the same splines as the baked cubic test
+    testBakedCubic_data();
+}
+
+void TestSpline::testBakedCubicSoA(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    std::shared_ptr<Spline<Vector2>> baked;
+    if(spline->isLooping()) {
+        baked = TestDataFloat::cast(TestDataFloat::createLoopingBakedCubic(std::static_pointer_cast<LoopingSpline<Vector2>>(spline)));
+    }
+    else {
+        baked = TestDataFloat::createBakedCubic(spline);
+    }
+
+    typedef BakedCubicSplineSoA<Vector2, float, 2> SoAType;
+    SoAType soa(*spline);
+
+    QCOMPARE(soa.isLooping(), spline->isLooping());
+    QCOMPARE(soa.getMaxT(), spline->getMaxT());
+    QCOMPARE(soa.segmentCount(), spline->segmentCount());
+
+    //use a count that isn't a multiple of the pack size, so that the last pack is partial
+    std::vector<float> tValues;
+    for(size_t i = 0; i <= 100; i++) {
+        tValues.push_back(spline->getMaxT() * i / 100);
+    }
+    tValues.push_back(-1.5f);
+    tValues.push_back(spline->getMaxT() + 1.5f);
+
+    std::minstd_rand gen(10);
+    std::uniform_real_distribution<float> distribution(0, spline->getMaxT());
+    for(size_t i = 0; i < 50; i++) {
+        tValues.push_back(distribution(gen));
+    }
+    QVERIFY(tValues.size() % SoAType::packSize != 0);
+
+    std::vector<Vector2> positions(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPT> tangents(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPTC> curvatures(tValues.size());
+    std::vector<Spline<Vector2>::InterpolatedPTCW> wiggles(tValues.size());
+
+    soa.getPositions(tValues.data(), tValues.size(), positions.data());
+    soa.getTangents(tValues.data(), tValues.size(), tangents.data());
+    soa.getCurvatures(tValues.data(), tValues.size(), curvatures.data());
+    soa.getWiggles(tValues.data(), tValues.size(), wiggles.data());
+
+    for(size_t i = 0; i < tValues.size(); i++)
+    {
+        auto expected = baked->getWiggle(tValues[i]);
+        auto scalar = soa.getWiggle(tValues[i]);
+
+        QCOMPARE(soa.segmentForT(tValues[i]), baked->segmentForT(tValues[i]));
+
+        for(size_t component = 0; component < 2; component++)
+        {
+            QCOMPARE(positions[i][component], expected.position[component]);
+
+            QCOMPARE(tangents[i].position[component], expected.position[component]);
+            QCOMPARE(tangents[i].tangent[component], expected.tangent[component]);
+
+            QCOMPARE(curvatures[i].position[component], expected.position[component]);
+            QCOMPARE(curvatures[i].tangent[component], expected.tangent[component]);
+            QCOMPARE(curvatures[i].curvature[component], expected.curvature[component]);
+
+            QCOMPARE(wiggles[i].position[component], expected.position[component]);
+            QCOMPARE(wiggles[i].tangent[component], expected.tangent[component]);
+            QCOMPARE(wiggles[i].curvature[component], expected.curvature[component]);
+            QCOMPARE(wiggles[i].wiggle[component], expected.wiggle[component]);
+
+            QCOMPARE(scalar.position[component], expected.position[component]);
+            QCOMPARE(scalar.tangent[component], expected.tangent[component]);
+            QCOMPARE(scalar.curvature[component], expected.curvature[component]);
+            QCOMPARE(scalar.wiggle[component], expected.wiggle[component]);
+        }
+    }
+}
+
+
+void TestSpline::testBakedCubicDegree_data(void)
+{
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<size_t>("degree");
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data) << size_t(3);
+    QTest::newRow("cubicHermite") << TestDataFloat::createCubicHermite(data, 0.5f) << size_t(3);
+    QTest::newRow("natural") << TestDataFloat::createNatural(data, true, 0.5f) << size_t(3);
+    QTest::newRow("uniformBSpline") << TestDataFloat::createUniformBSpline(data) << size_t(3);
+    QTest::newRow("baked") << TestDataFloat::createBakedCubic(TestDataFloat::createUniformCR(data)) << size_t(3);
+    QTest::newRow("genericBSpline degree 2") << TestDataFloat::createGenericBSpline(data, 2) << size_t(2);
+    QTest::newRow("genericBSpline degree 4") << TestDataFloat::createGenericBSpline(data, 4) << size_t(4);
+    QTest::newRow("quinticHermite") << TestDataFloat::createQuinticHermite(data, 0.5f) << size_t(5);
+    QTest::newRow("loopingQuinticCatmullRom") << TestDataFloat::cast(TestDataFloat::createLoopingQuinticCatmullRom(data, 0.5f)) << size_t(5);
+}
+
+void TestSpline::testBakedCubicDegree(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(size_t, degree);
+
+    QCOMPARE(spline->degree(), degree);
+
+    if(degree <= 3)
+    {
+        //lower degrees are exactly representable with cubic coefficients
+        BakedCubicSplineSoA<Vector2> soa(*spline);
+        QCOMPARE(soa.segmentCount(), spline->segmentCount());
+
+        if(!spline->isLooping())
+        {
+            BakedCubicSpline<Vector2> baked(*spline);
+            QCOMPARE(baked.degree(), size_t(3));
+            QVERIFY((baked.getPosition(1.5f) - spline->getPosition(1.5f)).length() < 0.001f);
+        }
+    }
+    else
+    {
+        QVERIFY_EXCEPTION_THROWN(BakedCubicSplineSoA<Vector2> soa(*spline), std::invalid_argument);
+        if(spline->isLooping())
+        {
+            auto looping = std::static_pointer_cast<LoopingSpline<Vector2>>(spline);
+            QVERIFY_EXCEPTION_THROWN(LoopingBakedCubicSpline<Vector2> baked(*looping), std::invalid_argument);
+        }
+        else
+        {
+            QVERIFY_EXCEPTION_THROWN(BakedCubicSpline<Vector2> baked(*spline), std::invalid_argument);
+        }
+
+        SplineFileWriter<Vector2> writer;
+        QVERIFY_EXCEPTION_THROWN(writer.addSpline(*spline), std::invalid_argument);
+        QCOMPARE(writer.splineCount(), size_t(0));
+
+        SplinePool<Vector2> pool;
+        QVERIFY_EXCEPTION_THROWN(pool.addSpline(*spline), std::invalid_argument);
+        QCOMPARE(pool.splineCount(), size_t(0));
+    }
+}
+
+
+void TestSpline::testViewSplines_data(void)
+{
+    //a degree of 0 means a uniform catmull-rom spline
+    QTest::addColumn<size_t>("degree");
+
+    QTest::newRow("uniformCR") <<       size_t(0);
+    QTest::newRow("genericBCubic") <<   size_t(3);
+    QTest::newRow("genericBQuintic") << size_t(5);
+}
+
+void TestSpline::testViewSplines(void)
+{
+    QFETCH(size_t, degree);
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    std::shared_ptr<Spline<Vector2>> spline, view;
+    if(degree == 0) {
+        spline = std::make_shared<UniformCRSpline<Vector2>>(data);
+        view = std::make_shared<UniformCRSplineView<Vector2>>(SplinePointView<Vector2>(data));
+    }
+    else {
+        spline = std::make_shared<GenericBSpline<Vector2>>(data, degree);
+        view = std::make_shared<GenericBSplineView<Vector2>>(SplinePointView<Vector2>(data.data(), data.size()), degree);
+    }
+
+    //the view should point straight at our data instead of making a copy
+    QVERIFY(spline->ownsPoints());
+    QVERIFY(!view->ownsPoints());
+    QVERIFY(view->getOriginalPointsView().data() == data.data());
+    QCOMPARE(view->getOriginalPointsView().size(), data.size());
+    QCOMPARE(spline->getOriginalPointsView().size(), data.size());
+
+    QCOMPARE(view->getMaxT(), spline->getMaxT());
+    QCOMPARE(view->segmentCount(), spline->segmentCount());
+    for(size_t i = 0; i <= spline->segmentCount(); i++) {
+        QCOMPARE(view->segmentT(i), spline->segmentT(i));
+    }
+
+    for(size_t i = 0; i <= 100; i++)
+    {
+        float t = spline->getMaxT() * i / 100;
+
+        auto expected = spline->getWiggle(t);
+        auto actual = view->getWiggle(t);
+
+        QCOMPARE(actual.position, expected.position);
+        QCOMPARE(actual.tangent, expected.tangent);
+        QCOMPARE(actual.curvature, expected.curvature);
+        QCOMPARE(actual.wiggle, expected.wiggle);
+    }
+
+    QCOMPARE(view->totalLength(), spline->totalLength());
+}
+
+
+void TestSpline::testHighDegreeGenericBSpline(void)
+{
+    const size_t degree = GenericBSpline<Vector2>::CoreType::maxRuntimeDegree + 2;
+    auto data = TestDataFloat::generateRandomData(40);
+
+    GenericBSpline<Vector2> runtimeDegree(data, degree);
+    GenericBSpline<Vector2, float, degree> fixedDegree(data);
+    QCOMPARE(runtimeDegree.degree(), degree);
+    QCOMPARE(runtimeDegree.segmentCount(), fixedDegree.segmentCount());
+
+    //both run the same arithmetic, just with different working space, so the results should match exactly
+    for(size_t i = 0; i <= 100; i++)
+    {
+        float t = runtimeDegree.getMaxT() * i / 100;
+
+        auto expected = fixedDegree.getWiggle(t);
+        auto actual = runtimeDegree.getWiggle(t);
+
+        QCOMPARE(actual.position, expected.position);
+        QCOMPARE(actual.tangent, expected.tangent);
+        QCOMPARE(actual.curvature, expected.curvature);
+        QCOMPARE(actual.wiggle, expected.wiggle);
+    }
+    QCOMPARE(runtimeDegree.totalLength(), fixedDegree.totalLength());
+}
+
+
+void TestSpline::testSplineFile_data(void)
+{
+    //use the same splines as the baked cubic test
+    testBakedCubic_data();
+}
+
+void TestSpline::testSplineFile(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    std::shared_ptr<Spline<Vector2>> baked;
+    if(spline->isLooping()) {
+        baked = TestDataFloat::cast(TestDataFloat::createLoopingBakedCubic(std::static_pointer_cast<LoopingSpline<Vector2>>(spline)));
+    }
+    else {
+        baked = TestDataFloat::createBakedCubic(spline);
+    }
+
+    //write the spline twice, so that we test a file with more than one spline in it
+    SplineFileWriter<Vector2> writer;
+    writer.addSpline(*spline);
+    writer.addSpline(*spline);
+
+    std::string filename = QDir::temp().filePath("testsplinefile.bin").toStdString();
+    QVERIFY(writer.save(filename));
+
+    SplineFile<Vector2> file;
+    QVERIFY(file.open(filename));
+    QCOMPARE(file.splineCount(), size_t(2));
+
+    auto compareSplines = [&](const Spline<Vector2> &loaded) {
+        QCOMPARE(loaded.isLooping(), baked->isLooping());
+        QCOMPARE(loaded.getMaxT(), baked->getMaxT());
+        QCOMPARE(loaded.segmentCount(), baked->segmentCount());
+        QVERIFY(!loaded.ownsPoints());
+        QCOMPARE(loaded.getOriginalPointsView().size(), spline->getOriginalPointsView().size());
+
+        for(size_t i = 0; i <= 100; i++)
+        {
+            float t = baked->getMaxT() * i / 100;
+
+            auto expected = baked->getWiggle(t);
+            auto actual = loaded.getWiggle(t);
+
+            QCOMPARE(actual.position, expected.position);
+            QCOMPARE(actual.tangent, expected.tangent);
+            QCOMPARE(actual.curvature, expected.curvature);
+            QCOMPARE(actual.wiggle, expected.wiggle);
+        }
+    };
+
+    for(size_t i = 0; i < file.splineCount(); i++)
+    {
+        QCOMPARE(file.isLooping(i), spline->isLooping());
+        if(file.isLooping(i)) {
+            compareSplines(file.getLoopingSpline(i));
+        }
+        else {
+            compareSplines(file.getSpline(i));
+        }
+    }
+
+    file.close();
+    std::remove(filename.c_str());
+
+    //a truncated buffer should be rejected rather than read past its end
+    std::ostringstream stream;
+    QVERIFY(writer.write(stream));
+    std::string contents = stream.str();
+
+    std::vector<BakedCubicSegment<Vector2>> buffer(contents.size() / sizeof(BakedCubicSegment<Vector2>) + 1);
+    std::memcpy(buffer.data(), contents.data(), contents.size());
+
+    QVERIFY(file.openBuffer(buffer.data(), contents.size()));
+    QVERIFY(!file.openBuffer(buffer.data(), contents.size() - 1));
+    QVERIFY(!file.isValid());
+
+    //so should a file written with a different floating point type
+    SplineFile<Vector2, double> doubleFile;
+    QVERIFY(!doubleFile.openBuffer(buffer.data(), contents.size()));
+}
+
+
+
+void TestSpline::testGpuBuffer_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<size_t>("degree");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data) << size_t(3);
+    QTest::newRow("cubicHermiteAlpha") << TestDataFloat::createCubicHermite(data, 0.5f) << size_t(3);
+    QTest::newRow("naturalAlpha") << TestDataFloat::createNatural(data, true, 0.5f) << size_t(3);
+    QTest::newRow("uniformBSpline") << TestDataFloat::createUniformBSpline(data) << size_t(3);
+    QTest::newRow("loopingCatmullRomAlpha") << TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(data, 0.5f)) << size_t(3);
+    QTest::newRow("quinticHermiteAlpha") << TestDataFloat::createQuinticHermite(data, 0.5f) << size_t(5);
+    QTest::newRow("loopingQuinticCatmullRom") << TestDataFloat::cast(TestDataFloat::createLoopingQuinticCatmullRom(data, 0.0f)) << size_t(5);
+    QTest::newRow("genericBSpline degree 5") << TestDataFloat::createGenericBSpline(data, 5) << size_t(5);
+    QTest::newRow("cubic as degree 5") << TestDataFloat::createUniformCR(data) << size_t(5);
+}
+
+void TestSpline::testGpuBuffer(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(size_t, degree);
+
+    //add a spline before the one we're testing, so that the tested spline doesn't start at offset 0
+    SplineGpuBuffer<Vector2> buffer;
+    buffer.addSpline(*TestDataFloat::createUniformCR(TestDataFloat::generateRandomData(5, 3)));
+    uint32_t offset = buffer.addSpline(*spline, degree);
+
+    //verify the header, and that the coefficients are aligned for vec4 reads
+    const auto &words = buffer.getWords();
+    QCOMPARE(offset % 4, uint32_t(0));
+    QCOMPARE(words[offset], uint32_t(SplineGpuBuffer<Vector2>::PowerBasis));
+    QCOMPARE(words[offset + 1], uint32_t(degree));
+    QCOMPARE(words[offset + 2], uint32_t(spline->segmentCount()));
+    QCOMPARE(words[offset + 3], spline->isLooping() ? uint32_t(SplineGpuBuffer<Vector2>::Looping) : uint32_t(0));
+    QCOMPARE(words[offset + 6] % 4, uint32_t(0));
+    QCOMPARE(buffer.sizeInBytes(), words.size() * sizeof(uint32_t));
+
+    //sample every segment, and a little past both ends to exercise looping splines' wrapping
+    float maxT = spline->getMaxT();
+    for(float t = -0.5f; t <= maxT + 0.5f; t += 0.07f)
+    {
+        float clampedT = spline->isLooping() ? t : std::max(0.0f, std::min(maxT, t));
+        Vector2 expectedPosition = spline->getPosition(clampedT);
+        Vector2 expectedTangent = spline->getTangent(clampedT).tangent;
+
+        auto position = buffer.evaluatePosition(offset, clampedT);
+        auto tangent = buffer.evaluateTangent(offset, clampedT);
+
+        for(size_t c = 0; c < 2; c++)
+        {
+            QVERIFY(std::abs(position[c] - expectedPosition[c]) < 1e-3f);
+            QVERIFY(std::abs(tangent[c] - expectedTangent[c]) < 1e-2f);
+        }
+        QCOMPARE(position[2], 0.0f);
+        QCOMPARE(position[3], 0.0f);
+    }
+
+    //without a degree, the spline's own degree is used
+    uint32_t derivedOffset = buffer.addSpline(*spline);
+    QCOMPARE(words[derivedOffset + 1], uint32_t(spline->degree()));
+
+    //degrees that can't represent the segments, or that the shaders can't evaluate, are rejected
+    QVERIFY_EXCEPTION_THROWN(buffer.addSpline(*spline, spline->degree() - 1), std::invalid_argument);
+    QVERIFY_EXCEPTION_THROWN(buffer.addSpline(*spline, SplineGpuBuffer<Vector2>::maxDegree + 1), std::invalid_argument);
+    QVERIFY_EXCEPTION_THROWN(buffer.addSpline(*TestDataFloat::createGenericBSpline(TestDataFloat::generateRandomData(10), 9)), std::invalid_argument);
+}
+
+void TestSpline::testIncrementalEdits_data(void)
+{
+    QTest::addColumn<QString>("splineType");
+    QTest::addColumn<float>("alpha");
+    QTest::addColumn<bool>("includeEndpoints");
+
+    QTest::newRow("uniformCR") <<               QString("uniformCR") <<     0.0f << false;
+    QTest::newRow("catmullRom") <<              QString("catmullRom") <<    0.0f << false;
+    QTest::newRow("catmullRomCentripetal") <<   QString("catmullRom") <<    0.5f << false;
+    QTest::newRow("cubicHermite") <<            QString("cubicHermite") <<  0.0f << true;
+    QTest::newRow("natural") <<                 QString("natural") <<       0.0f << true;
+    QTest::newRow("naturalCentripetal") <<      QString("natural") <<       0.5f << true;
+    QTest::newRow("naturalWithoutEndpoints") << QString("natural") <<       0.5f << false;
+}
+
+void TestSpline::testIncrementalEdits(void)
+{
+    QFETCH(QString, splineType);
+    QFETCH(float, alpha);
+    QFETCH(bool, includeEndpoints);
+
+    auto data = TestDataFloat::generateRandomData(40);
+    auto tangents = TestDataFloat::generateRandomData(40, 5);
+    auto replacements = TestDataFloat::generateRandomData(4, 15);
+
+    //start with a few points, append the rest one at a time, then move a few points, including the first and last
+    size_t initialSize = 6;
+    std::vector<Vector2> initialPoints(data.begin(), data.begin() + initialSize);
+    std::vector<Vector2> initialTangents(tangents.begin(), tangents.begin() + initialSize);
+    std::vector<size_t> replacedIndexes = { 0, 3, 20, data.size() - 1 };
+
+    std::vector<Vector2> finalPoints = data;
+    for(size_t i = 0; i < replacedIndexes.size(); i++) {
+        finalPoints[replacedIndexes[i]] = replacements[i];
+    }
+
+    std::shared_ptr<Spline<Vector2>> edited, expected;
+    if(splineType == "uniformCR") {
+        auto spline = std::make_shared<UniformCRSpline<Vector2>>(initialPoints);
+        spline->cacheSpeedPolynomials();
+        for(size_t i = initialSize; i < data.size(); i++)
+            spline->appendPoint(data[i]);
+        for(size_t i = 0; i < replacedIndexes.size(); i++)
+            spline->replacePoint(replacedIndexes[i], replacements[i]);
+
+        //every edit changes the shape of the spline, so it should discard the cached speed polynomials
+        QVERIFY(!spline->hasSpeedPolynomials());
+        edited = spline;
+        expected = std::make_shared<UniformCRSpline<Vector2>>(finalPoints);
+    }
+    else if(splineType == "catmullRom") {
+        auto spline = std::make_shared<CubicHermiteSpline<Vector2>>(initialPoints, alpha);
+        spline->cacheSpeedPolynomials();
+        for(size_t i = initialSize; i < data.size(); i++)
+            spline->appendPoint(data[i]);
+        for(size_t i = 0; i < replacedIndexes.size(); i++)
+            spline->replacePoint(replacedIndexes[i], replacements[i]);
+
+        QVERIFY(!spline->hasSpeedPolynomials());
+        edited = spline;
+        expected = std::make_shared<CubicHermiteSpline<Vector2>>(finalPoints, alpha);
+    }
+    else if(splineType == "cubicHermite") {
+        auto spline = std::make_shared<CubicHermiteSpline<Vector2>>(initialPoints, initialTangents, alpha);
+        spline->cacheSpeedPolynomials();
+        for(size_t i = initialSize; i < data.size(); i++)
+            spline->appendPoint(data[i], tangents[i]);
+        for(size_t i = 0; i < replacedIndexes.size(); i++)
+            spline->replacePoint(replacedIndexes[i], replacements[i], tangents[replacedIndexes[i]]);
+
+        QVERIFY(!spline->hasSpeedPolynomials());
+        edited = spline;
+        expected = std::make_shared<CubicHermiteSpline<Vector2>>(finalPoints, tangents, alpha);
+    }
+    else {
+        auto spline = std::make_shared<NaturalSpline<Vector2>>(initialPoints, includeEndpoints, alpha);
+        spline->cacheSpeedPolynomials();
+
+        //the appends reuse one scratch object, and the replacements use the overloads that allocate their own
+        SplineScratch<Vector2> scratch;
+        for(size_t i = initialSize; i < data.size(); i++)
+            spline->appendPoint(data[i], scratch);
+        for(size_t i = 0; i < replacedIndexes.size(); i++)
+            spline->replacePoint(replacedIndexes[i], replacements[i]);
+
+        QVERIFY(!spline->hasSpeedPolynomials());
+        edited = spline;
+        expected = std::make_shared<NaturalSpline<Vector2>>(finalPoints, includeEndpoints, alpha);
+    }
+
+    QCOMPARE(edited->getOriginalPoints().size(), finalPoints.size());
+    QCOMPARE(edited->getMaxT(), expected->getMaxT());
+    QCOMPARE(edited->segmentCount(), expected->segmentCount());
+    for(size_t i = 0; i <= expected->segmentCount(); i++) {
+        QVERIFY(std::abs(edited->segmentT(i) - expected->segmentT(i)) < 0.0001f);
+    }
+
+    //the edits accumulate some rounding error in the knots, so compare with a tolerance relative to the size of each value
+    //curvature and wiggle are much more sensitive to the knots than position is, so they get a looser tolerance
+    auto compareVectors = [](const Vector2 &actual, const Vector2 &expected, float tolerance) {
+        return (actual - expected).length() <= tolerance * (1 + expected.length());
+    };
+
+    for(size_t i = 0; i <= 200; i++)
+    {
+        float t = expected->getMaxT() * i / 200;
+
+        auto expectedResult = expected->getWiggle(t);
+        auto actualResult = edited->getWiggle(t);
+
+        QVERIFY(compareVectors(actualResult.position, expectedResult.position, 0.0001f));
+        QVERIFY(compareVectors(actualResult.tangent, expectedResult.tangent, 0.0001f));
+        QVERIFY(compareVectors(actualResult.curvature, expectedResult.curvature, 0.001f));
+        QVERIFY(compareVectors(actualResult.wiggle, expectedResult.wiggle, 0.001f));
+    }
+}
+
+
+
+template<class SplineType>
+static void verifyStaticDispatch(const SplineType &spline)
+{
+    const Spline<Vector2> &baseSpline = spline;
+
+    SplineCursor<Vector2, float, SplineType> staticCursor(spline);
+    SplineCursor<Vector2> cursor(baseSpline);
+
+    //go past the end, so that looping splines have to wrap
+    for(size_t i = 0; i <= 100; i++)
+    {
+        float t = baseSpline.getMaxT() * i / 80;
+
+        auto expected = baseSpline.getWiggle(t);
+        auto actual = staticCursor.getWiggle(t);
+        QVERIFY(actual.position == expected.position);
+        QVERIFY(actual.wiggle == expected.wiggle);
+        QVERIFY(cursor.getPosition(t) == expected.position);
+
+        auto staticDerivatives = spline.template evaluate<SplineDerivatives::Tangent | SplineDerivatives::Curvature>(t);
+        QVERIFY(staticDerivatives.tangent == expected.tangent);
+        QVERIFY(staticDerivatives.curvature == expected.curvature);
+
+        //the core doesn't wrap T values, so only compare the core inside [0, maxT). looping splines wrap maxT back to 0
+        if(t < baseSpline.getMaxT())
+        {
+            auto coreResult = spline.core().getWiggle(t);
+            QVERIFY(coreResult.position == expected.position);
+            QVERIFY(coreResult.tangent == expected.tangent);
+            QVERIFY(coreResult.curvature == expected.curvature);
+            QVERIFY(coreResult.wiggle == expected.wiggle);
+        }
+    }
+
+    SplineInverter<Vector2, float, 2, SplineType> staticInverter(spline);
+    SplineInverter<Vector2> inverter(baseSpline);
+    QCOMPARE(staticInverter.sampleCount(), inverter.sampleCount());
+
+    auto queryPoints = TestDataFloat::generateRandomData(20, 3);
+    for(const auto &queryPoint : queryPoints)
+    {
+        QCOMPARE(staticInverter.findClosestT(queryPoint), inverter.findClosestT(queryPoint));
+    }
+}
+
+void TestSpline::testStaticDispatch(void)
+{
+    auto data = TestDataFloat::generateRandomData(12);
+
+    verifyStaticDispatch(UniformCRSpline<Vector2>(data));
+    verifyStaticDispatch(CubicHermiteSpline<Vector2>(data, 0.5f));
+    verifyStaticDispatch(NaturalSpline<Vector2>(data));
+    verifyStaticDispatch(GenericBSpline<Vector2>(data, 3));
+    verifyStaticDispatch(LoopingUniformCRSpline<Vector2>(data));
+    verifyStaticDispatch(LoopingNaturalSpline<Vector2>(data, 0.5f));
+}
+
+
+
+static void verifySplinesMatch(const Spline<Vector2> &actual, const Spline<Vector2> &expected)
+{
+    QCOMPARE(actual.segmentCount(), expected.segmentCount());
+    for(size_t i = 0; i <= expected.segmentCount(); i++) {
+        QCOMPARE(actual.segmentT(i), expected.segmentT(i));
+    }
+
+    for(size_t i = 0; i <= 50; i++)
+    {
+        float t = expected.getMaxT() * i / 50;
+        auto expectedResult = expected.getWiggle(t);
+        auto actualResult = actual.getWiggle(t);
+        QVERIFY(actualResult.position == expectedResult.position);
+        QVERIFY(actualResult.tangent == expectedResult.tangent);
+        QVERIFY(actualResult.curvature == expectedResult.curvature);
+        QVERIFY(actualResult.wiggle == expectedResult.wiggle);
+    }
+}
+
+void TestSpline::testScratchConstruction(void)
+{
+    SplineScratch<Vector2> scratch;
+    size_t warmMemory = 0;
+
+    //build the largest splines first, so that the second pass shouldn't need to grow the scratch object at all
+    for(size_t pass = 0; pass < 2; pass++)
+    {
+        for(size_t size : { 40, 12, 7 })
+        {
+            auto data = TestDataFloat::generateRandomData(size, unsigned(size));
+
+            verifySplinesMatch(NaturalSpline<Vector2>(data, scratch, true, 0.5f), NaturalSpline<Vector2>(data, true, 0.5f));
+            verifySplinesMatch(NaturalSpline<Vector2>(data, scratch, false, 0.5f), NaturalSpline<Vector2>(data, false, 0.5f));
+            verifySplinesMatch(
+                        NaturalSpline<Vector2>(data, scratch, true, 0.5f, NaturalSpline<Vector2>::NotAKnot),
+                        NaturalSpline<Vector2>(data, true, 0.5f, NaturalSpline<Vector2>::NotAKnot));
+            verifySplinesMatch(LoopingNaturalSpline<Vector2>(data, scratch, 0.5f), LoopingNaturalSpline<Vector2>(data, 0.5f));
+            verifySplinesMatch(QuinticHermiteSpline<Vector2>(data, scratch, 0.5f), QuinticHermiteSpline<Vector2>(data, 0.5f));
+            verifySplinesMatch(LoopingQuinticHermiteSpline<Vector2>(data, scratch, 0.5f), LoopingQuinticHermiteSpline<Vector2>(data, 0.5f));
+        }
+
+        if(pass == 0)
+            warmMemory = scratch.usedMemory();
+        else
+            QCOMPARE(scratch.usedMemory(), warmMemory);
+    }
+    QVERIFY(warmMemory > 0);
+}
+
+void TestSpline::testUniformBatch(void)
+{
+    std::vector<std::vector<Vector2>> pointLists;
+    for(unsigned i = 0; i < 9; i++) {
+        pointLists.push_back(TestDataFloat::generateRandomData(15, i + 1));
+    }
+
+    auto splines = NaturalSpline<Vector2>::buildUniformBatch(pointLists);
+    auto splinesWithoutEndpoints = NaturalSpline<Vector2>::buildUniformBatch(pointLists, false);
+    auto loopingSplines = LoopingNaturalSpline<Vector2>::buildUniformBatch(pointLists);
+
+    QCOMPARE(splines.size(), pointLists.size());
+    QCOMPARE(splinesWithoutEndpoints.size(), pointLists.size());
+    QCOMPARE(loopingSplines.size(), pointLists.size());
+    for(size_t i = 0; i < pointLists.size(); i++)
+    {
+        verifySplinesMatch(splines[i], NaturalSpline<Vector2>(pointLists[i]));
+        verifySplinesMatch(splinesWithoutEndpoints[i], NaturalSpline<Vector2>(pointLists[i], false));
+        verifySplinesMatch(loopingSplines[i], LoopingNaturalSpline<Vector2>(pointLists[i]));
+    }
+
+    QVERIFY(NaturalSpline<Vector2>::buildUniformBatch({}).empty());
+}
+
+
+
+template<class MixedSpline, class FloatSpline>
+static void verifyMixedPrecision(const MixedSpline &mixed, const FloatSpline &single)
+{
+    QCOMPARE(mixed.segmentCount(), single.segmentCount());
+    QVERIFY(std::abs(mixed.getMaxT() - single.getMaxT()) < 1e-4);
+
+    for(size_t i = 0; i <= 40; i++)
+    {
+        double t = single.getMaxT() * i / 40.0;
+        auto mixedResult = mixed.getTangent(t);
+        auto singleResult = single.getTangent(float(t));
+        QVERIFY((mixedResult.position - singleResult.position).length() < 1e-3f);
+        QVERIFY((mixedResult.tangent - singleResult.tangent).length() < 1e-3f);
+    }
+    QVERIFY(std::abs(mixed.totalLength() - single.totalLength()) < 1e-3 * single.totalLength());
+}
+
+void TestSpline::testMixedPrecision(void)
+{
+    auto data = TestDataFloat::generateRandomData(12);
+
+    //the points are the same floats in both splines, only the T values and the math around them are double
+    verifyMixedPrecision(*TestDataMixed::createUniformCR(data), *TestDataFloat::createUniformCR(data));
+    verifyMixedPrecision(*TestDataMixed::createCatmullRom(data, 0.5), *TestDataFloat::createCatmullRom(data, 0.5f));
+    verifyMixedPrecision(*TestDataMixed::createQuinticHermite(data, 0.5), *TestDataFloat::createQuinticHermite(data, 0.5f));
+    verifyMixedPrecision(*TestDataMixed::createNatural(data, true, 0.5), *TestDataFloat::createNatural(data, true, 0.5f));
+    verifyMixedPrecision(*TestDataMixed::createGenericBSpline(data, 5), *TestDataFloat::createGenericBSpline(data, 5));
+    verifyMixedPrecision(*TestDataMixed::createLoopingUniformBSpline(data), *TestDataFloat::createLoopingUniformBSpline(data));
+    verifyMixedPrecision(*TestDataMixed::createLoopingNatural(data, 0.5), *TestDataFloat::createLoopingNatural(data, 0.5f));
+
+    //past 2^21, a float T can only resolve steps of 0.25, so the fraction of a segment is lost. repeat a short pattern of points, so that
+    //a segment at the end of the spline has to match a segment at the beginning exactly, and evaluate it at a fraction float can't represent
+    const size_t patternSize = 4;
+    const size_t segmentCount = (size_t(1) << 21) + 8;
+    std::vector<Vector2> repeated(segmentCount + 3);
+    for(size_t i = 0; i < repeated.size(); i++)
+    {
+        repeated[i] = data[i % patternSize];
+    }
+    UniformCRSpline<Vector2, double> longSpline(repeated);
+
+    size_t farSegment = segmentCount - patternSize;
+    QVERIFY(double(float(farSegment + 0.3)) != farSegment + 0.3);
+    for(double fraction : {0.1, 0.3, 0.7})
+    {
+        Vector2 expected = longSpline.getPosition(fraction);
+        Vector2 actual = longSpline.getPosition(farSegment + fraction);
+        QVERIFY((actual - expected).length() < 1e-5f);
+    }
+
+    //looping splines wrap T before evaluating it, so the wrapped T has to keep the same precision. the pattern divides the segment count,
+    //so the looping spline repeats it seamlessly across the wrap. check a T in the far segment, and the same T one loop later
+    std::vector<Vector2> loopedPoints(repeated.begin(), repeated.begin() + segmentCount);
+    LoopingUniformCRSpline<Vector2, double> longLoopingSpline(loopedPoints);
+    QCOMPARE(longLoopingSpline.segmentCount(), segmentCount);
+    for(double fraction : {0.1, 0.3, 0.7})
+    {
+        Vector2 expected = longLoopingSpline.getPosition(fraction);
+        Vector2 actual = longLoopingSpline.getPosition(farSegment + fraction);
+        Vector2 actualWrapped = longLoopingSpline.getPosition(longLoopingSpline.getMaxT() + farSegment + fraction);
+        QVERIFY((actual - expected).length() < 1e-5f);
+        QVERIFY((actualWrapped - expected).length() < 1e-5f);
+    }
+
+    //the arc length solver works in T as well, so it should also find the same fraction in the far segment as in the first one
+    float segmentLength = longSpline.arcLength(0, 1);
+    double nearSolution = ArcLength::solveLength(longSpline, 0.0, double(segmentLength) * 0.5);
+    double farSolution = ArcLength::solveLength(longSpline, double(farSegment), double(segmentLength) * 0.5);
+    QVERIFY(std::abs((farSolution - farSegment) - nearSolution) < 1e-4);
+}
+
+void TestSpline::testLazyConstruction(void)
+{
+    auto data = TestDataFloat::generateRandomData(200);
+
+    //use a small block size, so that the spline has plenty of blocks
+    const size_t blockSize = 16;
+    LazyCubicHermiteSpline<Vector2> lazyCubic(data, 0.5f, blockSize);
+    LazyQuinticHermiteSpline<Vector2> lazyQuintic(data, 0.5f, blockSize);
+
+    //nothing is computed until a segment is evaluated, and then only the blocks holding the segment's two points
+    QCOMPARE(lazyCubic.preparedBlockCount(), size_t(0));
+    lazyCubic.segmentPosition(40, lazyCubic.segmentT(40));
+    QCOMPARE(lazyCubic.preparedBlockCount(), size_t(1));
+    lazyCubic.segmentPosition(47, lazyCubic.segmentT(47));
+    QCOMPARE(lazyCubic.preparedBlockCount(), size_t(2));
+
+    verifySplinesMatch(lazyCubic, CubicHermiteSpline<Vector2>(data, 0.5f));
+    verifySplinesMatch(lazyQuintic, QuinticHermiteSpline<Vector2>(data, 0.5f));
+
+    //several threads evaluating a fresh spline at the same time should each compute or wait for every block, and get the same results as the eager spline
+    QuinticHermiteSpline<Vector2> eagerQuintic(data, 0.5f);
+    LazyQuinticHermiteSpline<Vector2> sharedQuintic(data, 0.5f, blockSize);
+
+    const size_t threadCount = 4;
+    const size_t sampleCount = 500;
+    std::vector<std::vector<Spline<Vector2>::InterpolatedPTCW>> results(threadCount);
+    std::vector<std::thread> threads;
+    for(size_t thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back([&sharedQuintic, &results, thread, sampleCount]() {
+            for(size_t i = 0; i < sampleCount; i++)
+            {
+                results[thread].push_back(sharedQuintic.getWiggle(sharedQuintic.getMaxT() * i / sampleCount));
+            }
+        });
+    }
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t totalBlocks = (sharedQuintic.segmentCount() + blockSize) / blockSize;
+    QCOMPARE(sharedQuintic.preparedBlockCount(), totalBlocks);
+    for(size_t thread = 0; thread < threadCount; thread++)
+    {
+        for(size_t i = 0; i < sampleCount; i++)
+        {
+            auto expected = eagerQuintic.getWiggle(eagerQuintic.getMaxT() * i / sampleCount);
+            QVERIFY(results[thread][i].position == expected.position);
+            QVERIFY(results[thread][i].tangent == expected.tangent);
+            QVERIFY(results[thread][i].curvature == expected.curvature);
+            QVERIFY(results[thread][i].wiggle == expected.wiggle);
+        }
+    }
+}
+
+void TestSpline::testSplinePool(void)
+{
+    std::vector<std::vector<Vector2>> pointLists;
+    for(unsigned i = 0; i < 20; i++) {
+        pointLists.push_back(TestDataFloat::generateRandomData(6 + i % 7, i + 1));
+    }
+
+    //build half of the pool at once, and add the rest one at a time, alternating looping and non-looping splines
+    SplinePool<Vector2> pool = SplinePool<Vector2>::build<NaturalSpline<Vector2>>(pointLists, true, 0.5f);
+    std::vector<std::shared_ptr<Spline<Vector2>>> originals;
+    for(const auto &points : pointLists) {
+        originals.push_back(TestDataFloat::createNatural(points, true, 0.5f));
+    }
+    for(size_t i = 0; i < pointLists.size(); i++)
+    {
+        std::shared_ptr<Spline<Vector2>> spline;
+        if(i % 2 == 0) {
+            spline = TestDataFloat::cast(TestDataFloat::createLoopingCatmullRom(pointLists[i], 0.5f));
+        }
+        else {
+            spline = TestDataFloat::createUniformCR(pointLists[i]);
+        }
+        QCOMPARE(pool.addSpline(*spline), originals.size());
+        originals.push_back(spline);
+    }
+    QCOMPARE(pool.splineCount(), originals.size());
+
+    //pick a T value for each spline, including some outside the looping splines' range
+    std::vector<float> tValues(pool.splineCount());
+    for(size_t i = 0; i < tValues.size(); i++) {
+        tValues[i] = originals[i]->getMaxT() * (float(i % 9) / 6 - 0.25f);
+    }
+
+    std::vector<Vector2> positions(pool.splineCount());
+    std::vector<Spline<Vector2>::InterpolatedPT> tangents(pool.splineCount());
+    pool.getPositions(tValues.data(), positions.data());
+    pool.getTangents(tValues.data(), tangents.data());
+
+    for(size_t i = 0; i < pool.splineCount(); i++)
+    {
+        const auto &original = originals[i];
+        QCOMPARE(pool.isLooping(i), original->isLooping());
+        QCOMPARE(pool.getMaxT(i), original->getMaxT());
+        QCOMPARE(pool.segmentCount(i), original->segmentCount());
+        QCOMPARE(pool.getOriginalPoints(i).size(), original->getOriginalPointsView().size());
+
+        std::shared_ptr<Spline<Vector2>> baked;
+        std::shared_ptr<Spline<Vector2>> view;
+        if(original->isLooping()) {
+            baked = TestDataFloat::cast(TestDataFloat::createLoopingBakedCubic(std::static_pointer_cast<LoopingSpline<Vector2>>(original)));
+            view = std::make_shared<LoopingBakedCubicSplineView<Vector2>>(pool.getLoopingSpline(i));
+        }
+        else {
+            baked = TestDataFloat::createBakedCubic(original);
+            view = std::make_shared<BakedCubicSplineView<Vector2>>(pool.getSpline(i));
+        }
+
+        //the pool bakes its splines the same way BakedCubicSpline does, so the results should be identical
+        QVERIFY(positions[i] == baked->getPosition(tValues[i]));
+        QVERIFY(tangents[i].tangent == baked->getTangent(tValues[i]).tangent);
+
+        //the core doesn't wrap T values, so stay below maxT, where a looping spline would wrap back to 0
+        for(size_t sample = 0; sample < 20; sample++)
+        {
+            float t = baked->getMaxT() * sample / 20;
+            QVERIFY(view->getPosition(t) == baked->getPosition(t));
+            QVERIFY(pool.core(i).getPosition(t) == baked->getPosition(t));
+        }
+    }
+
+    //evaluating a subset should match evaluating every spline
+    std::vector<size_t> subset = { 3, 3, 17, 0, 31 };
+    std::vector<float> subsetT;
+    for(size_t index : subset) {
+        subsetT.push_back(tValues[index]);
+    }
+    std::vector<Vector2> subsetPositions(subset.size());
+    pool.getPositions(subset.data(), subsetT.data(), subset.size(), subsetPositions.data());
+    for(size_t i = 0; i < subset.size(); i++) {
+        QVERIFY(subsetPositions[i] == positions[subset[i]]);
+    }
+}
@@ -33,4 +33,65 @@ private slots:
     //Verify that the 'segment arc length' method computes the correct result for cyclic splines
     void testSegmentArcLengthCyclic_data(void);
     void testSegmentArcLengthCyclic(void);
+
+    //verify that the batch evaluation methods return the same results as evaluating one T value at a time
+    void testBatchEvaluation_data(void);
+    void testBatchEvaluation(void);
+
+    //verify that the spline cursor returns the same results as the spline, whether T values are sorted or not
+    void testCursor_data(void);
+    void testCursor(void);
+
+    //verify that evaluate() and segmentEvaluate() compute the same values as getWiggle, for the outputs they were asked for
+    void testEvaluate_data(void);
+    void testEvaluate(void);
+
+    //verify that baked cubic splines match the spline they were baked from
+    void testBakedCubic_data(void);
+    void testBakedCubic(void);
+
+    //verify that the structure-of-arrays baked spline matches the regular baked spline, for full and partial packs of T values
+    void testBakedCubicSoA_data(void);
+    void testBakedCubicSoA(void);
+
+    //verify that each spline type reports its degree, and that baking only accepts splines of degree 3 or less
+    void testBakedCubicDegree_data(void);
+    void testBakedCubicDegree(void);
+
+    //verify that view splines match the owning splines of the same type, without copying the points
+    void testViewSplines_data(void);
+    void testViewSplines(void);
+
+    //verify that generic b-splines with a runtime degree too high for the stack buffer match the same degree fixed at compile time
+    void testHighDegreeGenericBSpline(void);
+
+    //verify that splines written to a spline file and read back match the baked version of the original spline
+    void testSplineFile_data(void);
+    void testSplineFile(void);
+
+    //verify that splines packed into a GPU buffer, and evaluated the way the reference shaders do, match the original spline
+    void testGpuBuffer_data(void);
+    void testGpuBuffer(void);
+
+    //verify that splines built up with appendPoint and replacePoint match splines built from scratch with the same points
+    void testIncrementalEdits_data(void);
+    void testIncrementalEdits(void);
+
+    //verify that the core() of concrete spline types, and cursors and inverters templated on concrete spline types, match the virtual interface
+    void testStaticDispatch(void);
+
+    //verify that splines built with a shared scratch object match splines built without one, and that a warm scratch object doesn't grow
+    void testScratchConstruction(void);
+
+    //verify that natural splines built in a batch match natural splines built one at a time
+    void testUniformBatch(void);
+
+    //verify that splines with double precision T values and float points match float splines, and stay accurate at T values where float can't resolve the fraction
+    void testMixedPrecision(void);
+
+    //verify that lazy splines match the splines they defer, only compute the blocks that are evaluated, and can be evaluated for the first time from several threads at once
+    void testLazyConstruction(void);
+
+    //verify that splines stored in a pool match baked copies of the original splines, both through views and through the pool's batch evaluation
+    void testSplinePool(void);
 };
@@ -77,3 +77,59 @@ void TestSplineCommon::testInnerPadding(void)
         QCOMPARE(actualT[i], expectedT[i]);
     }
 }
+
+void TestSplineCommon::testKnotIndex_data(void)
+{
+    QTest::addColumn<std::vector<float>>("knots");
+
+    size_t testSize = 8;
+    std::vector<Vector2> traingleLine = TestDataFloat::generateTriangleNumberData(testSize);
+
+    QTest::newRow("Equidistant") << std::vector<float>{ 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f };
+    QTest::newRow("Increasing distance, padding=1") << SplineCommon::computeTValuesWithInnerPadding(traingleLine, 1.0f, 1);
+
+    //b-splines repeat knots, and a zero-length segment should never be chosen over the segment after it
+    QTest::newRow("Repeated knots") << std::vector<float>{ -2.0f, -2.0f, -2.0f, 0.0f, 1.5f, 1.5f, 4.0f, 5.0f, 5.0f, 5.0f };
+
+    //a few long gaps between many short segments: most buckets are empty, and a few hold almost every knot
+    std::vector<float> gapped;
+    float t = 0;
+    for(size_t i = 0; i < 100; i++)
+    {
+        gapped.push_back(t);
+        t += i % 30 == 29 ? 500.0f : 0.1f + 0.01f * float(i % 7);
+    }
+    float scale = float(gapped.size() - 1) / gapped.back();
+    for(float &knot : gapped)
+    {
+        knot *= scale;
+    }
+    QTest::newRow("Gapped") << gapped;
+}
+
+void TestSplineCommon::testKnotIndex(void)
+{
+    QFETCH(std::vector<float>, knots);
+
+    SplineCommon::KnotIndex<float> index(knots);
+    QVERIFY(!index.empty());
+
+    //test every knot, the T values halfway between them, and T values just inside and past each end
+    std::vector<float> tValues = { knots.front() - 1, knots.front(), std::nextafter(knots.front(), knots.back()), std::nextafter(knots.back(), knots.front()), knots.back(), knots.back() + 1 };
+    for(size_t i = 0; i < knots.size(); i++)
+    {
+        tValues.push_back(knots[i]);
+        if(i + 1 < knots.size())
+            tValues.push_back((knots[i] + knots[i + 1]) / 2);
+    }
+
+    for(float t : tValues)
+    {
+        QCOMPARE(SplineCommon::getIndexForT(knots, index, t), SplineCommon::getIndexForT(knots, t));
+    }
+
+    //an index with no T range can't be built, and lookups fall back to getIndexForT
+    SplineCommon::KnotIndex<float> emptyIndex(std::vector<float>{ 3.0f, 3.0f });
+    QVERIFY(emptyIndex.empty());
+    QCOMPARE(SplineCommon::getIndexForT(std::vector<float>{ 3.0f, 3.0f }, emptyIndex, 3.0f), size_t(0));
+}
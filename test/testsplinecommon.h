@@ -14,4 +14,8 @@ private slots:
     //test the computeTValuesWithInnerPadding method, which computes the T values for a non-looping spline
     void testInnerPadding_data(void);
     void testInnerPadding(void);
+
+    //verify that looking up T values with a KnotIndex returns the same segments as getIndexForT
+    void testKnotIndex_data(void);
+    void testKnotIndex(void);
 };
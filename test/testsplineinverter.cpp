@@ -0,0 +1,581 @@
+#include "testsplineinverter.h"
+
+#include "common.h"
+#include "spline_library/utils/splineinverter.h"
+#include "spline_library/utils/distancefield.h"
+#include "spline_library/utils/dynamicsplineinverter.h"
+#include "spline_library/utils/segmentbvh.h"
+
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+#include <QtTest/QtTest>
+
+TestSplineInverter::TestSplineInverter(QObject *parent) : QObject(parent)
+{
+
+}
+
+void TestSplineInverter::testBatchFindClosestT_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<int>("threadCount");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    auto rowFunction = [](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+        std::string singleName = QString("%1 (Single Thread)").arg(name).toStdString();
+        QTest::newRow(singleName.data()) << spline << 1;
+
+        std::string multiName = QString("%1 (Multiple Threads)").arg(name).toStdString();
+        QTest::newRow(multiName.data()) << spline << 4;
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("natural", TestDataFloat::createNatural(data, true, 0.0f));
+    rowFunction("loopingCubicHermite", TestDataFloat::createLoopingCubicHermite(data, 0.5f));
+    rowFunction("loopingGenericB", TestDataFloat::createLoopingGenericBSpline(data, 5));
+}
+
+void TestSplineInverter::testBatchFindClosestT(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(int, threadCount);
+
+    SplineInverter<Vector2> inverter(*spline);
+
+    //create a grid of query points surrounding the spline, in scanline order like an image
+    std::vector<Vector2> queryPoints;
+    for(int y = 0; y < 40; y++)
+    {
+        for(int x = 0; x < 40; x++)
+        {
+            queryPoints.push_back(Vector2({x * 1.25f - 5, y * 1.25f - 5}));
+        }
+    }
+
+    //shuffle some random query points onto the end, so that some tiles aren't in a coherent order
+    std::minstd_rand gen(5);
+    std::uniform_real_distribution<float> distribution(-10, 60);
+    for(int i = 0; i < 300; i++)
+    {
+        queryPoints.push_back(Vector2({distribution(gen), distribution(gen)}));
+    }
+
+    std::vector<float> batchResults(queryPoints.size());
+    inverter.findClosestT(queryPoints.data(), queryPoints.size(), batchResults.data(), size_t(threadCount));
+
+    for(size_t i = 0; i < queryPoints.size(); i++)
+    {
+        float expected = inverter.findClosestT(queryPoints[i]);
+
+        //if two samples are exactly the same distance from a query point, the batch version might pick the other one,
+        //so compare the distance to the spline instead of the T values themselves
+        float expectedDistance = (spline->getPosition(expected) - queryPoints[i]).length();
+        float actualDistance = (spline->getPosition(batchResults[i]) - queryPoints[i]).length();
+        QCOMPARE(actualDistance, expectedDistance);
+    }
+}
+
+void TestSplineInverter::testNewtonRefinement_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data);
+    QTest::newRow("natural") << TestDataFloat::createNatural(data, true, 0.0f);
+    QTest::newRow("quinticHermite") << TestDataFloat::createQuinticHermite(data, 0.5f);
+    QTest::newRow("loopingCubicHermite") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingCubicHermite(data, 0.5f));
+    QTest::newRow("loopingGenericB") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingGenericBSpline(data, 5));
+}
+
+void TestSplineInverter::testNewtonRefinement(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    typedef SplineInverter<Vector2> InverterType;
+    InverterType brentInverter(*spline, 10, InverterType::RefinementMethod::Brent);
+    InverterType newtonInverter(*spline, 10, InverterType::RefinementMethod::Newton);
+
+    //the two methods should find the same closest point, although not necessarily exactly the same T, since the distance is flat at a minimum
+    //brent's method only solves to 16 bits, so newton's method is allowed to find a point that's slightly closer
+    std::minstd_rand gen(7);
+    std::uniform_real_distribution<float> distribution(-10, 60);
+    for(int i = 0; i < 500; i++)
+    {
+        Vector2 queryPoint({distribution(gen), distribution(gen)});
+
+        float brentT = brentInverter.findClosestT(queryPoint);
+        float newtonT = newtonInverter.findClosestT(queryPoint);
+
+        float brentDistance = (spline->getPosition(brentT) - queryPoint).length();
+        float newtonDistance = (spline->getPosition(newtonT) - queryPoint).length();
+        QVERIFY(newtonDistance <= brentDistance * 1.00001f + 0.00001f);
+    }
+}
+
+void TestSplineInverter::testSampling_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<bool>("adaptive");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    auto rowFunction = [](const char* name, std::shared_ptr<Spline<Vector2>> spline) {
+        std::string uniformName = QString("%1 (Uniform)").arg(name).toStdString();
+        QTest::newRow(uniformName.data()) << spline << false;
+
+        std::string adaptiveName = QString("%1 (Adaptive)").arg(name).toStdString();
+        QTest::newRow(adaptiveName.data()) << spline << true;
+    };
+
+    rowFunction("uniformCR", TestDataFloat::createUniformCR(data));
+    rowFunction("catmullRom", TestDataFloat::createCatmullRom(data, 0.5f));
+    rowFunction("natural", TestDataFloat::createNatural(data, true, 0.0f));
+
+    //the random data curves back over itself when it loops, so use circles for the looping splines
+    rowFunction("circularGenericB", TestDataFloat::createCircularGenericBSpline(12, 5, 10.0f));
+    rowFunction("circularQuinticHermite", TestDataFloat::createCircularQuinticHermite(12, 10.0f));
+}
+
+void TestSplineInverter::testSampling(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(bool, adaptive);
+
+    typedef SplineInverter<Vector2> InverterType;
+    auto sampling = adaptive ? InverterType::SamplingMethod::Adaptive : InverterType::SamplingMethod::Uniform;
+    InverterType inverter(*spline, 10, InverterType::RefinementMethod::Newton, sampling);
+
+    QVERIFY(inverter.sampleCount() > spline->segmentCount());
+
+    //every sample remembers the segment its T is in
+    const auto &sampleTree = inverter.getSampleTree();
+    for(size_t i = 0; i < sampleTree.sampleCount(); i++)
+    {
+        size_t segment = sampleTree.sampleSegment(i);
+        QVERIFY(segment < spline->segmentCount());
+        QVERIFY(sampleTree.sampleT(i) >= spline->segmentT(segment));
+        QVERIFY(sampleTree.sampleT(i) <= spline->segmentT(segment + 1));
+    }
+
+    //every point on the spline is the closest point on the spline to itself
+    std::minstd_rand gen(3);
+    std::uniform_real_distribution<float> distribution(0, spline->getMaxT());
+    for(int i = 0; i < 500; i++)
+    {
+        Vector2 queryPoint = spline->getPosition(distribution(gen));
+
+        float closestT = inverter.findClosestT(queryPoint);
+        float distance = (spline->getPosition(closestT) - queryPoint).length();
+        QVERIFY(distance < 0.001f);
+    }
+}
+
+
+
+void TestSplineInverter::testRangeQueries_data(void)
+{
+    QTest::addColumn<bool>("newton");
+
+    QTest::newRow("brent") << false;
+    QTest::newRow("newton") << true;
+}
+
+void TestSplineInverter::testRangeQueries(void)
+{
+    QFETCH(bool, newton);
+
+    //a track that goes right along y=0, turns around, and comes back along y=3
+    std::vector<Vector2> data = {
+        Vector2({-10, 0}), Vector2({0, 0}), Vector2({10, 0}), Vector2({20, 0}), Vector2({25, 1.5f}),
+        Vector2({20, 3}), Vector2({10, 3}), Vector2({0, 3}), Vector2({-10, 3})
+    };
+    auto spline = TestDataFloat::createUniformCR(data);
+
+    typedef SplineInverter<Vector2> InverterType;
+    InverterType inverter(*spline, 10, newton ? InverterType::RefinementMethod::Newton : InverterType::RefinementMethod::Brent);
+
+    //halfway between the two passes, both are 1.5 away, and the single closest T only finds one of them
+    Vector2 queryPoint({10, 1.5f});
+
+    std::vector<float> within = inverter.findAllWithin(queryPoint, 2);
+    QCOMPARE(within.size(), size_t(2));
+    QVERIFY(within[0] < within[1]);
+    QVERIFY(std::abs(spline->getPosition(within[0])[1] - 0) < 1e-3f);
+    QVERIFY(std::abs(spline->getPosition(within[1])[1] - 3) < 1e-3f);
+
+    QVERIFY(inverter.findAllWithin(queryPoint, 1).empty());
+
+    //the closest pass comes first
+    Vector2 offsetQueryPoint({10, 1});
+    std::vector<float> closest = inverter.findKClosest(offsetQueryPoint, 2);
+    QCOMPARE(closest.size(), size_t(2));
+    QVERIFY(std::abs(spline->getPosition(closest[0])[1] - 0) < 1e-3f);
+    QVERIFY(std::abs(spline->getPosition(closest[1])[1] - 3) < 1e-3f);
+
+    //there are only two passes near the query point, and the far ends of the track aren't local minima, so asking for more doesn't find any more
+    QCOMPARE(inverter.findKClosest(offsetQueryPoint, 5).size(), size_t(2));
+    QVERIFY(inverter.findKClosest(offsetQueryPoint, 0).empty());
+
+    //the closest of the k closest is the same point findClosestT finds
+    std::minstd_rand gen(13);
+    std::uniform_real_distribution<float> distribution(-15, 30);
+    for(int i = 0; i < 200; i++)
+    {
+        Vector2 randomPoint({distribution(gen), distribution(gen)});
+
+        float expectedDistance = (spline->getPosition(inverter.findClosestT(randomPoint)) - randomPoint).length();
+        float actualDistance = (spline->getPosition(inverter.findKClosest(randomPoint, 1).front()) - randomPoint).length();
+        QVERIFY(std::abs(actualDistance - expectedDistance) < 1e-3f);
+
+        //every T found by findAllWithin is inside the radius
+        for(float t : inverter.findAllWithin(randomPoint, 5))
+        {
+            QVERIFY((spline->getPosition(t) - randomPoint).length() <= 5);
+        }
+    }
+}
+
+
+
+void TestSplineInverter::testDynamicInverter(void)
+{
+    auto data = TestDataFloat::generateRandomData(40);
+    UniformCRSpline<Vector2> spline(data);
+
+    //use small blocks, so that the edits only touch some of them
+    typedef DynamicSplineInverter<Vector2> InverterType;
+    InverterType inverter(spline, 10, 4);
+    QCOMPARE(inverter.blockCount(), (spline.segmentCount() + 3) / 4);
+
+    //each point of a uniform catmull-rom spline is used by the 3 segments before it, and the segment that starts at it
+    spline.replacePoint(10, data[10] + Vector2({3, -2}));
+    inverter.invalidateSegments(7, 10);
+    spline.replacePoint(2, data[2] + Vector2({-1, 4}));
+    inverter.invalidateSegments(0, 2);
+
+    //appended segments don't need to be invalidated
+    spline.appendPoint(data.back() + Vector2({4, 1}));
+    spline.appendPoint(data.back() + Vector2({6, 5}));
+    inverter.update();
+
+    InverterType expectedInverter(spline, 10, 4);
+    QCOMPARE(inverter.blockCount(), expectedInverter.blockCount());
+    QCOMPARE(inverter.sampleCount(), expectedInverter.sampleCount());
+
+    std::minstd_rand gen(17);
+    std::uniform_real_distribution<float> distribution(-10, 160);
+    for(int i = 0; i < 500; i++)
+    {
+        Vector2 queryPoint({distribution(gen), distribution(gen)});
+        QCOMPARE(inverter.findClosestT(queryPoint), expectedInverter.findClosestT(queryPoint));
+    }
+
+    //points on the edited spline are found, on both sides of every block boundary. brent's method only solves to 16 bits, so allow some error
+    std::uniform_real_distribution<float> tDistribution(0, spline.getMaxT());
+    for(int i = 0; i < 500; i++)
+    {
+        Vector2 queryPoint = spline.getPosition(tDistribution(gen));
+
+        float closestT = inverter.findClosestT(queryPoint);
+        QVERIFY((spline.getPosition(closestT) - queryPoint).length() < 0.1f);
+    }
+
+    //looping splines wrap the neighbors of the first and last samples around to the other end
+    auto loopingSpline = TestDataFloat::createCircularQuinticHermite(12, 10.0f);
+    DynamicSplineInverter<Vector2> loopingInverter(*loopingSpline, 10, 5);
+    std::uniform_real_distribution<float> loopingDistribution(0, loopingSpline->getMaxT());
+    for(int i = 0; i < 500; i++)
+    {
+        Vector2 queryPoint = loopingSpline->getPosition(loopingDistribution(gen));
+
+        float closestT = loopingInverter.findClosestT(queryPoint);
+        QVERIFY((loopingSpline->getPosition(closestT) - queryPoint).length() < 0.1f);
+        QVERIFY(closestT >= 0 && closestT < loopingSpline->getMaxT());
+    }
+
+    //points at the seam are bracketed by samples on both ends of the spline, but the result is still wrapped into the spline's range
+    float loopingMaxT = loopingSpline->getMaxT();
+    for(float t : {0.0f, 0.01f, loopingMaxT - 0.01f})
+    {
+        float closestT = loopingInverter.findClosestT(loopingSpline->getPosition(t));
+        QVERIFY(closestT >= 0 && closestT < loopingMaxT);
+        QVERIFY((loopingSpline->getPosition(closestT) - loopingSpline->getPosition(t)).length() < 0.1f);
+    }
+}
+
+
+
+void TestSplineInverter::testSegmentBVH_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(40);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data);
+    QTest::newRow("natural") << TestDataFloat::createNatural(data, true, 0.5f);
+    QTest::newRow("quinticHermite") << TestDataFloat::createQuinticHermite(data, 0.5f);
+    QTest::newRow("genericB") << TestDataFloat::createGenericBSpline(data, 5);
+    QTest::newRow("circularQuinticHermite") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createCircularQuinticHermite(12, 10.0f));
+}
+
+void TestSplineInverter::testSegmentBVH(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+
+    typedef SegmentBVH<Vector2> BVHType;
+    BVHType bvh(*spline);
+    QCOMPARE(bvh.segmentCount(), spline->segmentCount());
+
+    //every point of each segment is inside its box, and the box's edges are touched by the segment
+    const int samplesPerSegment = 200;
+    for(size_t segment = 0; segment < spline->segmentCount(); segment++)
+    {
+        const BVHType::Box &box = bvh.segmentBounds(segment);
+        BVHType::Box sampledBox = box;
+
+        float beginT = spline->segmentT(segment);
+        float endT = spline->segmentT(segment + 1);
+        for(int i = 0; i <= samplesPerSegment; i++)
+        {
+            Vector2 position = spline->segmentPosition(segment, beginT + (endT - beginT) * i / samplesPerSegment);
+            for(size_t d = 0; d < 2; d++)
+            {
+                QVERIFY(position[d] >= box.minimum[d] - 1e-4f);
+                QVERIFY(position[d] <= box.maximum[d] + 1e-4f);
+
+                sampledBox.minimum[d] = i == 0 ? position[d] : std::min(sampledBox.minimum[d], position[d]);
+                sampledBox.maximum[d] = i == 0 ? position[d] : std::max(sampledBox.maximum[d], position[d]);
+            }
+        }
+        for(size_t d = 0; d < 2; d++)
+        {
+            QVERIFY(sampledBox.minimum[d] - box.minimum[d] < 1e-3f);
+            QVERIFY(box.maximum[d] - sampledBox.maximum[d] < 1e-3f);
+        }
+    }
+
+    //the tree's queries find exactly the segments whose boxes pass the same test
+    auto overlaps = [](const BVHType::Box &a, const BVHType::Box &b) {
+        return a.minimum[0] <= b.maximum[0] && b.minimum[0] <= a.maximum[0] && a.minimum[1] <= b.maximum[1] && b.minimum[1] <= a.maximum[1];
+    };
+    BVHType::Box queryBox = {{{10, 10}}, {{40, 30}}};
+    std::vector<size_t> found;
+    bvh.findSegmentsInBox(queryBox, found);
+    std::sort(found.begin(), found.end());
+    std::vector<size_t> expected;
+    for(size_t segment = 0; segment < spline->segmentCount(); segment++)
+    {
+        if(overlaps(bvh.segmentBounds(segment), queryBox))
+            expected.push_back(segment);
+    }
+    QVERIFY(found == expected);
+
+    //the same box, as 4 planes facing inwards
+    std::vector<BVHType::Plane> planes = {
+        {{{1, 0}}, -10}, {{{-1, 0}}, 40}, {{{0, 1}}, -10}, {{{0, -1}}, 30}
+    };
+    found.clear();
+    bvh.findSegmentsInsidePlanes(planes, found);
+    std::sort(found.begin(), found.end());
+    QVERIFY(found == expected);
+
+    //a diagonal ray finds at least every segment that crosses it
+    found.clear();
+    bvh.findSegmentsAlongRay(Vector2({-10, -10}), Vector2({1, 1}).normalized(), 300, found);
+    for(size_t segment = 0; segment < spline->segmentCount(); segment++)
+    {
+        Vector2 begin = spline->segmentPosition(segment, spline->segmentT(segment));
+        Vector2 end = spline->segmentPosition(segment, spline->segmentT(segment + 1));
+        if((begin[1] - begin[0] < 0) != (end[1] - end[0] < 0))
+            QVERIFY(std::find(found.begin(), found.end(), segment) != found.end());
+    }
+    found.clear();
+    bvh.findSegmentsAlongRay(Vector2({-10, -10}), Vector2({-1, -1}).normalized(), 5, found);
+    QVERIFY(found.empty());
+
+    //the closest point is never farther than the closest of a dense set of samples
+    std::vector<Vector2> samples;
+    const int sampleCount = 20000;
+    for(int i = 0; i <= sampleCount; i++)
+    {
+        samples.push_back(spline->getPosition(spline->getMaxT() * i / sampleCount));
+    }
+
+    std::minstd_rand gen(19);
+    std::uniform_real_distribution<float> distribution(-10, 160);
+    for(int i = 0; i < 100; i++)
+    {
+        Vector2 queryPoint({distribution(gen), distribution(gen)});
+
+        float bruteForceDistance = std::numeric_limits<float>::max();
+        for(const Vector2 &sample : samples)
+        {
+            bruteForceDistance = std::min(bruteForceDistance, (sample - queryPoint).length());
+        }
+
+        float closestT = bvh.findClosestT(queryPoint);
+        float distance = (spline->getPosition(closestT) - queryPoint).length();
+        QVERIFY(distance <= bruteForceDistance + 1e-3f);
+    }
+
+    //a spline with a higher degree than maxDegree is rejected, instead of being fitted with a polynomial of too low a degree
+    auto highDegreeSpline = TestDataFloat::createGenericBSpline(TestDataFloat::generateRandomData(20), 7);
+    bool rejected = false;
+    try
+    {
+        BVHType tooLow(*highDegreeSpline);
+    }
+    catch(const std::invalid_argument &)
+    {
+        rejected = true;
+    }
+    QVERIFY(rejected);
+
+    SegmentBVH<Vector2, float, 2, Spline<Vector2>, 7> highDegreeBVH(*highDegreeSpline);
+    QCOMPARE(highDegreeBVH.segmentCount(), highDegreeSpline->segmentCount());
+}
+
+
+
+void TestSplineInverter::testDistanceField_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<int>("supersampling");
+    QTest::addColumn<int>("tileSize");
+    QTest::addColumn<int>("threadCount");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data) << 1 << 16 << 1;
+    QTest::newRow("natural supersampled") << TestDataFloat::createNatural(data, true, 0.0f) << 2 << 8 << 1;
+    QTest::newRow("loopingCubicHermite threaded") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingCubicHermite(data, 0.5f)) << 2 << 5 << 3;
+    QTest::newRow("loopingGenericB single tile") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingGenericBSpline(data, 5)) << 1 << 1000 << 4;
+}
+
+void TestSplineInverter::testDistanceField(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(int, supersampling);
+    QFETCH(int, tileSize);
+    QFETCH(int, threadCount);
+
+    //an image that extends a little past the random data on every side, with a size that isn't a multiple of the tile size
+    DistanceField<Vector2>::Settings settings;
+    settings.width = 37;
+    settings.height = 29;
+    settings.originX = -10;
+    settings.originY = -5;
+    settings.pixelSize = 1.75f;
+    settings.supersampling = size_t(supersampling);
+    settings.tileSize = size_t(tileSize);
+    settings.threadCount = size_t(threadCount);
+
+    DistanceField<Vector2> field(*spline, settings);
+    size_t perPixel = field.samplesPerPixel();
+    size_t pixelCount = settings.width * settings.height;
+
+    std::vector<float> closestT(pixelCount * perPixel);
+    field.computeClosestT(closestT.data());
+
+    //the field doesn't search the kd-tree for each point, but it should still find the same closest points as the inverter
+    typedef DistanceField<Vector2>::InverterType InverterType;
+    InverterType inverter(*spline, 10, InverterType::RefinementMethod::Newton);
+    std::vector<float> expectedDistances(pixelCount, 0);
+    for(size_t y = 0; y < settings.height; y++)
+    {
+        for(size_t x = 0; x < settings.width; x++)
+        {
+            size_t pixelIndex = y * settings.width + x;
+            for(size_t i = 0; i < perPixel; i++)
+            {
+                Vector2 queryPoint = field.samplePosition(x, y, i);
+                float expected = (spline->getPosition(inverter.findClosestT(queryPoint)) - queryPoint).length();
+                float actual = (spline->getPosition(closestT[pixelIndex * perPixel + i]) - queryPoint).length();
+                QVERIFY(std::abs(actual - expected) < 1e-3f);
+
+                expectedDistances[pixelIndex] += actual / perPixel;
+            }
+        }
+    }
+
+    std::vector<float> distances(pixelCount);
+    field.computeDistances(distances.data());
+    for(size_t i = 0; i < pixelCount; i++)
+    {
+        QVERIFY(std::abs(distances[i] - expectedDistances[i]) < 1e-3f);
+    }
+
+    //color each sample by its T, so that the averaged color can be checked against the closest T values
+    //looping splines can return T values slightly outside [0, maxT], so clamp them first
+    float maxT = spline->getMaxT();
+    auto fraction = [maxT](float t) { return std::min(1.0f, std::max(0.0f, t / maxT)); };
+    std::vector<uint8_t> colors(pixelCount * 4);
+    field.computeColors([fraction](float t) { return std::array<float, 4>{{ fraction(t), 1 - fraction(t), 2.0f, -1.0f }}; }, colors.data());
+    for(size_t i = 0; i < pixelCount; i++)
+    {
+        float averageFraction = 0;
+        for(size_t s = 0; s < perPixel; s++)
+        {
+            averageFraction += fraction(closestT[i * perPixel + s]) / perPixel;
+        }
+        QVERIFY(std::abs(colors[i * 4 + 0] - averageFraction * 255) <= 1.0f);
+        QVERIFY(std::abs(colors[i * 4 + 1] - (1 - averageFraction) * 255) <= 1.0f);
+        QCOMPARE(int(colors[i * 4 + 2]), 255);
+        QCOMPARE(int(colors[i * 4 + 3]), 0);
+    }
+}
+
+void TestSplineInverter::testInstrumentation_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data);
+    QTest::newRow("loopingCubicHermite") << std::static_pointer_cast<Spline<Vector2>>(TestDataFloat::createLoopingCubicHermite(data, 0.5f));
+}
+
+void TestSplineInverter::testInstrumentation(void)
+{
+    if(!SplineInstrumentation::enabled)
+        QSKIP("Built without SPLINE_LIBRARY_INSTRUMENTATION");
+
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    typedef SplineInstrumentation::Counter Counter;
+
+    typedef SplineInverter<Vector2> InverterType;
+    InverterType brentInverter(*spline, 10, InverterType::RefinementMethod::Brent);
+    InverterType newtonInverter(*spline, 10, InverterType::RefinementMethod::Newton);
+
+    const size_t queryCount = 20;
+    std::vector<Vector2> queryPoints;
+    std::minstd_rand gen(11);
+    std::uniform_real_distribution<float> distribution(-10, 60);
+    for(size_t i = 0; i < queryCount; i++)
+    {
+        queryPoints.push_back(Vector2({distribution(gen), distribution(gen)}));
+    }
+
+    //every query searches the tree exactly once
+    SplineInstrumentation::reset();
+    for(const Vector2 &queryPoint : queryPoints)
+    {
+        brentInverter.findClosestT(queryPoint);
+    }
+    SplineInstrumentation::Snapshot brent = SplineInstrumentation::snapshot();
+    QCOMPARE(brent[Counter::KdTreeSearches], uint64_t(queryCount));
+    QVERIFY(brent[Counter::BrentIterations] > 0);
+    QCOMPARE(brent[Counter::NewtonIterations], uint64_t(0));
+
+    //the batch method's worker threads are joined before it returns, so their counts are included as well
+    std::vector<float> results(queryCount);
+    SplineInstrumentation::reset();
+    newtonInverter.findClosestT(queryPoints.data(), queryCount, results.data(), 3);
+    SplineInstrumentation::Snapshot newton = SplineInstrumentation::snapshot();
+    QCOMPARE(newton[Counter::KdTreeSearches], uint64_t(queryCount));
+    QVERIFY(newton[Counter::NewtonIterations] > 0);
+}
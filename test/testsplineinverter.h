@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+
+class TestSplineInverter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestSplineInverter(QObject *parent = 0);
+
+private slots:
+    //verify that the batch version of findClosestT gives the same results as calling findClosestT for each query point, with and without threads
+    void testBatchFindClosestT_data(void);
+    void testBatchFindClosestT(void);
+
+    //verify that newton refinement finds the same closest points as brent refinement
+    void testNewtonRefinement_data(void);
+    void testNewtonRefinement(void);
+
+    //verify that query points on the spline are found by each sampling method, and that each sample is tagged with its segment
+    void testSampling_data(void);
+    void testSampling(void);
+
+    //verify that findAllWithin and findKClosest find one T for each pass of a track that doubles back on itself
+    void testRangeQueries_data(void);
+    void testRangeQueries(void);
+
+    //verify that after a batch of edits, DynamicSplineInverter gives the same results as an inverter created from scratch for the edited spline
+    void testDynamicInverter(void);
+
+    //verify that SegmentBVH's boxes tightly contain their segments, that its queries agree with checking every box, and that its closest point is never farther than a brute force search
+    void testSegmentBVH_data(void);
+    void testSegmentBVH(void);
+
+    //verify that DistanceField finds the same closest points as the inverter, and that its distances and colors agree with those points
+    void testDistanceField_data(void);
+    void testDistanceField(void);
+
+    //verify that the instrumentation counters separate the inverter's kd-tree searches from its brent and newton iterations
+    void testInstrumentation_data(void);
+    void testInstrumentation(void);
+};
@@ -0,0 +1,162 @@
+#include "testtessellation.h"
+
+#include "common.h"
+#include "spline_library/utils/tessellation.h"
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+#include <QtTest/QtTest>
+
+TestTessellation::TestTessellation(QObject *parent) : QObject(parent)
+{
+
+}
+
+void TestTessellation::testWorkStealingFor_data(void)
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("empty") << 0 << 4;
+    QTest::newRow("single thread") << 1000 << 1;
+    QTest::newRow("fewer indexes than threads") << 3 << 8;
+    QTest::newRow("multiple threads") << 1000 << 4;
+    QTest::newRow("uneven split") << 997 << 7;
+}
+
+void TestTessellation::testWorkStealingFor(void)
+{
+    QFETCH(int, count);
+    QFETCH(int, threadCount);
+
+    std::unique_ptr<std::atomic<int>[]> visits(new std::atomic<int>[size_t(count) + 1]);
+    for(int i = 0; i < count; i++)
+    {
+        visits[i] = 0;
+    }
+
+    std::atomic<bool> validWorker(true);
+    SplineParallel::workStealingFor(size_t(count), size_t(threadCount), [&](size_t index, size_t worker) {
+        if(worker >= size_t(threadCount))
+            validWorker = false;
+
+        //make the early indexes much more expensive than the late ones, so that the threads that started with the late ones run out and have to steal
+        volatile double busy = 0;
+        for(size_t i = 0; i < (size_t(count) - index) * 20; i++)
+        {
+            busy = busy + 1;
+        }
+        visits[index]++;
+    });
+
+    QVERIFY(validWorker);
+    for(int i = 0; i < count; i++)
+    {
+        QCOMPARE(int(visits[i]), 1);
+    }
+
+    //the ranged version should cover every index exactly once too, with chunks that don't divide the count evenly
+    for(int i = 0; i < count; i++)
+    {
+        visits[i] = 0;
+    }
+    SplineParallel::workStealingForRanges(size_t(count), 10, size_t(threadCount), [&](size_t begin, size_t end, size_t) {
+        for(size_t index = begin; index < end; index++)
+        {
+            visits[index]++;
+        }
+    });
+    for(int i = 0; i < count; i++)
+    {
+        QCOMPARE(int(visits[i]), 1);
+    }
+
+    //an exception thrown on any thread should be rethrown on the calling thread
+    bool caught = false;
+    try
+    {
+        SplineParallel::workStealingFor(size_t(count), size_t(threadCount), [&](size_t index, size_t) {
+            if(index == size_t(count) / 2)
+                throw std::runtime_error("index failed");
+        });
+    }
+    catch(const std::runtime_error &)
+    {
+        caught = true;
+    }
+    QCOMPARE(caught, count > 0);
+}
+
+void TestTessellation::testTessellate_data(void)
+{
+    QTest::addColumn<std::shared_ptr<Spline<Vector2>>>("spline");
+    QTest::addColumn<float>("tolerance");
+
+    auto data = TestDataFloat::generateRandomData(10);
+
+    QTest::newRow("uniformCR") << TestDataFloat::createUniformCR(data) << 0.1f;
+    QTest::newRow("uniformCR fine") << TestDataFloat::createUniformCR(data) << 0.001f;
+    QTest::newRow("CatmullRomAlpha") << TestDataFloat::createCatmullRom(data, 0.5f) << 0.05f;
+    QTest::newRow("natural") << TestDataFloat::createNatural(data, true, 0.0f) << 0.05f;
+    QTest::newRow("quinticHermite") << TestDataFloat::createQuinticHermite(data, 0.5f) << 0.01f;
+    QTest::newRow("genericB") << TestDataFloat::createGenericBSpline(data, 5) << 0.01f;
+    QTest::newRow("loopingCubicHermite") << TestDataFloat::cast(TestDataFloat::createLoopingCubicHermite(data, 0.5f)) << 0.05f;
+    QTest::newRow("loopingGenericB") << TestDataFloat::cast(TestDataFloat::createLoopingGenericBSpline(data, 4)) << 0.05f;
+}
+
+void TestTessellation::testTessellate(void)
+{
+    QFETCH(std::shared_ptr<Spline<Vector2>>, spline);
+    QFETCH(float, tolerance);
+
+    auto polyline = Tessellation::tessellate(*spline, tolerance, 1);
+
+    size_t segmentCount = spline->segmentCount();
+    QCOMPARE(polyline.segmentOffsets.size(), segmentCount + 1);
+    QCOMPARE(polyline.segmentOffsets.front(), size_t(0));
+    QCOMPARE(polyline.segmentOffsets.back() + 1, polyline.points.size());
+    QCOMPARE(polyline.tValues.size(), polyline.points.size());
+    QCOMPARE(polyline.tValues.back(), spline->getMaxT());
+
+    //every segment begins its own run of points, and the T values only increase
+    for(size_t i = 0; i < segmentCount; i++)
+    {
+        QVERIFY(polyline.segmentOffsets[i] < polyline.segmentOffsets[i + 1]);
+        QCOMPARE(polyline.tValues[polyline.segmentOffsets[i]], spline->segmentT(i));
+    }
+    for(size_t i = 1; i < polyline.tValues.size(); i++)
+    {
+        QVERIFY(polyline.tValues[i - 1] <= polyline.tValues[i]);
+    }
+
+    for(size_t i = 0; i < segmentCount; i++)
+    {
+        for(size_t p = polyline.segmentOffsets[i]; p < polyline.segmentOffsets[i + 1]; p++)
+        {
+            float beginT = polyline.tValues[p];
+            float endT = polyline.tValues[p + 1];
+
+            Vector2 expectedBegin = spline->segmentPosition(i, beginT);
+            QVERIFY((polyline.points[p] - expectedBegin).length() < 1e-5f);
+
+            if(endT > beginT)
+            {
+                Vector2 chordMiddle = (polyline.points[p] + polyline.points[p + 1]) / 2.0f;
+                float error = (spline->segmentPosition(i, (beginT + endT) / 2) - chordMiddle).length();
+                QVERIFY(error <= tolerance * 1.001f + 1e-5f);
+            }
+        }
+    }
+
+    //the work is split differently with more threads, but every segment is subdivided the same way
+    auto threadedPolyline = Tessellation::tessellate(*spline, tolerance, 4);
+    QVERIFY(threadedPolyline.tValues == polyline.tValues);
+    QVERIFY(threadedPolyline.segmentOffsets == polyline.segmentOffsets);
+    for(size_t i = 0; i < polyline.points.size(); i++)
+    {
+        QCOMPARE(threadedPolyline.points[i], polyline.points[i]);
+    }
+}
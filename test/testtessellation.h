@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QObject>
+
+class TestTessellation : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestTessellation(QObject *parent = nullptr);
+
+private slots:
+    //verify that workStealingFor and workStealingForRanges call the function exactly once for every index, for several thread counts, and that exceptions reach the caller
+    void testWorkStealingFor_data(void);
+    void testWorkStealingFor(void);
+
+    //verify that tessellate's points are on the spline, that every piece is within the tolerance of its chord, and that the results don't depend on the thread count
+    void testTessellate_data(void);
+    void testTessellate(void);
+};
@@ -14,6 +14,8 @@
 #include <vector>
 
 #include <memory>
+#include <array>
+#include <cmath>
 
 #include <QtTest/QtTest>
 
@@ -156,6 +158,71 @@ void TestVector::testLengthOperations(void)
     }
 }
 
+template<size_t dimension, typename floating_t>
+static void verifyMultiplyAdd(void)
+{
+    typedef Vector<dimension, floating_t> VectorT;
+
+    std::array<floating_t, dimension> a, b, expected;
+    for(size_t i = 0; i < dimension; i++) {
+        a[i] = floating_t(i + 1);
+        b[i] = floating_t(10 * i) - 3;
+        expected[i] = a[i] + b[i] * floating_t(0.5);
+    }
+    QCOMPARE(VectorT::multiplyAdd(VectorT(a), VectorT(b), floating_t(0.5)), VectorT(expected));
+}
+
+void TestVector::testMultiplyAdd(void)
+{
+    verifyMultiplyAdd<2, float>();
+    verifyMultiplyAdd<3, float>();
+    verifyMultiplyAdd<4, float>();
+    verifyMultiplyAdd<2, double>();
+    verifyMultiplyAdd<3, double>();
+    verifyMultiplyAdd<4, double>();
+    verifyMultiplyAdd<5, float>();
+}
+
+template<size_t dimension, typename floating_t>
+static void verifyPaddingLane(void)
+{
+    typedef Vector<dimension, floating_t> VectorT;
+
+    std::array<floating_t, dimension> components;
+    for(size_t i = 0; i < dimension; i++) {
+        components[i] = floating_t(i + 2);
+    }
+    VectorT v(components);
+
+    //dividing by zero makes the padding lane of a 3 dimensional register 0/0, which is NaN. writing the components back leaves the NaN in the padding lane,
+    //so if it were included in any result, the comparisons below would fail
+    VectorT padded = v / floating_t(0);
+    QVERIFY(std::isinf(padded[0]));
+    for(size_t i = 0; i < dimension; i++) {
+        padded[i] = components[i];
+    }
+    QVERIFY(padded == v);
+    QVERIFY(!(padded != v));
+
+    floating_t expectedDot = 0;
+    for(size_t i = 0; i < dimension; i++) {
+        expectedDot += components[i] * components[i];
+    }
+    QCOMPARE(padded.lengthSquared(), expectedDot);
+    QCOMPARE(VectorT::dotProduct(padded, v), expectedDot);
+    QCOMPARE((padded * floating_t(2)).lengthSquared(), expectedDot * 4);
+}
+
+void TestVector::testPaddingLane(void)
+{
+    verifyPaddingLane<2, float>();
+    verifyPaddingLane<3, float>();
+    verifyPaddingLane<4, float>();
+    verifyPaddingLane<2, double>();
+    verifyPaddingLane<3, double>();
+    verifyPaddingLane<4, double>();
+}
+
 void TestVector::testSplineFunctionality_data(void)
 {
     std::vector<Vector2> cubicPoints {
@@ -22,6 +22,10 @@ private slots:
     void testLengthOperations_data(void);
     void testLengthOperations(void);
 
+    //verify multiplyAdd, and that the padding lane of SIMD backed vectors never shows up in dot products or comparisons, for every dimension that can be SIMD backed
+    void testMultiplyAdd(void);
+    void testPaddingLane(void);
+
     //verify that we can create a spline using Vector as the interpolation type and get the expected results
     void testSplineFunctionality_data(void);
     void testSplineFunctionality(void);